@@ -1,13 +1,14 @@
 # ----------------------------
 # Qt Modules
 # ----------------------------
-QT += core gui printsupport sql serialbus concurrent
+QT += core gui printsupport sql serialbus concurrent network
 greaterThan(QT_MAJOR_VERSION, 4): QT += widgets 
 
 CONFIG += c++17
 
 # 禁用 Qt 过时 API（如需要，取消注释）
 # DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000
+# Modbus 采集链路压力测试为独立目标: benchmark/mdbbenchmark.pro
 
 # ----------------------------
 # 编译选项
@@ -38,7 +39,26 @@ SOURCES += \
     src/DebugTestMotion.cpp \
     src/DrillingController.cpp \
     src/DrillingParameters.cpp \
-    src/StateMachineWorker.cpp
+    src/StateMachineWorker.cpp \
+    src/daqringbuffer.cpp \
+    src/daqblock.cpp \
+    src/vibrationstore.cpp \
+    src/vibrationrecorder.cpp \
+    src/vibrationsegment.cpp \
+    src/plotdecimator.cpp \
+    src/vibrationhistory.cpp \
+    src/realfft.cpp \
+    src/vibrationanalyzer.cpp \
+    src/mdbrecorder.cpp \
+    src/mdbpollscheduler.cpp \
+    src/sensoraligner.cpp \
+    src/mdbdecoder.cpp \
+    src/mdbtcptransport.cpp \
+    src/mdbcalibration.cpp \
+    src/axistelemetry.cpp \
+    src/motionstate.cpp \
+    src/controlexecutor.cpp \
+    src/stepsequencer.cpp
     
 
 # ----------------------------
@@ -65,7 +85,29 @@ HEADERS += \
     #inc/MotionParameters.h \
     inc/DrillingController.h \
     inc/DrillingParameters.h \
-    inc/StateMachineWorker.h
+    inc/StateMachineWorker.h \
+    inc/daqringbuffer.h \
+    inc/daqblock.h \
+    inc/vibrationstore.h \
+    inc/vibrationrecorder.h \
+    inc/vibrationsegment.h \
+    inc/plotdecimator.h \
+    inc/vibrationhistory.h \
+    inc/realfft.h \
+    inc/vibrationanalyzer.h \
+    inc/mdbrecorder.h \
+    inc/mdbpollscheduler.h \
+    inc/sensorclock.h \
+    inc/sensoraligner.h \
+    inc/mdbdecoder.h \
+    inc/mdbtcptransport.h \
+    inc/mdbcalibration.h \
+    inc/seqlock.h \
+    inc/livesensors.h \
+    inc/axistelemetry.h \
+    inc/motionstate.h \
+    inc/controlexecutor.h \
+    inc/stepsequencer.h
 
 # ----------------------------
 # UI 界面文件
@@ -77,6 +119,10 @@ FORMS += \
     vk701page.ui \
     zmotionpage.ui
 
+# 控制器工程中的 BASIC 程序 (不参与编译)
+DISTFILES += \
+    bas/AXISTELEM.BAS
+
 # ----------------------------
 # 头文件 & 库路径
 # ----------------------------
@@ -127,6 +173,13 @@ unix:!macx {
     LIBS += -L$$PWD/lib/ -lzmotion
 }
 
+# ----------------------------
+# 系统库 (控制周期高精度定时)
+# ----------------------------
+win32 {
+    LIBS += -lwinmm
+}
+
 # ----------------------------
 # 目标文件夹
 # ----------------------------
@@ -0,0 +1,18 @@
+#include "inc/mdbbenchmark.h"
+#include <QCoreApplication>
+#include <QTextCodec>
+
+// mdbprocess 按该开关决定是否记录, 压力测试不写数据库
+bool AllRecordStart = false;
+
+int main(int argc, char *argv[])
+{
+    // 设置UTF-8编码，确保中文显示正常
+    QTextCodec::setCodecForLocale(QTextCodec::codecForName("UTF-8"));
+
+    QCoreApplication a(argc, argv);
+
+    // Modbus 采集链路压力测试: 连接本地模拟器, 输出结果后退出
+    MdbBenchmark mdbBenchmark;
+    return mdbBenchmark.run() ? 0 : 1;
+}
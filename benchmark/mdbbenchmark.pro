@@ -0,0 +1,54 @@
+# ----------------------------
+# Modbus 采集链路压力测试 (本地模拟器)
+# 独立于主程序构建: qmake benchmark/mdbbenchmark.pro && make
+# ----------------------------
+QT += core network serialbus sql
+QT -= gui
+
+CONFIG += c++17 console
+CONFIG -= app_bundle
+
+TARGET = mdbbenchmark
+
+QMAKE_CXXFLAGS += -fpermissive
+msvc {
+    QMAKE_CXXFLAGS += -utf-8
+}
+
+ROOT = $$PWD/..
+
+# ----------------------------
+# 源文件
+# ----------------------------
+SOURCES += \
+    main.cpp \
+    $$ROOT/src/mdbbenchmark.cpp \
+    $$ROOT/src/mdbsimulator.cpp \
+    $$ROOT/src/mdbprocess.cpp \
+    $$ROOT/src/mdbpollscheduler.cpp \
+    $$ROOT/src/mdbtcptransport.cpp \
+    $$ROOT/src/mdbdecoder.cpp \
+    $$ROOT/src/mdbcalibration.cpp \
+    $$ROOT/src/mdbrecorder.cpp \
+    $$ROOT/src/sensoraligner.cpp
+
+HEADERS += \
+    $$ROOT/inc/mdbbenchmark.h \
+    $$ROOT/inc/mdbsimulator.h \
+    $$ROOT/inc/mdbprocess.h \
+    $$ROOT/inc/mdbpollscheduler.h \
+    $$ROOT/inc/mdbtcptransport.h \
+    $$ROOT/inc/mdbdecoder.h \
+    $$ROOT/inc/mdbcalibration.h \
+    $$ROOT/inc/mdbrecorder.h \
+    $$ROOT/inc/sensoraligner.h \
+    $$ROOT/inc/sensorclock.h \
+    $$ROOT/inc/seqlock.h \
+    $$ROOT/inc/livesensors.h
+
+# ----------------------------
+# 头文件路径
+# ----------------------------
+INCLUDEPATH += \
+    $$ROOT \
+    $$ROOT/inc
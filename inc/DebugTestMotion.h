@@ -88,7 +88,7 @@ private:
     int m_currentSequenceIndex;
     bool m_isStepMode;
     bool m_isRunning;
-    QMap<int, QMap<QString, float>> m_motorStatus; // 存储电机状态
+    QMap<int, AxisState> m_motorStatus; // 存储电机状态
 
 private slots:
     // 状态机事件响应
@@ -100,7 +100,7 @@ private slots:
     void onPipeCountChanged(int count);
     
     // 电机状态更新
-    void onMotorStatusUpdated(int motorID, const QMap<QString, float>& params);
+    void onMotorStatusUpdated(int motorID, const AxisState& state);
     
     // 命令响应
     void onCommandResponse(const QString& response);
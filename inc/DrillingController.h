@@ -3,6 +3,9 @@
 
 #include "autodrilling.h"
 #include "motioncontroller.h"
+#include "sensoraligner.h"
+#include "livesensors.h"
+#include "controlexecutor.h"
 #include <QObject>
 #include <QThread>
 #include <QMutex>
@@ -37,6 +40,9 @@ public:
     // 获取运动控制器指针
     MotionController* getMotionController() const;
     
+    // 获取控制执行线程 (读取周期抖动与超时统计)
+    ControlExecutor* getControlExecutor() const;
+    
     // 启动状态机
     bool startStateMachine();
     
@@ -55,6 +61,12 @@ public:
     // 是否正在运行
     bool isRunning() const;
 
+    // 获取最新的多传感器对齐帧 (拉力/扭矩/位置/振动/电机在同一时刻的值)
+    SensorFrame getSensorFrame() const;
+
+    // 获取 Modbus 传感器各通道的最新值 (无锁, 可在任意线程调用)
+    MdbCalibratedFrame getLiveSensors() const;
+
 signals:
     // 当前状态变更信号
     void currentStepChanged(const QString& oldState, const QString& newState);
@@ -75,7 +87,7 @@ signals:
     void stateMachineResumed();
     
     // 电机状态更新信号
-    void motorStatusUpdated(int motorID, const QMap<QString, float>& params);
+    void motorStatusUpdated(int motorID, const AxisState& state);
     
     // 工作线程控制信号
     void startWorker();
@@ -98,7 +110,7 @@ private slots:
     void onCommandResponse(const QString& response);
     
     // 电机状态更新处理
-    void onMotorStatusUpdated(int motorID, const QMap<QString, float>& params);
+    void onMotorStatusUpdated(int motorID, const AxisState& state);
     
     // 钻进模式变更处理
     void onDrillingModeChanged(AutoDrillingStateMachine::DrillMode mode, double value);
@@ -139,8 +151,8 @@ private:
     bool m_paused;
     bool m_stopRequested;
     
-    // 定时器，用于更新状态
-    QTimer m_updateTimer;
+    // 控制执行线程，按固定周期驱动状态机
+    ControlExecutor* m_executor;
 };
 
 #endif // DRILLINGCONTROLLER_H 
\ No newline at end of file
@@ -81,6 +81,23 @@ public:
         static inline const float CONNECTION_ENGAGED = 100.0f;    // 对接装置咬合位置
     };
 
+    // 控制周期参数
+    struct ControlLoop {
+        static const int PERIOD_US = 5000;      // 状态机控制周期 (1000 ~ 10000 us)
+        static const bool REALTIME = false;     // 申请实时调度 (SCHED_FIFO), 确认周期内无阻塞通信后再开启
+    };
+
+    // 自动流程步骤超时 (ms), 0 表示不限时
+    struct StepTimeout {
+        static const int STORAGE_MS = 20000;    // 存储机构旋转
+        static const int ROBOT_ARM_MS = 15000;  // 机械手旋转/伸缩/夹持
+        static const int SPINDLE_MS = 5000;     // 钻进机构转速/冲击设定
+        static const int PENETRATION_MS = 60000; // 进给机构定位 (含对接速度慢移)
+        static const int DRILLING_MS = 0;       // 钻进行程, 时间取决于地层
+        static const int CLAMP_MS = 10000;      // 下夹紧机构
+        static const int CONNECTION_MS = 10000; // 对接机构
+    };
+
     // 获取参数
     QVariant getParameter(const QString& category, const QString& name) const;
     
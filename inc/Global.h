@@ -7,7 +7,6 @@ extern int MotorMapbuckup[10];
 extern float fAxisNum;
 
 extern bool AllRecordStart;
-extern float downForce;
 
 // 声明全局变量
 extern ZMC_HANDLE g_handle;
@@ -3,6 +3,7 @@
 
 #include "autodrilling.h"
 #include <QObject>
+#include <atomic>
 
 /**
  * @brief 线程工作类，用于在单独线程中管理状态机
@@ -28,9 +29,10 @@ signals:
 
 private:
     AutoDrillingStateMachine* m_stateMachine;
-    bool m_running;
-    bool m_paused;
-    bool m_stopRequested;
+    // 由工作线程的槽修改, 在控制执行线程的 run() 中读取
+    std::atomic<bool> m_running;
+    std::atomic<bool> m_paused;
+    std::atomic<bool> m_stopRequested;
 };
 
 #endif // STATEMACHINEWORKER_H 
\ No newline at end of file
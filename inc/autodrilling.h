@@ -8,9 +8,17 @@
 #include <QObject>
 #include <memory>
 #include <QMap>
+#include <QMutex>
+#include <QFuture>
 
 // 前向声明
 class MotionController;
+class StorageUnitStateMachine;
+class RobotArmStateMachine;
+class DrillingMechanismStateMachine;
+class PenetrationMechanismStateMachine;
+class ClampMechanismStateMachine;
+class ConnectionMechanismStateMachine;
 
 // 钻管数量宏定义
 #define MAX_PIPE_COUNT 6       // 最大钻管数量
@@ -41,10 +49,33 @@ public:
     void setDebugMode(bool debug);
     bool isDebugMode() const;
     
+    // 电机最近一次运动是否已完成到位 (无运动或调试模式时为 true), 供控制周期轮询
+    bool isMoveDone(int motorID) const;
+    
 protected:
+    // 发出绝对运动后立即返回, 记录目标与完成令牌; timeoutMs 为 0 表示不限时
+    bool startMove(int motorID, float position, int timeoutMs = MotionController::MOTION_TIMEOUT);
+    
+    // 统一轮询是否在运行 (否则只能依据完成令牌判断)
+    static bool hasMotionState();
+    // 当前快照版本, 命令发出前记录, 用于排除命令之前读取的快照
+    static quint64 motionStateVersion();
+    // 从统一轮询快照读取电机状态, 版本低于 minVersion 或该轴未读到时返回 false
+    static bool readAxisState(int motorID, AxisState& state, quint64 minVersion = 0);
+    
     QString m_componentName;
     MotionController* m_motionController;
     bool m_isDebugMode;  // 添加调试模式标志
+    
+private:
+    // 最近一次运动
+    struct MoveRecord {
+        float target = 0;
+        quint64 issuedVersion = 0;      // 发出命令前的快照版本
+        QFuture<bool> done;             // 完成令牌 (统一轮询未运行时使用)
+    };
+    mutable QMutex m_moveMutex;
+    QMap<int, MoveRecord> m_moves;
 };
 
 /**
@@ -55,7 +86,7 @@ class AutoDrillingStateMachine : public StateMachine {
     Q_OBJECT
 
 public:
-    // 主状态机状态枚举
+    // 主状态机状态枚举, 即状态表中的 StateId
     enum MainState {
         SYSTEM_STARTUP,       // 系统启动
         DEFAULT_POSITION,     // 默认位置
@@ -66,7 +97,8 @@ public:
         PIPE_REMOVAL_LOOP,    // 钻管拆卸循环
         FIRST_TOOL_RECOVERY,  // 首根钻具回收
         SYSTEM_RESET,         // 系统重置
-        OPERATION_COMPLETE    // 操作完成
+        OPERATION_COMPLETE,   // 操作完成
+        MAIN_STATE_COUNT
     };
 
     // 钻进模式枚举
@@ -98,8 +130,11 @@ public:
     void pauseOperation();
     void resumeOperation();
     
-    // 获取当前钻管计数
+    // 获取当前钻管计数 (首根钻具之上已安装的钻管数)
     int getCurrentPipeCount() const;
+    // 钻管计数增减, 钻管安装/拆卸循环每完成一根时调用
+    void incrementPipeCount();
+    void decrementPipeCount();
     
     // 获取增量参数
     double getDeltaThread() const { return m_deltaThread; }
@@ -119,6 +154,17 @@ public:
     std::shared_ptr<ComponentStateMachine> getPenetrationMechanism() const { return m_penetrationMechanism; }
     std::shared_ptr<ComponentStateMachine> getClampMechanism() const { return m_clampMechanism; }
     std::shared_ptr<ComponentStateMachine> getConnectionMechanism() const { return m_connectionMechanism; }
+    
+    // 按具体类型缓存的组件指针 (构造时确定, 状态 update() 中直接使用, 无需 dynamic_cast)
+    StorageUnitStateMachine* storageUnit() const { return m_storageUnitPtr; }
+    RobotArmStateMachine* robotArm() const { return m_robotArmPtr; }
+    DrillingMechanismStateMachine* drillingMechanism() const { return m_drillingMechanismPtr; }
+    PenetrationMechanismStateMachine* penetrationMechanism() const { return m_penetrationMechanismPtr; }
+    ClampMechanismStateMachine* clampMechanism() const { return m_clampMechanismPtr; }
+    ConnectionMechanismStateMachine* connectionMechanism() const { return m_connectionMechanismPtr; }
+    
+    // 当前主状态
+    MainState getCurrentMainState() const;
 
     // 状态机状态名称常量
     static const QString STATE_SYSTEM_STARTUP;
@@ -134,17 +180,15 @@ public:
 
 protected:
     // 重写StateMachine的钩子方法
-    bool beforeStateChange(const QString& oldState, const QString& newState) override;
-    void afterStateChange(const QString& oldState, const QString& newState) override;
+    bool beforeStateChange(StateId oldState, StateId newState) override;
+    void afterStateChange(StateId oldState, StateId newState) override;
 
     // 创建主状态机状态
     void createMainStates();
+    // 建立主状态的转换表与守卫条件
+    void createTransitions();
 
 private:
-    // 钻管计数增减
-    void incrementPipeCount();
-    void decrementPipeCount();
-    
     // 运动控制器
     MotionController* m_motionController;
     
@@ -155,6 +199,12 @@ private:
     std::shared_ptr<ComponentStateMachine> m_penetrationMechanism; // 进给机构
     std::shared_ptr<ComponentStateMachine> m_clampMechanism;   // 下夹紧机构
     std::shared_ptr<ComponentStateMachine> m_connectionMechanism; // 对接机构
+    StorageUnitStateMachine* m_storageUnitPtr;
+    RobotArmStateMachine* m_robotArmPtr;
+    DrillingMechanismStateMachine* m_drillingMechanismPtr;
+    PenetrationMechanismStateMachine* m_penetrationMechanismPtr;
+    ClampMechanismStateMachine* m_clampMechanismPtr;
+    ConnectionMechanismStateMachine* m_connectionMechanismPtr;
     
     // 操作参数
     int m_pipeCount;            // 钻管计数
@@ -294,9 +344,14 @@ public:
     // 设置钻进模式 (66=恒速度, 67=恒力矩)
     bool setDrillMode(int mode, double value);
     
+    // 快照中的转速 (恒力矩模式为 DAC) 与冲击频率是否已是设定值
+    bool isRotationApplied() const;
+    bool isPercussionApplied() const;
+    
     // 电机ID常量
     static const int DRILL_MOTOR_ID;
     static const int PERCUSSION_MOTOR_ID;
+    static constexpr float SETTING_TOLERANCE = 0.1f;  // 快照读回值与设定值的容差
     
 private:
     double m_rotationSpeed;       // 旋转速度
@@ -304,6 +359,8 @@ private:
     bool m_connected;             // 连接状态
     int m_drillMode;             // 钻进模式
     double m_drillValue;         // 钻进参数值
+    quint64 m_rotationVersion;   // 设定转速前的快照版本
+    quint64 m_percussionVersion; // 设定冲击频率前的快照版本
 };
 
 /**
@@ -0,0 +1,107 @@
+#ifndef AXISTELEMETRY_H
+#define AXISTELEMETRY_H
+
+#include <QObject>
+#include <QTimer>
+#include <QVector>
+#include <QMetaType>
+#include <atomic>
+
+#include "zmotion.h"
+#include "zmcaux.h"
+#include "inc/seqlock.h"
+#include "inc/sensoraligner.h"
+
+// 某一时刻各轴的三环反馈 (按物理轴号索引)
+struct AxisTelemetrySample {
+    qint64 timeUs = 0;                          // 采样时刻 (sensorClockUs)
+    quint32 axisMask = 0;                       // 第i位为1表示轴i有数据
+    float torque[SENSOR_MOTOR_AXES] = {};       // DRIVE_TORQUE
+    float speed[SENSOR_MOTOR_AXES] = {};        // MSPEED
+    float position[SENSOR_MOTOR_AXES] = {};     // MPOS
+
+    bool hasAxis(int axis) const { return (axisMask >> axis) & 1u; }
+};
+Q_DECLARE_METATYPE(AxisTelemetrySample)
+
+/**
+ * @brief 控制器端缓存的电机高速采样
+ *
+ * 采样程序 programFile 随控制器工程一起下载到 FLASH, 与主程序并存: 默认 tableBase 对应的程序为仓库中的
+ * bas/AXISTELEM.BAS, 修改 tableBase 后用 exportProgram() 重新生成并加入控制器工程。
+ * start() 把采样轴、环形缓冲行数等写入 TABLE 头部后用 RUN "programFile", taskId 在独立任务中启动,
+ * stop() 只用 STOPTASK 停止该任务, 不会替换或停止控制器上的其它 BASIC 程序。
+ * 采样任务每 samplePeriodTicks 个伺服周期把各轴的 DRIVE_TORQUE/MSPEED/MPOS 写入 TABLE 中的环形缓冲,
+ * 并更新 TABLE(tableBase) 处的写序号。主机每 drainIntervalMs 读一次写序号, 把新增的行用
+ * "?*TABLE(起点,个数)" 分段读出 (每次约 1 + 行数*每行个数/valuesPerCommand 次通信, 1kHz/20ms/10轴约6次),
+ * 按伺服周期补齐时间戳后推送到 g_sensorAligner 并发出 samplesReady。
+ * 本对象须与 g_motionState 在同一线程, 对控制器的访问与统一轮询串行进行。
+ */
+class AxisTelemetry : public QObject
+{
+    Q_OBJECT
+public:
+    explicit AxisTelemetry(QObject *parent = nullptr);
+    ~AxisTelemetry();
+
+    //////////////////////////////////采样参数/////////////////////////////////////
+    QString programFile = "AXISTELEM.BAS";  // 控制器工程中的采样程序文件
+    int taskId = 9;                         // 采样任务号, 不得与主程序使用的任务冲突
+    int tableBase = 20000;                  // 与采样程序一致: TABLE(tableBase) 写序号, 其后为头部与环形缓冲
+    int ringSamples = 512;                  // 环形缓冲行数
+    int samplePeriodTicks = 1;              // 控制器采样周期 (伺服周期数)
+    int drainIntervalMs = 20;               // 主机读取周期
+    int valuesPerCommand = 120;             // 每条读取命令的 TABLE 个数 (受应答缓冲长度限制)
+    QVector<int> axes;                      // 采样的物理轴号, 为空时采样 0 ~ SENSOR_MOTOR_AXES-1
+
+    bool isRunning() const { return m_running.load(std::memory_order_acquire); }
+    // 最近一次读到的采样 (无锁, 任意线程)
+    AxisTelemetrySample latest() const { return m_latest.load(); }
+    // 缓冲溢出丢弃的行数
+    quint64 droppedSamples() const { return m_dropped.load(std::memory_order_relaxed); }
+
+    // 控制器工程中采样程序的源码, 程序中的 TABLE 起始地址为 base
+    static QString programSource(int base);
+    // 把采样程序写到 path (CRLF 换行), 供加入控制器工程
+    static bool exportProgram(const QString &path, int base);
+
+public slots:
+    // 启动控制器端采样任务, 须在本对象所在线程调用
+    bool start();
+    // 只停止采样任务
+    void stop();
+
+signals:
+    void samplesReady(const QVector<AxisTelemetrySample> &samples);
+    void runningChanged(bool running);
+
+private slots:
+    void drain();
+
+private:
+    bool execute(const QString &command, QString *response = nullptr);
+    int tableSize();
+    bool readTable(int start, int count, float *out);
+    void publish(const QVector<AxisTelemetrySample> &samples);
+
+    enum {
+        SeqModulo = 1 << 20,                // 写序号回绕周期 (float 可精确表示)
+        HeaderSize = 4 + SENSOR_MOTOR_AXES  // 写序号, 行数, 采样周期, 轴数, 轴号表
+    };
+
+    QTimer *m_drainTimer = nullptr;
+    QVector<int> m_axes;
+    int m_stride = 0;                       // 每行 TABLE 个数
+    qint64 m_periodUs = 1000;               // 采样周期
+    int m_lastSeq = -1;                     // 已读到的写序号
+    QVector<float> m_buffer;
+
+    std::atomic<bool> m_running;
+    std::atomic<quint64> m_dropped;
+    SeqLock<AxisTelemetrySample> m_latest;
+};
+
+// 全局实例, 由 motorpage 创建
+extern AxisTelemetry *g_axisTelemetry;
+
+#endif // AXISTELEMETRY_H
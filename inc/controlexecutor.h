@@ -0,0 +1,103 @@
+#ifndef CONTROLEXECUTOR_H
+#define CONTROLEXECUTOR_H
+
+#include <QThread>
+#include <QMetaType>
+#include <atomic>
+#include <functional>
+
+#include "inc/seqlock.h"
+
+// 控制周期的时序统计 (时间单位 us)
+struct ControlCycleStats {
+    qint64 periodUs = 0;                // 控制周期
+    quint64 cycles = 0;                 // 已执行的周期数
+    quint64 overruns = 0;               // 执行时间超过一个周期的次数
+    quint64 skippedCycles = 0;          // 超时后跳过的截止时刻数
+    qint64 lastJitterUs = 0;            // 最近一次唤醒相对截止时刻的延迟
+    qint64 maxJitterUs = 0;
+    qint64 meanJitterUs = 0;
+    qint64 lastExecUs = 0;              // 最近一个周期的执行时间
+    qint64 maxExecUs = 0;
+    bool realtime = false;              // 是否已获得实时调度
+};
+Q_DECLARE_METATYPE(ControlCycleStats)
+
+/**
+ * @brief 按绝对截止时刻定周期唤醒
+ *
+ * 截止时刻按 periodUs 累加, 不随每次执行时间漂移; 某个周期执行超时后跳过已错过的截止时刻,
+ * 不连续补跑。每次 waitNext() 同时统计上一周期的执行时间、唤醒延迟与超时次数。
+ */
+class ControlPacer
+{
+public:
+    explicit ControlPacer(qint64 periodUs = 10000);
+
+    // 重新开始计时, 下一次 waitNext() 立即返回
+    void reset();
+    // 睡眠到下一个截止时刻, 返回唤醒延迟 (us)
+    qint64 waitNext();
+
+    qint64 periodUs() const { return m_periodUs; }
+    const ControlCycleStats &stats() const { return m_stats; }
+
+    // 睡眠到 sensorClockUs() 时基上的绝对时刻 (Linux 为 clock_nanosleep, Windows 为高精度可等待定时器)
+    static void sleepUntilUs(qint64 deadlineUs);
+
+private:
+    qint64 m_periodUs;
+    qint64 m_deadlineUs = 0;            // 本周期的截止时刻, 0 表示尚未开始
+    qint64 m_wakeUs = 0;                // 本周期的唤醒时刻
+    qint64 m_jitterSumUs = 0;
+    ControlCycleStats m_stats;
+};
+
+/**
+ * @brief 定周期控制执行线程
+ *
+ * 在独立线程中每 periodUs 调用一次 cycleTask, 周期限定在 1~10 ms。realtime 为 true 时
+ * 申请实时调度 (Linux 为 SCHED_FIFO, 需要 CAP_SYS_NICE; Windows 为 TIME_CRITICAL 优先级),
+ * 申请失败时按普通优先级运行。每周期的时序统计通过 stats() 无锁读取。
+ * cycleTask 在执行线程中调用, 不应阻塞等待运动完成, 应在后续周期中轮询。
+ */
+class ControlExecutor : public QThread
+{
+    Q_OBJECT
+public:
+    typedef std::function<void()> CycleTask;
+
+    explicit ControlExecutor(QObject *parent = nullptr);
+    ~ControlExecutor();
+
+    //////////////////////////////////控制周期参数/////////////////////////////////////
+    int periodUs = 5000;                    // 控制周期 (1000 ~ 10000)
+    bool realtime = false;                  // 是否申请实时调度
+    int realtimePriority = 80;              // SCHED_FIFO 优先级 (1 ~ 99)
+    int overrunLogInterval = 100;           // 每多少次超时打印一次日志
+
+    // 设置每周期执行的任务, 须在 start() 之前调用
+    void setCycleTask(CycleTask task);
+    // 请求停止并等待线程退出, 之后可再次 start()
+    void stop();
+
+    bool isStopping() const { return m_stopFlag.load(std::memory_order_acquire); }
+    // 最近一个周期后的时序统计 (无锁, 任意线程)
+    ControlCycleStats stats() const { return m_stats.load(); }
+
+signals:
+    // 某个周期执行时间超过控制周期 (在执行线程中发出, 按 overrunLogInterval 限频)
+    void overrunDetected(const ControlCycleStats &stats);
+
+protected:
+    void run() override;
+
+private:
+    bool applyRealtimePriority();
+
+    CycleTask m_task;
+    std::atomic<bool> m_stopFlag;
+    SeqLock<ControlCycleStats> m_stats;
+};
+
+#endif // CONTROLEXECUTOR_H
@@ -0,0 +1,56 @@
+#ifndef DAQBLOCK_H
+#define DAQBLOCK_H
+
+#include <QtGlobal>
+#include <memory>
+#include <vector>
+
+/**
+ * @brief 采集数据块
+ *
+ * 驱动直接写入块内的交错缓冲区 ([点0的CH1..CHn, 点1的CH1..CHn, ...]),
+ * 提交时一次性拆分为各通道连续存储(SoA)。块发布后只读, 下游各环节
+ * (绘图、存储、频谱分析)通过 DAQBlockPtr 共享同一块数据, 不再复制。
+ */
+class DAQSampleBlock
+{
+public:
+    DAQSampleBlock(int maxPoints, int channels);
+
+    DAQSampleBlock(const DAQSampleBlock&) = delete;
+    DAQSampleBlock& operator=(const DAQSampleBlock&) = delete;
+
+    int maxPoints() const { return m_maxPoints; }
+    int channels() const { return m_channels; }
+    int points() const { return m_points; }
+    qint64 samplePos() const { return m_samplePos; }     // 本块第一个点在本次采集中的序号(每通道, 暂停恢复后继续累加)
+    quint64 seq() const { return m_seq; }                // 块序号
+    qint64 timeUs() const { return m_timeUs; }           // 本块第一个点的采样时刻 (sensorClockUs)
+
+    // 驱动写入区, 容量为 maxPoints * channels
+    double* interleavedBuffer() { return m_interleaved.data(); }
+    const double* interleavedData() const { return m_interleaved.data(); }
+
+    // 某通道的连续数据, 长度为 points()
+    const double* channel(int ch) const { return m_soa.data() + static_cast<size_t>(ch) * m_maxPoints; }
+
+    // 拆分交错数据并设置块信息 (仅生产者调用)
+    void publish(int points, qint64 samplePos, quint64 seq, qint64 timeUs);
+
+private:
+    int m_maxPoints;
+    int m_channels;
+    int m_points = 0;
+    qint64 m_samplePos = 0;
+    quint64 m_seq = 0;
+    qint64 m_timeUs = 0;
+    std::vector<double> m_interleaved;  // 驱动写入的交错数据
+    std::vector<double> m_soa;          // 按通道连续存储, 每通道 maxPoints 个
+};
+
+typedef std::shared_ptr<const DAQSampleBlock> DAQBlockPtr;
+
+// 将交错存储的数据拆分为各通道连续存储; 4通道时使用SIMD实现
+void daqDeinterleave(const double* src, int points, int channels, double* const* dst);
+
+#endif // DAQBLOCK_H
@@ -0,0 +1,91 @@
+#ifndef DAQRINGBUFFER_H
+#define DAQRINGBUFFER_H
+
+#include <QString>
+#include <atomic>
+#include <memory>
+
+#include "inc/daqblock.h"
+
+/**
+ * @brief 采集数据块的无锁环形缓冲区 (单生产者/多消费者)
+ *
+ * 所有槽位的数据块和备用块在构造时一次性分配, 写入路径不分配内存。生产者(采集线程)直接向
+ * 当前槽的块写入并提交, 从不等待消费者; 消费者落后超过一圈时由其自身记录溢出并跳到最旧的有效块。
+ * 每个消费者(绘图、存储、分析)拥有独立的读游标和溢出计数, 读到的是块的共享句柄。
+ * 若某个块在生产者绕回时仍被消费者持有, 该槽与一个空闲的备用块交换, 已发布的块内容不会被改写;
+ * 备用块也全部被持有时本块写入临时块并丢弃, 该槽不发布, 各消费者读到时计为溢出。
+ */
+class DAQRingBuffer
+{
+public:
+    static constexpr int MaxConsumers = 8;
+    static constexpr int SpareBlocks = 2 * MaxConsumers;    // 每个消费者同时持有的块通常不超过一个
+
+    DAQRingBuffer(int slotCount, int maxPoints, int channels);
+    ~DAQRingBuffer();
+
+    DAQRingBuffer(const DAQRingBuffer&) = delete;
+    DAQRingBuffer& operator=(const DAQRingBuffer&) = delete;
+
+    int slotCount() const { return m_slotCount; }
+    int maxPoints() const { return m_maxPoints; }
+    int channels() const { return m_channels; }
+
+    //////////////////////////////////生产者接口/////////////////////////////////////
+    // 获取当前可写槽的数据块
+    DAQSampleBlock* beginWrite();
+    // 获取当前可写槽的交错数据区, 容量为 maxPoints * channels
+    double* writeBuffer() { return beginWrite()->interleavedBuffer(); }
+    // 提交当前槽(拆分通道并发布), points为每通道点数, timeUs为第一个点的采样时刻;
+    // 返回已发布块的句柄, 本块被丢弃时返回空
+    DAQBlockPtr commit(int points, qint64 samplePos, qint64 timeUs = 0);
+    // 已提交的块总数 (含丢弃的块)
+    quint64 writtenBlocks() const;
+    // 因块仍被持有而换用备用块的次数
+    quint64 replacedBlocks() const;
+    // 备用块耗尽而丢弃的块数
+    quint64 droppedBlocks() const;
+
+    //////////////////////////////////消费者接口/////////////////////////////////////
+    // 注册消费者, 返回消费者ID, 失败返回-1; 新消费者从当前写位置开始读取
+    int addConsumer(const QString& name);
+    // 读取下一个块的共享句柄, 无新数据时返回false
+    bool read(int consumerId, DAQBlockPtr& out);
+    // 当前可读块数
+    quint64 available(int consumerId) const;
+    // 因落后被覆盖而丢失的块数
+    quint64 overruns(int consumerId) const;
+    // 消费者名称
+    QString consumerName(int consumerId) const;
+    // 将读游标移动到最新位置(丢弃未读数据, 不计入溢出)
+    void skipToLatest(int consumerId);
+
+private:
+    struct Slot {
+        std::atomic<quint64> seq{0};    // 槽内数据对应的块序号+1, 0表示正在写入
+        std::shared_ptr<DAQSampleBlock> block;  // 通过 std::atomic_load/atomic_store 访问
+    };
+
+    struct Consumer {
+        std::atomic<quint64> cursor{0};     // 下一个要读的块序号
+        std::atomic<quint64> overruns{0};   // 溢出块数
+        QString name;
+    };
+
+    int m_slotCount;
+    int m_maxPoints;
+    int m_channels;
+    std::unique_ptr<Slot[]> m_slots;
+    std::shared_ptr<DAQSampleBlock> m_spares[SpareBlocks];  // 备用块, 仅生产者访问
+    std::unique_ptr<DAQSampleBlock> m_scratch;  // 备用块耗尽时的写入区, 从不发布
+    DAQSampleBlock* m_writing = nullptr;    // 当前正在写入的块
+    bool m_discard = false;                 // 当前块写入临时块, 提交时丢弃
+    Consumer m_consumers[MaxConsumers];
+    std::atomic<int> m_consumerCount{0};
+    std::atomic<quint64> m_writeSeq{0};     // 下一个要写的块序号
+    std::atomic<quint64> m_replaced{0};     // 换用备用块的次数
+    std::atomic<quint64> m_dropped{0};      // 丢弃的块数
+};
+
+#endif // DAQRINGBUFFER_H
@@ -4,10 +4,21 @@
 #include "statemachine.h"
 #include "autodrilling.h"
 #include "motioncontroller.h"
+#include "stepsequencer.h"
 
 // 前向声明
 class AutoDrillingStateMachine;
 
+// 步骤占用的机构 (StepSequencer 资源位), 占用相同机构的步骤不会同时执行
+enum DrillMechanism : quint32 {
+    MECH_STORAGE     = 1u << 0,   // 存储机构
+    MECH_ROBOT_ARM   = 1u << 1,   // 机械手 (旋转/伸缩/夹持)
+    MECH_DRILLING    = 1u << 2,   // 钻进机构 (旋转/冲击)
+    MECH_PENETRATION = 1u << 3,   // 进给机构
+    MECH_CLAMP       = 1u << 4,   // 下夹紧机构
+    MECH_CONNECTION  = 1u << 5    // 对接机构
+};
+
 /**
  * @brief 钻进状态基类
  */
@@ -20,9 +31,17 @@ public:
     void enter() override;
     void exit() override;
     void update() override;
+    void pause() override;
+    void resume() override;
 
 protected:
+    // 建立本状态的步骤序列, 首次进入状态时调用一次
+    virtual void buildSequence() {}
+    // 执行一个周期的步骤序列, 步骤超时时上报错误并暂停自动流程
+    StepSequencer::Result runSequence();
+
     AutoDrillingStateMachine* m_machine;
+    StepSequencer m_sequence;   // 本状态的步骤与进度 (每个状态实例独立)
 };
 
 /**
@@ -63,6 +82,9 @@ public:
     explicit FirstToolInstallationState(AutoDrillingStateMachine* machine);
     void enter() override;
     void update() override;
+
+protected:
+    void buildSequence() override;
 };
 
 /**
@@ -73,6 +95,9 @@ public:
     explicit FirstDrillingState(AutoDrillingStateMachine* machine);
     void enter() override;
     void update() override;
+
+protected:
+    void buildSequence() override;
 };
 
 /**
@@ -83,6 +108,9 @@ public:
     explicit PipeInstallationLoopState(AutoDrillingStateMachine* machine);
     void enter() override;
     void update() override;
+
+protected:
+    void buildSequence() override;
 };
 
 /**
@@ -93,6 +121,9 @@ public:
     explicit PipeRemovalLoopState(AutoDrillingStateMachine* machine);
     void enter() override;
     void update() override;
+
+protected:
+    void buildSequence() override;
 };
 
 /**
@@ -103,6 +134,9 @@ public:
     explicit FirstToolRecoveryState(AutoDrillingStateMachine* machine);
     void enter() override;
     void update() override;
+
+protected:
+    void buildSequence() override;
 };
 
 /**
@@ -0,0 +1,14 @@
+#ifndef LIVESENSORS_H
+#define LIVESENSORS_H
+
+#include "inc/seqlock.h"
+#include "inc/mdbcalibration.h"
+
+/*
+ * Modbus 传感器各通道的最新值。
+ * 由 mdbprocess 在采集线程中每个轮询周期发布一次 (唯一写者),
+ * 自动控制线程、状态机等通过 g_liveSensors.load() 无锁读取一致的带时间戳快照。
+ */
+extern SeqLock<MdbCalibratedFrame> g_liveSensors;
+
+#endif // LIVESENSORS_H
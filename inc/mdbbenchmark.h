@@ -0,0 +1,56 @@
+#ifndef MDBBENCHMARK_H
+#define MDBBENCHMARK_H
+
+#include <QObject>
+#include <QVector>
+
+#include "inc/mdbdecoder.h"
+#include "inc/mdbtcptransport.h"
+
+// 一个轮询频率下的测试结果
+struct MdbBenchmarkResult {
+    int rateHz = 0;                         // 目标轮询频率
+    int intervalMs = 0;                     // 实际设置的轮询周期
+    double seconds = 0;                     // 测试时长
+    quint64 frames = 0;                     // 收到的轮询周期帧数
+    quint64 values[MdbChannelCount] = {};   // 各通道收到的值个数
+    quint64 issuedRequests = 0;             // 调度器发出的读请求数
+    quint64 droppedPolls = 0;               // 调度器丢弃的轮询数
+    MdbTransportStats transport;            // 四个端口的传输统计之和
+    MdbRttHistogram rtt;                    // 四个端口的往返时间
+};
+
+/**
+ * @brief Modbus 采集链路压力测试
+ *
+ * 在独立线程中启动 MdbSimulator, 用 mdbprocess 按与界面相同的方式连接四个网关并轮询
+ * (端口1拉力, 端口2扭矩, 端口3位置, 端口4再挂一路拉力), 依次在各频率下运行 durationSec,
+ * 输出实际采样率、往返时间分位数和丢弃的轮询数。由独立目标 benchmark/mdbbenchmark.pro 的 main 调用。
+ */
+class MdbBenchmark : public QObject
+{
+    Q_OBJECT
+public:
+    explicit MdbBenchmark(QObject *parent = nullptr);
+
+    //////////////////////////////////测试参数/////////////////////////////////////
+    QString address = "127.0.0.1";          // 模拟器起始地址 (占用 +0..3)
+    int port = 5020;
+    double durationSec = 5.0;               // 每个频率的运行时间
+    QVector<int> ratesHz = {1, 10, 50, 100, 250, 500, 1000};
+    double latencyMs = 2.0;                 // 模拟器应答延迟
+    double jitterMs = 1.0;                  // 模拟器延迟抖动
+
+    // 运行全部频率并打印结果, 模拟器启动失败返回false
+    bool run();
+
+    QVector<MdbBenchmarkResult> results() const { return m_results; }
+
+private:
+    MdbBenchmarkResult runRate(int rateHz);
+    static void printResult(const MdbBenchmarkResult &r);
+
+    QVector<MdbBenchmarkResult> m_results;
+};
+
+#endif // MDBBENCHMARK_H
@@ -0,0 +1,67 @@
+#ifndef MDBCALIBRATION_H
+#define MDBCALIBRATION_H
+
+#include <QVector>
+#include <QMetaType>
+
+#include "inc/mdbdecoder.h"
+
+// 标定表中的一点: 原始值 -> 工程值
+struct MdbCalibrationPoint {
+    double raw;
+    double value;
+};
+
+// 单个通道的标定参数
+struct MdbChannelCalibration {
+    double scale = 1.0;                     // 线性换算 value = raw * scale + offset (无标定表时使用)
+    double offset = 0.0;
+    bool unwrap16 = false;                  // 负的原始值按16位回绕修正 (raw + 2*32767)
+    QVector<MdbCalibrationPoint> table;     // 分段线性标定表 (按 raw 升序), 非空时代替线性换算
+    double zero = 0.0;                      // 零点 (工程单位)
+    double filterAlpha = 1.0;               // 一阶低通系数 (0,1], 1 表示不滤波
+};
+
+// 换算后的一个轮询周期
+struct MdbCalibratedFrame {
+    quint32 validMask = 0;
+    double value[MdbChannelCount] = {};     // 去零点、滤波后的工程值
+    double absolute[MdbChannelCount] = {};  // 未去零点、未滤波的工程值
+    qint64 timeUs[MdbChannelCount] = {};    // 采样时刻 (sensorClockUs)
+
+    bool isValid(int ch) const { return (validMask >> ch) & 1u; }
+};
+Q_DECLARE_METATYPE(MdbCalibratedFrame)
+
+/**
+ * @brief Modbus 传感器标定
+ *
+ * 按通道的标定参数把 MdbFrame 中的原始值换算为工程单位, 扣除零点并做一阶低通滤波。
+ * 默认参数与原界面中的换算一致: 拉力 x0.00981, 扭矩 x0.01, 位置 150/4096 (负值回绕修正)。
+ * 非线程安全, 只在采集线程中使用。
+ */
+class MdbCalibrator
+{
+public:
+    MdbCalibrator();
+
+    MdbChannelCalibration channels[MdbChannelCount];
+
+    // 换算 in 中有效的通道, 写入 out (out 的其他通道保持不变)
+    void process(const MdbFrame &in, MdbCalibratedFrame &out);
+
+    // 以通道最近一次的工程值作为零点
+    void zeroChannel(int ch);
+    void zeroAll();
+    // 清除滤波状态
+    void resetFilters();
+
+private:
+    double toEngineering(const MdbChannelCalibration &cal, qint32 raw) const;
+
+    double lastAbsolute[MdbChannelCount] = {};
+    double filterState[MdbChannelCount] = {};
+    bool hasValue[MdbChannelCount] = {};
+};
+
+#endif // MDBCALIBRATION_H
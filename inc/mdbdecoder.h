@@ -0,0 +1,66 @@
+#ifndef MDBDECODER_H
+#define MDBDECODER_H
+
+#include <QtGlobal>
+#include <QMetaType>
+
+// 传感器类型, 数值与原 mdbprocess::ReadValue 的 mode 一致
+enum MdbSensorType {
+    MdbSensorTraction = 1,          // 拉力传感器 (原 mode 1)
+    MdbSensorTorque = 2,            // 扭矩传感器 (原 mode 2)
+    MdbSensorPosition = 3,          // 位置传感器 (原 mode 3)
+    MdbSensorTypeCount
+};
+
+// 寄存器数据格式
+enum class MdbWordFormat : quint8 {
+    Int32,                          // 两个寄存器, 高字在前, 32位补码
+    Long,                           // 两个寄存器, 高字在前, 低字按有符号16位扩展后拼接 (保持原扭矩/位置的解码结果)
+    Short                           // 单个寄存器, 16位补码
+};
+
+// 解码后的传感器通道
+enum MdbChannel {
+    MdbTractionTop = 0,             // 上拉力 (450)
+    MdbTractionDown,                // 下拉力 (452)
+    MdbTorque,                      // 扭矩 (0x00)
+    MdbPosition,                    // 位置 (0x00)
+    MdbChannelCount
+};
+
+// 寄存器表中的一项: 寄存器地址 -> 通道
+struct MdbRegisterField {
+    quint16 reg;
+    MdbWordFormat format;
+    quint8 channel;
+};
+
+// 一个轮询周期内所有传感器的原始值 (未换算为工程单位)
+struct MdbFrame {
+    quint32 validMask = 0;                  // 第i位为1表示通道i本周期有新值
+    qint32 raw[MdbChannelCount] = {};       // 寄存器解码值
+    qint64 timeUs[MdbChannelCount] = {};    // 采样时刻 (sensorClockUs)
+
+    bool isValid(int ch) const { return (validMask >> ch) & 1u; }
+    void clear() { validMask = 0; }
+};
+Q_DECLARE_METATYPE(MdbFrame)
+
+/**
+ * @brief Modbus 寄存器解码
+ *
+ * 每种传感器对应一张编译期确定的寄存器表, 直接从回复的寄存器数组按表解码到预分配的 MdbFrame,
+ * 不经过字符串转换, 也不分配内存。
+ */
+class MdbDecoder
+{
+public:
+    // 解码从 startReg 开始的 count 个寄存器, 只处理完全落在区间内的表项; 返回解码的值个数
+    static int decode(int sensorType, int startReg, const quint16 *regs, int count,
+                      qint64 timeUs, MdbFrame &frame);
+
+    // 某通道对应的寄存器地址
+    static int channelRegister(int channel);
+};
+
+#endif // MDBDECODER_H
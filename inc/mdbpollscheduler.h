@@ -0,0 +1,92 @@
+#ifndef MDBPOLLSCHEDULER_H
+#define MDBPOLLSCHEDULER_H
+
+#include <QObject>
+#include <QTimer>
+#include <QVector>
+#include <QModbusDataUnit>
+#include <functional>
+
+#include "inc/mdbtcptransport.h"
+
+#define MDB_POLL_MAX_PORTS 4
+
+// 一个周期读取的寄存器区间
+struct MdbPollItem {
+    int port = 0;               // 网关端口 (0-3)
+    int deviceId = 1;           // Modbus 设备地址
+    int reg = 0;                // 起始寄存器
+    int count = 2;              // 寄存器个数
+    int mode = 1;               // 传感器类型 (MdbSensorType), 同 mdbprocess::ReadValue 的 mode
+    int intervalMs = 100;       // 读取周期
+    bool enabled = false;
+};
+
+/**
+ * @brief Modbus 统一轮询调度
+ *
+ * 用一个基准时钟(各周期的最大公约数)代替每个传感器各自的定时器, 所有传感器在同一时钟节拍上对齐。
+ * 每个节拍把同一端口、同一设备上相邻的寄存器区间合并为一次读请求 (如 450-451 与 452-453 合并为 450-453),
+ * 请求经流水线传输 (MdbTcpTransport) 发出, 每个端口同时未完成的请求数不超过 maxInFlight,
+ * 超出时本次轮询计为丢弃。
+ * 一个节拍发出的请求全部返回(或下一节拍开始)时调用周期结束回调, 便于按周期批量输出。
+ * 须在所属线程中使用; 从其他线程调用 setItemEnabled() 会自动转到所属线程执行。
+ */
+class MdbPollScheduler : public QObject
+{
+    Q_OBJECT
+public:
+    // 回复处理: 区间, 回复数据, 区间在回复中的偏移, 采样时刻(sensorClockUs, 取请求发出与回复到达的中点)
+    typedef std::function<void(const MdbPollItem &item, const QModbusDataUnit &unit, int offset, qint64 timeUs)> Handler;
+    // 周期结束: 本节拍的回复已全部处理
+    typedef std::function<void()> CycleHandler;
+
+    MdbPollScheduler(MdbTcpTransport **transports, int portCount, QObject *parent = nullptr);
+
+    //////////////////////////////////调度参数/////////////////////////////////////
+    int maxInFlight = 4;        // 每个端口同时未完成的请求数 (流水线, 可跨节拍)
+    int maxMergeGap = 0;        // 合并时允许跨过的空寄存器数
+    int maxRegisters = 120;     // 单次读请求的最大寄存器数
+
+    // 添加一个轮询区间 (默认不启用), 返回编号
+    int addItem(const MdbPollItem &item);
+    // 启用/停用某区间并设置端口和周期
+    void setItemEnabled(int id, bool enabled, int port, int intervalMs);
+    // 设置回复处理函数
+    void setHandler(const Handler &h) { handler = h; }
+    // 设置周期结束回调
+    void setCycleHandler(const CycleHandler &h) { cycleHandler = h; }
+
+    int tickInterval() const { return tickMs; }
+    quint64 issuedRequests() const { return issued; }
+    quint64 droppedPolls() const { return dropped; }
+
+private slots:
+    void onTick();
+
+private:
+    // 按启用区间的周期重新计算基准节拍
+    void reschedule();
+    // 发送一个合并后的读请求
+    void sendGroup(int port, int deviceId, int startReg, int count, const QVector<int> &members);
+    // 结束当前周期
+    void finishCycle();
+
+    MdbTcpTransport **transports;
+    int portCount;
+    QTimer *timer;
+    qint64 tickIndex = 0;
+    int tickMs = 0;
+    QVector<MdbPollItem> items;
+    QVector<int> due;               // 本节拍到期的区间 (复用)
+    int inFlight[MDB_POLL_MAX_PORTS] = {0};
+    quint64 issued = 0;
+    quint64 dropped = 0;
+    Handler handler;
+    CycleHandler cycleHandler;
+    quint64 cycle = 0;              // 当前周期序号
+    int cycleOutstanding = 0;       // 当前周期未返回的请求数
+    bool cycleOpen = false;
+};
+
+#endif // MDBPOLLSCHEDULER_H
@@ -8,6 +8,13 @@
 #include <QModbusDataUnit>
 #include <QModbusTcpClient>
 #include <QModbusReply>
+#include <QAtomicInt>
+#include <QElapsedTimer>
+
+#include "inc/mdbpollscheduler.h"
+#include "inc/mdbdecoder.h"
+#include "inc/mdbcalibration.h"
+#include "inc/mdbrecorder.h"
 
 
 class mdbprocess : public QObject
@@ -17,31 +24,41 @@ public:
     explicit mdbprocess(QObject *parent = nullptr);
     ~mdbprocess();
     QModbusClient *modbusDevices[4] = {nullptr};            // Modbus对象
-    QTimer *tractTimer;                                     // 拉力数据的定时器
-    QTimer *torqueTimer;                                    // 扭矩的数据定时器
-    QTimer *positionTimer;                                  // 位置传感器定时器
+    MdbTcpTransport *pollTransports[4] = {nullptr};         // 轮询专用的流水线连接, 与 modbusDevices 连接同一网关
+    MdbPollScheduler *pollScheduler;                        // 统一轮询调度 (取代各传感器的定时器)
+    QString RttReport() const;                              // 各网关各设备的往返时间直方图
+
+    //////////////////////////////////传感器处理/////////////////////////////////////
+    MdbCalibrator calibrator;                               // 标定/零点/滤波, 只在本线程访问
+    int displayIntervalMs = 50;                             // 界面刷新的最小间隔
+    void setRecorder(MdbRecorder *rec) { recorder = rec; }  // 记录期间在采集线程中直接提交采样
+    void setRecordRound(int round) { recordRound.storeRelaxed(round); }
 public slots:
     void TCPConnect(int port, QString addr);                // 与服务器建立TCP连接
     void TCPDisconnect();                                   // 断开服务器的连接
     // 读取寄存器的信息 服务器采集口0-3，modbus设备地址，寄存器地址，寄存器数量，是否需要翻译
-    // mode: 1-Long补码翻译 2-Long 3-short
+    // mode: 1-拉力 2-扭矩 3-位置 (见 MdbSensorType, 按寄存器表解码) 4-原始寄存器
     void ReadValue(int mdbport, int mdbID, int reg, int num, int mode);
-    // 翻译读取的寄存器的值，内容判断也在这里
-    void ReceiveData(int mode, int reg, int num);
+    // 翻译读取的寄存器的值，内容判断也在这里; sendUs 为请求发出的时刻
+    void ReceiveData(int mode, int reg, int num, qint64 sendUs);
+    // 按mode翻译 unit 中从 offset 开始的 num 个寄存器到 frame, timeUs 为采样时刻 (sensorClockUs)
+    void DecodeValues(int mode, int reg, const QModbusDataUnit &unit, int offset, int num, qint64 timeUs, MdbFrame &frame);
     void Readtraction(int mdbport);                         // 封装的便于读取拉力传感器的函数
     void Readtorque(int mdbport);
     void Readposition(int mdbport);
 
-    void setReadtractionTimer(bool start, int interval);    // 定时读取拉力传感器的定时器（定时和传输速率有关）
+    void setReadtractionTimer(bool start, int interval);    // 定时读取拉力传感器（定时和传输速率有关）, 由轮询调度统一执行
     void setReadtorqueTimer(bool start, int interval);
     void setReadpositionTimer(bool start, int interval);
 
     void WriteValue(int mdbport, int mdbID, int reg, const QVector<quint16>& values);   //写入操作
     void ReadWriteValue(int mdbport, int mdbID, int readReg, int readNum, int writeReg, const QVector<quint16>& writeValues);
+
+    void ZeroSensors();                                     // 以当前值作为各传感器零点
 signals:
-    void tractionLCDshow(long data, int reg);               // 发射读取到的拉力传感器的信号
-    void torqueLCDshow(long data, int reg);
-    void positionLCDshow(long data, int reg);
+    void frameDecoded(const MdbFrame &frame);               // 每个轮询周期发射一次, 包含本周期读到的所有传感器原始值
+    void calibratedFrame(const MdbCalibratedFrame &frame);  // 每个轮询周期发射一次, 工程单位 (控制用, 全速率)
+    void displayFrame(const MdbCalibratedFrame &frame);     // 限速的工程单位数据 (界面用)
     void dataReceived(const QVector<quint16>& data, int startReg);
 public:
     bool connectStatus;
@@ -49,6 +66,20 @@ public:
     int  Torquemdbport;
     int  Poitionmdbport;
 private:
+    // 轮询区间编号
+    int pollTractionTop;
+    int pollTractionDown;
+    int pollTorque;
+    int pollPosition;
+    MdbFrame pendingFrame;                                  // 当前轮询周期的解码结果 (预分配, 周期结束时发射)
+    MdbCalibratedFrame latestFrame;                         // 各通道最近的工程值
+    QElapsedTimer displayClock;
+    MdbRecorder *recorder = nullptr;
+    QAtomicInt recordRound;
+
+    // 换算并分发一个周期的数据: 控制/对齐/记录全速率, 界面限速
+    void ProcessFrame(const MdbFrame &frame);
+
     void ReceiveWriteResponse(int reg); //写入
     void ReceiveReadWriteResponse(int readReg, int writeReg);
 };
@@ -0,0 +1,110 @@
+#ifndef MDBRECORDER_H
+#define MDBRECORDER_H
+
+#include <QObject>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QVector>
+#include <QVariantList>
+#include <QAtomicInt>
+#include <QSqlDatabase>
+
+#include "inc/sensoraligner.h"
+
+// Modbus 采样类型, 对应 Forcedata / Torquedata / Positiondata 表
+enum class MdbSampleKind {
+    Force,
+    Torque,
+    Position
+};
+
+// 一个待写入的 Modbus 采样
+struct MdbSample {
+    MdbSampleKind kind = MdbSampleKind::Force;
+    int roundId = 0;
+    int chId = 0;                   // 仅拉力使用 (1-上, 2-下)
+    double value = 0.0;
+    qint64 timeUs = 0;              // 采样时刻 (sensorClockUs), 与 SensorFrames.TimeUs 同一时钟
+};
+
+// 一个通道一个统计周期的振动特征, 对应 VibFeatures 表的一行
+struct MdbFeatureRow {
+    int roundId = 0;
+    int chId = 0;                   // 通道编号从1开始
+    qint64 timeUs = 0;              // 统计周期结束时刻 (sensorClockUs)
+    double rms = 0.0;
+    double peak = 0.0;
+    double crest = 0.0;
+    double kurtosis = 0.0;
+    double peakFreq = 0.0;
+    QString bandRms;                // 各频带均方根, 逗号分隔
+};
+
+/**
+ * @brief Modbus 采样写库线程
+ *
+ * 界面线程只把采样放入队列, 本线程使用独立的数据库连接(WAL), 以预编译语句和
+ * execBatch 按周期在一个事务中批量写入, 不再每个采样一次自动提交。
+ * 各采样连同采样时刻写入 TimeUs 列, 多传感器对齐帧写入 SensorFrames 表, 各通道值以 float64 小端序列存为 BLOB,
+ * 振动特征写入 VibFeatures 表, 与各采样表在同一数据库中按 (RoundID, TimeUs) 对齐。
+ * 数据库不可用或提交失败时待写入行数最多保留 maxPendingRows, 超出部分从最早的开始丢弃并计入 droppedRows()。
+ */
+class MdbRecorder : public QObject
+{
+    Q_OBJECT
+public:
+    explicit MdbRecorder(QObject *parent = nullptr);
+    ~MdbRecorder();
+
+    //////////////////////////////////写库参数/////////////////////////////////////
+    QString dbFileName;                     // 数据库文件
+    int queueCapacity = 100000;             // 队列容量(采样数), 超出时丢弃
+    int commitRows = 1000;                  // 待写入行数达到该值时提交
+    int commitIntervalMs = 500;             // 最长提交间隔
+    int maxPendingRows = 200000;            // 提交失败时每张表最多保留的待写入行数
+
+    // 提交一个采样 (线程安全, 不阻塞), 队列满时返回false
+    bool submit(const MdbSample &sample);
+    // 提交一个对齐帧 (线程安全, 不阻塞), 队列满时返回false
+    bool submitFrame(const SensorFrame &frame, int roundId);
+    // 提交一帧振动特征 (每通道一行, 线程安全, 不阻塞), 队列满时返回false
+    bool submitFeatures(const QVector<MdbFeatureRow> &rows);
+
+    // 请求停止写库线程, 剩余数据会在退出前提交
+    void requestStop();
+
+    qint64 writtenRows() const;             // 已写入行数
+    qint64 droppedRows() const;             // 队列满或积压超限丢弃的行数
+
+public slots:
+    void doWork();
+
+private:
+    struct FrameRow {
+        int roundId;
+        SensorFrame frame;
+    };
+
+    // 将待写入的采样按表批量写入, 失败时保留数据以便重试
+    bool commitPending(QSqlDatabase &db);
+    // 待写入数据超过上限时丢弃最早的部分
+    void trimPending();
+
+    mutable QMutex queueMutex;
+    QWaitCondition queueNotEmpty;
+    QVector<MdbSample> queue;
+    QVector<FrameRow> frameQueue;
+    QVector<MdbFeatureRow> featureQueue;
+    qint64 written = 0;                     // 受 queueMutex 保护
+    qint64 dropped = 0;
+    QAtomicInt shouldStop;
+
+    // 以下仅在写库线程中访问, 直接用于 execBatch
+    QVariantList forceRounds, forceChannels, forceValues, forceTimes;
+    QVariantList torqueRounds, torqueValues, torqueTimes;
+    QVariantList positionRounds, positionValues, positionTimes;
+    QVariantList frameRounds, frameTimes, frameMasks, frameValues;
+    QVariantList featRounds, featChannels, featTimes, featRms, featPeaks, featCrests, featKurtosis, featPeakFreqs, featBandRms;
+};
+
+#endif // MDBRECORDER_H
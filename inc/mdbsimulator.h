@@ -0,0 +1,67 @@
+#ifndef MDBSIMULATOR_H
+#define MDBSIMULATOR_H
+
+#include <QObject>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QElapsedTimer>
+#include <QHash>
+#include <random>
+
+#include "inc/mdbdecoder.h"
+
+#define MDB_SIM_GATEWAYS 4
+
+/**
+ * @brief Modbus TCP 传感器模拟器
+ *
+ * 在 baseAddress+0..3 上模拟四个网关 (与 mdbprocess 的连接方式一致), 提供:
+ * 拉力 450/452 (32位补码, x0.00981), 扭矩 0x00 或位置 0x00 (由网关的传感器类型决定)。
+ * 数值按时间生成钻进过程的近似波形; 每个连接按顺序应答, 应答延迟为 latencyMs ± jitterMs。
+ * 用于脱离钻机对采集链路做联调和压力测试。
+ */
+class MdbSimulator : public QObject
+{
+    Q_OBJECT
+public:
+    explicit MdbSimulator(QObject *parent = nullptr);
+    ~MdbSimulator();
+
+    //////////////////////////////////模拟参数/////////////////////////////////////
+    double latencyMs = 2.0;                 // 平均应答延迟
+    double jitterMs = 1.0;                  // 延迟抖动 (均匀分布)
+    bool serialService = true;              // 同一连接上的请求按顺序逐个处理 (与实际网关一致)
+    int gatewaySensor[MDB_SIM_GATEWAYS] = { // 各网关 0x00 寄存器对应的传感器
+        MdbSensorTraction, MdbSensorTorque, MdbSensorPosition, MdbSensorTraction
+    };
+
+    // 开始监听, 失败返回false
+    bool start(const QString &baseAddress = "127.0.0.1", int port = 5020);
+    void stop();
+
+    quint64 servedRequests() const { return served; }
+
+private slots:
+    void onNewConnection();
+    void onReadyRead();
+
+private:
+    struct Connection {
+        int gateway = 0;
+        QByteArray rxBuffer;
+        qint64 busyUntilUs = 0;             // 串行处理时上一个应答的完成时刻
+    };
+
+    // 某网关某寄存器在 tSec 时刻的值
+    quint16 registerValue(int gateway, int reg, double tSec);
+    QByteArray buildResponse(int gateway, quint16 transactionId, quint8 unitId,
+                             const char *pdu, int pduSize);
+
+    QTcpServer *servers[MDB_SIM_GATEWAYS] = {nullptr};
+    QHash<QTcpSocket *, Connection> connections;
+    QElapsedTimer clock;
+    std::mt19937 rng;
+    quint64 served = 0;
+};
+
+#endif // MDBSIMULATOR_H
@@ -15,6 +15,8 @@
 #include <QTableWidget>
 #include <QProcess>
 #include "inc/mdbprocess.h"
+#include "inc/mdbrecorder.h"
+#include "inc/vibrationanalyzer.h"
 #include "inc/Global.h"
 
 //解决 Python 和 Qt 的关键词 slots 冲突
@@ -37,12 +39,11 @@ public:
     int  timeTract      = 100;       //默认100ms
     int  timeTorque     = 100;
     int  timePosition   = 100;
+public slots:
+    // 记录期间把振动特征与 Modbus 采样写入同一数据库
+    void recordVibFeatures(const VibFeatureFrame &frame);
 private slots:
-    void ShowLCDtraction(long data, int reg);
-
-    void ShowLCDtorque(long data, int reg);
-
-    void ShowLCDposition(long data, int reg);
+    void ShowFrame(const MdbCalibratedFrame &frame);
 
     void on_btn_nuke_clicked();
 
@@ -68,15 +69,12 @@ private:
     //QModbusClient *modbusDevices[4] = {nullptr};
     QThread *mdbThread;
     mdbprocess *mdbworker;
+    QThread *recorderThread;              // 采样写库线程
+    MdbRecorder *recorder;                // 采样写库对象
     int currentRoundID = 1;
     QSqlDatabase dbModbus;                // 存储数据的数据库
     QDateTime startTime;            // 开始时间
     QDateTime stopTime;             // 结束时间
-
-    double traction1zero = 0;
-    double traction2zero = 0;
-    double torqueZero    = 0;
-    double positionZero  = 0;
 };
 
 #endif // MDBTCP_H
@@ -0,0 +1,116 @@
+#ifndef MDBTCPTRANSPORT_H
+#define MDBTCPTRANSPORT_H
+
+#include <QObject>
+#include <QTcpSocket>
+#include <QTimer>
+#include <QHash>
+#include <QVector>
+#include <QByteArray>
+#include <functional>
+
+#define MDB_RTT_BUCKETS     14      // RTT 直方图桶数, 上界 0.25ms * 2^i, 最后一桶不设上界
+
+// 单个设备的往返时间直方图
+struct MdbRttHistogram {
+    quint64 counts[MDB_RTT_BUCKETS] = {};
+    quint64 total = 0;
+    qint64 minUs = 0;
+    qint64 maxUs = 0;
+    qint64 sumUs = 0;
+
+    void add(qint64 rttUs);
+    void merge(const MdbRttHistogram &other);
+    // 第i个桶的上界 (us), 最后一个桶返回-1
+    static qint64 bucketUpperUs(int i);
+    // 近似分位数 (取所在桶的上界), p 取 0-1
+    qint64 percentileUs(double p) const;
+    QString toString() const;
+};
+
+// 传输统计
+struct MdbTransportStats {
+    quint64 sent = 0;               // 发出的请求帧数 (含重试)
+    quint64 completed = 0;          // 成功返回的事务数
+    quint64 retries = 0;            // 超时重发次数
+    quint64 timeouts = 0;           // 重试耗尽后失败的事务数
+    quint64 exceptions = 0;         // 设备返回异常码的事务数
+    quint64 stale = 0;              // 超时后才到达、被丢弃的回复数
+};
+
+/**
+ * @brief 流水线 Modbus TCP 传输
+ *
+ * 一个网关连接上同时保持最多 maxOutstanding 个未完成的读事务, 以 MBAP 事务号区分回复,
+ * 不再一问一答地等待。每个事务单独计时, 超时后以新的事务号重发, 重试耗尽才回调失败,
+ * 不会阻塞同一连接上的其他传感器。按 Modbus 设备地址统计往返时间直方图。
+ * 须在所属线程中使用; 回调总在事件循环中调用, 不会在 readHoldingRegisters() 内同步调用。
+ */
+class MdbTcpTransport : public QObject
+{
+    Q_OBJECT
+public:
+    // 读结果: 是否成功, 寄存器值, 采样时刻(sensorClockUs, 最后一次发送与回复到达的中点)
+    typedef std::function<void(bool ok, const QVector<quint16> &regs, qint64 timeUs)> ReadCallback;
+
+    explicit MdbTcpTransport(QObject *parent = nullptr);
+    ~MdbTcpTransport();
+
+    //////////////////////////////////传输参数/////////////////////////////////////
+    int maxOutstanding = 8;         // 同时未完成的事务数
+    int maxQueued = 32;             // 超出 maxOutstanding 后排队等待的事务数
+    int timeoutMs = 300;            // 单次请求超时
+    int maxRetries = 1;             // 超时后的重发次数
+
+    void connectToHost(const QString &address, int port);
+    void disconnectFromHost();
+    bool isConnected() const;
+
+    // 读保持寄存器 (功能码03); 未连接或队列已满时返回false且不回调
+    bool readHoldingRegisters(int unitId, int startReg, int count, const ReadCallback &callback);
+
+    int outstanding() const { return pending.size(); }
+    MdbTransportStats stats() const { return counters; }
+    QList<int> devices() const { return histograms.keys(); }
+    MdbRttHistogram rttHistogram(int unitId) const { return histograms.value(unitId); }
+
+    // 组帧/解析 (MBAP + PDU)
+    static QByteArray buildReadRequest(quint16 transactionId, quint8 unitId, quint16 startReg, quint16 count);
+    // 从 data 中解析一帧: 返回消耗的字节数, 数据不完整返回0, 帧头非法返回-1
+    static int parseFrame(const char *data, int size, quint16 *transactionId, quint8 *unitId,
+                          quint8 *function, const char **pdu, int *pduSize);
+
+signals:
+    void connectionChanged(bool connected);
+
+private slots:
+    void onReadyRead();
+    void onDisconnected();
+    void onTimeoutCheck();
+
+private:
+    struct Request {
+        quint8 unitId = 1;
+        quint16 startReg = 0;
+        quint16 count = 0;
+        int attempts = 0;
+        qint64 sendUs = 0;
+        ReadCallback callback;
+    };
+
+    void send(Request &request);
+    void sendWaiting();
+    void finish(Request &request, bool ok, const QVector<quint16> &regs, qint64 timeUs);
+    void failAll();
+
+    QTcpSocket *socket;
+    QTimer *timeoutTimer;
+    QByteArray rxBuffer;
+    QHash<quint16, Request> pending;        // 已发出, 按事务号索引
+    QVector<Request> waiting;               // 等待发出
+    quint16 nextTransactionId = 1;
+    QHash<int, MdbRttHistogram> histograms; // 按设备地址
+    MdbTransportStats counters;
+};
+
+#endif // MDBTCPTRANSPORT_H
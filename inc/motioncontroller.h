@@ -5,10 +5,15 @@
 #include <QMap>
 #include <QVector>
 #include <QString>
+#include <QStringList>
 #include <functional>
 #include <QTimer>
 #include <QRecursiveMutex>
+#include <QMutex>
+#include <QFuture>
+#include <QFutureInterface>
 #include "zmcaux.h"
+#include "motionstate.h"
 #include "DrillingParameters.h"
 
 // 预定义 ZMC_HANDLE 类型
@@ -28,6 +33,47 @@ extern "C" {
     int ZAux_Direct_GetDAC(ZMC_HANDLE handle, int axis, float* fValue);
 }
 
+/**
+ * @brief 多轴命令批
+ *
+ * 收集若干轴参数设置与运动命令, 由 MotionController::executeBatch 合并为一个命令串一次发送,
+ * 每条命令后附带序号打印, 据应答判断各条命令是否执行成功。
+ */
+class MotionCommandBatch
+{
+public:
+    MotionCommandBatch &setAtype(int axis, int atype);
+    MotionCommandBatch &setDac(int axis, float value);
+    MotionCommandBatch &setAxisEnable(int axis, bool enable);
+    MotionCommandBatch &setSpeed(int axis, float speed);
+    MotionCommandBatch &setAccel(int axis, float accel);
+    MotionCommandBatch &setDecel(int axis, float decel);
+    MotionCommandBatch &moveAbs(int axis, float position);
+    MotionCommandBatch &move(int axis, float distance);
+    MotionCommandBatch &cancel(int axis, int mode);
+    MotionCommandBatch &rapidStop(int mode);
+    // 任意一条 BASIC 语句
+    MotionCommandBatch &add(const QString &statement);
+
+    const QStringList &commands() const { return m_commands; }
+    int size() const { return m_commands.size(); }
+    bool isEmpty() const { return m_commands.isEmpty(); }
+    void clear() { m_commands.clear(); }
+
+private:
+    QStringList m_commands;
+};
+
+// 命令批的执行结果
+struct MotionBatchResult {
+    int errorCode = 0;                  // 控制器返回的错误码, 0 表示全部发送成功
+    int completed = 0;                  // 按顺序执行成功的命令数
+    int roundTrips = 0;                 // 实际的通信次数
+    QVector<bool> ok;                   // 每条命令是否执行成功
+
+    bool success() const { return errorCode == 0 && completed == ok.size(); }
+};
+
 /**
  * @brief 运动控制器类，封装与运动控制卡的通信
  */
@@ -37,7 +83,7 @@ class MotionController : public QObject
 
 public:
     // 定义回调函数类型，用于通知电机状态变化
-    typedef std::function<void(int motorID, const QMap<QString, float>&)> MotionCallback;
+    typedef std::function<void(int motorID, const AxisState&)> MotionCallback;
 
     // 定义位置到达判断的容差范围（默认为0.1单位）
     static constexpr float POSITION_TOLERANCE = 0.1f;
@@ -58,17 +104,30 @@ public:
     void setControllerHandle(ZMC_HANDLE handle);
 
     // 电机参数操作
-    bool getMotorParameters(int motorID, QMap<QString, float> &params);
+    bool getMotorParameters(int motorID, AxisState &state);
+    bool getMotorParameters(const QList<int> &motorIDs, AxisStateArray &states);
     bool setMotorParameter(int motorID, const QString &paramName, float value);
 
     // 电机运动控制
     bool moveMotorAbsolute(int motorID, float position);
     bool moveMotorRelative(int motorID, float distance);
+    // 异步运动: 发出命令后立即返回, future 在到位 (true) 或超时/停在错误位置 (false) 时完成
+    QFuture<bool> moveMotorAbsoluteAsync(int motorID, float position, int timeout = MOTION_TIMEOUT);
+    QFuture<bool> moveMotorRelativeAsync(int motorID, float distance, int timeout = MOTION_TIMEOUT);
+    // 运动完成令牌: 轴停止且反馈位置在 targetPosition 附近时为 true
+    QFuture<bool> motionCompletion(int motorID, float targetPosition, int timeout = MOTION_TIMEOUT);
     bool stopMotor(int motorID, int stopMode = 0);
     bool enableMotor(int motorID, bool enable);
     bool clearAlarm(int motorID);
     bool setZeroPosition(int motorID);
 
+    // 多轴命令批: 合并为一次发送, 返回每条命令的结果
+    MotionBatchResult executeBatch(const MotionCommandBatch &batch);
+    // 不经过 MotionController 实例, 直接用控制器句柄执行 (供自动模式线程等使用)
+    static MotionBatchResult executeBatch(ZMC_HANDLE handle, const MotionCommandBatch &batch);
+    // 逐条发送, 失败后继续发送其余命令 (用于停止序列及合并发送失败后的补发)
+    static MotionBatchResult executeEach(ZMC_HANDLE handle, const MotionCommandBatch &batch);
+
     // 全局操作
     bool pauseAllMotors();
     bool resumeAllMotors();
@@ -95,12 +154,18 @@ public:
 signals:
     void connectionChanged(bool connected);
     void commandResponse(const QString &response);
-    void motorStatusChanged(int motorID, const QMap<QString, float> &params);
+    void motorStatusChanged(int motorID, const AxisState &state);
+    // 一次更新中所有已读取电机的状态 (validMask 标明包含的轴)
+    void motorStatesChanged(const AxisStateArray &states);
     void errorOccurred(const QString &errorMessage);
 
 private slots:
     // 定时更新电机状态
     void onUpdateTimerTimeout();
+    // 统一轮询的新快照 (在轮询线程中直接调用)
+    void onMotionState(const AxisStateArray &state);
+    // 统一轮询读取失败的周期 (在轮询线程中直接调用)
+    void onMotionPollFailed(qint64 timeUs);
 
 protected:
     // 记录错误日志
@@ -142,11 +207,24 @@ private:
     bool m_debugMode;
 
     // 为调试模式生成模拟的电机参数
-    QMap<QString, float> generateDebugMotorParameters(int motorID);
+    AxisState generateDebugMotorParameters(int motorID);
 
     // 运动状态检查辅助函数
     bool checkEndMove(int motorID) const;
     bool checkPositionReached(int motorID, float targetPosition, float tolerance) const;
+
+    // 把快照中的轴状态分发给回调 (在本对象线程中)
+    void dispatchMotorStatus(const AxisStateArray &state);
+
+    // 等待完成的运动, 由统一轮询的快照判定完成
+    struct PendingMotion {
+        float target;
+        quint64 issuedVersion;          // 发出命令时的快照版本
+        qint64 deadlineUs;              // 超时时刻 (sensorClockUs)
+        QFutureInterface<bool> promise;
+    };
+    QMutex m_pendingMutex;
+    QMap<int, PendingMotion> m_pendingMotions;
 };
 
 #endif // MOTIONCONTROLLER_H
\ No newline at end of file
@@ -0,0 +1,118 @@
+#ifndef MOTIONSTATE_H
+#define MOTIONSTATE_H
+
+#include <QObject>
+#include <QTimer>
+#include <QVector>
+#include <QMetaType>
+#include <atomic>
+
+#include "zmotion.h"
+#include "zmcaux.h"
+#include "inc/seqlock.h"
+
+#define MOTION_STATE_AXES       10      // 轮询的轴数 (物理轴号 0 ~ 9)
+
+// 单个轴的状态
+struct AxisState {
+    qint32 atype = 0;                   // ATYPE 轴类型
+    qint32 enabled = 0;                 // AXIS_ENABLE
+    qint32 idle = 0;                    // IDLE: -1 停止, 0 运动中
+    qint32 axisStatus = 0;              // AXISSTATUS 轴状态/告警位
+    float dpos = 0;                     // 指令位置
+    float mpos = 0;                     // 反馈位置
+    float speed = 0;                    // SPEED 设定速度
+    float mspeed = 0;                   // 反馈速度
+    float dac = 0;                      // DAC 输出
+    float driveTorque = 0;              // DRIVE_TORQUE 驱动器力矩
+    float units = 0;                    // 脉冲当量
+    float accel = 0;
+    float decel = 0;
+
+    bool isIdle() const { return idle != 0; }
+};
+
+// 一个轮询周期内所有轴的状态
+struct AxisStateArray {
+    quint64 version = 0;                // 轮询序号, 每完成一个周期加1
+    qint64 timeUs = 0;                  // 读取时刻 (sensorClockUs)
+    quint32 validMask = 0;              // 第i位为1表示轴i已读到
+    AxisState axis[MOTION_STATE_AXES];
+
+    bool isValid(int a) const { return a >= 0 && a < MOTION_STATE_AXES && ((validMask >> a) & 1u); }
+};
+Q_DECLARE_METATYPE(AxisState)
+Q_DECLARE_METATYPE(AxisStateArray)
+
+// AxisState 中可由控制器轴参数读取的字段, AxisFieldFastCount 之前为需要高频刷新的字段
+enum AxisStateField {
+    AxisFieldEnable = 0, AxisFieldIdle, AxisFieldAxisStatus, AxisFieldDpos, AxisFieldMpos,
+    AxisFieldMspeed, AxisFieldDac, AxisFieldDriveTorque,
+    AxisFieldFastCount,
+    AxisFieldAtype = AxisFieldFastCount, AxisFieldUnits, AxisFieldSpeed, AxisFieldAccel, AxisFieldDecel,
+    AxisFieldCount
+};
+
+// 字段对应的控制器参数名, 如 "MPOS"
+const char *axisStateParamName(int field);
+// 把读到的参数值写入对应字段
+void axisStateStore(AxisState &state, int field, float value);
+
+/**
+ * @brief 统一的电机状态轮询
+ *
+ * 每 pollIntervalMs 用一条批量查询读取所有轴的位置/速度/状态等参数, 轴类型、单位、
+ * 加减速等很少变化的参数每 slowDivider 个周期才读一次。结果存为带版本号的快照,
+ * 各页面与状态机通过 snapshot() 无锁读取或订阅 stateUpdated, 控制器通信量与打开的界面数量无关。
+ * 未连接或读取失败时快照的 validMask 清零, 读取方不会把旧数据当作当前状态。
+ */
+class MotionStateService : public QObject
+{
+    Q_OBJECT
+public:
+    explicit MotionStateService(QObject *parent = nullptr);
+    ~MotionStateService();
+
+    //////////////////////////////////轮询参数/////////////////////////////////////
+    int pollIntervalMs = 20;                // 轮询周期
+    int slowDivider = 10;                   // 静态参数的读取分频
+
+    // 最近一次完整读取的快照 (无锁, 任意线程)
+    AxisStateArray snapshot() const { return m_state.load(); }
+    quint64 version() const { return m_version.load(std::memory_order_acquire); }
+    bool isRunning() const { return m_running.load(std::memory_order_acquire); }
+
+public slots:
+    void start();
+    void stop();
+
+signals:
+    // 每个周期读取完成后发出 (在轮询线程中)
+    void stateUpdated(const AxisStateArray &state);
+    // 未连接或读取失败的周期发出 (在轮询线程中), 等待方据此处理超时
+    void pollFailed(qint64 timeUs);
+
+private slots:
+    void poll();
+
+private:
+    // 读取失败: 快照标记为无效 (保留版本号), 并发出 pollFailed
+    void invalidate();
+
+    QTimer *m_timer = nullptr;
+    int m_cycle = 0;
+    AxisStateArray m_work;
+    QVector<const char *> m_names;
+    QVector<int> m_axes;
+    QVector<int> m_fields;
+    QVector<float> m_values;
+
+    std::atomic<bool> m_running;
+    std::atomic<quint64> m_version;
+    SeqLock<AxisStateArray> m_state;
+};
+
+// 全局实例, 由 MainWindow 创建
+extern MotionStateService *g_motionState;
+
+#endif // MOTIONSTATE_H
@@ -9,6 +9,9 @@
 #include "./inc/zmotion.h"
 #include "./inc/zmcaux.h"
 #include "inc/Global.h"
+#include "inc/sensoraligner.h"
+#include "inc/axistelemetry.h"
+#include "inc/motionstate.h"
 #include <QSqlDatabase>
 #include <QSqlQuery>
 #include <QSqlRecord>
@@ -94,12 +97,45 @@ protected:
                 QVector<float> speedAllData(10);
                 QVector<float> positionAllData(10);
 
+                // 三个参数的全部轴合并为一次查询, 取调用前后时刻的中点作为采样时刻
+                static const char *const names[3] = {"DRIVE_TORQUE", "MSPEED", "MPOS"};
+                const char *batchNames[30];
+                int batchAxes[30];
+                float batchValues[30] = {};
+                for (int p = 0; p < 3; p++) {
+                    for (int axis = 0; axis < 10; axis++) {
+                        batchNames[p * 10 + axis] = names[p];
+                        batchAxes[p * 10 + axis] = axis;
+                    }
+                }
                 int ret = 0;
-                ret += ZAux_Direct_GetAllAxisPara(g_handle, "DRIVE_TORQUE", 10, torqueAllData.data());
-                ret += ZAux_Direct_GetAllAxisPara(g_handle, "MSPEED", 10, speedAllData.data());
-                ret += ZAux_Direct_GetAllAxisPara(g_handle, "MPOS", 10, positionAllData.data());
+                qint64 sampleUs = 0;
+                if (g_motionState && g_motionState->isRunning()) {
+                    // 统一轮询已读取这些参数, 直接取快照
+                    const AxisStateArray state = g_motionState->snapshot();
+                    ret = state.validMask ? 0 : -1;
+                    sampleUs = state.timeUs;
+                    for (int axis = 0; axis < 10; axis++) {
+                        batchValues[axis] = state.axis[axis].driveTorque;
+                        batchValues[10 + axis] = state.axis[axis].mspeed;
+                        batchValues[20 + axis] = state.axis[axis].mpos;
+                    }
+                } else {
+                    const qint64 t0 = sensorClockUs();
+                    ret = ZAux_Direct_GetParamBatch(g_handle, batchNames, batchAxes, 30, batchValues);
+                    sampleUs = (t0 + sensorClockUs()) / 2;
+                }
+                std::copy(batchValues, batchValues + 10, torqueAllData.begin());
+                std::copy(batchValues + 10, batchValues + 20, speedAllData.begin());
+                std::copy(batchValues + 20, batchValues + 30, positionAllData.begin());
 
                 if (ret == 0) {
+                    // 控制器端高速采样运行时由其提供对齐通道, 这里只刷新界面
+                    if (g_sensorAligner && !(g_axisTelemetry && g_axisTelemetry->isRunning())) {
+                        g_sensorAligner->push(SensorMotorTorque0, torqueAllData.constData(), SENSOR_MOTOR_AXES, sampleUs);
+                        g_sensorAligner->push(SensorMotorSpeed0, speedAllData.constData(), SENSOR_MOTOR_AXES, sampleUs);
+                        g_sensorAligner->push(SensorMotorPosition0, positionAllData.constData(), SENSOR_MOTOR_AXES, sampleUs);
+                    }
                     emit paramsRead(torqueAllData, speedAllData, positionAllData);
                 } else {
                     qDebug() << "Error reading parameters, ret =" << ret;
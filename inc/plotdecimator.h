@@ -0,0 +1,67 @@
+#ifndef PLOTDECIMATOR_H
+#define PLOTDECIMATOR_H
+
+#include <QVector>
+
+// 按出现顺序保存的一对极值
+struct MinMaxBucket {
+    float first;    // 先出现的极值
+    float second;   // 后出现的极值
+};
+
+// 按出现顺序累积最小/最大值
+struct MinMaxAccumulator {
+    float min = 0.0f;
+    float max = 0.0f;
+    int minIdx = 0;
+    int maxIdx = 0;
+    int count = 0;
+
+    void clear() { count = 0; }
+    void add(float v);
+    MinMaxBucket bucket() const;
+};
+
+/**
+ * @brief 按像素的最小/最大值抽取
+ *
+ * 按时间顺序输入样本或已合并的桶, 落在同一像素内的数据合并为按出现顺序的最小值和最大值,
+ * 每像素最多输出2个点, 绘图点数只与像素数有关, 与采样频率无关。NaN 输入被忽略,
+ * addBreak() 在数据中断处插入 NaN, 曲线在断开处不相连。
+ */
+class MinMaxDecimator
+{
+public:
+    MinMaxDecimator();
+
+    // 开始输出 [t0, t1] 范围, 宽 pixels 像素; 值乘以 scale 后写入 keys/values (先清空)
+    void begin(double t0, double t1, int pixels, double scale,
+               QVector<double> *keys, QVector<double> *values);
+    // 追加时刻 t 开始的一个桶 (单个样本时 first == second)
+    void add(double t, float first, float second);
+    // 在时刻 t 处断开曲线
+    void addBreak(double t);
+    // 输出最后一个像素, 返回输出点数
+    int finish();
+
+    // 已输出值的范围 (无输出时为0)
+    double minValue() const { return m_hasValue ? m_lo : 0.0; }
+    double maxValue() const { return m_hasValue ? m_hi : 0.0; }
+
+private:
+    void flush();
+
+    double m_t0 = 0.0;
+    double m_pixelSec = 1.0;
+    double m_scale = 1.0;
+    QVector<double> *m_keys = nullptr;
+    QVector<double> *m_values = nullptr;
+
+    MinMaxAccumulator m_acc;        // 当前像素
+    qint64 m_pixel = -1;
+    double m_lo = 0.0;
+    double m_hi = 0.0;
+    bool m_hasValue = false;
+};
+
+#endif // PLOTDECIMATOR_H
@@ -0,0 +1,44 @@
+#ifndef REALFFT_H
+#define REALFFT_H
+
+#include <QtGlobal>
+#include <vector>
+
+/**
+ * @brief 实数序列FFT (基2, 单精度)
+ *
+ * 将N点实数序列打包为N/2点复数序列做一次复数FFT, 再拆分得到单边频谱。
+ * 旋转因子、位反转表和工作缓冲在 setSize() 时一次分配, 变换过程中不再分配内存。
+ * 复数部分按实部/虚部分开存放(SoA), 蝶形运算在支持SSE时每次处理4个。
+ * 非线程安全, 每个线程使用各自的实例。
+ */
+class RealFFT
+{
+public:
+    explicit RealFFT(int size = 0);
+
+    // 设置变换点数 (2的整数次幂, 至少8), 失败返回false
+    bool setSize(int size);
+    int size() const { return m_size; }
+    // 单边频谱的点数 N/2+1
+    int bins() const { return m_size / 2 + 1; }
+
+    // 计算 in[0..N) 的功率谱 |X_k|^2, 输出 bins() 个值
+    void powerSpectrum(const float *in, float *power);
+
+private:
+    // 对 m_re/m_im 做原位复数FFT
+    void complexTransform();
+
+    int m_size = 0;                 // 实数点数 N
+    int m_half = 0;                 // 复数点数 N/2
+    std::vector<int> m_bitrev;      // 位反转下标
+    std::vector<float> m_twRe;      // 各级旋转因子, 按级连续存放
+    std::vector<float> m_twIm;
+    std::vector<float> m_splitCos;  // 拆分用的 cos(2πk/N)
+    std::vector<float> m_splitSin;  // 拆分用的 sin(2πk/N)
+    std::vector<float> m_re;        // 工作缓冲
+    std::vector<float> m_im;
+};
+
+#endif // REALFFT_H
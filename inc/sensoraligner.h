@@ -0,0 +1,103 @@
+#ifndef SENSORALIGNER_H
+#define SENSORALIGNER_H
+
+#include <QObject>
+#include <QMutex>
+#include <QTimer>
+#include <QMetaType>
+
+#include "inc/sensorclock.h"
+
+#define SENSOR_MOTOR_AXES       10      // 电机轴数
+#define SENSOR_HISTORY_SIZE     64      // 每个通道保留的最近采样数
+
+// 对齐帧中的通道
+enum SensorChannel {
+    SensorForceTop = 0,                                         // 上拉力
+    SensorForceDown,                                            // 下拉力
+    SensorTorque,                                               // 扭矩
+    SensorPosition,                                             // 位置
+    SensorVib1Rms,                                              // 振动CH1~CH4 每块有效值
+    SensorVib2Rms,
+    SensorVib3Rms,
+    SensorVib4Rms,
+    SensorMotorTorque0,                                         // 各轴电机力矩 (+轴号)
+    SensorMotorSpeed0 = SensorMotorTorque0 + SENSOR_MOTOR_AXES, // 各轴电机速度
+    SensorMotorPosition0 = SensorMotorSpeed0 + SENSOR_MOTOR_AXES, // 各轴电机位置
+    SensorChannelCount = SensorMotorPosition0 + SENSOR_MOTOR_AXES
+};
+
+// 一个时钟节拍上所有传感器的对齐值
+struct SensorFrame {
+    qint64 timeUs = 0;                          // 帧时刻 (sensorClockUs)
+    quint64 validMask = 0;                      // 第i位为1表示通道i有效
+    double values[SensorChannelCount] = {};
+
+    bool isValid(int ch) const { return (validMask >> ch) & 1u; }
+};
+Q_DECLARE_METATYPE(SensorFrame)
+
+/**
+ * @brief 多传感器时间对齐
+ *
+ * 各采集线程用 push() 提交带单调时间戳的采样, 本对象按固定周期在公共时钟网格上
+ * 生成对齐帧: 对每个通道在帧时刻两侧的采样做线性插值, 只有更早的采样时保持最近值,
+ * 超过 staleMs 未更新的通道标记为无效 (两侧采样间隔超过 staleMs 时不插值)。
+ * 帧时刻滞后当前时间 latencyMs, 以等待慢速传感器的采样到达。
+ * 对象应移入独立线程, 由 QThread::started 调用 start(); frameReady 以排队连接送到各页面。
+ */
+class SensorAligner : public QObject
+{
+    Q_OBJECT
+public:
+    explicit SensorAligner(QObject *parent = nullptr);
+
+    //////////////////////////////////对齐参数/////////////////////////////////////
+    int framePeriodMs = 10;                 // 帧周期
+    int latencyMs = 50;                     // 帧时刻相对当前时间的滞后
+    int staleMs = 500;                      // 超过该时间未更新的通道视为无效
+
+    // 提交一个采样 (线程安全)
+    void push(int channel, qint64 timeUs, double value);
+    // 提交同一时刻的连续多个通道 (线程安全)
+    void push(int firstChannel, const float *values, int count, qint64 timeUs);
+
+    // 最近生成的对齐帧 (线程安全)
+    SensorFrame latestFrame() const;
+
+public slots:
+    // 在对齐线程中调用
+    void start();
+    void stop();
+
+signals:
+    void frameReady(const SensorFrame &frame);
+
+private slots:
+    void onTick();
+
+private:
+    struct Sample {
+        qint64 timeUs;
+        double value;
+    };
+    struct History {
+        Sample samples[SENSOR_HISTORY_SIZE];
+        int head = 0;                       // 下一个写入位置
+        int count = 0;
+    };
+
+    // 计算某通道在 timeUs 时刻的值, 无有效数据时返回false (调用时持有 mutex)
+    bool valueAt(const History &history, qint64 timeUs, double *value) const;
+
+    mutable QMutex mutex;
+    History histories[SensorChannelCount];  // 受 mutex 保护
+    SensorFrame latest;                     // 受 mutex 保护
+    QTimer *timer = nullptr;                // 在 start() 中创建, 属于对齐线程
+    qint64 nextFrameUs = 0;
+};
+
+// 全局对齐器, 由主窗口创建
+extern SensorAligner *g_sensorAligner;
+
+#endif // SENSORALIGNER_H
@@ -0,0 +1,17 @@
+#ifndef SENSORCLOCK_H
+#define SENSORCLOCK_H
+
+#include <QtGlobal>
+#include <chrono>
+
+/*
+ * 所有传感器采样共用的单调时钟 (微秒), 不受系统时间调整影响。
+ * 各采集线程在I/O完成处直接调用, 时间戳在不同线程之间可直接比较。
+ */
+inline qint64 sensorClockUs()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+#endif // SENSORCLOCK_H
@@ -0,0 +1,83 @@
+#ifndef SEQLOCK_H
+#define SEQLOCK_H
+
+#include <QtGlobal>
+#include <atomic>
+#include <cstring>
+#include <type_traits>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define SEQLOCK_PAUSE() _mm_pause()
+#else
+#define SEQLOCK_PAUSE() do {} while (0)
+#endif
+
+/**
+ * @brief 单写多读的顺序锁
+ *
+ * 写者不等待读者; 读者在写入期间重试, 总能读到某一次完整写入的快照, 不持有锁。
+ * 数据按64位原子字保存, 读写都不构成数据竞争。T 须可平凡复制, 只允许一个线程写入。
+ */
+template <typename T>
+class SeqLock
+{
+    static_assert(std::is_trivially_copyable<T>::value, "SeqLock requires a trivially copyable type");
+
+public:
+    SeqLock() : m_seq(0)
+    {
+        for (auto &w : m_words) {
+            w.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    // 写入新值 (仅写线程调用)
+    void store(const T &value)
+    {
+        quint64 buf[Words] = {};
+        std::memcpy(buf, &value, sizeof(T));
+
+        const quint64 seq = m_seq.load(std::memory_order_relaxed);
+        m_seq.store(seq + 1, std::memory_order_relaxed);       // 奇数: 写入中
+        std::atomic_thread_fence(std::memory_order_release);
+        for (int i = 0; i < Words; i++) {
+            m_words[i].store(buf[i], std::memory_order_relaxed);
+        }
+        m_seq.store(seq + 2, std::memory_order_release);
+    }
+
+    // 读取最近一次完整写入的值
+    T load() const
+    {
+        quint64 buf[Words];
+        for (;;) {
+            const quint64 before = m_seq.load(std::memory_order_acquire);
+            if (before & 1) {
+                SEQLOCK_PAUSE();
+                continue;
+            }
+            for (int i = 0; i < Words; i++) {
+                buf[i] = m_words[i].load(std::memory_order_relaxed);
+            }
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (m_seq.load(std::memory_order_relaxed) == before) {
+                break;
+            }
+        }
+        T value;
+        std::memcpy(&value, buf, sizeof(T));
+        return value;
+    }
+
+    // 已完成的写入次数
+    quint64 version() const { return m_seq.load(std::memory_order_acquire) / 2; }
+
+private:
+    enum { Words = (sizeof(T) + sizeof(quint64) - 1) / sizeof(quint64) };
+
+    std::atomic<quint64> m_seq;
+    std::atomic<quint64> m_words[Words];
+};
+
+#endif // SEQLOCK_H
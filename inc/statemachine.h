@@ -2,9 +2,12 @@
 #define STATEMACHINE_H
 
 #include <QObject>
-#include <QMap>
+#include <QVector>
 #include <QString>
 #include <QDebug>
+#include <QRecursiveMutex>
+#include <atomic>
+#include <functional>
 #include <memory>
 
 // 前向声明
@@ -13,21 +16,51 @@ class State;
 /**
  * @brief 状态机基类
  * 提供状态机的基本框架，包括状态添加、切换、启动/停止等核心功能
+ *
+ * 状态以整数编号 (StateId, 0 ~ MAX_STATES-1) 存放在表中, 名称只用于日志和界面显示。
+ * 转换表按 "源状态 -> 目标状态位掩码" 预先建立, 守卫条件按 (源, 目标) 存放;
+ * 未声明任何转换时允许任意切换。validateStateTable() 在构造完成后检查一次表的完整性,
+ * 运行时的切换与 update() 分发都是 O(1) 的表查询, 不做字符串比较, 不分配内存。
+ *
+ * update() 在控制执行线程中调用, changeState()/start()/stop()/pause()/resume() 可能来自界面或工作线程,
+ * 二者用同一把递归锁互斥 (状态的 update() 内可再次切换状态)。update() 只尝试加锁, 其他线程正在切换时
+ * 跳过本周期, 控制线程不因此阻塞。
  */
 class StateMachine : public QObject
 {
     Q_OBJECT
 
 public:
+    typedef int StateId;
+    typedef std::function<bool()> TransitionGuard;
+
+    static const StateId INVALID_STATE = -1;
+    static const int MAX_STATES = 64;                      // 转换表用64位掩码, 状态数上限
+
     explicit StateMachine(QObject *parent = nullptr);
     virtual ~StateMachine();
 
     // 状态管理
-    void addState(const QString& stateName, std::shared_ptr<State> state);
-    void setInitialState(const QString& stateName);
-    bool changeState(const QString& stateName);
+    bool addState(StateId id, const QString& stateName, std::shared_ptr<State> state);
+    bool addTransition(StateId from, StateId to, TransitionGuard guard = TransitionGuard());
+    // 检查状态表, 结果保存下来; 检查未通过时 start() 拒绝启动
+    bool validateStateTable();
+    bool isStateTableValid() const { return m_tableValid; }
+    void setInitialState(StateId id);
+    bool changeState(StateId id);
+    StateId getCurrentStateId() const;
     QString getCurrentStateName() const;
     std::shared_ptr<State> getCurrentState() const;
+    // 执行当前状态的一个周期 (由控制执行线程周期调用)
+    void update();
+
+    // 状态编号与名称互查 (按名称查找为线性搜索, 仅用于调试和界面)
+    StateId stateId(const QString& stateName) const;
+    QString stateName(StateId id) const;
+    bool hasState(StateId id) const;
+    bool canTransition(StateId from, StateId to) const;
+    // 按名称切换, 供调试工具使用
+    bool changeState(const QString& stateName);
 
     // 状态机控制
     virtual bool start();
@@ -43,6 +76,7 @@ public:
 signals:
     // 状态变化信号
     void stateChanged(const QString& oldState, const QString& newState);
+    void stateIdChanged(int oldState, int newState);
     void machineStarted();
     void machineStopped();
     void machinePaused();
@@ -57,8 +91,8 @@ signals:
 
 protected:
     // 状态转换相关
-    virtual bool beforeStateChange(const QString& oldState, const QString& newState);
-    virtual void afterStateChange(const QString& oldState, const QString& newState);
+    virtual bool beforeStateChange(StateId oldState, StateId newState);
+    virtual void afterStateChange(StateId oldState, StateId newState);
 
     // 日志输出方法
     void logError(const QString& message);
@@ -67,11 +101,23 @@ protected:
     void logDebug(const QString& message);
 
 private:
-    QMap<QString, std::shared_ptr<State>> m_states;        // 状态映射表
-    QString m_currentStateName;                            // 当前状态名
-    QString m_initialStateName;                            // 初始状态名
-    bool m_isRunning;                                      // 运行状态标志
-    bool m_isPaused;                                      // 暂停状态标志
+    // 状态表中的一项
+    struct StateEntry {
+        QString name;
+        std::shared_ptr<State> state;
+        quint64 transitions = 0;                           // 第j位为1表示允许切换到状态j
+        QVector<TransitionGuard> guards;                   // 到各目标状态的守卫条件, 有守卫时才分配 MAX_STATES 项
+    };
+
+    QVector<StateEntry> m_states;                          // 状态表, 按 StateId 索引
+    bool m_hasTransitions;                                 // 是否声明了转换表
+    bool m_tableValid;                                     // 最近一次 validateStateTable() 的结果 (未检查时为 true)
+    std::atomic<StateId> m_currentState;                   // 当前状态 (可跨线程读取)
+    State* m_current;                                      // 当前状态对象 (update 分发用, 受 m_mutex 保护)
+    StateId m_initialState;                                // 初始状态
+    std::atomic<bool> m_isRunning;                         // 运行状态标志
+    std::atomic<bool> m_isPaused;                          // 暂停状态标志
+    QRecursiveMutex m_mutex;                               // 保护状态切换、启停与 update 分发
 };
 
 /**
@@ -88,6 +134,8 @@ public:
     virtual void enter() = 0;                              // 进入状态时调用
     virtual void exit() = 0;                               // 退出状态时调用
     virtual void update() = 0;                             // 状态更新时调用
+    virtual void pause() {}                                // 状态机暂停时调用 (默认无操作)
+    virtual void resume() {}                               // 状态机恢复时调用 (默认无操作)
 
     // 状态机引用
     StateMachine* getMachine() const;
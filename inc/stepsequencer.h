@@ -0,0 +1,115 @@
+#ifndef STEPSEQUENCER_H
+#define STEPSEQUENCER_H
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <atomic>
+#include <functional>
+#include <initializer_list>
+
+/**
+ * @brief 声明式步骤序列, 进度保存在实例中 (可重入, 可暂停恢复)
+ *
+ * 每一步声明: 开始时执行一次的动作、完成条件、超时、占用的机构 (资源位) 和前置步骤。
+ * 默认前置步骤为上一步 (顺序执行); parallel() 使该步与上一步同时开始, after() 指定任意前置步骤。
+ * 占用相同机构的步骤不会同时执行。tick() 由控制周期调用: 检查运行中步骤的完成条件与超时,
+ * 并在同一周期内启动所有前置已完成且机构空闲的步骤, 步骤衔接不额外等待周期。
+ * 暂停期间不计入超时; 超时后序列停在 Failed, resume() 后重新计时继续等待该步完成。
+ */
+class StepSequencer
+{
+public:
+    typedef std::function<bool()> Action;               // 返回 false 表示命令未被接受, 下个周期重试
+    typedef std::function<bool()> Condition;             // 返回 true 表示该步已完成
+    typedef std::function<void(const QString &)> StepCallback;
+
+    enum Result {
+        Running,                                         // 仍有步骤未完成
+        Finished,                                        // 全部步骤已完成
+        Failed                                           // 有步骤超时
+    };
+
+    static const int MAX_STEPS = 64;                     // 完成状态用64位掩码, 步骤数上限
+
+    // 步骤声明, 由 addStep() 返回, 可链式设置; 引用在下一次 addStep() 前有效
+    class Step
+    {
+    public:
+        Step &action(Action action) { m_action = action; return *this; }
+        Step &until(Condition done) { m_done = done; return *this; }
+        Step &timeoutMs(int ms) { m_timeoutUs = qint64(qMax(0, ms)) * 1000; return *this; }
+        Step &uses(quint32 resources) { m_resources = resources; return *this; }
+        // 开始时通过 StepCallback 上报步骤名称
+        Step &announce() { m_announce = true; return *this; }
+        // 与上一步同时开始 (前置步骤与上一步相同)
+        Step &parallel();
+        // 指定前置步骤, 替代默认的上一步; 空列表表示序列开始即可执行
+        Step &after(std::initializer_list<int> steps);
+        // 步骤编号, 供后续步骤的 after() 引用
+        int index() const { return m_index; }
+
+    private:
+        friend class StepSequencer;
+
+        enum Status { Pending, Starting, Running, Done };
+
+        QString m_name;
+        Action m_action;
+        Condition m_done;
+        qint64 m_timeoutUs = 0;                          // 0 表示不限时
+        quint32 m_resources = 0;
+        quint64 m_deps = 0;                              // 第j位为1表示须等待步骤j完成
+        bool m_announce = false;
+
+        StepSequencer *m_owner = nullptr;
+        int m_index = 0;
+        Status m_status = Pending;
+        qint64 m_startUs = 0;                            // 开始时刻 (不含暂停时间的时钟)
+    };
+
+    explicit StepSequencer(const QString &name = QString());
+
+    // 添加一步, 返回其声明; 步骤编号即添加顺序
+    Step &addStep(const QString &name);
+    void clear();
+    bool isEmpty() const { return m_steps.isEmpty(); }
+    int stepCount() const { return m_steps.size(); }
+
+    void setName(const QString &name) { m_name = name; }
+    void setStepCallback(StepCallback callback) { m_callback = callback; }
+
+    // 回到初始状态, 所有步骤重新等待执行
+    void reset();
+    // 执行一个周期, 须在控制线程中调用
+    Result tick();
+
+    // 暂停/恢复计时, 可在任意线程调用
+    void pause();
+    void resume();
+
+    Result result() const { return m_result; }
+    // 超时的步骤名称, 未失败时为空
+    QString failedStep() const;
+    // 正在执行的步骤名称
+    QStringList runningSteps() const;
+
+private:
+    qint64 activeClockUs() const;
+    bool startStep(Step &step, qint64 nowUs);
+
+    QString m_name;
+    QVector<Step> m_steps;
+    StepCallback m_callback;
+
+    quint64 m_doneMask = 0;
+    quint32 m_busy = 0;                                  // 运行中步骤占用的机构
+    int m_failedStep = -1;
+    Result m_result = Running;
+
+    std::atomic<qint64> m_pauseStartUs;                  // 暂停开始时刻, 0 表示未暂停
+    std::atomic<qint64> m_pausedTotalUs;                 // 累计暂停时间
+    std::atomic<bool> m_rearm;                           // 恢复后重新计时
+};
+
+#endif // STEPSEQUENCER_H
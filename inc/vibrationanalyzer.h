@@ -0,0 +1,126 @@
+#ifndef VIBRATIONANALYZER_H
+#define VIBRATIONANALYZER_H
+
+#include <QObject>
+#include <QMutex>
+#include <QAtomicInt>
+#include <QVector>
+#include <QMetaType>
+#include <memory>
+#include <vector>
+
+#include "inc/daqringbuffer.h"
+#include "inc/realfft.h"
+
+// 单通道振动特征
+struct VibChannelFeatures {
+    double rms = 0.0;               // 去直流后的均方根
+    double peak = 0.0;              // 去直流后的峰值(绝对值)
+    double crestFactor = 0.0;       // 峰值因子 peak/rms
+    double kurtosis = 0.0;          // 峭度 (正态分布为3)
+    double peakFrequency = 0.0;     // 功率谱最大处的频率 (Hz, 不含直流)
+    QVector<double> bandRms;        // 各频带的均方根, 频带由 bandEdges 划分
+    QVector<float> spectrum;        // Welch平均后的单边功率谱 (V^2/每频点), 用于绘图
+};
+
+// 一个统计周期的特征帧
+struct VibFeatureFrame {
+    int roundId = 0;                // 轮次
+    int sampleRate = 0;             // 采样频率
+    qint64 samplePos = 0;           // 本周期最后一个点的序号(每通道)
+    double timeSec = 0.0;           // 本周期结束时刻, 自本轮开始的秒数
+    qint64 timeUs = 0;              // 本周期结束时刻 (sensorClockUs), 与 Modbus 各表的 TimeUs 同一时钟
+    double frequencyResolution = 0; // 频谱分辨率 (Hz)
+    int averages = 0;               // Welch平均的段数
+    QVector<double> bandEdges;      // 频带边界 (Hz)
+    QVector<VibChannelFeatures> channels;
+};
+Q_DECLARE_METATYPE(VibFeatureFrame)
+
+/**
+ * @brief 振动在线分析线程
+ *
+ * 作为环形缓冲区的一个消费者读取采集块, 对每个通道做加Hann窗、50%重叠的分段FFT,
+ * 按 featureIntervalMs 周期输出 Welch 平均功率谱、频带均方根、主频、峰值因子和峭度。
+ * 各通道缓冲在每轮开始时分配, 处理采集块时不再分配内存。
+ * 每块各通道的有效值同时送入 g_sensorAligner。
+ */
+class VibrationAnalyzer : public QObject
+{
+    Q_OBJECT
+public:
+    explicit VibrationAnalyzer(QObject *parent = nullptr);
+    ~VibrationAnalyzer();
+
+    //////////////////////////////////分析参数/////////////////////////////////////
+    int fftSize = 4096;                     // 每段点数 (2的整数次幂), 周期内点数不足时自动减小
+    int featureIntervalMs = 500;            // 特征输出周期
+    QVector<double> bandEdges = {10, 100, 500, 1000, 2000, 5000, 10000, 20000, 50000};   // 频带边界 (Hz)
+
+    // 注册为环形缓冲区的消费者 (在线程启动前调用)
+    void setRingBuffer(const std::shared_ptr<DAQRingBuffer> &ring);
+
+    // 开始新的一轮分析 (线程安全)
+    void beginRound(int roundId, int sampleRate);
+
+    // 请求停止分析线程
+    void requestStop();
+
+signals:
+    void featuresReady(VibFeatureFrame frame);
+
+public slots:
+    void doWork();
+
+private:
+    // 单通道分析状态
+    struct ChannelState {
+        std::vector<float> frame;           // 当前段的样本
+        int fill = 0;                       // 当前段已有点数
+        std::vector<double> psdSum;         // 各段功率谱之和
+        double sum = 0.0;                   // 时域统计 (本周期)
+        double sum2 = 0.0;
+        double sum3 = 0.0;
+        double sum4 = 0.0;
+        double minValue = 0.0;
+        double maxValue = 0.0;
+        qint64 count = 0;
+        int segments = 0;                   // 本周期已完成的段数
+    };
+
+    // 按当前轮次参数重新分配各通道缓冲
+    void setupRound();
+    void processBlock(const DAQSampleBlock &block);
+    // 每块各通道的有效值按块中点时刻送入多传感器对齐 (不在采集线程中计算)
+    void pushBlockRms(const DAQSampleBlock &block);
+    // 一段已满: 加窗、FFT、累加功率谱, 保留后半段作为下一段的开头
+    void processSegment(ChannelState &state);
+    // 输出本周期的特征并清零累加量
+    void emitFeatures(qint64 samplePos, qint64 timeUs);
+
+    std::shared_ptr<DAQRingBuffer> ring;
+    int consumerId = -1;
+
+    QMutex roundMutex;
+    int pendingRoundId = 0;                 // 受 roundMutex 保护
+    int pendingSampleRate = 0;
+    QAtomicInt roundChanged;
+    QAtomicInt shouldStop;
+
+    // 以下仅在分析线程中访问
+    int roundId = 0;
+    int sampleRate = 0;
+    int segmentSize = 0;                    // 实际使用的段长
+    int intervalSamples = 0;                // 每周期点数
+    qint64 intervalCount = 0;               // 本周期已处理点数
+    qint64 nextSamplePos = -1;              // 期望的下一块起始点, 用于检测断点
+    qint64 roundStartPos = -1;              // 本轮第一个块的起始点, 特征时刻相对于该点计算
+    RealFFT fft;
+    std::vector<float> window;              // Hann窗
+    double windowPower = 0.0;               // 窗函数平方和
+    std::vector<float> windowed;            // 加窗后的段 (复用)
+    std::vector<float> power;               // 单段功率谱 (复用)
+    std::vector<ChannelState> channelStates;
+};
+
+#endif // VIBRATIONANALYZER_H
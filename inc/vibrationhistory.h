@@ -0,0 +1,106 @@
+#ifndef VIBRATIONHISTORY_H
+#define VIBRATIONHISTORY_H
+
+#include <QString>
+#include <QVector>
+#include <QTemporaryFile>
+#include <memory>
+#include <vector>
+
+#include "inc/daqblock.h"
+#include "inc/plotdecimator.h"
+
+/**
+ * @brief 振动历史数据的多分辨率最小/最大值金字塔
+ *
+ * 每个通道保存全部原始样本, 其上第0层每 baseBucket 个样本一个桶, 往上每层合并 levelFactor
+ * 个下层桶, 每个桶按出现顺序保存最小值和最大值。原始样本和各层只在内存中保留最近的部分,
+ * 较早的数据整页写入临时文件, 绘制时再读回。绘制任意时间范围时选用每像素至少一个桶的最粗层,
+ * 第0层的桶已宽于一个像素时直接读原始样本, 读出的数据再由 MinMaxDecimator 按像素合并,
+ * 读取和输出的点数只与像素数有关, 与轮次长度和采样频率无关。
+ * 横轴按块的采样时刻放置: 块序号不连续 (溢出丢块) 或时刻与连续推算相差超过 gapThresholdSec
+ * (暂停后恢复) 时开始新的一段, 段之间的曲线断开。非线程安全, 由界面线程使用。
+ */
+class VibrationHistory
+{
+public:
+    VibrationHistory();
+    ~VibrationHistory();
+
+    //////////////////////////////////金字塔参数/////////////////////////////////////
+    int baseBucket = 16;                    // 第0层每桶样本数
+    int levelFactor = 8;                    // 相邻层的合并倍数
+    int levelCount = 8;                     // 层数 (最粗层每桶 16*8^7 个样本)
+    int memoryBuckets = 256 * 1024;         // 每层 (含原始样本) 内存中保留的条目数, 超过两倍时写出一页
+    double gapThresholdSec = 0.1;           // 块时刻与连续推算相差超过该值时视为中断
+    QString spillDir;                       // 临时文件目录, 为空时使用系统临时目录
+
+    // 开始新的一轮 (清空数据并删除临时文件)
+    void reset(int channels, int sampleRate);
+    // 追加一个采集块
+    void append(const DAQSampleBlock &block);
+
+    int channels() const { return static_cast<int>(m_channels.size()); }
+    int sampleRate() const { return m_sampleRate; }
+    qint64 totalSamples() const { return m_totalSamples; }
+    double duration() const;                // 本轮开始到最后一个样本的时长(秒), 含中断
+    int segmentCount() const { return m_segments.size(); }
+    qint64 spilledBytes() const { return m_spilledBytes; }
+
+    // 输出某通道 [t0, t1] 秒范围内的数据, 每像素最多2个点; 键为自本轮开始的秒数,
+    // 中断处插入 NaN; 值乘以scale; 同时给出值的范围。返回输出点数
+    int render(int ch, double t0, double t1, int pixels,
+               QVector<double> &keys, QVector<double> &values, double scale,
+               double *minValue = nullptr, double *maxValue = nullptr);
+
+private:
+    typedef MinMaxBucket Bucket;
+
+    // 按顺序追加的条目, 内存中为 [spilled, count), 之前的在文件中
+    template <typename T>
+    struct Store {
+        qint64 count = 0;                       // 已追加的条目数
+        qint64 spilled = 0;                     // 已写入文件的条目数
+        QVector<T> tail;                        // 内存中的条目
+        std::unique_ptr<QTemporaryFile> file;   // 写出的条目
+    };
+
+    struct Level : Store<Bucket> {
+        MinMaxAccumulator pending;              // 正在累积的桶
+    };
+
+    struct Channel {
+        Store<float> raw;                       // 原始样本
+        std::vector<Level> levels;              // 金字塔各层
+    };
+
+    // 连续采集的一段: 第 start 个样本起, 位于本轮开始后 timeSec 秒
+    struct Segment {
+        qint64 start;
+        double timeSec;
+    };
+
+    qint64 bucketSamples(int level) const;
+    // 向某层追加一个完成的桶, 并逐层向上合并
+    void push(Channel &channel, int level, const Bucket &bucket);
+    // 追加一个条目, 内存中超过两页时写出最早的一页
+    template <typename T> void appendItem(Store<T> &store, const T &item);
+    // 将最早的 memoryBuckets 个条目写入临时文件
+    template <typename T> void spill(Store<T> &store);
+    // 读取 [first, first+n) 的条目 (须小于 count), 读文件失败的部分填入 fill
+    template <typename T> void read(Store<T> &store, qint64 first, int n, T *dst, const T &fill);
+
+    std::vector<Channel> m_channels;
+    QVector<Segment> m_segments;
+    QVector<Bucket> m_readBuffer;               // 绘制时复用
+    QVector<float> m_rawBuffer;                 // 绘制时复用
+    MinMaxDecimator m_decimator;                // 按像素合并读出的数据
+    int m_sampleRate = 0;
+    qint64 m_totalSamples = 0;
+    qint64 m_startUs = 0;                       // 本轮第一个块的采样时刻
+    qint64 m_nextSamplePos = 0;                 // 下一个块应有的 samplePos
+    qint64 m_spilledBytes = 0;
+    bool m_spillFailed = false;                 // 写临时文件失败后全部保留在内存
+};
+
+#endif // VIBRATIONHISTORY_H
@@ -0,0 +1,131 @@
+#ifndef VIBRATIONRECORDER_H
+#define VIBRATIONRECORDER_H
+
+#include <QObject>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QQueue>
+#include <QAtomicInt>
+#include <QMetaType>
+#include <memory>
+
+#include "inc/daqringbuffer.h"
+#include "inc/vibrationstore.h"
+#include "inc/vibrationsegment.h"
+
+// 记录方式
+enum class RecordMode {
+    Database,       // 编码为BLOB写入SQLite (IEPEBlocks)
+    RawSegments     // 全速率原始数据写入内存映射段文件
+};
+
+// 记录线程统计信息
+struct RecorderStats {
+    int queueDepth = 0;             // 环形缓冲区中尚未读取的块数
+    int maxQueueDepth = 0;          // 未读块数峰值
+    int queueCapacity = 0;          // 环形缓冲区可缓存的块数
+    qint64 readBlocks = 0;          // 记录轮次中已读取的块数
+    qint64 overrunBlocks = 0;       // 读取落后被覆盖的块数
+    qint64 lostSamples = 0;         // 被覆盖块的样本点数 (按起始点跳变计算)
+    int recordGaps = 0;             // 因覆盖造成的记录断点数
+    qint64 ignoredBlocks = 0;       // 不在记录轮次中而被忽略的块数
+    qint64 writtenChunks = 0;       // 已写入数据库的存储块数
+    qint64 writtenBytes = 0;        // 已写入的编码字节数
+    qint64 segmentBytes = 0;        // 已写入段文件的字节数
+    int segmentCount = 0;           // 已创建的段文件数
+    qint64 segmentErrors = 0;       // 段文件写入失败的块数
+    qint64 commits = 0;             // 提交次数
+    qint64 failedCommits = 0;       // 失败的提交次数
+    qint64 droppedChunks = 0;       // 待提交超过上限而丢弃的存储块数
+    int lastCommitMs = 0;           // 最近一次提交耗时
+    int maxCommitMs = 0;            // 提交耗时峰值
+};
+Q_DECLARE_METATYPE(RecorderStats)
+
+/**
+ * @brief 振动数据记录线程
+ *
+ * 作为环形缓冲区的一个消费者, 以独立的读游标读取采集块, 编码后按数量或时间阈值成组提交;
+ * 采集线程不参与记录, 也不会被数据库操作阻塞。读取落后超过一圈时由环形缓冲区记录溢出,
+ * 本线程按起始点跳变统计丢失点数并计为一个记录断点 (存储块/段索引据此分段)。
+ * 数据库不可用或提交失败时待提交数据最多保留 maxPendingChunks 块, 超出部分从最早的开始丢弃并计数。
+ * 轮次的开始/结束记录调用时的写位置, 与数据块按块序号排序, 保证顺序一致。
+ */
+class VibrationRecorder : public QObject
+{
+    Q_OBJECT
+public:
+    explicit VibrationRecorder(QObject *parent = nullptr);
+    ~VibrationRecorder();
+
+    //////////////////////////////////记录参数/////////////////////////////////////
+    QString dbFileName;                     // 数据库文件
+    int commitChunks = 64;                  // 待提交存储块数达到该值时提交
+    qint64 commitBytes = 1024 * 1024;       // 待提交字节数达到该值时提交
+    int commitIntervalMs = 500;             // 最长提交间隔
+    int maxPendingChunks = 1024;            // 提交失败时最多保留的待提交存储块数
+    VibSampleFormat sampleFormat = VibSampleFormat::Int24;  // 样本编码格式
+    QString segmentDir;                     // 段文件目录 (RawSegments 模式)
+    qint64 segmentSize = 256LL * 1024 * 1024;   // 段文件滚动大小
+
+    // 注册为环形缓冲区的消费者 (在线程启动前调用)
+    void setRingBuffer(const std::shared_ptr<DAQRingBuffer> &ring);
+
+    // 开始/结束一轮记录 (线程安全)
+    void beginRound(int roundId, int sampleRate, RecordMode mode = RecordMode::Database);
+    void endRound();
+
+    // 是否处于记录轮次中
+    bool isRecording() const;
+
+    // 获取统计信息 (线程安全)
+    RecorderStats getStats() const;
+
+    // 请求停止记录线程, 剩余数据会在退出前提交
+    void requestStop();
+
+signals:
+    void statsUpdated(RecorderStats stats);     // 提交后发送 (空闲时约每 commitIntervalMs 一次)
+
+public slots:
+    void doWork();
+
+private:
+    struct Item {
+        enum Type { BeginRound, EndRound };
+        Type type = BeginRound;
+        quint64 seq = 0;                    // 轮次开始/结束时环形缓冲区的写位置
+        int roundId = 0;
+        int sampleRate = 0;
+        RecordMode mode = RecordMode::Database;
+    };
+
+    // 读取并记录块序号小于 endSeq 的采集块
+    void drainRing(quint64 endSeq);
+    void recordBlock(const DAQSampleBlock &block);
+    // 将待提交块写入数据库
+    void commitPending(QSqlDatabase &db);
+    // 待提交数据超过上限时丢弃最早的部分
+    void trimPending();
+
+    mutable QMutex queueMutex;
+    QWaitCondition queueNotEmpty;
+    QQueue<Item> queue;                     // 特征帧与轮次控制项
+    RecorderStats stats;                    // 受 queueMutex 保护
+    QAtomicInt recording;
+    QAtomicInt shouldStop;
+
+    std::shared_ptr<DAQRingBuffer> ring;
+    int consumerId = -1;
+
+    // 以下仅在记录线程中访问
+    DAQBlockPtr heldBlock;                  // 已读出但属于下一个控制项之后的块
+    qint64 nextSamplePos = -1;              // 期望的下一块起始点, 用于统计覆盖丢失的点数
+    quint64 lastOverruns = 0;
+    VibrationStore store;
+    VibrationSegmentWriter segmentWriter;
+    RecordMode roundMode = RecordMode::Database;
+    bool inRound = false;
+};
+
+#endif // VIBRATIONRECORDER_H
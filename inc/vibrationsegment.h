@@ -0,0 +1,132 @@
+#ifndef VIBRATIONSEGMENT_H
+#define VIBRATIONSEGMENT_H
+
+#include <QString>
+#include <QStringList>
+#include <QFile>
+#include <QVector>
+
+#include "inc/daqblock.h"
+
+/*
+ * 振动原始数据段文件 (*.vks) 布局:
+ *   [0, 4096)                       段头 VibSegmentHeader
+ *   [4096, dataOffset)              块索引, indexCapacity 个 VibSegmentIndexEntry
+ *   [dataOffset, dataOffset+dataUsed) 数据区, 每块按通道连续存放 float32:
+ *                                   CH1[points], CH2[points], ...
+ * 文件创建时按 segmentSize 预分配并整体映射, 写入只是内存复制; 关闭时截断到实际大小。
+ */
+
+#define VIB_SEGMENT_MAGIC       "VKSEG001"
+#define VIB_SEGMENT_VERSION     1
+#define VIB_SEGMENT_HEADER_SIZE 4096
+#define VIB_SEGMENT_SUFFIX      ".vks"
+
+#pragma pack(push, 1)
+struct VibSegmentHeader {
+    char magic[8];              // VIB_SEGMENT_MAGIC
+    quint32 version;
+    quint32 channels;           // 通道数
+    quint32 sampleRate;         // 采样频率
+    quint32 indexCapacity;      // 索引容量(块)
+    quint64 segmentSize;        // 预分配大小
+    quint64 dataOffset;         // 数据区起始偏移
+    quint64 dataUsed;           // 数据区已用字节
+    quint32 blockCount;         // 已写入块数 (最后更新)
+    quint32 closed;             // 1 表示已正常关闭
+    qint64 createdMs;           // 创建时间 (自1970年的毫秒数)
+};
+
+struct VibSegmentIndexEntry {
+    quint64 dataOffset;         // 块数据相对文件开头的偏移
+    qint64 samplePos;           // 块第一个点在本次采集中的序号
+    qint64 timestampUs;         // 块第一个点的采样时间 (自1970年的微秒数)
+    qint32 roundId;             // 轮次
+    qint32 points;              // 每通道点数
+};
+#pragma pack(pop)
+
+// 单通道数据视图, 直接指向映射内存
+struct VibChannelSpan {
+    const float *data = nullptr;
+    int count = 0;
+};
+
+/**
+ * @brief 段文件写入器
+ *
+ * 将采集块追加到预分配并内存映射的段文件中, 写满(数据区或索引)时自动滚动到下一个段。
+ * 非线程安全, 由记录线程独占使用。
+ */
+class VibrationSegmentWriter
+{
+public:
+    VibrationSegmentWriter();
+    ~VibrationSegmentWriter();
+
+    QString directory;                          // 段文件目录
+    QString prefix = "vib";                     // 文件名前缀
+    qint64 segmentSize = 256LL * 1024 * 1024;   // 每段预分配大小
+    int indexCapacity = 65536;                  // 每段最多块数
+
+    // 设置当前轮次, 之后写入的块在索引中记录该轮次
+    void setRound(int roundId, int sampleRate);
+    // 追加一个采集块, 失败返回false
+    bool append(const DAQSampleBlock &block);
+    // 关闭当前段 (截断到实际大小)
+    void close();
+
+    bool isOpen() const { return m_map != nullptr; }
+    QString currentFile() const { return m_file.fileName(); }
+    int segmentCount() const { return m_segmentCount; }
+    qint64 totalBytes() const { return m_totalBytes; }
+
+private:
+    // 创建并映射新段
+    bool openSegment(int channels);
+    VibSegmentHeader *header() { return reinterpret_cast<VibSegmentHeader *>(m_map); }
+
+    QFile m_file;
+    uchar *m_map = nullptr;
+    int m_roundId = 0;
+    int m_sampleRate = 0;
+    qint64 m_wallOffsetUs = 0;      // 墙上时间(微秒) - sensorClockUs, 每轮开始时确定
+    int m_segmentCount = 0;
+    qint64 m_totalBytes = 0;
+};
+
+/**
+ * @brief 段文件读取器
+ *
+ * 只读映射整个段文件, 按块返回各通道数据视图, 无需解析或复制。
+ */
+class VibrationSegmentReader
+{
+public:
+    VibrationSegmentReader();
+    ~VibrationSegmentReader();
+
+    bool open(const QString &fileName);
+    void close();
+
+    bool isOpen() const { return m_map != nullptr; }
+    const VibSegmentHeader &header() const { return *reinterpret_cast<const VibSegmentHeader *>(m_map); }
+    int blockCount() const;
+    const VibSegmentIndexEntry &entry(int block) const;
+
+    // 某块某通道的数据视图
+    VibChannelSpan channel(int block, int ch) const;
+
+    // 查找某轮次中包含指定采样点的块, 未找到返回-1
+    int findBlock(int roundId, qint64 samplePos) const;
+
+    // 列出目录下的段文件 (按文件名排序)
+    static QStringList listSegments(const QString &directory, const QString &prefix = "vib");
+
+private:
+    QFile m_file;
+    uchar *m_map = nullptr;
+    qint64 m_size = 0;
+};
+
+#endif // VIBRATIONSEGMENT_H
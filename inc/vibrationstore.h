@@ -0,0 +1,95 @@
+#ifndef VIBRATIONSTORE_H
+#define VIBRATIONSTORE_H
+
+#include <QByteArray>
+#include <QVector>
+#include <QVariantList>
+#include <QSqlDatabase>
+
+#include "inc/daqblock.h"
+
+// 振动数据块的样本编码格式
+enum class VibSampleFormat : quint8 {
+    Float32 = 1,    // 32位浮点, 原样保存
+    Int24 = 2       // 24位整数 + 块内缩放系数 (按块峰值归一化)
+};
+
+// 数据块头 (小端, 16字节), 位于每个BLOB的开头
+struct VibBlockHeader {
+    quint16 magic = 0;          // 固定为 VIB_BLOCK_MAGIC
+    quint8 version = 0;         // 格式版本
+    quint8 format = 0;          // VibSampleFormat
+    quint32 points = 0;         // 样本点数
+    float scale = 1.0f;         // Int24 时的缩放系数 (电压 = 整数值 * scale)
+    quint32 sampleRate = 0;     // 采样频率
+};
+
+#define VIB_BLOCK_MAGIC         0x4256  // "VB"
+#define VIB_BLOCK_VERSION       1
+#define VIB_BLOCK_HEADER_SIZE   16
+
+// 编码一个通道的连续样本
+QByteArray encodeVibrationBlock(const double *samples, int points, VibSampleFormat format, int sampleRate);
+
+// 解码数据块, 成功返回true
+bool decodeVibrationBlock(const QByteArray &blob, QVector<double> &samples, VibBlockHeader *header = nullptr);
+
+/**
+ * @brief 振动数据分块存储
+ *
+ * 按 (轮次, 通道, 起始点) 将每个通道的连续样本累积为固定大小的块,
+ * 编码后以BLOB形式写入 SQLite 的 IEPEBlocks 表, 取代每个样本一行的 IEPEdata 表。
+ * 本类不持有数据库连接, 由调用方提供。
+ */
+class VibrationStore
+{
+public:
+    explicit VibrationStore(VibSampleFormat format = VibSampleFormat::Int24, int chunkPoints = 1000);
+
+    // 创建分块存储表及索引
+    static bool createTables(QSqlDatabase &db);
+
+    // 开始新的一轮记录
+    void beginRound(int roundId, int sampleRate);
+    // 追加一个采集块 (各通道分别累积)
+    void append(const DAQSampleBlock &block);
+    // 结束本轮, 将未满的块也编码为待提交块
+    void finishRound();
+
+    // 待提交的块数
+    int pendingChunks() const { return m_roundIds.size(); }
+    // 待提交块的编码后字节数
+    qint64 pendingBytes() const { return m_pendingBytes; }
+    // 在一个事务中提交所有待提交块, 失败时保留数据以便重试
+    bool commit(QSqlDatabase &db);
+    // 丢弃最早的待提交块, 只保留最近 keep 个, 返回丢弃数 (数据库长时间不可用时限制内存)
+    int dropOldestChunks(int keep);
+
+    void setFormat(VibSampleFormat format) { m_format = format; }
+    void setChunkPoints(int points) { m_chunkPoints = qMax(1, points); }
+
+private:
+    // 将某通道已累积的样本编码为一个待提交块
+    void flushChannel(int ch);
+
+    VibSampleFormat m_format;
+    int m_chunkPoints;
+    int m_roundId = 0;
+    int m_sampleRate = 0;
+    qint64 m_roundStartSample = -1;         // 本轮第一个块的起始点, 块起始时刻相对于该点计算
+
+    // 各通道的累积缓冲和起始点
+    QVector<QVector<double>> m_channelBuf;
+    QVector<qint64> m_channelStart;
+
+    // 待提交的列数据, 直接用于 execBatch
+    QVariantList m_roundIds;
+    QVariantList m_chIds;
+    QVariantList m_startSamples;
+    QVariantList m_startTimes;
+    QVariantList m_points;
+    QVariantList m_blobs;
+    qint64 m_pendingBytes = 0;
+};
+
+#endif // VIBRATIONSTORE_H
@@ -14,8 +14,17 @@
 #include <QMutex>
 #include <QVector>
 #include <QAtomicInt>
+#include <QElapsedTimer>
+#include <QMetaType>
 #include <memory>
 
+#include "inc/daqringbuffer.h"
+
+// 采集环形缓冲区配置
+#define DAQ_CHANNEL_COUNT           4       // VK701N 通道数
+#define DAQ_RING_SLOT_COUNT         128     // 环形缓冲区槽数
+#define DAQ_RING_MAX_BLOCK_POINTS   2000    // 每槽最大每通道点数
+
 // 定义采集卡工作状态枚举
 enum class DAQState {
     Disconnected,   // 未连接
@@ -26,6 +35,15 @@ enum class DAQState {
     Error           // 错误状态
 };
 
+// 连续流采集统计信息 (采样点数均为每通道点数)
+struct DAQStreamStats {
+    qint64 totalSamples = 0;    // 已接收的采样点总数
+    qint64 droppedSamples = 0;  // 估算丢失的采样点总数
+    int gapCount = 0;           // 检测到的断点次数
+    qint64 blockCount = 0;      // 已读取的数据块数
+};
+Q_DECLARE_METATYPE(DAQStreamStats)
+
 class vk701nsd : public QObject
 {
     Q_OBJECT
@@ -45,6 +63,8 @@ public:
     bool fDAQSampleClr;                     // 0-开始采样 1-停止采样
     int reconnectCounter = 2000;            // 初始化过程中的连接尝试次数
     int loopTimes = 0;                      // 循环次数计数
+    bool streamingMode = true;              // 连续流采集模式 (false: 旧的 启动-读取-休眠 模式)
+    int blockPoints = 0;                    // 流模式下每块每通道点数, 0表示自动(约10ms一块)
 
     // 设置缓冲区大小
     void setBufferSize(int size);
@@ -57,13 +77,20 @@ public:
     
     // 判断工作线程是否应该继续运行
     bool shouldContinue() const;
+
+    // 获取连续流采集统计信息
+    DAQStreamStats getStreamStats() const;
+
+    // 获取采集数据环形缓冲区, 消费者通过各自的游标读取
+    std::shared_ptr<DAQRingBuffer> ringBuffer() const;
     
 signals:
-    void resultValue(QVector<double> *list);   // 传输数据采集卡的值
     void resultMsg(QString msg);               // 消息结果
     void resultClr(QString msg);               // 清除结果
     void resultConn(bool msg);                 // 连接状态
     void stateChanged(DAQState newState);      // 状态变更信号
+    void gapDetected(qint64 samplePos, qint64 missing);  // 断点: 位置(每通道点序号)与丢失点数
+    void streamStatsUpdated(DAQStreamStats stats);       // 流采集统计(约每秒一次)
 
 public slots:
     void doWork();
@@ -75,21 +102,40 @@ private:
     // 开始采样过程
     bool startSampling();
     
-    // 处理数据采集
+    // 处理数据采集 (旧模式: 每次重新启动采样)
     void processSampling();
+
+    // 连续流采集: 读取一个数据块并检测断点
+    void processStreaming();
+
+    // 计算流模式下的块大小
+    int streamBlockPoints() const;
+
+    // 重置流采集统计
+    void resetStreamStats();
+
+    // 重新开始断点检测计时 (恢复采样时), 不清零统计与点序号
+    void rearmGapDetection();
     
     // 处理暂停状态
     void handlePausedState();
 
 private:
-    // 使用QVector替代QList提高性能，使用互斥锁保护数据
-    QVector<double> *dataBuffer;
+    // 采集数据环形缓冲区 (单生产者/多消费者, 无锁)
+    std::shared_ptr<DAQRingBuffer> ring;
     QMutex mutex;
     int bufferSize;
     
     // 使用原子变量控制工作线程的运行和状态
     QAtomicInt shouldStop;
     DAQState currentState;
+
+    // 连续流采集相关
+    QElapsedTimer streamClock;              // 断点检测计时窗口, 自窗口起点起的计时
+    qint64 streamBaseSamples = 0;           // 窗口起点时已计入的点数 (含丢失)
+    qint64 lastStatsEmitMs = 0;             // 上次发送统计信息的时间 (sensorClockUs / 1000)
+    DAQStreamStats stats;                   // 流采集统计
+    mutable QMutex statsMutex;              // 统计信息互斥锁
 };
 
 #endif // VK701NSD_H
\ No newline at end of file
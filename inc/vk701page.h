@@ -19,6 +19,9 @@
 #include "inc/vk701nsd.h"
 #include "inc/qcustomplot.h"
 #include "inc/Global.h"
+#include "inc/vibrationrecorder.h"
+#include "inc/vibrationhistory.h"
+#include "inc/vibrationanalyzer.h"
 
 // 添加Sqlite 数据库
 #include <QSqlDatabase>
@@ -48,16 +51,21 @@ public:
 public slots:
     // 数据库初始化与操作
     void InitDB(const QString &fileName);           // 初始化数据库
-    void saveDataToDatabase(const QVector<double> &data, int channels, int pointsPerChannel); // 异步保存数据
     void cleanupOldData(int keepLastNRounds);      // 清理旧数据，保留最近N轮
     
     // 新增: 处理数据采集卡状态变化
     void handleStateChanged(DAQState newState);
 
+    // 处理流采集统计 (丢点与断点)
+    void handleStreamStats(DAQStreamStats stats);
+
+    // 处理记录线程统计 (队列深度与背压)
+    void handleRecorderStats(RecorderStats stats);
+
+    // 处理振动特征 (频谱、频带均方根、主频、峰值因子、峭度)
+    void handleVibFeatures(VibFeatureFrame frame);
+
 private slots:
-    // 处理数据采集卡获取的数据
-    void handleResultValue(QVector<double> *list);
-    
     // UI按钮事件处理
     void on_btn_start_2_clicked();          // 开始按钮
     void on_btn_stop_2_clicked();           // 停止按钮
@@ -77,6 +85,9 @@ private slots:
     // 新增: 关闭事件处理 (优雅退出)
     void closeEvent(QCloseEvent *event) override;
 
+signals:
+    // 振动特征帧, 由 Modbus 写库线程与各采样一起记录
+    void vibFeaturesReady(const VibFeatureFrame &frame);
 
 private:
     // 数据库相关
@@ -84,10 +95,17 @@ private:
     QDateTime startTime;                    // 开始时间
     QDateTime stopTime;                     // 结束时间
     
-    // 批量插入相关
-    QList<QVariantList> batchData;          // 批量插入缓冲
-    int batchSize = 1000;                   // 批量插入大小
-    QTimer *dbCommitTimer;                  // 定时提交数据库
+    // 记录线程相关
+    QThread *recorderThread;                // 振动数据记录线程
+    VibrationRecorder *recorder;            // 振动数据记录对象
+    qint64 lastRecorderOverruns = 0;        // 上次报告的被覆盖块数
+    qint64 lastRecorderDropped = 0;         // 上次报告的丢弃存储块数
+    qint64 recordLostSamples = 0;           // 本轮未被记录的样本点数
+    qint64 roundLostBase = 0;               // 本轮开始前记录线程累计丢失的点数
+
+    // 分析线程相关
+    QThread *analyzerThread;                // 振动在线分析线程
+    VibrationAnalyzer *analyzer;            // 振动在线分析对象
     
     // UI相关
     Ui::vk701page *ui;
@@ -99,15 +117,38 @@ private:
     QTimer *plotUpdateTimer;                // 图表更新定时器
     
     // 数据缓冲
-    QVector<double> currentData;            // 当前显示的数据
+    VibrationHistory history;               // 本轮全部数据的多分辨率最小/最大值, 用于回看
+    QVector<double> plotKeys;               // 绘图键值缓冲(复用)
+    QVector<double> plotValues;             // 绘图数据缓冲(复用)
     QMutex dataMutex;                       // 数据互斥锁
     
     // 绘图性能优化
     int plotUpdateInterval = 100;           // 绘图更新间隔(ms)
     bool needPlotUpdate = false;            // 是否需要更新绘图
+    bool plotFollowLive = true;             // 横轴跟随最新数据; 拖动/缩放后停在回看位置, 双击恢复
+    bool updatingPlotRange = false;         // 程序设置横轴范围时忽略rangeChanged
+    double plotWindowSec = 1.0;             // 跟随时显示的时长(秒)
     
     // 新增: 安全关闭工作线程
     void safelyShutdownWorker();
+
+    // 安全关闭记录线程
+    void safelyShutdownRecorder();
+
+    // 安全关闭分析线程
+    void safelyShutdownAnalyzer();
+
+    // 采集环形缓冲区消费
+    std::shared_ptr<DAQRingBuffer> daqRing; // 采集数据环形缓冲区
+    int plotConsumer = -1;                  // 绘图消费者ID
+    DAQBlockPtr plotBlock;                  // 绘图读取的块句柄
+    quint64 lastPlotOverruns = 0;           // 上次报告的绘图溢出块数
+    int daqSampleRate = 5000;               // 采样频率, 绘图窗口保持1秒数据
+    DAQState daqState = DAQState::Disconnected; // 采集卡当前状态
+
+    void drainPlotBlocks();                 // 读取绘图数据
+    void handlePlotRangeChanged(int index, const QCPRange &range);  // 用户拖动/缩放横轴
+
 };
 
 #endif // VK701PAGE_H
\ No newline at end of file
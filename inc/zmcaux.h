@@ -2994,6 +2994,17 @@ Return:         //错误码
 *************************************************************/
 int32  ZAux_Direct_GetAllAxisInfo(ZMC_HANDLE handle,int imaxaxis,int * IdleStatus,float * DposStatus,float * MposStatus,int * AxisStatus);
 
+/*************************************************************
+Description:    //批量读取多个轴参数, 多个 (参数名, 轴号) 合并为一条命令, 一次往返
+Input:          //卡链接handle
+				sParams  参数名数组, 如 "MPOS"
+				piAxis   轴号数组
+				inum     读取个数, 超过单条命令容量时自动分成多条
+Output:         //pfValue 读取值, 与输入顺序一致
+Return:         //错误码
+*************************************************************/
+int32  ZAux_Direct_GetParamBatch(ZMC_HANDLE handle, const char * const *sParams, const int *piAxis, int inum, float *pfValue);
+
 /*************************************************************
 Description:    //设置BASIC自定义全局数组
 Input:          //卡链接handle
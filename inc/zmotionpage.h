@@ -469,6 +469,15 @@ protected:
     void run() override;
 
 private:
+    // 合并发送命令批, 失败时逐条补发未执行的命令
+    bool executeWithFallback(const MotionCommandBatch &batch, const char *what);
+    // 等待轴类型回读为期望值
+    bool waitForAtype(int axis, int atype);
+    // 读取钻进下降监控所需的进给位置与旋转速度
+    bool readDescentState(float &position, float &speed);
+    // 停止旋转与冲击输出并取消进给运动, 命令逐条发送
+    void stopDrillMotors();
+
     std::atomic<bool> m_stopFlag;
     QMutex m_mutex;
     QWaitCondition m_waitCondition;
@@ -15,7 +15,7 @@ int main(int argc, char *argv[])
     
     // 创建应用程序实例
     QApplication a(argc, argv);
-    
+
 #ifdef ENABLE_DEBUG_TEST_MOTION
     // 创建调试测试对象
     DebugTestMotion debugTest;
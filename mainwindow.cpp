@@ -4,6 +4,8 @@
 #include <QDebug>
 #include <QTimer>
 #include "inc/vk701nsd.h"
+#include "inc/sensoraligner.h"
+#include "inc/motionstate.h"
 
 const QColor color[4] = {Qt::darkRed, Qt::darkGreen, Qt::darkBlue, Qt::darkYellow};
 
@@ -15,6 +17,21 @@ MainWindow::MainWindow(QWidget *parent)
 {
     ui->setupUi(this);
 
+    // 多传感器时间对齐, 须在各采集页面之前创建; 在独立线程中按帧周期生成对齐帧
+    sensorAlignerThread = new QThread(this);
+    g_sensorAligner = new SensorAligner();
+    g_sensorAligner->moveToThread(sensorAlignerThread);
+    connect(sensorAlignerThread, &QThread::started, g_sensorAligner, &SensorAligner::start);
+    connect(sensorAlignerThread, &QThread::finished, g_sensorAligner, &QObject::deleteLater);
+    sensorAlignerThread->start();
+
+    // 统一的电机状态轮询, 须在使用 MotionController 的页面之前创建
+    motionStateThread = new QThread(this);
+    g_motionState = new MotionStateService();
+    g_motionState->moveToThread(motionStateThread);
+    connect(motionStateThread, &QThread::started, g_motionState, &MotionStateService::start);
+    connect(motionStateThread, &QThread::finished, g_motionState, &QObject::deleteLater);
+    motionStateThread->start();
 
     // Instantiate motorpage
     this->ppagemotor = new motorpage;
@@ -39,6 +56,8 @@ MainWindow::MainWindow(QWidget *parent)
     connect(ui->btn_mdbtcp, &QPushButton::clicked, [=](){
         mdbtcp->setVisible(!mdbtcp->isVisible());
     });
+    // 振动特征与 Modbus 采样写入同一数据库, 按 TimeUs 对齐
+    connect(ppagevk701, &vk701page::vibFeaturesReady, mdbtcp, &MdbTCP::recordVibFeatures);
 
 
 
@@ -75,6 +94,12 @@ MainWindow::MainWindow(QWidget *parent)
 
 MainWindow::~MainWindow()
 {
+    motionStateThread->quit();
+    motionStateThread->wait();
+    g_motionState = nullptr;
+    g_sensorAligner = nullptr;
+    sensorAlignerThread->quit();
+    sensorAlignerThread->wait();
     delete ui;
 }
 
@@ -40,6 +40,8 @@ private slots:
 private:
     Ui::MainWindow *ui;
     QThread *workerThread;
+    QThread *motionStateThread;        // 电机状态轮询线程
+    QThread *sensorAlignerThread;      // 多传感器对齐线程
     vk701nsd *worker;
     QCustomPlot *qcustomplot[4];
     QTimer *debugtimer;
@@ -296,16 +296,16 @@ void DebugTestMotion::printMechanismStatus(int motorId) const
         return;
     }
     
-    const QMap<QString, float>& params = m_motorStatus[motorId];
+    const AxisState& state = m_motorStatus[motorId];
     
     // 获取电机名称
     QString name = m_controller->getMotionController()->getMotorName(motorId);
     
     // 获取电机参数
-    double position = params.value("Pos", 0.0);
-    double velocity = params.value("Vel", 0.0);
-    int mode = params.value("Atype", 0);
-    bool enabled = params.value("EN", 0) > 0;
+    double position = state.dpos;
+    double velocity = state.speed;
+    int mode = state.atype;
+    bool enabled = state.enabled > 0;
     
     QString modeStr;
     switch (mode) {
@@ -719,6 +719,10 @@ bool DebugTestMotion::transitionToState(const QString& targetState)
             std::string input;
             std::getline(std::cin, input);
             
+            // 转换表不允许直接回到就绪时经系统重置
+            if (!stateMachine->canTransition(stateMachine->getCurrentStateId(), AutoDrillingStateMachine::READY)) {
+                stateMachine->changeState(AutoDrillingStateMachine::STATE_SYSTEM_RESET);
+            }
             if (stateMachine->changeState(AutoDrillingStateMachine::STATE_READY)) {
                 waitForOperation(2000);
                 return stateMachine->changeState(targetState);
@@ -820,10 +824,10 @@ void DebugTestMotion::onPipeCountChanged(int count)
 }
 
 // 电机状态更新处理函数
-void DebugTestMotion::onMotorStatusUpdated(int motorID, const QMap<QString, float>& params)
+void DebugTestMotion::onMotorStatusUpdated(int motorID, const AxisState& state)
 {
     // 更新电机状态
-    m_motorStatus[motorID] = params;
+    m_motorStatus[motorID] = state;
 }
 
 // 命令响应处理函数
@@ -13,6 +13,7 @@ DrillingController::DrillingController(QObject *parent)
     , m_motionController(nullptr)
     , m_workerThread(nullptr)
     , m_worker(nullptr)
+    , m_executor(nullptr)
     , m_running(false)
     , m_paused(false)
     , m_stopRequested(false)
@@ -43,9 +44,14 @@ DrillingController::DrillingController(QObject *parent)
     m_worker = new StateMachineWorker(m_stateMachine);
     m_worker->moveToThread(m_workerThread);
     
-    // 连接线程信号
-    connect(m_workerThread, &QThread::started, m_worker, &StateMachineWorker::run);
-    connect(&m_updateTimer, &QTimer::timeout, m_worker, &StateMachineWorker::run);
+    // 控制执行线程: 每个控制周期直接调用工作对象的 run, 不经过事件循环
+    m_executor = new ControlExecutor(this);
+    m_executor->periodUs = DrillingParameters::ControlLoop::PERIOD_US;
+    m_executor->realtime = DrillingParameters::ControlLoop::REALTIME;
+    StateMachineWorker* worker = m_worker;
+    m_executor->setCycleTask([worker]() {
+        worker->run();
+    });
     
     // 连接工作对象的信号
     connect(this, &DrillingController::startWorker, m_worker, &StateMachineWorker::startWork);
@@ -70,6 +76,11 @@ DrillingController::~DrillingController()
     // 释放资源
     release();
     
+    // 先停止控制执行线程, 再删除其访问的对象
+    if (m_executor) {
+        m_executor->stop();
+    }
+    
     // 删除状态机和控制器
     if (m_stateMachine) {
         delete m_stateMachine;
@@ -123,8 +134,8 @@ bool DrillingController::initialize(const QString& ipAddress, bool debugMode)
     if (!debugMode) {
         for (int i = 0; i <= 9; i++) {
             m_motionController->registerMotionCallback(i, 
-                [this](int motorID, const QMap<QString, float>& params) {
-                    onMotorStatusUpdated(motorID, params);
+                [this](int motorID, const AxisState& state) {
+                    onMotorStatusUpdated(motorID, state);
                 });
         }
     }
@@ -169,6 +180,15 @@ MotionController* DrillingController::getMotionController() const
     return m_motionController;
 }
 
+/**
+ * @brief 获取控制执行线程
+ * @return 控制执行线程指针
+ */
+ControlExecutor* DrillingController::getControlExecutor() const
+{
+    return m_executor;
+}
+
 /**
  * @brief 启动状态机
  * @return 是否成功
@@ -187,8 +207,8 @@ bool DrillingController::startStateMachine()
     m_paused = false;
     m_stopRequested = false;
     
-    // 启动定时器以定期调用工作对象的run方法
-    m_updateTimer.start(100);
+    // 启动控制执行线程以定期调用工作对象的run方法
+    m_executor->start();
     
     // 发送启动信号给工作对象
     emit startWorker();
@@ -214,8 +234,8 @@ bool DrillingController::stopStateMachine()
     m_stopRequested = true;
     m_running = false;
     
-    // 停止定时器
-    m_updateTimer.stop();
+    // 停止控制执行线程 (等待当前周期结束)
+    m_executor->stop();
     
     // 发送停止信号给工作对象
     emit stopWorker();
@@ -280,21 +300,7 @@ AutoDrillingStateMachine::MainState DrillingController::getCurrentState() const
         return AutoDrillingStateMachine::SYSTEM_STARTUP;
     }
     
-    QString stateName = m_stateMachine->getCurrentStateName();
-    
-    // 将状态名称转换为枚举值
-    if (stateName == "SYSTEM_STARTUP") return AutoDrillingStateMachine::SYSTEM_STARTUP;
-    if (stateName == "DEFAULT_POSITION") return AutoDrillingStateMachine::DEFAULT_POSITION;
-    if (stateName == "READY") return AutoDrillingStateMachine::READY;
-    if (stateName == "FIRST_TOOL_INSTALLATION") return AutoDrillingStateMachine::FIRST_TOOL_INSTALLATION;
-    if (stateName == "FIRST_DRILLING") return AutoDrillingStateMachine::FIRST_DRILLING;
-    if (stateName == "PIPE_INSTALLATION_LOOP") return AutoDrillingStateMachine::PIPE_INSTALLATION_LOOP;
-    if (stateName == "PIPE_REMOVAL_LOOP") return AutoDrillingStateMachine::PIPE_REMOVAL_LOOP;
-    if (stateName == "FIRST_TOOL_RECOVERY") return AutoDrillingStateMachine::FIRST_TOOL_RECOVERY;
-    if (stateName == "SYSTEM_RESET") return AutoDrillingStateMachine::SYSTEM_RESET;
-    if (stateName == "OPERATION_COMPLETE") return AutoDrillingStateMachine::OPERATION_COMPLETE;
-    
-    return AutoDrillingStateMachine::SYSTEM_STARTUP;
+    return m_stateMachine->getCurrentMainState();
 }
 
 /**
@@ -306,6 +312,27 @@ bool DrillingController::isRunning() const
     return m_running;
 }
 
+/**
+ * @brief 获取最新的多传感器对齐帧
+ * @return 对齐帧, 对齐器未创建时所有通道均无效
+ */
+SensorFrame DrillingController::getSensorFrame() const
+{
+    if (!g_sensorAligner) {
+        return SensorFrame();
+    }
+    return g_sensorAligner->latestFrame();
+}
+
+/**
+ * @brief 获取 Modbus 传感器各通道的最新值
+ * @return 最近一个轮询周期发布的快照, 尚无数据时 validMask 为 0
+ */
+MdbCalibratedFrame DrillingController::getLiveSensors() const
+{
+    return g_liveSensors.load();
+}
+
 /**
  * @brief 内部启动状态机
  */
@@ -372,11 +399,11 @@ void DrillingController::onCommandResponse(const QString& response)
 /**
  * @brief 电机状态更新处理
  * @param motorID 电机ID
- * @param params 参数
+ * @param state 电机状态
  */
-void DrillingController::onMotorStatusUpdated(int motorID, const QMap<QString, float>& params)
+void DrillingController::onMotorStatusUpdated(int motorID, const AxisState& state)
 {
-    emit motorStatusUpdated(motorID, params);
+    emit motorStatusUpdated(motorID, state);
 }
 
 /**
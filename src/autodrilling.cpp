@@ -4,6 +4,8 @@
 #include "motioncontroller.h"
 #include <QDebug>
 #include <QThread>
+#include <limits>
+#include <cmath>
 
 // 定义静态常量
 const QString AutoDrillingStateMachine::STATE_SYSTEM_STARTUP = "SYSTEM_STARTUP";
@@ -36,6 +38,12 @@ const int ConnectionMechanismStateMachine::CONNECTION_MOTOR_ID = 8;   // 对接
 AutoDrillingStateMachine::AutoDrillingStateMachine(QObject *parent)
     : StateMachine(parent)
     , m_motionController(nullptr)
+    , m_storageUnitPtr(nullptr)
+    , m_robotArmPtr(nullptr)
+    , m_drillingMechanismPtr(nullptr)
+    , m_penetrationMechanismPtr(nullptr)
+    , m_clampMechanismPtr(nullptr)
+    , m_connectionMechanismPtr(nullptr)
     , m_pipeCount(0)
     , m_percussionEnabled(false)
     , m_percussionFrequency(0.0)
@@ -51,16 +59,32 @@ AutoDrillingStateMachine::AutoDrillingStateMachine(QObject *parent)
     , m_omega(60.0)  // 正常钻进旋转速度
     , m_omega_s(10.0) // 低速对接/断开旋转速度
 {
-    // 创建组件状态机
-    m_storageUnit = std::make_shared<StorageUnitStateMachine>();
-    m_robotArm = std::make_shared<RobotArmStateMachine>();
-    m_drillingMechanism = std::make_shared<DrillingMechanismStateMachine>();
-    m_penetrationMechanism = std::make_shared<PenetrationMechanismStateMachine>();
-    m_clampMechanism = std::make_shared<ClampMechanismStateMachine>();
-    m_connectionMechanism = std::make_shared<ConnectionMechanismStateMachine>();
-    
-    // 创建主状态
+    // 创建组件状态机, 同时缓存具体类型的指针
+    auto storageUnit = std::make_shared<StorageUnitStateMachine>();
+    auto robotArm = std::make_shared<RobotArmStateMachine>();
+    auto drillingMechanism = std::make_shared<DrillingMechanismStateMachine>();
+    auto penetrationMechanism = std::make_shared<PenetrationMechanismStateMachine>();
+    auto clampMechanism = std::make_shared<ClampMechanismStateMachine>();
+    auto connectionMechanism = std::make_shared<ConnectionMechanismStateMachine>();
+    m_storageUnitPtr = storageUnit.get();
+    m_robotArmPtr = robotArm.get();
+    m_drillingMechanismPtr = drillingMechanism.get();
+    m_penetrationMechanismPtr = penetrationMechanism.get();
+    m_clampMechanismPtr = clampMechanism.get();
+    m_connectionMechanismPtr = connectionMechanism.get();
+    m_storageUnit = storageUnit;
+    m_robotArm = robotArm;
+    m_drillingMechanism = drillingMechanism;
+    m_penetrationMechanism = penetrationMechanism;
+    m_clampMechanism = clampMechanism;
+    m_connectionMechanism = connectionMechanism;
+    
+    // 创建主状态与转换表, 并检查一次
     createMainStates();
+    createTransitions();
+    if (!validateStateTable()) {
+        logError("主状态表无效, 状态机将拒绝启动");
+    }
     
     logInfo("自动钻进状态机已创建");
 }
@@ -126,7 +150,7 @@ void AutoDrillingStateMachine::initialize() {
     m_drillParameter = 0.0;
     
     // 设置初始状态并启动状态机
-    setInitialState(STATE_SYSTEM_STARTUP);
+    setInitialState(SYSTEM_STARTUP);
     start();
     
     logInfo("自动钻进状态机初始化完成");
@@ -160,7 +184,7 @@ void AutoDrillingStateMachine::setDrillMode(DrillMode mode, double value) {
     m_drillParameter = value;
     
     // 应用模式到钻进机构
-    static_cast<DrillingMechanismStateMachine*>(m_drillingMechanism.get())->setDrillMode(static_cast<int>(mode), value);
+    m_drillingMechanismPtr->setDrillMode(static_cast<int>(mode), value);
     
     // 发送信号以更新GUI
     emit drillingModeChanged(mode, value);
@@ -177,9 +201,9 @@ void AutoDrillingStateMachine::enablePercussion(bool enable) {
     
     // 应用到钻进机构
     if (enable) {
-        static_cast<DrillingMechanismStateMachine*>(m_drillingMechanism.get())->setPercussionFrequency(m_percussionFrequency);
+        m_drillingMechanismPtr->setPercussionFrequency(m_percussionFrequency);
     } else {
-        static_cast<DrillingMechanismStateMachine*>(m_drillingMechanism.get())->setPercussionFrequency(0.0);
+        m_drillingMechanismPtr->setPercussionFrequency(0.0);
     }
     
     // 发送信号以更新GUI
@@ -197,7 +221,7 @@ void AutoDrillingStateMachine::setPercussionFrequency(double frequency) {
     
     // 如果冲击功能已启用，应用新频率
     if (m_percussionEnabled) {
-        static_cast<DrillingMechanismStateMachine*>(m_drillingMechanism.get())->setPercussionFrequency(frequency);
+        m_drillingMechanismPtr->setPercussionFrequency(frequency);
     }
     
     // 发送信号以更新GUI
@@ -212,8 +236,8 @@ void AutoDrillingStateMachine::setPercussionFrequency(double frequency) {
 void AutoDrillingStateMachine::startOperation() {
     if (!isRunning()) {
         // 确保状态机处于正确的初始状态
-        if (getCurrentStateName().isEmpty()) {
-            setInitialState(STATE_SYSTEM_STARTUP);
+        if (getCurrentStateId() == INVALID_STATE) {
+            setInitialState(SYSTEM_STARTUP);
         }
         start();
         logInfo("状态机已启动");
@@ -228,8 +252,8 @@ void AutoDrillingStateMachine::startOperation() {
 void AutoDrillingStateMachine::stopOperation() {
     if (isRunning()) {
         // 如果在PIPE_INSTALLATION_LOOP中，切换到PIPE_REMOVAL_LOOP
-        if (getCurrentStateName() == STATE_PIPE_INSTALLATION_LOOP) {
-            changeState(STATE_PIPE_REMOVAL_LOOP);
+        if (getCurrentStateId() == PIPE_INSTALLATION_LOOP) {
+            changeState(PIPE_REMOVAL_LOOP);
         } else {
             stop();
         }
@@ -268,14 +292,26 @@ int AutoDrillingStateMachine::getCurrentPipeCount() const {
     return m_pipeCount;
 }
 
+/**
+ * @brief 获取当前主状态
+ * @return 主状态, 未运行时为 SYSTEM_STARTUP
+ */
+AutoDrillingStateMachine::MainState AutoDrillingStateMachine::getCurrentMainState() const {
+    const StateId id = getCurrentStateId();
+    if (id < 0 || id >= MAIN_STATE_COUNT) {
+        return SYSTEM_STARTUP;
+    }
+    return static_cast<MainState>(id);
+}
+
 /**
  * @brief 状态切换前的处理
  * @param oldState 当前状态
  * @param newState 目标状态
  * @return true允许切换，false阻止切换
  */
-bool AutoDrillingStateMachine::beforeStateChange(const QString& oldState, const QString& newState) {
-    logInfo(QString("状态即将从 %1 切换到 %2").arg(oldState).arg(newState));
+bool AutoDrillingStateMachine::beforeStateChange(StateId oldState, StateId newState) {
+    logInfo(QString("状态即将从 %1 切换到 %2").arg(stateName(oldState)).arg(stateName(newState)));
     return true;
 }
 
@@ -284,9 +320,9 @@ bool AutoDrillingStateMachine::beforeStateChange(const QString& oldState, const
  * @param oldState 之前的状态
  * @param newState 当前状态
  */
-void AutoDrillingStateMachine::afterStateChange(const QString& oldState, const QString& newState) {
-    logInfo(QString("状态已从 %1 切换到 %2").arg(oldState).arg(newState));
-    emit currentStepChanged(QString("当前状态: %1").arg(newState));
+void AutoDrillingStateMachine::afterStateChange(StateId oldState, StateId newState) {
+    logInfo(QString("状态已从 %1 切换到 %2").arg(stateName(oldState)).arg(stateName(newState)));
+    emit currentStepChanged(QString("当前状态: %1").arg(stateName(newState)));
 }
 
 /**
@@ -294,25 +330,58 @@ void AutoDrillingStateMachine::afterStateChange(const QString& oldState, const Q
  */
 void AutoDrillingStateMachine::createMainStates() {
     // 创建所有状态
-    addState(STATE_SYSTEM_STARTUP, std::make_shared<SystemStartupState>(this));
-    addState(STATE_DEFAULT_POSITION, std::make_shared<DefaultPositionState>(this));
-    addState(STATE_READY, std::make_shared<ReadyState>(this));
-    addState(STATE_FIRST_TOOL_INSTALLATION, std::make_shared<FirstToolInstallationState>(this));
-    addState(STATE_FIRST_DRILLING, std::make_shared<FirstDrillingState>(this));
-    addState(STATE_PIPE_INSTALLATION_LOOP, std::make_shared<PipeInstallationLoopState>(this));
-    addState(STATE_PIPE_REMOVAL_LOOP, std::make_shared<PipeRemovalLoopState>(this));
-    addState(STATE_FIRST_TOOL_RECOVERY, std::make_shared<FirstToolRecoveryState>(this));
-    addState(STATE_SYSTEM_RESET, std::make_shared<SystemResetState>(this));
-    addState(STATE_OPERATION_COMPLETE, std::make_shared<OperationCompleteState>(this));
+    addState(SYSTEM_STARTUP, STATE_SYSTEM_STARTUP, std::make_shared<SystemStartupState>(this));
+    addState(DEFAULT_POSITION, STATE_DEFAULT_POSITION, std::make_shared<DefaultPositionState>(this));
+    addState(READY, STATE_READY, std::make_shared<ReadyState>(this));
+    addState(FIRST_TOOL_INSTALLATION, STATE_FIRST_TOOL_INSTALLATION, std::make_shared<FirstToolInstallationState>(this));
+    addState(FIRST_DRILLING, STATE_FIRST_DRILLING, std::make_shared<FirstDrillingState>(this));
+    addState(PIPE_INSTALLATION_LOOP, STATE_PIPE_INSTALLATION_LOOP, std::make_shared<PipeInstallationLoopState>(this));
+    addState(PIPE_REMOVAL_LOOP, STATE_PIPE_REMOVAL_LOOP, std::make_shared<PipeRemovalLoopState>(this));
+    addState(FIRST_TOOL_RECOVERY, STATE_FIRST_TOOL_RECOVERY, std::make_shared<FirstToolRecoveryState>(this));
+    addState(SYSTEM_RESET, STATE_SYSTEM_RESET, std::make_shared<SystemResetState>(this));
+    addState(OPERATION_COMPLETE, STATE_OPERATION_COMPLETE, std::make_shared<OperationCompleteState>(this));
     
     // 设置初始状态
-    setInitialState(STATE_SYSTEM_STARTUP);
+    setInitialState(SYSTEM_STARTUP);
     
     // 记录状态创建信息
     logInfo("所有状态已创建完成");
     logInfo(QString("初始状态设置为: %1").arg(STATE_SYSTEM_STARTUP));
 }
 
+/**
+ * @brief 建立主状态的转换表
+ *
+ * 正常流程依次经过各状态, 钻管安装循环可随时转入拆卸循环 (停止操作),
+ * 任意状态都可转入系统重置。
+ */
+void AutoDrillingStateMachine::createTransitions() {
+    addTransition(SYSTEM_STARTUP, DEFAULT_POSITION);
+    addTransition(DEFAULT_POSITION, READY);
+    // 开始作业前必须已连接运动控制器, 且钻杆已全部收回
+    addTransition(READY, FIRST_TOOL_INSTALLATION, [this]() {
+        return m_motionController != nullptr && m_pipeCount == 0;
+    });
+    addTransition(FIRST_TOOL_INSTALLATION, FIRST_DRILLING);
+    addTransition(FIRST_DRILLING, PIPE_INSTALLATION_LOOP);
+    addTransition(PIPE_INSTALLATION_LOOP, PIPE_REMOVAL_LOOP);
+    // 除首根钻具外的钻管全部拆卸后才能回收钻具
+    addTransition(PIPE_REMOVAL_LOOP, FIRST_TOOL_RECOVERY, [this]() {
+        return m_pipeCount == 0;
+    });
+    addTransition(FIRST_TOOL_RECOVERY, OPERATION_COMPLETE);
+    addTransition(OPERATION_COMPLETE, READY);
+    // 重置完成后回到默认位置/就绪, 或直接结束作业 (调试工具的测试序列经重置进入操作完成)
+    addTransition(SYSTEM_RESET, DEFAULT_POSITION);
+    addTransition(SYSTEM_RESET, READY);
+    addTransition(SYSTEM_RESET, OPERATION_COMPLETE);
+    for (int state = 0; state < MAIN_STATE_COUNT; state++) {
+        if (state != SYSTEM_RESET) {
+            addTransition(state, SYSTEM_RESET);
+        }
+    }
+}
+
 /**
  * @brief 增加钻管计数
  */
@@ -381,6 +450,77 @@ bool ComponentStateMachine::isDebugMode() const {
     return m_isDebugMode;
 }
 
+/**
+ * @brief 发出绝对运动, 不等待到位
+ *
+ * 组件的设定函数在控制执行线程的周期内调用, 不能阻塞等待运动完成;
+ * 目标位置保存在组件中, 由后续周期通过 isMoveDone() 对照统一轮询快照判断。
+ * @param motorID 电机ID
+ * @param position 目标位置
+ * @param timeoutMs 运动超时 (ms), 0 表示不限时
+ * @return 命令是否已被控制器接受
+ */
+bool ComponentStateMachine::startMove(int motorID, float position, int timeoutMs) {
+    const int timeout = timeoutMs > 0 ? timeoutMs : std::numeric_limits<int>::max() / 1000;
+    MoveRecord record;
+    record.target = position;
+    record.issuedVersion = motionStateVersion();
+    record.done = m_motionController->moveMotorAbsoluteAsync(motorID, position, timeout);
+    if (record.done.isFinished() && !record.done.result()) {
+        return false;
+    }
+    QMutexLocker locker(&m_moveMutex);
+    m_moves[motorID] = record;
+    return true;
+}
+
+/**
+ * @brief 电机最近一次运动是否已完成到位
+ *
+ * 依据命令发出之后的快照: 轴已停止且反馈位置在目标附近。统一轮询未运行时退回到完成令牌。
+ * @param motorID 电机ID
+ * @return 已到位, 或没有进行中的运动时为 true
+ */
+bool ComponentStateMachine::isMoveDone(int motorID) const {
+    if (m_isDebugMode) {
+        return true;
+    }
+    QMutexLocker locker(&m_moveMutex);
+    auto it = m_moves.constFind(motorID);
+    if (it == m_moves.constEnd()) {
+        return true;
+    }
+    if (!hasMotionState()) {
+        return it->done.isFinished() && it->done.result();
+    }
+    // 命令发出时可能已有一次读取在途, 至少等到其后的下一个周期
+    AxisState state;
+    if (!readAxisState(motorID, state, it->issuedVersion + 2)) {
+        return false;
+    }
+    return state.isIdle() && std::abs(state.mpos - it->target) <= MotionController::POSITION_TOLERANCE;
+}
+
+bool ComponentStateMachine::hasMotionState() {
+    return g_motionState && g_motionState->isRunning();
+}
+
+quint64 ComponentStateMachine::motionStateVersion() {
+    return g_motionState ? g_motionState->version() : 0;
+}
+
+bool ComponentStateMachine::readAxisState(int motorID, AxisState& state, quint64 minVersion) {
+    if (!hasMotionState()) {
+        return false;
+    }
+    const AxisStateArray snapshot = g_motionState->snapshot();
+    if (snapshot.version < minVersion || !snapshot.isValid(motorID)) {
+        return false;
+    }
+    state = snapshot.axis[motorID];
+    return true;
+}
+
 //================ StorageUnitStateMachine 实现 ================
 
 /**
@@ -462,14 +602,14 @@ bool StorageUnitStateMachine::rotateToPosition(int position) {
     // 计算角度 - 每个位置对应的角度为 (position/MAX_POSITIONS) * 360
     float angle = (float)position / MAX_POSITIONS * 360.0f;
     
-    // 使用运动控制器执行旋转
-    if (!m_motionController->moveMotorAbsolute(STORAGE_MOTOR_ID, angle)) {
+    // 发出旋转命令, 到位由 isMoveDone() 轮询
+    if (!startMove(STORAGE_MOTOR_ID, angle, DrillingParameters::StepTimeout::STORAGE_MS)) {
         logError(QString("旋转到位置 %1 失败").arg(position));
         return false;
     }
     
     m_currentPosition = position;
-    logInfo(QString("存储单元旋转到位置: %1").arg(position));
+    logInfo(QString("存储单元开始旋转到位置: %1").arg(position));
     return true;
 }
 
@@ -596,14 +736,14 @@ bool RobotArmStateMachine::setRotationPosition(int position) {
         DrillingParameters::RobotPosition::DRILL_POSITION : 
         DrillingParameters::RobotPosition::STORAGE_POSITION;
     
-    // 使用运动控制器执行旋转
-    if (!m_motionController->moveMotorAbsolute(ROTATION_MOTOR_ID, angle)) {
+    // 发出旋转命令, 到位由 isMoveDone() 轮询
+    if (!startMove(ROTATION_MOTOR_ID, angle, DrillingParameters::StepTimeout::ROBOT_ARM_MS)) {
         logError(QString("设置旋转位置 %1 失败").arg(position));
         return false;
     }
     
     m_rotationPosition = position;
-    logInfo(QString("机械手旋转位置设置为: %1").arg(position == 0 ? "对准钻进机构" : "对准存储单元"));
+    logInfo(QString("机械手开始旋转到: %1").arg(position == 0 ? "对准钻进机构" : "对准存储单元"));
     return true;
 }
 
@@ -638,14 +778,14 @@ bool RobotArmStateMachine::setExtension(int extension) {
     // 计算伸缩位置：0表示缩回，100表示伸出
     float position = extension * 100.0f;
     
-    // 使用运动控制器执行伸缩
-    if (!m_motionController->moveMotorAbsolute(EXTENSION_MOTOR_ID, position)) {
+    // 发出伸缩命令, 到位由 isMoveDone() 轮询
+    if (!startMove(EXTENSION_MOTOR_ID, position, DrillingParameters::StepTimeout::ROBOT_ARM_MS)) {
         logError(QString("设置伸缩状态 %1 失败").arg(extension));
         return false;
     }
     
     m_extension = extension;
-    logInfo(QString("机械手伸缩状态设置为: %1").arg(extension == 0 ? "缩回" : "伸出"));
+    logInfo(QString("机械手开始%1").arg(extension == 0 ? "缩回" : "伸出"));
     return true;
 }
 
@@ -680,14 +820,14 @@ bool RobotArmStateMachine::setClamp(int clamp) {
     // 计算夹持位置：0表示未夹持，50表示夹紧
     float position = clamp * 50.0f;
     
-    // 使用运动控制器执行夹持
-    if (!m_motionController->moveMotorAbsolute(CLAMP_MOTOR_ID, position)) {
+    // 发出夹持命令, 到位由 isMoveDone() 轮询
+    if (!startMove(CLAMP_MOTOR_ID, position, DrillingParameters::StepTimeout::ROBOT_ARM_MS)) {
         logError(QString("设置夹持状态 %1 失败").arg(clamp));
         return false;
     }
     
     m_clamp = clamp;
-    logInfo(QString("机械手夹持状态设置为: %1").arg(clamp == 0 ? "未夹持" : "夹紧"));
+    logInfo(QString("机械手开始%1").arg(clamp == 0 ? "松开" : "夹紧"));
     return true;
 }
 
@@ -727,6 +867,8 @@ DrillingMechanismStateMachine::DrillingMechanismStateMachine(QObject *parent)
     , m_connected(false)
     , m_drillMode(66)  // 默认恒速度模式
     , m_drillValue(0.0)
+    , m_rotationVersion(0)
+    , m_percussionVersion(0)
 {
     // 初始化钻进机构状态机
 }
@@ -806,6 +948,7 @@ bool DrillingMechanismStateMachine::setRotationSpeed(double speed) {
         return false;
     }
     
+    m_rotationVersion = motionStateVersion();
     if (m_drillMode == 66) {  // 恒速度模式
         if (!m_motionController->setMotorParameter(DRILL_MOTOR_ID, "Vel", speed)) {
             logError(QString("设置旋转速度 %1 失败").arg(speed));
@@ -845,6 +988,7 @@ bool DrillingMechanismStateMachine::setPercussionFrequency(double frequency) {
     }
     
     // 设置冲击电机频率
+    m_percussionVersion = motionStateVersion();
     if (frequency > 0) {
         // 启用冲击
         if (!m_motionController->setMotorParameter(PERCUSSION_MOTOR_ID, "Vel", frequency)) {
@@ -899,6 +1043,37 @@ bool DrillingMechanismStateMachine::getConnectionStatus() const {
     return m_connected;
 }
 
+/**
+ * @brief 快照中的钻进电机设定是否已生效
+ * @return 恒速度模式比较 SPEED, 恒力矩模式比较 DAC; 统一轮询未运行时以命令成功为准
+ */
+bool DrillingMechanismStateMachine::isRotationApplied() const {
+    if (isDebugMode() || !hasMotionState()) {
+        return true;
+    }
+    AxisState state;
+    if (!readAxisState(DRILL_MOTOR_ID, state, m_rotationVersion + 2)) {
+        return false;
+    }
+    const float actual = (m_drillMode == 67) ? state.dac : state.speed;
+    return std::abs(actual - float(m_rotationSpeed)) <= SETTING_TOLERANCE;
+}
+
+/**
+ * @brief 快照中的冲击电机速度是否已是设定频率
+ * @return 统一轮询未运行时以命令成功为准
+ */
+bool DrillingMechanismStateMachine::isPercussionApplied() const {
+    if (isDebugMode() || !hasMotionState()) {
+        return true;
+    }
+    AxisState state;
+    if (!readAxisState(PERCUSSION_MOTOR_ID, state, m_percussionVersion + 2)) {
+        return false;
+    }
+    return std::abs(state.speed - float(m_percussionFrequency)) <= SETTING_TOLERANCE;
+}
+
 /**
  * @brief 设置钻进模式
  * @param mode 模式 (66=恒速度, 67=恒力矩)
@@ -1062,9 +1237,11 @@ bool PenetrationMechanismStateMachine::moveToPosition(Position position) {
     // 设置电机速度
     m_motionController->setMotorParameter(PENETRATION_MOTOR_ID, "Vel", speed);
     
-    // 移动到目标位置
+    // 发出移动命令, 到位由 isMoveDone() 轮询; 钻进行程按钻进超时 (不限时)
     double targetPosition = m_positionValues[position];
-    if (!m_motionController->moveMotorAbsolute(PENETRATION_MOTOR_ID, targetPosition)) {
+    const int timeoutMs = (position == POSITION_A) ? DrillingParameters::StepTimeout::DRILLING_MS
+                                                   : DrillingParameters::StepTimeout::PENETRATION_MS;
+    if (!startMove(PENETRATION_MOTOR_ID, targetPosition, timeoutMs)) {
         logError(QString("移动到位置 %1 失败").arg(position));
         return false;
     }
@@ -1083,7 +1260,7 @@ bool PenetrationMechanismStateMachine::moveToPosition(Position position) {
         case POSITION_D: positionName = "D (最顶部)"; break;
     }
     
-    logInfo(QString("进给机构移动到位置: %1").arg(positionName));
+    logInfo(QString("进给机构开始移动到位置: %1").arg(positionName));
     return true;
 }
 
@@ -1253,8 +1430,8 @@ bool ClampMechanismStateMachine::setClampState(ClampState state) {
             return false;
     }
     
-    // 移动到目标位置
-    if (!m_motionController->moveMotorAbsolute(CLAMP_MOTOR_ID, position)) {
+    // 发出夹紧命令, 到位由 isMoveDone() 轮询
+    if (!startMove(CLAMP_MOTOR_ID, position, DrillingParameters::StepTimeout::CLAMP_MS)) {
         logError(QString("设置夹紧状态 %1 失败").arg(state));
         return false;
     }
@@ -1268,7 +1445,7 @@ bool ClampMechanismStateMachine::setClampState(ClampState state) {
         case TIGHT: stateName = "夹紧成功"; break;
     }
     
-    logInfo(QString("下夹紧机构状态设置为: %1").arg(stateName));
+    logInfo(QString("下夹紧机构开始切换到: %1").arg(stateName));
     return true;
 }
 
@@ -1356,14 +1533,14 @@ bool ConnectionMechanismStateMachine::setConnectionState(bool extended) {
     // 设置位置：0表示收回，100表示推出
     double position = extended ? 100.0 : 0.0;
     
-    // 移动到目标位置
-    if (!m_motionController->moveMotorAbsolute(CONNECTION_MOTOR_ID, position)) {
+    // 发出移动命令, 到位由 isMoveDone() 轮询
+    if (!startMove(CONNECTION_MOTOR_ID, position, DrillingParameters::StepTimeout::CONNECTION_MS)) {
         logError(QString("设置对接状态 %1 失败").arg(extended ? "推出" : "收回"));
         return false;
     }
     
     m_isExtended = extended;
-    logInfo(QString("对接机构状态设置为: %1").arg(extended ? "推出" : "收回"));
+    logInfo(QString("对接机构开始%1").arg(extended ? "推出" : "收回"));
     return true;
 }
 
@@ -0,0 +1,300 @@
+#include "inc/axistelemetry.h"
+#include "inc/Global.h"
+
+#include <QDebug>
+#include <QFile>
+#include <QTextStream>
+#include <cstring>
+
+AxisTelemetry *g_axisTelemetry = nullptr;
+
+AxisTelemetry::AxisTelemetry(QObject *parent) : QObject(parent), m_running(false), m_dropped(0)
+{
+    qRegisterMetaType<AxisTelemetrySample>("AxisTelemetrySample");
+    qRegisterMetaType<QVector<AxisTelemetrySample>>("QVector<AxisTelemetrySample>");
+}
+
+AxisTelemetry::~AxisTelemetry()
+{
+    stop();
+    // 随轮询线程退出释放时清空全局指针, 界面对象析构时不再访问已释放的对象
+    if (g_axisTelemetry == this) {
+        g_axisTelemetry = nullptr;
+    }
+}
+
+bool AxisTelemetry::start()
+{
+    if (isRunning()) {
+        return true;
+    }
+    if (!g_handle) {
+        qDebug() << "AxisTelemetry: controller not connected";
+        return false;
+    }
+
+    m_axes.clear();
+    for (int axis : axes) {
+        if (axis >= 0 && axis < SENSOR_MOTOR_AXES && !m_axes.contains(axis)) {
+            m_axes.append(axis);
+        }
+    }
+    if (m_axes.isEmpty()) {
+        for (int axis = 0; axis < SENSOR_MOTOR_AXES; axis++) {
+            m_axes.append(axis);
+        }
+    }
+    m_stride = 3 * m_axes.size();
+
+    // 采样任务号被占用时不启动, 避免打断主程序
+    QString status;
+    if (!execute(QString("?PROC_STATUS(%1)").arg(taskId), &status)) {
+        return false;
+    }
+    if (status.trimmed().toFloat() != 0) {
+        qDebug() << "AxisTelemetry: task" << taskId << "is busy, status" << status.trimmed();
+        return false;
+    }
+
+    // 环形缓冲行数取2的幂, 使写序号回绕时行号连续; 整个区域须在控制器 TABLE 范围内
+    const int tsize = tableSize();
+    const int capacity = tsize - (tableBase + HeaderSize);
+    int ring = 1;
+    while (ring * 2 <= qBound(2, ringSamples, int(SeqModulo)) && ring * 2 * m_stride <= capacity) {
+        ring *= 2;
+    }
+    if (ring < 2 || ring * m_stride > capacity) {
+        qDebug() << "AxisTelemetry: TABLE too small for base" << tableBase << ", size" << tsize;
+        return false;
+    }
+    if (ring != ringSamples) {
+        qDebug() << "AxisTelemetry: ring" << ringSamples << "->" << ring << "rows (TABLE size" << tsize << ")";
+    }
+    ringSamples = ring;
+
+    // 伺服周期 (us)
+    char response[64] = {0};
+    float servoUs = 1000;
+    if (ZAux_DirectCommand(g_handle, "?SERVO_PERIOD", response, sizeof(response)) == ERR_OK) {
+        ZAux_TransStringtoFloat(response, 1, &servoUs);
+    }
+    m_periodUs = qMax<qint64>(1, qRound64(servoUs)) * qMax(1, samplePeriodTicks);
+
+    // 头部: 行数, 采样周期, 轴数, 轴号表 (写序号由采样任务清零)
+    float header[HeaderSize - 1] = {0};
+    header[0] = ringSamples;
+    header[1] = qMax(1, samplePeriodTicks);
+    header[2] = m_axes.size();
+    for (int i = 0; i < m_axes.size(); i++) {
+        header[3 + i] = m_axes[i];
+    }
+    if (ZAux_Direct_SetTable(g_handle, tableBase + 1, HeaderSize - 1, header) != ERR_OK) {
+        qDebug() << "AxisTelemetry: cannot write TABLE header";
+        return false;
+    }
+    if (!execute(QString("RUN \"%1\", %2").arg(programFile).arg(taskId))) {
+        qDebug() << "AxisTelemetry:" << programFile << "must be part of the controller project, see bas/AXISTELEM.BAS"
+                 << "or exportProgram() for TABLE base" << tableBase;
+        return false;
+    }
+
+    m_lastSeq = -1;
+    m_buffer.resize(ringSamples * m_stride);
+    if (!m_drainTimer) {
+        m_drainTimer = new QTimer(this);
+        m_drainTimer->setTimerType(Qt::PreciseTimer);
+        connect(m_drainTimer, &QTimer::timeout, this, &AxisTelemetry::drain);
+    }
+    m_drainTimer->start(drainIntervalMs);
+    m_running.store(true, std::memory_order_release);
+    emit runningChanged(true);
+    qDebug() << "AxisTelemetry: started on task" << taskId << "," << m_axes.size() << "axes, period" << m_periodUs
+             << "us, ring" << ringSamples;
+    return true;
+}
+
+void AxisTelemetry::stop()
+{
+    if (!isRunning()) {
+        return;
+    }
+    m_drainTimer->stop();
+    if (g_handle) {
+        execute(QString("STOPTASK %1").arg(taskId));
+    }
+    m_running.store(false, std::memory_order_release);
+    emit runningChanged(false);
+    qDebug() << "AxisTelemetry: stopped, dropped" << droppedSamples() << "samples";
+}
+
+bool AxisTelemetry::execute(const QString &command, QString *response)
+{
+    char buffer[256] = {0};
+    const QByteArray cmd = command.toLatin1();
+    const int ret = ZAux_Execute(g_handle, cmd.constData(), buffer, sizeof(buffer));
+    if (ret != ERR_OK) {
+        qDebug() << "AxisTelemetry:" << command << "failed, ret =" << ret;
+        return false;
+    }
+    if (response) {
+        *response = QString::fromLatin1(buffer);
+    }
+    return true;
+}
+
+int AxisTelemetry::tableSize()
+{
+    struct_SysMaxSpecification spec;
+    std::memset(&spec, 0, sizeof(spec));
+    if (ZMC_GetSysSpecification(g_handle, &spec) != ERR_OK) {
+        return 0;
+    }
+    return int(spec.m_MaxTable);
+}
+
+QString AxisTelemetry::programSource(int base)
+{
+    QString s;
+    QTextStream out(&s);
+    // 注释只用 ASCII, 避免控制器工程编码不同导致乱码
+    out << "'AxisTelemetry sampling task. Add this file to the controller project and download it to FLASH;\n";
+    out << "'the host starts it with RUN \"AXISTELEM.BAS\", <taskId> and stops it with STOPTASK.\n";
+    out << "'TABLE(base) write sequence, base+1 rows, base+2 period ticks, base+3 axis count,\n";
+    out << "'base+4.. axis list, ring buffer from base+" << int(HeaderSize) << " (DRIVE_TORQUE, MSPEED, MPOS per axis)\n";
+    out << "DIM base, ring, period, naxis, stride, seq, row, i, ax\n";
+    out << "base = " << base << "\n";
+    out << "ring = TABLE(base + 1)\n";
+    out << "period = TABLE(base + 2)\n";
+    out << "naxis = TABLE(base + 3)\n";
+    out << "stride = naxis * 3\n";
+    out << "seq = 0\n";
+    out << "TABLE(base) = 0\n";
+    out << "TICKS = 0\n";
+    out << "WHILE 1\n";
+    out << "    WAIT UNTIL TICKS <= 0\n";
+    out << "    TICKS = TICKS + period\n";
+    out << "    row = base + " << int(HeaderSize) << " + (seq MOD ring) * stride\n";
+    out << "    FOR i = 0 TO naxis - 1\n";
+    out << "        ax = TABLE(base + 4 + i)\n";
+    out << "        TABLE(row + i * 3) = DRIVE_TORQUE(ax)\n";
+    out << "        TABLE(row + i * 3 + 1) = MSPEED(ax)\n";
+    out << "        TABLE(row + i * 3 + 2) = MPOS(ax)\n";
+    out << "    NEXT\n";
+    out << "    seq = (seq + 1) MOD " << int(SeqModulo) << "\n";
+    out << "    TABLE(base) = seq\n";
+    out << "WEND\n";
+    out << "END\n";
+    return s;
+}
+
+bool AxisTelemetry::exportProgram(const QString &path, int base)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qDebug() << "AxisTelemetry: cannot write" << path << file.errorString();
+        return false;
+    }
+    // BASIC 工程文件使用 CRLF 换行
+    const QByteArray text = programSource(base).replace("\n", "\r\n").toLatin1();
+    if (file.write(text) != text.size()) {
+        qDebug() << "AxisTelemetry: cannot write" << path << file.errorString();
+        return false;
+    }
+    qDebug() << "AxisTelemetry: sampling program for TABLE base" << base << "exported to" << path;
+    return true;
+}
+
+bool AxisTelemetry::readTable(int start, int count, float *out)
+{
+    char response[2048];
+    const int chunk = qMax(1, valuesPerCommand);
+    for (int done = 0; done < count; done += chunk) {
+        const int n = qMin(chunk, count - done);
+        const QByteArray cmd = QString("?*TABLE(%1,%2)").arg(start + done).arg(n).toLatin1();
+        if (ZAux_DirectCommand(g_handle, cmd.constData(), response, sizeof(response)) != ERR_OK) {
+            return false;
+        }
+        if (ZAux_TransStringtoFloat(response, n, out + done) != ERR_OK) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void AxisTelemetry::drain()
+{
+    if (!g_handle) {
+        return;
+    }
+
+    float head = 0;
+    const qint64 t0 = sensorClockUs();
+    if (ZAux_Direct_GetTable(g_handle, tableBase, 1, &head) != ERR_OK) {
+        return;
+    }
+    const qint64 headUs = (t0 + sensorClockUs()) / 2;
+    const int seq = int(head);
+
+    if (m_lastSeq < 0) {
+        m_lastSeq = seq;
+        return;
+    }
+    int n = (seq - m_lastSeq + SeqModulo) % SeqModulo;
+    if (n == 0) {
+        return;
+    }
+    // 读取期间控制器继续写入, 只读最新的 3/4 个缓冲, 更早的行视为已被覆盖
+    const int maxRows = ringSamples - ringSamples / 4;
+    if (n > maxRows) {
+        m_dropped.fetch_add(n - maxRows, std::memory_order_relaxed);
+        m_lastSeq = (seq - maxRows + SeqModulo) % SeqModulo;
+        n = maxRows;
+    }
+
+    // 至多两段连续的行
+    const int firstRow = m_lastSeq % ringSamples;
+    const int rows1 = qMin(n, ringSamples - firstRow);
+    const int rows2 = n - rows1;
+    if (!readTable(tableBase + HeaderSize + firstRow * m_stride, rows1 * m_stride, m_buffer.data())) {
+        return;
+    }
+    if (rows2 > 0 && !readTable(tableBase + HeaderSize, rows2 * m_stride, m_buffer.data() + rows1 * m_stride)) {
+        return;
+    }
+    m_lastSeq = seq;
+
+    // 最新一行约在读写序号时采样, 之前的行依次早一个采样周期
+    quint32 mask = 0;
+    for (int axis : m_axes) {
+        mask |= 1u << axis;
+    }
+    QVector<AxisTelemetrySample> samples(n);
+    for (int r = 0; r < n; r++) {
+        AxisTelemetrySample &s = samples[r];
+        const float *row = m_buffer.constData() + r * m_stride;
+        s.timeUs = headUs - qint64(n - 1 - r) * m_periodUs;
+        s.axisMask = mask;
+        for (int i = 0; i < m_axes.size(); i++) {
+            const int axis = m_axes[i];
+            s.torque[axis] = row[i * 3];
+            s.speed[axis] = row[i * 3 + 1];
+            s.position[axis] = row[i * 3 + 2];
+        }
+    }
+    publish(samples);
+}
+
+void AxisTelemetry::publish(const QVector<AxisTelemetrySample> &samples)
+{
+    if (g_sensorAligner) {
+        for (const AxisTelemetrySample &s : samples) {
+            for (int axis : m_axes) {
+                g_sensorAligner->push(SensorMotorTorque0 + axis, s.timeUs, s.torque[axis]);
+                g_sensorAligner->push(SensorMotorSpeed0 + axis, s.timeUs, s.speed[axis]);
+                g_sensorAligner->push(SensorMotorPosition0 + axis, s.timeUs, s.position[axis]);
+            }
+        }
+    }
+    m_latest.store(samples.last());
+    emit samplesReady(samples);
+}
@@ -0,0 +1,221 @@
+#include "inc/controlexecutor.h"
+#include "inc/sensorclock.h"
+
+#include <QDebug>
+#include <chrono>
+#include <thread>
+
+#if defined(Q_OS_LINUX)
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+#include <cerrno>
+#include <cstring>
+#elif defined(Q_OS_WIN)
+#include <windows.h>
+#include <mmsystem.h>
+#ifndef CREATE_WAITABLE_TIMER_HIGH_RESOLUTION
+#define CREATE_WAITABLE_TIMER_HIGH_RESOLUTION 0x00000002
+#endif
+#endif
+
+#if defined(Q_OS_WIN)
+/**
+ * @brief 每个线程一个高精度可等待定时器
+ *
+ * Windows 默认定时精度约 15.6 ms, 远大于控制周期。优先使用 CREATE_WAITABLE_TIMER_HIGH_RESOLUTION
+ * (Windows 10 1803 及以后); 系统不支持时退回 timeBeginPeriod(1), 在线程退出时 timeEndPeriod(1)。
+ */
+class WinPrecisionTimer
+{
+public:
+    WinPrecisionTimer()
+    {
+        m_timer = CreateWaitableTimerExW(nullptr, nullptr, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+        if (!m_timer) {
+            m_periodSet = timeBeginPeriod(1) == TIMERR_NOERROR;
+            m_timer = CreateWaitableTimerExW(nullptr, nullptr, 0, TIMER_ALL_ACCESS);
+        }
+    }
+    ~WinPrecisionTimer()
+    {
+        if (m_timer) {
+            CloseHandle(m_timer);
+        }
+        if (m_periodSet) {
+            timeEndPeriod(1);
+        }
+    }
+
+    // 睡眠 us 微秒, 定时器不可用时返回 false
+    bool sleepUs(qint64 us)
+    {
+        if (!m_timer) {
+            return false;
+        }
+        LARGE_INTEGER due;
+        due.QuadPart = -us * 10;            // 相对时间, 单位 100 ns
+        if (!SetWaitableTimer(m_timer, &due, 0, nullptr, nullptr, FALSE)) {
+            return false;
+        }
+        return WaitForSingleObject(m_timer, INFINITE) == WAIT_OBJECT_0;
+    }
+
+private:
+    HANDLE m_timer = nullptr;
+    bool m_periodSet = false;
+};
+#endif
+
+/* ===================================== ControlPacer ===================================== */
+
+ControlPacer::ControlPacer(qint64 periodUs) : m_periodUs(qMax<qint64>(1, periodUs))
+{
+    m_stats.periodUs = m_periodUs;
+}
+
+void ControlPacer::reset()
+{
+    m_deadlineUs = 0;
+    m_wakeUs = 0;
+    m_jitterSumUs = 0;
+    m_stats = ControlCycleStats();
+    m_stats.periodUs = m_periodUs;
+}
+
+qint64 ControlPacer::waitNext()
+{
+    qint64 now = sensorClockUs();
+    if (m_deadlineUs == 0) {
+        // 第一个周期不等待
+        m_deadlineUs = now;
+    } else {
+        // 上一周期的执行时间
+        m_stats.lastExecUs = now - m_wakeUs;
+        m_stats.maxExecUs = qMax(m_stats.maxExecUs, m_stats.lastExecUs);
+        m_deadlineUs += m_periodUs;
+        if (now > m_deadlineUs) {
+            m_stats.overruns++;
+            // 跳过已错过的截止时刻, 保持与原时间网格对齐
+            const qint64 missed = (now - m_deadlineUs) / m_periodUs + 1;
+            m_stats.skippedCycles += quint64(missed);
+            m_deadlineUs += missed * m_periodUs;
+        }
+        sleepUntilUs(m_deadlineUs);
+        now = sensorClockUs();
+    }
+
+    m_wakeUs = now;
+    const qint64 jitter = m_wakeUs - m_deadlineUs;
+    m_stats.cycles++;
+    m_stats.lastJitterUs = jitter;
+    m_stats.maxJitterUs = qMax(m_stats.maxJitterUs, jitter);
+    m_jitterSumUs += jitter;
+    m_stats.meanJitterUs = m_jitterSumUs / qint64(m_stats.cycles);
+    return jitter;
+}
+
+void ControlPacer::sleepUntilUs(qint64 deadlineUs)
+{
+#if defined(Q_OS_LINUX)
+    // steady_clock 与 CLOCK_MONOTONIC 同一时基, 用绝对时刻睡眠避免唤醒误差累积
+    struct timespec ts;
+    ts.tv_sec = time_t(deadlineUs / 1000000);
+    ts.tv_nsec = long(deadlineUs % 1000000) * 1000;
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr) == EINTR) {
+    }
+#elif defined(Q_OS_WIN)
+    static thread_local WinPrecisionTimer timer;
+    const qint64 remainUs = deadlineUs - sensorClockUs();
+    if (remainUs > 0 && !timer.sleepUs(remainUs)) {
+        std::this_thread::sleep_until(std::chrono::steady_clock::time_point(std::chrono::microseconds(deadlineUs)));
+    }
+#else
+    std::this_thread::sleep_until(std::chrono::steady_clock::time_point(std::chrono::microseconds(deadlineUs)));
+#endif
+}
+
+/* ===================================== ControlExecutor ===================================== */
+
+ControlExecutor::ControlExecutor(QObject *parent) : QThread(parent), m_stopFlag(false)
+{
+    qRegisterMetaType<ControlCycleStats>("ControlCycleStats");
+}
+
+ControlExecutor::~ControlExecutor()
+{
+    stop();
+}
+
+void ControlExecutor::setCycleTask(CycleTask task)
+{
+    if (isRunning()) {
+        qDebug() << "ControlExecutor: cannot change the cycle task while running";
+        return;
+    }
+    m_task = task;
+}
+
+void ControlExecutor::stop()
+{
+    m_stopFlag.store(true, std::memory_order_release);
+    wait();
+    m_stopFlag.store(false, std::memory_order_release);
+}
+
+bool ControlExecutor::applyRealtimePriority()
+{
+#if defined(Q_OS_LINUX)
+    struct sched_param param;
+    std::memset(&param, 0, sizeof(param));
+    param.sched_priority = qBound(sched_get_priority_min(SCHED_FIFO), realtimePriority, sched_get_priority_max(SCHED_FIFO));
+    const int ret = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+    if (ret != 0) {
+        qDebug() << "ControlExecutor: SCHED_FIFO unavailable:" << strerror(ret);
+        return false;
+    }
+    return true;
+#elif defined(Q_OS_WIN)
+    return SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_TIME_CRITICAL) != 0;
+#else
+    setPriority(QThread::TimeCriticalPriority);
+    return false;
+#endif
+}
+
+void ControlExecutor::run()
+{
+    const bool rt = realtime && applyRealtimePriority();
+    ControlPacer pacer(qBound(1000, periodUs, 10000));
+    const quint64 logEvery = quint64(qMax(1, overrunLogInterval));
+    quint64 reportedOverruns = 0;
+    qDebug() << "ControlExecutor: started, period" << pacer.periodUs() << "us" << (rt ? "(realtime)" : "");
+
+    while (!m_stopFlag.load(std::memory_order_acquire)) {
+        pacer.waitNext();
+        if (m_stopFlag.load(std::memory_order_acquire)) {
+            break;
+        }
+        if (m_task) {
+            m_task();
+        }
+
+        ControlCycleStats s = pacer.stats();
+        s.realtime = rt;
+        m_stats.store(s);
+
+        // 超时在下一次 waitNext() 时才能确认, 统计的是上一周期
+        if (s.overruns != reportedOverruns) {
+            if (reportedOverruns == 0 || reportedOverruns / logEvery != s.overruns / logEvery) {
+                qDebug() << "ControlExecutor: overrun, exec" << s.lastExecUs << "us, total" << s.overruns
+                         << "overruns," << s.skippedCycles << "cycles skipped";
+                emit overrunDetected(s);
+            }
+            reportedOverruns = s.overruns;
+        }
+    }
+
+    const ControlCycleStats s = pacer.stats();
+    qDebug() << "ControlExecutor: stopped after" << s.cycles << "cycles, jitter mean" << s.meanJitterUs
+             << "us max" << s.maxJitterUs << "us, overruns" << s.overruns;
+}
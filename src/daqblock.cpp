@@ -0,0 +1,72 @@
+#include "inc/daqblock.h"
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define DAQ_USE_SSE2 1
+#endif
+
+DAQSampleBlock::DAQSampleBlock(int maxPoints, int channels)
+    : m_maxPoints(qMax(1, maxPoints))
+    , m_channels(qMax(1, channels))
+    , m_interleaved(static_cast<size_t>(m_maxPoints) * m_channels)
+    , m_soa(static_cast<size_t>(m_maxPoints) * m_channels)
+{
+}
+
+void DAQSampleBlock::publish(int points, qint64 samplePos, quint64 seq, qint64 timeUs)
+{
+    m_points = qBound(0, points, m_maxPoints);
+    m_samplePos = samplePos;
+    m_seq = seq;
+    m_timeUs = timeUs;
+
+    double* dst[16];
+    const int channels = qMin(m_channels, 16);
+    for (int ch = 0; ch < channels; ++ch) {
+        dst[ch] = m_soa.data() + static_cast<size_t>(ch) * m_maxPoints;
+    }
+    daqDeinterleave(m_interleaved.data(), m_points, channels, dst);
+}
+
+// 4通道拆分: 每次处理两个采样点, 用 unpacklo/unpackhi 完成2x2转置
+static void deinterleave4(const double* src, int points, double* const* dst)
+{
+    double* ch0 = dst[0];
+    double* ch1 = dst[1];
+    double* ch2 = dst[2];
+    double* ch3 = dst[3];
+    int i = 0;
+#ifdef DAQ_USE_SSE2
+    for (; i + 1 < points; i += 2) {
+        const double* p = src + 4 * i;
+        __m128d a01 = _mm_loadu_pd(p);         // [CH1_i,   CH2_i]
+        __m128d a23 = _mm_loadu_pd(p + 2);     // [CH3_i,   CH4_i]
+        __m128d b01 = _mm_loadu_pd(p + 4);     // [CH1_i+1, CH2_i+1]
+        __m128d b23 = _mm_loadu_pd(p + 6);     // [CH3_i+1, CH4_i+1]
+        _mm_storeu_pd(ch0 + i, _mm_unpacklo_pd(a01, b01));
+        _mm_storeu_pd(ch1 + i, _mm_unpackhi_pd(a01, b01));
+        _mm_storeu_pd(ch2 + i, _mm_unpacklo_pd(a23, b23));
+        _mm_storeu_pd(ch3 + i, _mm_unpackhi_pd(a23, b23));
+    }
+#endif
+    for (; i < points; ++i) {
+        const double* p = src + 4 * i;
+        ch0[i] = p[0];
+        ch1[i] = p[1];
+        ch2[i] = p[2];
+        ch3[i] = p[3];
+    }
+}
+
+void daqDeinterleave(const double* src, int points, int channels, double* const* dst)
+{
+    if (channels == 4) {
+        deinterleave4(src, points, dst);
+        return;
+    }
+    for (int i = 0; i < points; ++i) {
+        for (int ch = 0; ch < channels; ++ch) {
+            dst[ch][i] = src[i * channels + ch];
+        }
+    }
+}
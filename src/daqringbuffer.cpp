@@ -0,0 +1,177 @@
+#include "inc/daqringbuffer.h"
+
+#include <QDebug>
+
+DAQRingBuffer::DAQRingBuffer(int slotCount, int maxPoints, int channels)
+    : m_slotCount(qMax(2, slotCount))
+    , m_maxPoints(qMax(1, maxPoints))
+    , m_channels(qMax(1, channels))
+    , m_slots(new Slot[m_slotCount])
+{
+    for (int i = 0; i < m_slotCount; ++i) {
+        m_slots[i].block = std::make_shared<DAQSampleBlock>(m_maxPoints, m_channels);
+    }
+    for (int i = 0; i < SpareBlocks; ++i) {
+        m_spares[i] = std::make_shared<DAQSampleBlock>(m_maxPoints, m_channels);
+    }
+    m_scratch.reset(new DAQSampleBlock(m_maxPoints, m_channels));
+}
+
+DAQRingBuffer::~DAQRingBuffer()
+{
+}
+
+// 获取当前可写槽; 先将槽标记为无效, 读者据此识别正在被覆盖的数据。
+// 若槽中的块仍被消费者持有, 与空闲的备用块交换, 保证已发布的块不被改写; 不分配内存。
+DAQSampleBlock* DAQRingBuffer::beginWrite()
+{
+    if (m_writing) {
+        return m_writing;
+    }
+    const quint64 w = m_writeSeq.load(std::memory_order_relaxed);
+    Slot& slot = m_slots[w % m_slotCount];
+    slot.seq.store(0, std::memory_order_seq_cst);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    std::shared_ptr<DAQSampleBlock> block = std::atomic_load(&slot.block);
+    m_discard = false;
+    if (block.use_count() > 2) {
+        // 除槽与本地变量外仍有持有者: 换用只被备用池持有的块, 被持有的块放回备用池
+        int spare = 0;
+        while (spare < SpareBlocks && m_spares[spare].use_count() > 1) {
+            ++spare;
+        }
+        if (spare == SpareBlocks) {
+            m_discard = true;
+            m_dropped.fetch_add(1, std::memory_order_relaxed);
+            m_writing = m_scratch.get();
+            return m_writing;
+        }
+        std::swap(block, m_spares[spare]);
+        std::atomic_store(&slot.block, block);
+        m_replaced.fetch_add(1, std::memory_order_relaxed);
+    }
+    m_writing = block.get();
+    return m_writing;
+}
+
+// 拆分通道并发布当前槽, 推进写位置
+DAQBlockPtr DAQRingBuffer::commit(int points, qint64 samplePos, qint64 timeUs)
+{
+    const quint64 w = m_writeSeq.load(std::memory_order_relaxed);
+    Slot& slot = m_slots[w % m_slotCount];
+    beginWrite();
+    m_writing->publish(points, samplePos, w, timeUs);
+    m_writing = nullptr;
+    if (m_discard) {
+        // 槽保持无效, 写位置照常推进, 消费者读到该序号时计为溢出
+        m_discard = false;
+        m_writeSeq.store(w + 1, std::memory_order_release);
+        return DAQBlockPtr();
+    }
+    slot.seq.store(w + 1, std::memory_order_release);
+    m_writeSeq.store(w + 1, std::memory_order_release);
+    return std::atomic_load(&slot.block);
+}
+
+quint64 DAQRingBuffer::writtenBlocks() const
+{
+    return m_writeSeq.load(std::memory_order_acquire);
+}
+
+quint64 DAQRingBuffer::replacedBlocks() const
+{
+    return m_replaced.load(std::memory_order_relaxed);
+}
+
+quint64 DAQRingBuffer::droppedBlocks() const
+{
+    return m_dropped.load(std::memory_order_relaxed);
+}
+
+int DAQRingBuffer::addConsumer(const QString& name)
+{
+    const int id = m_consumerCount.fetch_add(1);
+    if (id >= MaxConsumers) {
+        m_consumerCount.fetch_sub(1);
+        qDebug() << "环形缓冲区消费者数量已满, 无法注册" << name;
+        return -1;
+    }
+    m_consumers[id].name = name;
+    m_consumers[id].overruns.store(0, std::memory_order_relaxed);
+    m_consumers[id].cursor.store(m_writeSeq.load(std::memory_order_acquire), std::memory_order_release);
+    return id;
+}
+
+bool DAQRingBuffer::read(int consumerId, DAQBlockPtr& out)
+{
+    if (consumerId < 0 || consumerId >= m_consumerCount.load(std::memory_order_acquire)) {
+        return false;
+    }
+    Consumer& consumer = m_consumers[consumerId];
+
+    for (;;) {
+        quint64 cursor = consumer.cursor.load(std::memory_order_relaxed);
+        const quint64 w = m_writeSeq.load(std::memory_order_acquire);
+        if (cursor >= w) {
+            return false;
+        }
+
+        // 落后超过一圈: 跳到最旧的有效块 (槽 w % n 可能正被写入, 有效范围为 [w-n+1, w))
+        const quint64 oldest = w - (m_slotCount - 1);
+        if (w >= static_cast<quint64>(m_slotCount) && cursor < oldest) {
+            consumer.overruns.fetch_add(oldest - cursor, std::memory_order_relaxed);
+            cursor = oldest;
+        }
+
+        // 先持有块再校验序号: 生产者要么看到引用而换块, 要么已将序号置零而被此处识别
+        Slot& slot = m_slots[cursor % m_slotCount];
+        std::shared_ptr<DAQSampleBlock> block = std::atomic_load(&slot.block);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (slot.seq.load(std::memory_order_seq_cst) != cursor + 1) {
+            // 该槽已被生产者覆盖, 跳过
+            consumer.overruns.fetch_add(1, std::memory_order_relaxed);
+            consumer.cursor.store(cursor + 1, std::memory_order_relaxed);
+            continue;
+        }
+
+        out = std::move(block);
+        consumer.cursor.store(cursor + 1, std::memory_order_release);
+        return true;
+    }
+}
+
+quint64 DAQRingBuffer::available(int consumerId) const
+{
+    if (consumerId < 0 || consumerId >= m_consumerCount.load(std::memory_order_acquire)) {
+        return 0;
+    }
+    const quint64 w = m_writeSeq.load(std::memory_order_acquire);
+    const quint64 cursor = m_consumers[consumerId].cursor.load(std::memory_order_relaxed);
+    return cursor < w ? qMin<quint64>(w - cursor, m_slotCount - 1) : 0;
+}
+
+quint64 DAQRingBuffer::overruns(int consumerId) const
+{
+    if (consumerId < 0 || consumerId >= m_consumerCount.load(std::memory_order_acquire)) {
+        return 0;
+    }
+    return m_consumers[consumerId].overruns.load(std::memory_order_relaxed);
+}
+
+QString DAQRingBuffer::consumerName(int consumerId) const
+{
+    if (consumerId < 0 || consumerId >= m_consumerCount.load(std::memory_order_acquire)) {
+        return QString();
+    }
+    return m_consumers[consumerId].name;
+}
+
+void DAQRingBuffer::skipToLatest(int consumerId)
+{
+    if (consumerId < 0 || consumerId >= m_consumerCount.load(std::memory_order_acquire)) {
+        return;
+    }
+    m_consumers[consumerId].cursor.store(m_writeSeq.load(std::memory_order_acquire),
+                                         std::memory_order_release);
+}
@@ -1,16 +1,106 @@
 #include "drillingstate.h"
 #include "autodrilling.h"
+#include "DrillingParameters.h"
 #include <QDebug>
+#include <memory>
+
+typedef DrillingParameters::StepTimeout Timeout;
+
+/* 常用步骤: 动作、完成条件、占用机构与超时, 返回步骤声明以便继续设置前置步骤
+ * 动作只发出命令不等待; 完成条件在后续控制周期依据统一轮询的快照判断 (到位或设定值已生效),
+ * 不以最近一次指令值为准 */
+
+static StepSequencer::Step& armRotationStep(StepSequencer& seq, RobotArmStateMachine* arm, const QString& name, int position)
+{
+    return seq.addStep(name).uses(MECH_ROBOT_ARM).timeoutMs(Timeout::ROBOT_ARM_MS)
+        .action([arm, position] { return arm->setRotationPosition(position); })
+        .until([arm] { return arm->isMoveDone(RobotArmStateMachine::ROTATION_MOTOR_ID); });
+}
+
+static StepSequencer::Step& armExtensionStep(StepSequencer& seq, RobotArmStateMachine* arm, const QString& name, int extension)
+{
+    return seq.addStep(name).uses(MECH_ROBOT_ARM).timeoutMs(Timeout::ROBOT_ARM_MS)
+        .action([arm, extension] { return arm->setExtension(extension); })
+        .until([arm] { return arm->isMoveDone(RobotArmStateMachine::EXTENSION_MOTOR_ID); });
+}
+
+static StepSequencer::Step& armClampStep(StepSequencer& seq, RobotArmStateMachine* arm, const QString& name, int clamp)
+{
+    return seq.addStep(name).uses(MECH_ROBOT_ARM).timeoutMs(Timeout::ROBOT_ARM_MS)
+        .action([arm, clamp] { return arm->setClamp(clamp); })
+        .until([arm] { return arm->isMoveDone(RobotArmStateMachine::CLAMP_MOTOR_ID); });
+}
+
+// 目标位置在步骤开始时计算 (取决于当时的钻管计数)
+static StepSequencer::Step& storageStep(StepSequencer& seq, StorageUnitStateMachine* storage, const QString& name,
+                                        std::function<int()> position)
+{
+    return seq.addStep(name).uses(MECH_STORAGE).timeoutMs(Timeout::STORAGE_MS)
+        .action([storage, position] { return storage->rotateToPosition(position()); })
+        .until([storage] { return storage->isMoveDone(StorageUnitStateMachine::STORAGE_MOTOR_ID); });
+}
+
+static StepSequencer::Step& penetrationStep(StepSequencer& seq, PenetrationMechanismStateMachine* penetration,
+                                            const QString& name, PenetrationMechanismStateMachine::Position position,
+                                            int timeoutMs = Timeout::PENETRATION_MS)
+{
+    return seq.addStep(name).uses(MECH_PENETRATION).timeoutMs(timeoutMs)
+        .action([penetration, position] { return penetration->moveToPosition(position); })
+        .until([penetration] { return penetration->isMoveDone(PenetrationMechanismStateMachine::PENETRATION_MOTOR_ID); });
+}
+
+static StepSequencer::Step& spindleStep(StepSequencer& seq, DrillingMechanismStateMachine* drilling, const QString& name, double speed)
+{
+    return seq.addStep(name).uses(MECH_DRILLING).timeoutMs(Timeout::SPINDLE_MS)
+        .action([drilling, speed] { return drilling->setRotationSpeed(speed); })
+        .until([drilling] { return drilling->isRotationApplied(); });
+}
+
+// 同时设定转速与冲击频率
+static StepSequencer::Step& spindleStep(StepSequencer& seq, DrillingMechanismStateMachine* drilling, const QString& name,
+                                        double speed, double frequency)
+{
+    return seq.addStep(name).uses(MECH_DRILLING).timeoutMs(Timeout::SPINDLE_MS)
+        .action([drilling, speed, frequency] {
+            return drilling->setRotationSpeed(speed) && drilling->setPercussionFrequency(frequency);
+        })
+        .until([drilling] { return drilling->isRotationApplied() && drilling->isPercussionApplied(); });
+}
+
+static StepSequencer::Step& clampStep(StepSequencer& seq, ClampMechanismStateMachine* clamp, const QString& name,
+                                      ClampMechanismStateMachine::ClampState state)
+{
+    return seq.addStep(name).uses(MECH_CLAMP).timeoutMs(Timeout::CLAMP_MS)
+        .action([clamp, state] { return clamp->setClampState(state); })
+        .until([clamp] { return clamp->isMoveDone(ClampMechanismStateMachine::CLAMP_MOTOR_ID); });
+}
+
+static StepSequencer::Step& connectionStep(StepSequencer& seq, ConnectionMechanismStateMachine* connection,
+                                           const QString& name, bool extended)
+{
+    return seq.addStep(name).uses(MECH_CONNECTION).timeoutMs(Timeout::CONNECTION_MS)
+        .action([connection, extended] { return connection->setConnectionState(extended); })
+        .until([connection] { return connection->isMoveDone(ConnectionMechanismStateMachine::CONNECTION_MOTOR_ID); });
+}
 
 // DrillState 基类实现
 DrillState::DrillState(AutoDrillingStateMachine* machine)
     : State(static_cast<StateMachine*>(machine)), m_machine(machine)
 {
+    m_sequence.setStepCallback([machine](const QString& step) {
+        machine->emit currentStepChanged(step);
+    });
 }
 
 void DrillState::enter()
 {
     qDebug() << QString("进入状态");
+    
+    // 每次进入状态都从第一步开始
+    if (m_sequence.isEmpty()) {
+        buildSequence();
+    }
+    m_sequence.reset();
 }
 
 void DrillState::exit()
@@ -23,6 +113,30 @@ void DrillState::update()
     // 基类默认实现为空
 }
 
+void DrillState::pause()
+{
+    m_sequence.pause();
+}
+
+void DrillState::resume()
+{
+    m_sequence.resume();
+}
+
+StepSequencer::Result DrillState::runSequence()
+{
+    const StepSequencer::Result result = m_sequence.tick();
+    if (result == StepSequencer::Failed) {
+        const QString message = QString("步骤超时: %1").arg(m_sequence.failedStep());
+        qDebug() << "错误：" << message;
+        m_machine->emit currentStepChanged(message);
+        m_machine->emit operationError(message);
+        // 停在当前位置等待处理, 恢复后继续等待该步完成
+        m_machine->pauseOperation();
+    }
+    return result;
+}
+
 // SystemStartupState 实现
 SystemStartupState::SystemStartupState(AutoDrillingStateMachine* machine)
     : DrillState(machine)
@@ -89,146 +203,51 @@ void FirstToolInstallationState::enter()
     m_machine->emit currentStepChanged("首根钻具安装开始");
 }
 
-void FirstToolInstallationState::update()
+void FirstToolInstallationState::buildSequence()
 {
-    // 实现首根钻具安装流程
-    static int step = 0;
+    auto robotArm = m_machine->robotArm();
+    auto penetration = m_machine->penetrationMechanism();
+    auto drilling = m_machine->drillingMechanism();
+    auto connection = m_machine->connectionMechanism();
     
-    // 获取组件状态机
-    auto robotArm = dynamic_cast<RobotArmStateMachine*>(m_machine->getRobotArm().get());
-    auto penetration = dynamic_cast<PenetrationMechanismStateMachine*>(m_machine->getPenetrationMechanism().get());
-    auto drilling = dynamic_cast<DrillingMechanismStateMachine*>(m_machine->getDrillingMechanism().get());
-    auto connection = dynamic_cast<ConnectionMechanismStateMachine*>(m_machine->getConnectionMechanism().get());
+    m_sequence.setName("首根钻具安装");
     
-    if (!robotArm || !penetration || !drilling || !connection) {
-        qDebug() << "错误：无法获取组件状态机";
-        return;
-    }
+    // 1. 机械手移动到存储区, 同时进给机构移动到工作位置
+    const int toStorage = armRotationStep(m_sequence, robotArm, "机械手移动到存储区", 90).announce().index();
+    const int feedReady = penetrationStep(m_sequence, penetration, "进给机构移动到工作位置",
+                                          PenetrationMechanismStateMachine::POSITION_B1).parallel().index();
+    
+    // 2. 机械手夹持钻具 (只需机械手已到存储区)
+    armExtensionStep(m_sequence, robotArm, "机械手准备夹持钻具", 200).announce().after({toStorage});
+    armClampStep(m_sequence, robotArm, "机械手夹紧钻具", 100);
+    const int gripped = armExtensionStep(m_sequence, robotArm, "机械手已夹持钻具", 0).announce().index();
+    
+    // 3. 机械手移动到钻台 (须等进给机构到位)
+    armRotationStep(m_sequence, robotArm, "机械手移动到钻台", 0).announce().after({gripped, feedReady});
+    armExtensionStep(m_sequence, robotArm, "机械手对准钻台", 250);
+    
+    // 4. 进给机构移动
+    penetrationStep(m_sequence, penetration, "进给机构移动到钻具安装起始位置",
+                    PenetrationMechanismStateMachine::POSITION_A1).announce();
     
-    switch (step) {
-        case 0: // 1. 机械手移动到存储区 - 开始旋转
-            m_machine->emit currentStepChanged("机械手移动到存储区");
-            robotArm->setRotationPosition(90); // 旋转到存储区位置
-            step++;
-            break;
-            
-        case 1: // 1. 机械手移动到存储区 - 等待旋转完成并开始进给
-            if (robotArm->getRotationPosition() == 90) {
-                penetration->moveToPosition(PenetrationMechanismStateMachine::POSITION_B1); // 工作位置
-                step++;
-            }
-            break;
-            
-        case 2: // 1. 机械手移动到存储区 - 等待进给完成
-            if (penetration->getCurrentPosition() == PenetrationMechanismStateMachine::POSITION_B1) {
-                m_machine->emit currentStepChanged("机械手准备夹持钻具");
-                step++;
-            }
-            break;
-            
-        case 3: // 2. 机械手夹持钻具 - 开始伸出
-            robotArm->setExtension(200); // 伸出
-            step++;
-            break;
-            
-        case 4: // 2. 机械手夹持钻具 - 等待伸出完成并开始夹紧
-            if (robotArm->getExtension() == 200) {
-                robotArm->setClamp(100); // 完全夹紧
-                step++;
-            }
-            break;
-            
-        case 5: // 2. 机械手夹持钻具 - 等待夹紧完成并开始收回
-            if (robotArm->getClamp() == 100) {
-                robotArm->setExtension(0); // 回收
-                step++;
-            }
-            break;
-            
-        case 6: // 2. 机械手夹持钻具 - 等待收回完成
-            if (robotArm->getExtension() == 0) {
-                m_machine->emit currentStepChanged("机械手已夹持钻具");
-                step++;
-            }
-            break;
-            
-        case 7: // 3. 机械手移动到钻台
-            if (robotArm->getExtension() == 0) {
-                m_machine->emit currentStepChanged("机械手移动到钻台");
-                robotArm->setRotationPosition(0); // 旋转到钻台位置
-                step++;
-            }
-            break;
-            
-        case 8:
-            if (robotArm->getRotationPosition() == 0) {
-                robotArm->setExtension(250); // 对准钻台
-                step++;
-            }
-            break;
-            
-        case 9: // 4. 进给机构移动
-            if (robotArm->getExtension() == 250) {
-                m_machine->emit currentStepChanged("进给机构移动到钻具安装起始位置");
-                penetration->moveToPosition(PenetrationMechanismStateMachine::POSITION_A1); // 钻具安装起始位置
-                step++;
-            }
-            break;
-            
-        case 10: // 5. 执行连接操作
-            if (penetration->getCurrentPosition() == PenetrationMechanismStateMachine::POSITION_A1) {
-                m_machine->emit currentStepChanged("执行连接操作");
-                drilling->setRotationSpeed(60); // 低速对接旋转
-                step++;
-            }
-            break;
-            
-        case 11:
-            if (drilling->getRotationSpeed() == 60) {
-                penetration->moveToPosition(PenetrationMechanismStateMachine::POSITION_B1); // 对接速度缓慢下移
-                step++;
-            }
-            break;
-            
-        case 12:
-            if (penetration->getCurrentPosition() == PenetrationMechanismStateMachine::POSITION_B1) {
-                drilling->setRotationSpeed(0); // 停止旋转
-                step++;
-            }
-            break;
-            
-        case 13: // 6. 对接机构
-            if (drilling->getRotationSpeed() == 0) {
-                m_machine->emit currentStepChanged("对接机构伸出");
-                connection->setConnectionState(true); // 对接机构伸出
-                step++;
-            }
-            break;
-            
-        case 14: // 7. 机械手松开
-            if (connection->isExtended()) {
-                m_machine->emit currentStepChanged("机械手松开");
-                robotArm->setClamp(0); // 完全松开
-                step++;
-            }
-            break;
-            
-        case 15:
-            if (robotArm->getClamp() == 0) {
-                robotArm->setExtension(0); // 完全收回
-                step++;
-            }
-            break;
-            
-        case 16: // 完成首根钻具安装
-            if (robotArm->getExtension() == 0) {
-                m_machine->emit currentStepChanged("首根钻具安装完成");
-                // 重置步骤计数器，为下一次使用做准备
-                step = 0;
-                // 切换到下一个状态
-                m_machine->changeState(AutoDrillingStateMachine::STATE_FIRST_DRILLING);
-            }
-            break;
+    // 5. 执行连接操作
+    spindleStep(m_sequence, drilling, "执行连接操作", 60).announce();                 // 低速对接旋转
+    penetrationStep(m_sequence, penetration, "对接下移", PenetrationMechanismStateMachine::POSITION_B1);
+    spindleStep(m_sequence, drilling, "停止对接旋转", 0);
+    
+    // 6. 对接机构
+    connectionStep(m_sequence, connection, "对接机构伸出", true).announce();
+    
+    // 7. 机械手松开并收回
+    armClampStep(m_sequence, robotArm, "机械手松开", 0).announce();
+    armExtensionStep(m_sequence, robotArm, "机械手收回", 0);
+}
+
+void FirstToolInstallationState::update()
+{
+    if (runSequence() == StepSequencer::Finished) {
+        m_machine->emit currentStepChanged("首根钻具安装完成");
+        m_machine->changeState(AutoDrillingStateMachine::FIRST_DRILLING);
     }
 }
 
@@ -247,101 +266,46 @@ void FirstDrillingState::enter()
     m_machine->emit currentStepChanged("首次钻进开始");
 }
 
-void FirstDrillingState::update()
+void FirstDrillingState::buildSequence()
 {
-    // 实现首次钻进流程
-    static int step = 0;
+    auto drilling = m_machine->drillingMechanism();
+    auto penetration = m_machine->penetrationMechanism();
+    auto clamp = m_machine->clampMechanism();
+    auto connection = m_machine->connectionMechanism();
     
-    // 获取组件状态机
-    auto drilling = dynamic_cast<DrillingMechanismStateMachine*>(m_machine->getDrillingMechanism().get());
-    auto penetration = dynamic_cast<PenetrationMechanismStateMachine*>(m_machine->getPenetrationMechanism().get());
-    auto clamp = dynamic_cast<ClampMechanismStateMachine*>(m_machine->getClampMechanism().get());
-    auto connection = dynamic_cast<ConnectionMechanismStateMachine*>(m_machine->getConnectionMechanism().get());
+    m_sequence.setName("首次钻进");
     
-    if (!drilling || !penetration || !clamp || !connection) {
-        qDebug() << "错误：无法获取组件状态机";
-        return;
-    }
+    // 1. 启动钻进和冲击
+    spindleStep(m_sequence, drilling, "启动钻进和冲击", 120, 10).announce();
+    
+    // 2. 钻进到预定深度 (这里简化为等待到达目标位置)
+    penetrationStep(m_sequence, penetration, "开始进给", PenetrationMechanismStateMachine::POSITION_A,
+                    Timeout::DRILLING_MS).announce();
     
-    switch (step) {
-        case 0: // 1. 启动钻进和冲击
-            m_machine->emit currentStepChanged("启动钻进和冲击");
-            drilling->setRotationSpeed(120); // 工作转速
-            drilling->setPercussionFrequency(10); // 工作频率
-            step++;
-            break;
-            
-        case 1: // 等待钻进和冲击启动完成
-            if (drilling->getRotationSpeed() == 120 && drilling->getPercussionFrequency() == 10) {
-                m_machine->emit currentStepChanged("开始进给");
-                penetration->moveToPosition(PenetrationMechanismStateMachine::POSITION_A); // 钻进速度下降到工作位置
-                step++;
-            }
-            break;
-            
-        case 2: // 2. 监测钻进参数 (这里简化为等待到达目标位置)
-            if (penetration->getCurrentPosition() == PenetrationMechanismStateMachine::POSITION_A) {
-                m_machine->emit currentStepChanged("达到预定深度");
-                step++;
-            }
-            break;
-            
-        case 3: // 3. 达到预定深度后停止
-            drilling->setRotationSpeed(0); // 停止旋转
-            drilling->setPercussionFrequency(0); // 停止冲击
-            step++;
-            break;
-            
-        case 4: // 4. 下夹紧机构夹紧
-            if (drilling->getRotationSpeed() == 0 && drilling->getPercussionFrequency() == 0) {
-                m_machine->emit currentStepChanged("下夹紧机构夹紧");
-                clamp->setClampState(ClampMechanismStateMachine::TIGHT); // 完全夹紧
-                step++;
-            }
-            break;
-            
-        case 5: // 5. 对接机构回收
-            if (clamp->getClampState() == ClampMechanismStateMachine::TIGHT) {
-                m_machine->emit currentStepChanged("对接机构回收");
-                connection->setConnectionState(false); // 解锁钻具
-                step++;
-            }
-            break;
-            
-        case 6: // 6. 执行断开操作 - 同时启动旋转和进给
-            if (!connection->isExtended()) {
-                m_machine->emit currentStepChanged("执行断开操作");
-                drilling->setRotationSpeed(-60); // 低速反向旋转
-                penetration->moveToPosition(PenetrationMechanismStateMachine::POSITION_A1); // 对接速度缓慢上移
-                step++;
-            }
-            break;
-            
-        case 7: // 等待断开操作完成
-            if (penetration->getCurrentPosition() == PenetrationMechanismStateMachine::POSITION_A1 && 
-                drilling->getRotationSpeed() == -60) {
-                drilling->setRotationSpeed(0); // 停止旋转
-                step++;
-            }
-            break;
-            
-        case 8: // 7. 进给机构上升
-            if (drilling->getRotationSpeed() == 0) {
-                m_machine->emit currentStepChanged("进给机构上升");
-                penetration->moveToPosition(PenetrationMechanismStateMachine::POSITION_D); // 空行程速度上升
-                step++;
-            }
-            break;
-            
-        case 9: // 完成首次钻进
-            if (penetration->getCurrentPosition() == PenetrationMechanismStateMachine::POSITION_D) {
-                m_machine->emit currentStepChanged("首次钻进完成");
-                // 重置步骤计数器，为下一次使用做准备
-                step = 0;
-                // 切换到下一个状态
-                m_machine->changeState(AutoDrillingStateMachine::STATE_PIPE_INSTALLATION_LOOP);
-            }
-            break;
+    // 3. 达到预定深度后停止
+    spindleStep(m_sequence, drilling, "达到预定深度", 0, 0).announce();
+    
+    // 4. 下夹紧机构夹紧
+    clampStep(m_sequence, clamp, "下夹紧机构夹紧", ClampMechanismStateMachine::TIGHT).announce();
+    
+    // 5. 对接机构回收
+    connectionStep(m_sequence, connection, "对接机构回收", false).announce();
+    
+    // 6. 执行断开操作: 反向旋转与缓慢上移同时进行
+    const int unscrew = spindleStep(m_sequence, drilling, "执行断开操作", -60).announce().index();
+    const int lift = penetrationStep(m_sequence, penetration, "断开上移",
+                                     PenetrationMechanismStateMachine::POSITION_A1).parallel().index();
+    spindleStep(m_sequence, drilling, "停止断开旋转", 0).after({unscrew, lift});
+    
+    // 7. 进给机构上升
+    penetrationStep(m_sequence, penetration, "进给机构上升", PenetrationMechanismStateMachine::POSITION_D).announce();
+}
+
+void FirstDrillingState::update()
+{
+    if (runSequence() == StepSequencer::Finished) {
+        m_machine->emit currentStepChanged("首次钻进完成");
+        m_machine->changeState(AutoDrillingStateMachine::PIPE_INSTALLATION_LOOP);
     }
 }
 
@@ -360,241 +324,85 @@ void PipeInstallationLoopState::enter()
     m_machine->emit currentStepChanged("钻管安装循环开始");
 }
 
-void PipeInstallationLoopState::update()
+void PipeInstallationLoopState::buildSequence()
 {
-    // 实现钻管安装循环流程
-    static int step = 0;
+    auto machine = m_machine;
+    auto robotArm = m_machine->robotArm();
+    auto storageUnit = m_machine->storageUnit();
+    auto penetration = m_machine->penetrationMechanism();
+    auto drilling = m_machine->drillingMechanism();
+    auto clamp = m_machine->clampMechanism();
+    auto connection = m_machine->connectionMechanism();
+    
+    m_sequence.setName("钻管安装循环");
+    
+    // 1. 机械手取钻管: 存储机构旋转到钻管位置 (从位置1开始, 位置0存放钻具) 与机械手旋转同时进行
+    const int storageReady = storageStep(m_sequence, storageUnit, "存储机构旋转到钻管位置",
+                                         [machine] { return machine->getCurrentPipeCount() + 1; }).index();
+    const int toStorage = armRotationStep(m_sequence, robotArm, "机械手移动到存储区", 90).announce().parallel().index();
+    armExtensionStep(m_sequence, robotArm, "机械手伸出", 200).after({storageReady, toStorage});
+    armClampStep(m_sequence, robotArm, "机械手夹紧钻管", 100);
+    armExtensionStep(m_sequence, robotArm, "机械手缩回", 0);
+    armRotationStep(m_sequence, robotArm, "机械手旋转到钻台", 0);
+    armExtensionStep(m_sequence, robotArm, "机械手对准钻台", 200);
+    
+    // 2. 进给机构下降
+    penetrationStep(m_sequence, penetration, "进给机构下降到钻管安装高度",
+                    PenetrationMechanismStateMachine::POSITION_C2).announce();
+    
+    // 3. 执行连接操作
+    spindleStep(m_sequence, drilling, "执行连接操作", 60).announce();                 // 低速对接旋转
+    penetrationStep(m_sequence, penetration, "对接下移", PenetrationMechanismStateMachine::POSITION_B2);
+    spindleStep(m_sequence, drilling, "停止对接旋转", 0);
+    
+    // 4. 对接机构推出, 锁住钻管
+    connectionStep(m_sequence, connection, "对接机构推出", true).announce();
     
-    // 获取组件状态机
-    auto robotArm = dynamic_cast<RobotArmStateMachine*>(m_machine->getRobotArm().get());
-    auto storageUnit = dynamic_cast<StorageUnitStateMachine*>(m_machine->getStorageUnit().get());
-    auto penetration = dynamic_cast<PenetrationMechanismStateMachine*>(m_machine->getPenetrationMechanism().get());
-    auto drilling = dynamic_cast<DrillingMechanismStateMachine*>(m_machine->getDrillingMechanism().get());
-    auto clamp = dynamic_cast<ClampMechanismStateMachine*>(m_machine->getClampMechanism().get());
-    auto connection = dynamic_cast<ConnectionMechanismStateMachine*>(m_machine->getConnectionMechanism().get());
+    // 5. 机械手松开并收回
+    armClampStep(m_sequence, robotArm, "机械手松开并收回", 0).announce();
+    armExtensionStep(m_sequence, robotArm, "机械手收回", 0);
     
-    if (!robotArm || !storageUnit || !penetration || !drilling || !clamp || !connection) {
-        qDebug() << "错误：无法获取组件状态机";
+    // 6. 钻管之间的对接
+    spindleStep(m_sequence, drilling, "钻管之间的对接", 60).announce();
+    penetrationStep(m_sequence, penetration, "钻管对接下移", PenetrationMechanismStateMachine::POSITION_A1);
+    spindleStep(m_sequence, drilling, "停止钻管对接旋转", 0);
+    
+    // 7. 下夹紧机构松开
+    clampStep(m_sequence, clamp, "下夹紧机构松开", ClampMechanismStateMachine::OPEN).announce();
+    
+    // 8. 钻机钻进
+    spindleStep(m_sequence, drilling, "开始钻进", 120, 10).announce();
+    penetrationStep(m_sequence, penetration, "钻进到工作位置", PenetrationMechanismStateMachine::POSITION_A,
+                    Timeout::DRILLING_MS);
+    spindleStep(m_sequence, drilling, "停止钻进和冲击", 0, 0);
+    
+    // 9. 下夹紧机构夹紧
+    clampStep(m_sequence, clamp, "下夹紧机构夹紧", ClampMechanismStateMachine::TIGHT).announce();
+    
+    // 10. 执行断开操作
+    connectionStep(m_sequence, connection, "对接机构回收", false).announce();
+    spindleStep(m_sequence, drilling, "断开反向旋转", -60);
+    penetrationStep(m_sequence, penetration, "断开上移", PenetrationMechanismStateMachine::POSITION_A1);
+    spindleStep(m_sequence, drilling, "停止断开旋转", 0);
+    
+    // 11. 进给机构上升
+    penetrationStep(m_sequence, penetration, "进给机构上升", PenetrationMechanismStateMachine::POSITION_D).announce();
+}
+
+void PipeInstallationLoopState::update()
+{
+    if (runSequence() != StepSequencer::Finished) {
         return;
     }
+    m_machine->emit currentStepChanged("钻管安装循环完成");
+    m_machine->incrementPipeCount();
     
-    // 获取当前钻管计数
-    int pipeCount = m_machine->getCurrentPipeCount();
-    
-    switch (step) {
-        case 0: // 1. 机械手取钻管 - 旋转到存储区
-            // 计算当前要取的钻管位置：从位置1开始（位置0存放钻具）
-            if (!storageUnit->rotateToPosition(pipeCount + 1)) {
-                qDebug() << "错误：存储单元旋转失败";
-                return;
-            }
-            m_machine->emit currentStepChanged("机械手移动到存储区");
-            robotArm->setRotationPosition(90); // 旋转到存储区位置
-            step++;
-            break;
-            
-        case 1: // 机械手伸出
-            if (robotArm->getRotationPosition() == 90) {
-                robotArm->setExtension(200); // 伸出
-                step++;
-            }
-            break;
-            
-        case 2: // 机械手夹紧
-            if (robotArm->getExtension() == 200) {
-                robotArm->setClamp(100); // 完全夹紧
-                step++;
-            }
-            break;
-            
-        case 3: // 机械手缩回
-            if (robotArm->getClamp() == 100) {
-                robotArm->setExtension(0); // 缩回
-                step++;
-            }
-            break;
-            
-        case 4: // 机械手旋转到钻台
-            if (robotArm->getExtension() == 0) {
-                robotArm->setRotationPosition(0); // 旋转到钻台位置
-                step++;
-            }
-            break;
-            
-        case 5: // 机械手伸出
-            if (robotArm->getRotationPosition() == 0) {
-                robotArm->setExtension(200); // 伸出
-                step++;
-            }
-            break;
-            
-        case 6: // 2. 进给机构下降
-            if (robotArm->getExtension() == 200) {
-                m_machine->emit currentStepChanged("进给机构下降到钻管安装高度");
-                penetration->moveToPosition(PenetrationMechanismStateMachine::POSITION_C2); // 钻管安装高度
-                step++;
-            }
-            break;
-            
-        case 7: // 3. 执行连接操作
-            if (penetration->getCurrentPosition() == PenetrationMechanismStateMachine::POSITION_C2) {
-                m_machine->emit currentStepChanged("执行连接操作");
-                drilling->setRotationSpeed(60); // 低速对接旋转
-                step++;
-            }
-            break;
-            
-        case 8:
-            if (drilling->getRotationSpeed() == 60) {
-                penetration->moveToPosition(PenetrationMechanismStateMachine::POSITION_B2); // 对接速度缓慢下移
-                step++;
-            }
-            break;
-            
-        case 9:
-            if (penetration->getCurrentPosition() == PenetrationMechanismStateMachine::POSITION_B2) {
-                drilling->setRotationSpeed(0); // 停止旋转
-                step++;
-            }
-            break;
-            
-        case 10: // 4. 对接机构推出
-            if (drilling->getRotationSpeed() == 0) {
-                m_machine->emit currentStepChanged("对接机构推出");
-                connection->setConnectionState(true); // 锁住钻管
-                step++;
-            }
-            break;
-            
-        case 11: // 5. 机械手收回
-            if (connection->isExtended()) {
-                m_machine->emit currentStepChanged("机械手松开并收回");
-                robotArm->setClamp(0); // 松开
-                step++;
-            }
-            break;
-            
-        case 12:
-            if (robotArm->getClamp() == 0) {
-                robotArm->setExtension(0); // 收回
-                step++;
-            }
-            break;
-            
-        case 13: // 6. 钻管之间的对接
-            if (robotArm->getExtension() == 0) {
-                m_machine->emit currentStepChanged("钻管之间的对接");
-                drilling->setRotationSpeed(60); // 低速对接旋转
-                step++;
-            }
-            break;
-            
-        case 14:
-            if (drilling->getRotationSpeed() == 60) {
-                penetration->moveToPosition(PenetrationMechanismStateMachine::POSITION_A1); // 对接速度缓慢下降
-                step++;
-            }
-            break;
-            
-        case 15:
-            if (penetration->getCurrentPosition() == PenetrationMechanismStateMachine::POSITION_A1) {
-                drilling->setRotationSpeed(0); // 停止旋转
-                step++;
-            }
-            break;
-            
-        case 16: // 7. 下夹紧机构松开
-            if (drilling->getRotationSpeed() == 0) {
-                m_machine->emit currentStepChanged("下夹紧机构松开");
-                clamp->setClampState(ClampMechanismStateMachine::OPEN); // 松开
-                step++;
-            }
-            break;
-            
-        case 17: // 8. 钻机钻进
-            if (clamp->getClampState() == ClampMechanismStateMachine::OPEN) {
-                m_machine->emit currentStepChanged("开始钻进");
-                drilling->setRotationSpeed(120); // 工作转速
-                drilling->setPercussionFrequency(10); // 工作频率
-                step++;
-            }
-            break;
-            
-        case 18:
-            if (drilling->getRotationSpeed() == 120 && drilling->getPercussionFrequency() == 10) {
-                penetration->moveToPosition(PenetrationMechanismStateMachine::POSITION_A); // 钻进速度下降到工作位置
-                step++;
-            }
-            break;
-            
-        case 19:
-            if (penetration->getCurrentPosition() == PenetrationMechanismStateMachine::POSITION_A) {
-                drilling->setRotationSpeed(0); // 停止旋转
-                drilling->setPercussionFrequency(0); // 停止冲击
-                step++;
-            }
-            break;
-            
-        case 20: // 9. 下夹紧机构夹紧
-            if (drilling->getRotationSpeed() == 0) {
-                m_machine->emit currentStepChanged("下夹紧机构夹紧");
-                clamp->setClampState(ClampMechanismStateMachine::TIGHT); // 夹紧
-                step++;
-            }
-            break;
-            
-        case 21: // 10. 执行断开操作 - 对接机构回收
-            if (clamp->getClampState() == ClampMechanismStateMachine::TIGHT) {
-                m_machine->emit currentStepChanged("对接机构回收");
-                connection->setConnectionState(false); // 回收
-                step++;
-            }
-            break;
-            
-        case 22: // 钻进旋转反向
-            if (!connection->isExtended()) {
-                drilling->setRotationSpeed(-60); // 低速反向旋转
-                step++;
-            }
-            break;
-            
-        case 23: // 进给机构缓慢上移
-            if (drilling->getRotationSpeed() == -60) {
-                penetration->moveToPosition(PenetrationMechanismStateMachine::POSITION_A1); // 对接速度缓慢上移
-                step++;
-            }
-            break;
-            
-        case 24:
-            if (penetration->getCurrentPosition() == PenetrationMechanismStateMachine::POSITION_A1) {
-                drilling->setRotationSpeed(0); // 停止旋转
-                step++;
-            }
-            break;
-            
-        case 25: // 11. 进给机构上升
-            if (drilling->getRotationSpeed() == 0) {
-                m_machine->emit currentStepChanged("进给机构上升");
-                penetration->moveToPosition(PenetrationMechanismStateMachine::POSITION_D); // 空行程速度上升
-                step++;
-            }
-            break;
-            
-        case 26: // 完成钻管安装循环
-            if (penetration->getCurrentPosition() == PenetrationMechanismStateMachine::POSITION_D) {
-                m_machine->emit currentStepChanged("钻管安装循环完成");
-                
-                // 检查是否需要继续安装钻管或切换到拆卸模式
-                if (pipeCount < ACTIVE_PIPE_COUNT) { // 使用ACTIVE_PIPE_COUNT宏控制钻管数量
-                    // 重置步骤计数器，继续安装下一根钻管
-                    step = 0;
-                } else {
-                    // 重置步骤计数器，切换到钻管拆卸循环
-                    step = 0;
-                    m_machine->changeState(AutoDrillingStateMachine::STATE_PIPE_REMOVAL_LOOP);
-                }
-            }
-            break;
+    // 检查是否需要继续安装钻管或切换到拆卸模式
+    if (m_machine->getCurrentPipeCount() < ACTIVE_PIPE_COUNT) { // 使用ACTIVE_PIPE_COUNT宏控制钻管数量
+        // 继续安装下一根钻管
+        m_sequence.reset();
+    } else {
+        m_machine->changeState(AutoDrillingStateMachine::PIPE_REMOVAL_LOOP);
     }
 }
 
@@ -613,231 +421,89 @@ void PipeRemovalLoopState::enter()
     m_machine->emit currentStepChanged("钻管拆卸循环开始");
 }
 
-void PipeRemovalLoopState::update()
+void PipeRemovalLoopState::buildSequence()
 {
-    // 实现钻管拆卸循环流程
-    static int step = 0;
+    auto machine = m_machine;
+    auto robotArm = m_machine->robotArm();
+    auto storageUnit = m_machine->storageUnit();
+    auto penetration = m_machine->penetrationMechanism();
+    auto drilling = m_machine->drillingMechanism();
+    auto clamp = m_machine->clampMechanism();
+    auto connection = m_machine->connectionMechanism();
+    
+    m_sequence.setName("钻管拆卸循环");
+    
+    // 存储机构旋转到空位与钻台上的拆卸操作无关, 循环开始即执行
+    // 存储位置: 当前钻管数就是要存放的位置 (从1开始, 0号位置留给钻具)
+    const int storageReady = storageStep(m_sequence, storageUnit, "存储机构旋转到空位",
+                                         [machine] { return machine->getCurrentPipeCount(); }).announce().index();
+    
+    // 1. 进给机构下降, 执行连接操作
+    penetrationStep(m_sequence, penetration, "进给机构下降", PenetrationMechanismStateMachine::POSITION_A1)
+        .announce().parallel();
+    spindleStep(m_sequence, drilling, "执行连接操作", 60).announce();                 // 低速对接旋转
+    penetrationStep(m_sequence, penetration, "对接下移", PenetrationMechanismStateMachine::POSITION_A);
+    spindleStep(m_sequence, drilling, "停止对接旋转", 0);
+    connectionStep(m_sequence, connection, "对接机构推出", true).announce();
     
-    // 获取组件状态机
-    auto robotArm = dynamic_cast<RobotArmStateMachine*>(m_machine->getRobotArm().get());
-    auto storageUnit = dynamic_cast<StorageUnitStateMachine*>(m_machine->getStorageUnit().get());
-    auto penetration = dynamic_cast<PenetrationMechanismStateMachine*>(m_machine->getPenetrationMechanism().get());
-    auto drilling = dynamic_cast<DrillingMechanismStateMachine*>(m_machine->getDrillingMechanism().get());
-    auto clamp = dynamic_cast<ClampMechanismStateMachine*>(m_machine->getClampMechanism().get());
-    auto connection = dynamic_cast<ConnectionMechanismStateMachine*>(m_machine->getConnectionMechanism().get());
+    // 2. 下夹紧松开
+    clampStep(m_sequence, clamp, "下夹紧机构松开", ClampMechanismStateMachine::OPEN).announce();
     
-    if (!robotArm || !storageUnit || !penetration || !drilling || !clamp || !connection) {
-        qDebug() << "错误：无法获取组件状态机";
+    // 3. 进给机构上升
+    penetrationStep(m_sequence, penetration, "进给机构上升", PenetrationMechanismStateMachine::POSITION_B2).announce();
+    
+    // 4. 下夹紧机构夹紧
+    clampStep(m_sequence, clamp, "下夹紧机构夹紧", ClampMechanismStateMachine::TIGHT).announce();
+    
+    // 5. 断开钻管间连接
+    spindleStep(m_sequence, drilling, "断开钻管间连接", -60).announce();             // 低速反向旋转
+    penetrationStep(m_sequence, penetration, "断开上移", PenetrationMechanismStateMachine::POSITION_C2);
+    spindleStep(m_sequence, drilling, "停止断开旋转", 0);
+    
+    // 6. 机械手抓取钻管
+    armExtensionStep(m_sequence, robotArm, "机械手抓取钻管", 250).announce();
+    armClampStep(m_sequence, robotArm, "机械手夹紧钻管", 100);
+    
+    // 7. 对接机构回收, 解锁钻进机构的钻管
+    connectionStep(m_sequence, connection, "对接机构回收", false).announce();
+    
+    // 8. 断开钻管与钻进机构连接
+    spindleStep(m_sequence, drilling, "断开钻管与钻进机构连接", -60).announce();
+    penetrationStep(m_sequence, penetration, "脱开上移", PenetrationMechanismStateMachine::POSITION_D);
+    spindleStep(m_sequence, drilling, "停止脱开旋转", 0);
+    
+    // 9. 机械手回收: 缩回时存储机构可能仍在旋转, 旋转到存储区前须等存储机构到位
+    const int retracted = armExtensionStep(m_sequence, robotArm, "机械手回收钻管", 0).announce().index();
+    armRotationStep(m_sequence, robotArm, "机械手旋转到存储区", 90).after({retracted, storageReady});
+    armExtensionStep(m_sequence, robotArm, "机械手伸出", 250);
+    armClampStep(m_sequence, robotArm, "机械手松开钻管", 0);
+    armExtensionStep(m_sequence, robotArm, "机械手缩回", 0);
+    armRotationStep(m_sequence, robotArm, "机械手旋转回钻台", 0);
+    
+    // 10. 进给机构上升到待机位置
+    penetrationStep(m_sequence, penetration, "进给机构上升到待机位置",
+                    PenetrationMechanismStateMachine::POSITION_D).announce();
+}
+
+void PipeRemovalLoopState::update()
+{
+    // 没有已安装的钻管 (如首次钻进后即停止), 直接回收钻具
+    if (m_machine->getCurrentPipeCount() == 0) {
+        m_machine->changeState(AutoDrillingStateMachine::FIRST_TOOL_RECOVERY);
         return;
     }
+    if (runSequence() != StepSequencer::Finished) {
+        return;
+    }
+    m_machine->emit currentStepChanged("钻管拆卸循环完成");
+    m_machine->decrementPipeCount();
     
-    // 获取当前钻管计数
-    int pipeCount = m_machine->getCurrentPipeCount();
-    
-    switch (step) {
-        case 0: // 1. 进给机构下降
-            m_machine->emit currentStepChanged("进给机构下降");
-            penetration->moveToPosition(PenetrationMechanismStateMachine::POSITION_A1); // 空行程速度下降
-            step++;
-            break;
-            
-        case 1: // 执行连接操作
-            if (penetration->getCurrentPosition() == PenetrationMechanismStateMachine::POSITION_A1) {
-                m_machine->emit currentStepChanged("执行连接操作");
-                drilling->setRotationSpeed(60); // 低速对接旋转
-                step++;
-            }
-            break;
-            
-        case 2:
-            if (drilling->getRotationSpeed() == 60) {
-                penetration->moveToPosition(PenetrationMechanismStateMachine::POSITION_A); // 对接速度缓慢下移
-                step++;
-            }
-            break;
-            
-        case 3:
-            if (penetration->getCurrentPosition() == PenetrationMechanismStateMachine::POSITION_A) {
-                drilling->setRotationSpeed(0); // 停止旋转
-                step++;
-            }
-            break;
-            
-        case 4: // 对接机构推出
-            if (drilling->getRotationSpeed() == 0) {
-                m_machine->emit currentStepChanged("对接机构推出");
-                connection->setConnectionState(true); // 对接机构伸出
-                step++;
-            }
-            break;
-            
-        case 5: // 2. 下夹紧松开
-            if (connection->isExtended()) {
-                m_machine->emit currentStepChanged("下夹紧机构松开");
-                clamp->setClampState(ClampMechanismStateMachine::OPEN); // 松开
-                step++;
-            }
-            break;
-            
-        case 6: // 3. 进给机构上升
-            if (clamp->getClampState() == ClampMechanismStateMachine::OPEN) {
-                m_machine->emit currentStepChanged("进给机构上升");
-                penetration->moveToPosition(PenetrationMechanismStateMachine::POSITION_B2); // 空行程速度上升
-                step++;
-            }
-            break;
-            
-        case 7: // 4. 下夹紧机构夹紧
-            if (penetration->getCurrentPosition() == PenetrationMechanismStateMachine::POSITION_B2) {
-                m_machine->emit currentStepChanged("下夹紧机构夹紧");
-                clamp->setClampState(ClampMechanismStateMachine::TIGHT); // 夹紧
-                step++;
-            }
-            break;
-            
-        case 8: // 5. 断开钻管间连接
-            if (clamp->getClampState() == ClampMechanismStateMachine::TIGHT) {
-                m_machine->emit currentStepChanged("断开钻管间连接");
-                drilling->setRotationSpeed(-60); // 低速反向旋转
-                step++;
-            }
-            break;
-            
-        case 9:
-            if (drilling->getRotationSpeed() == -60) {
-                penetration->moveToPosition(PenetrationMechanismStateMachine::POSITION_C2); // 对接速度缓慢上移
-                step++;
-            }
-            break;
-            
-        case 10:
-            if (penetration->getCurrentPosition() == PenetrationMechanismStateMachine::POSITION_C2) {
-                drilling->setRotationSpeed(0); // 停止旋转
-                step++;
-            }
-            break;
-            
-        case 11: // 6. 机械手抓取钻管
-            if (drilling->getRotationSpeed() == 0) {
-                m_machine->emit currentStepChanged("机械手抓取钻管");
-                robotArm->setExtension(250); // 伸出
-                step++;
-            }
-            break;
-            
-        case 12:
-            if (robotArm->getExtension() == 250) {
-                robotArm->setClamp(100); // 完全夹紧
-                step++;
-            }
-            break;
-            
-        case 13: // 7. 对接机构回收
-            if (robotArm->getClamp() == 100) {
-                m_machine->emit currentStepChanged("对接机构回收");
-                connection->setConnectionState(false); // 解锁钻进机构的钻管
-                step++;
-            }
-            break;
-            
-        case 14: // 8. 断开钻管与钻进机构连接
-            if (!connection->isExtended()) {
-                m_machine->emit currentStepChanged("断开钻管与钻进机构连接");
-                drilling->setRotationSpeed(-60); // 低速反向旋转
-                step++;
-            }
-            break;
-            
-        case 15:
-            if (drilling->getRotationSpeed() == -60) {
-                penetration->moveToPosition(PenetrationMechanismStateMachine::POSITION_D); // 对接速度缓慢上移
-                step++;
-            }
-            break;
-            
-        case 16:
-            if (penetration->getCurrentPosition() == PenetrationMechanismStateMachine::POSITION_D) {
-                drilling->setRotationSpeed(0); // 停止旋转
-                step++;
-            }
-            break;
-            
-        case 17: // 9. 存储机构旋转到空位
-            if (drilling->getRotationSpeed() == 0) {
-                m_machine->emit currentStepChanged("存储机构旋转到空位");
-                // 计算存储位置：当前钻管数就是要存放的位置（从1开始，0号位置留给钻具）
-                int storagePosition = pipeCount;
-                storageUnit->rotateToPosition(storagePosition);
-                step++;
-            }
-            break;
-            
-        case 18: // 10. 机械手回收
-            if (storageUnit->getCurrentPosition() == StorageUnitStateMachine::MAX_POSITIONS - pipeCount) {
-                m_machine->emit currentStepChanged("机械手回收钻管");
-                robotArm->setExtension(0); // 缩回
-                step++;
-            }
-            break;
-            
-        case 19:
-            if (robotArm->getExtension() == 0) {
-                robotArm->setRotationPosition(90); // 旋转到存储区
-                step++;
-            }
-            break;
-            
-        case 20:
-            if (robotArm->getRotationPosition() == 90) {
-                robotArm->setExtension(250); // 伸出
-                step++;
-            }
-            break;
-            
-        case 21:
-            if (robotArm->getExtension() == 250) {
-                robotArm->setClamp(0); // 完全松开
-                step++;
-            }
-            break;
-            
-        case 22:
-            if (robotArm->getClamp() == 0) {
-                robotArm->setExtension(0); // 缩回
-                step++;
-            }
-            break;
-            
-        case 23:
-            if (robotArm->getExtension() == 0) {
-                robotArm->setRotationPosition(0); // 旋转回钻台
-                step++;
-            }
-            break;
-            
-        case 24: // 11. 进给机构上升
-            if (robotArm->getRotationPosition() == 0) {
-                m_machine->emit currentStepChanged("进给机构上升到待机位置");
-                penetration->moveToPosition(PenetrationMechanismStateMachine::POSITION_D); // 待机位置
-                step++;
-            }
-            break;
-            
-        case 25: // 完成钻管拆卸循环
-            if (penetration->getCurrentPosition() == PenetrationMechanismStateMachine::POSITION_D) {
-                m_machine->emit currentStepChanged("钻管拆卸循环完成");
-                
-                // 检查是否还有钻管需要拆卸
-                if (pipeCount > 1) { // 如果还有钻管（不包括首根钻具）
-                    // 重置步骤计数器，继续拆卸下一根钻管
-                    step = 0;
-                } else {
-                    // 重置步骤计数器，切换到首根钻具回收
-                    step = 0;
-                    m_machine->changeState(AutoDrillingStateMachine::STATE_FIRST_TOOL_RECOVERY);
-                }
-            }
-            break;
+    // 检查是否还有钻管需要拆卸 (不包括首根钻具)
+    if (m_machine->getCurrentPipeCount() > 0) {
+        // 继续拆卸下一根钻管
+        m_sequence.reset();
+    } else {
+        m_machine->changeState(AutoDrillingStateMachine::FIRST_TOOL_RECOVERY);
     }
 }
 
@@ -856,191 +522,65 @@ void FirstToolRecoveryState::enter()
     m_machine->emit currentStepChanged("首根钻具回收开始");
 }
 
-void FirstToolRecoveryState::update()
+void FirstToolRecoveryState::buildSequence()
 {
-    // 实现首根钻具回收流程
-    static int step = 0;
+    auto robotArm = m_machine->robotArm();
+    auto storageUnit = m_machine->storageUnit();
+    auto penetration = m_machine->penetrationMechanism();
+    auto drilling = m_machine->drillingMechanism();
+    auto clamp = m_machine->clampMechanism();
+    auto connection = m_machine->connectionMechanism();
     
-    // 获取组件状态机
-    auto robotArm = dynamic_cast<RobotArmStateMachine*>(m_machine->getRobotArm().get());
-    auto storageUnit = dynamic_cast<StorageUnitStateMachine*>(m_machine->getStorageUnit().get());
-    auto penetration = dynamic_cast<PenetrationMechanismStateMachine*>(m_machine->getPenetrationMechanism().get());
-    auto drilling = dynamic_cast<DrillingMechanismStateMachine*>(m_machine->getDrillingMechanism().get());
-    auto clamp = dynamic_cast<ClampMechanismStateMachine*>(m_machine->getClampMechanism().get());
-    auto connection = dynamic_cast<ConnectionMechanismStateMachine*>(m_machine->getConnectionMechanism().get());
+    m_sequence.setName("首根钻具回收");
     
-    if (!robotArm || !storageUnit || !penetration || !drilling || !clamp || !connection) {
-        qDebug() << "错误：无法获取组件状态机";
-        return;
-    }
+    // 首根钻具存放在0号位置, 存储机构循环开始即旋转
+    const int storageReady = storageStep(m_sequence, storageUnit, "存储机构旋转到空位",
+                                         [] { return 0; }).announce().index();
+    
+    // 1. 进给机构下降, 执行连接操作
+    penetrationStep(m_sequence, penetration, "进给机构下降", PenetrationMechanismStateMachine::POSITION_A1)
+        .announce().parallel();
+    spindleStep(m_sequence, drilling, "执行连接操作", 60).announce();                 // 低速对接旋转
+    penetrationStep(m_sequence, penetration, "对接下移", PenetrationMechanismStateMachine::POSITION_A);
+    spindleStep(m_sequence, drilling, "停止对接旋转", 0);
+    connectionStep(m_sequence, connection, "对接机构推出", true).announce();
+    
+    // 2. 下夹紧松开
+    clampStep(m_sequence, clamp, "下夹紧机构松开", ClampMechanismStateMachine::OPEN).announce();
+    
+    // 3. 进给机构上升
+    penetrationStep(m_sequence, penetration, "进给机构上升", PenetrationMechanismStateMachine::POSITION_C2).announce();
+    
+    // 4. 机械手抓取钻具
+    armExtensionStep(m_sequence, robotArm, "机械手抓取钻具", 250).announce();
+    armClampStep(m_sequence, robotArm, "机械手夹紧钻具", 100);
     
-    switch (step) {
-        case 0: // 1. 进给机构下降
-            m_machine->emit currentStepChanged("进给机构下降");
-            penetration->moveToPosition(PenetrationMechanismStateMachine::POSITION_A1); // 空行程速度下降
-            step++;
-            break;
-            
-        case 1: // 执行连接操作
-            if (penetration->getCurrentPosition() == PenetrationMechanismStateMachine::POSITION_A1) {
-                m_machine->emit currentStepChanged("执行连接操作");
-                drilling->setRotationSpeed(60); // 低速对接旋转
-                step++;
-            }
-            break;
-            
-        case 2:
-            if (drilling->getRotationSpeed() == 60) {
-                penetration->moveToPosition(PenetrationMechanismStateMachine::POSITION_A); // 对接速度缓慢下移
-                step++;
-            }
-            break;
-            
-        case 3:
-            if (penetration->getCurrentPosition() == PenetrationMechanismStateMachine::POSITION_A) {
-                drilling->setRotationSpeed(0); // 停止旋转
-                step++;
-            }
-            break;
-            
-        case 4: // 对接机构推出
-            if (drilling->getRotationSpeed() == 0) {
-                m_machine->emit currentStepChanged("对接机构推出");
-                connection->setConnectionState(true); // 对接机构伸出
-                step++;
-            }
-            break;
-            
-        case 5: // 2. 下夹紧松开
-            if (connection->isExtended()) {
-                m_machine->emit currentStepChanged("下夹紧机构松开");
-                clamp->setClampState(ClampMechanismStateMachine::OPEN); // 松开
-                step++;
-            }
-            break;
-            
-        case 6: // 3. 进给机构上升
-            if (clamp->getClampState() == ClampMechanismStateMachine::OPEN) {
-                m_machine->emit currentStepChanged("进给机构上升");
-                penetration->moveToPosition(PenetrationMechanismStateMachine::POSITION_C2); // 空行程速度上升
-                step++;
-            }
-            break;
-            
-        case 7: // 4. 机械手抓取钻管
-            if (penetration->getCurrentPosition() == PenetrationMechanismStateMachine::POSITION_C2) {
-                m_machine->emit currentStepChanged("机械手抓取钻具");
-                robotArm->setExtension(250); // 伸出
-                step++;
-            }
-            break;
-            
-        case 8:
-            if (robotArm->getExtension() == 250) {
-                robotArm->setClamp(100); // 完全夹紧
-                step++;
-            }
-            break;
-            
-        case 9: // 5. 对接机构回收
-            if (robotArm->getClamp() == 100) {
-                m_machine->emit currentStepChanged("对接机构回收");
-                connection->setConnectionState(false); // 解锁钻进机构的钻管
-                step++;
-            }
-            break;
-            
-        case 10: // 6. 断开钻管与钻进机构连接
-            if (!connection->isExtended()) {
-                m_machine->emit currentStepChanged("断开钻具与钻进机构连接");
-                drilling->setRotationSpeed(-60); // 低速反向旋转
-                step++;
-            }
-            break;
-            
-        case 11:
-            if (drilling->getRotationSpeed() == -60) {
-                penetration->moveToPosition(PenetrationMechanismStateMachine::POSITION_D); // 对接速度缓慢上移
-                step++;
-            }
-            break;
-            
-        case 12:
-            if (penetration->getCurrentPosition() == PenetrationMechanismStateMachine::POSITION_D) {
-                drilling->setRotationSpeed(0); // 停止旋转
-                step++;
-            }
-            break;
-            
-        case 13: // 7. 存储机构旋转到空位
-            if (drilling->getRotationSpeed() == 0) {
-                m_machine->emit currentStepChanged("存储机构旋转到空位");
-                // 首根钻具存放在0号位置
-                storageUnit->rotateToPosition(0);
-                step++;
-            }
-            break;
-            
-        case 14: // 8. 机械手回收
-            if (storageUnit->getCurrentPosition() == 0) {
-                m_machine->emit currentStepChanged("机械手回收钻具");
-                robotArm->setExtension(0); // 缩回
-                step++;
-            }
-            break;
-            
-        case 15:
-            if (robotArm->getExtension() == 0) {
-                robotArm->setRotationPosition(90); // 旋转到存储区
-                step++;
-            }
-            break;
-            
-        case 16:
-            if (robotArm->getRotationPosition() == 90) {
-                robotArm->setExtension(250); // 伸出
-                step++;
-            }
-            break;
-            
-        case 17:
-            if (robotArm->getExtension() == 250) {
-                robotArm->setClamp(0); // 完全松开
-                step++;
-            }
-            break;
-            
-        case 18:
-            if (robotArm->getClamp() == 0) {
-                robotArm->setExtension(0); // 缩回
-                step++;
-            }
-            break;
-            
-        case 19:
-            if (robotArm->getExtension() == 0) {
-                robotArm->setRotationPosition(0); // 旋转回钻台
-                step++;
-            }
-            break;
-            
-        case 20: // 9. 进给机构下降
-            if (robotArm->getRotationPosition() == 0) {
-                m_machine->emit currentStepChanged("进给机构下降到待机位置");
-                penetration->moveToPosition(PenetrationMechanismStateMachine::POSITION_A); // 待机位置
-                step++;
-            }
-            break;
-            
-        case 21: // 完成首根钻具回收
-            if (penetration->getCurrentPosition() == PenetrationMechanismStateMachine::POSITION_A) {
-                m_machine->emit currentStepChanged("首根钻具回收完成");
-                // 重置步骤计数器，为下一次使用做准备
-                step = 0;
-                // 切换到操作完成状态
-                m_machine->changeState(AutoDrillingStateMachine::STATE_OPERATION_COMPLETE);
-            }
-            break;
+    // 5. 对接机构回收, 解锁钻进机构的钻具
+    connectionStep(m_sequence, connection, "对接机构回收", false).announce();
+    
+    // 6. 断开钻具与钻进机构连接
+    spindleStep(m_sequence, drilling, "断开钻具与钻进机构连接", -60).announce();     // 低速反向旋转
+    penetrationStep(m_sequence, penetration, "脱开上移", PenetrationMechanismStateMachine::POSITION_D);
+    spindleStep(m_sequence, drilling, "停止脱开旋转", 0);
+    
+    // 7. 机械手回收: 缩回与存储机构旋转并行, 旋转到存储区前须等存储机构到位
+    const int retracted = armExtensionStep(m_sequence, robotArm, "机械手回收钻具", 0).announce().index();
+    armRotationStep(m_sequence, robotArm, "机械手旋转到存储区", 90).after({retracted, storageReady});
+    armExtensionStep(m_sequence, robotArm, "机械手伸出", 250);
+    armClampStep(m_sequence, robotArm, "机械手松开钻具", 0);
+    armExtensionStep(m_sequence, robotArm, "机械手缩回", 0);
+    armRotationStep(m_sequence, robotArm, "机械手旋转回钻台", 0);
+    
+    // 8. 进给机构下降到待机位置
+    penetrationStep(m_sequence, penetration, "进给机构下降到待机位置",
+                    PenetrationMechanismStateMachine::POSITION_A).announce();
+}
+
+void FirstToolRecoveryState::update()
+{
+    if (runSequence() == StepSequencer::Finished) {
+        m_machine->emit currentStepChanged("首根钻具回收完成");
+        m_machine->changeState(AutoDrillingStateMachine::OPERATION_COMPLETE);
     }
 }
 
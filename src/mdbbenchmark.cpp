@@ -0,0 +1,184 @@
+#include "inc/mdbbenchmark.h"
+#include "inc/mdbsimulator.h"
+#include "inc/mdbprocess.h"
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QThread>
+#include <QTimer>
+#include <functional>
+#include <iostream>
+
+// 处理事件直到条件满足或超时
+static bool waitUntil(const std::function<bool()> &done, int timeoutMs)
+{
+    QElapsedTimer timer;
+    timer.start();
+    while (!done()) {
+        if (timer.elapsed() > timeoutMs) {
+            return false;
+        }
+        QCoreApplication::processEvents(QEventLoop::AllEvents, 5);
+        QThread::usleep(500);
+    }
+    return true;
+}
+
+// 运行事件循环 ms 毫秒
+static void runEvents(int ms)
+{
+    QEventLoop loop;
+    QTimer::singleShot(ms, Qt::PreciseTimer, &loop, &QEventLoop::quit);
+    loop.exec();
+}
+
+MdbBenchmark::MdbBenchmark(QObject *parent) : QObject(parent)
+{
+}
+
+bool MdbBenchmark::run()
+{
+    QThread simThread;
+    MdbSimulator *simulator = new MdbSimulator();
+    simulator->latencyMs = latencyMs;
+    simulator->jitterMs = jitterMs;
+    simulator->moveToThread(&simThread);
+    connect(&simThread, &QThread::finished, simulator, &QObject::deleteLater);
+    simThread.start();
+
+    bool started = false;
+    QMetaObject::invokeMethod(simulator, [&]() {
+        started = simulator->start(address, port);
+    }, Qt::BlockingQueuedConnection);
+    if (!started) {
+        simThread.quit();
+        simThread.wait();
+        return false;
+    }
+
+    std::cout << "\n=== Modbus 采集链路压力测试 ===" << std::endl;
+    std::cout << "模拟器延迟 " << latencyMs << "ms ± " << jitterMs << "ms, 每个频率运行 "
+              << durationSec << "s" << std::endl;
+
+    m_results.clear();
+    for (int rate : ratesHz) {
+        const MdbBenchmarkResult r = runRate(rate);
+        m_results.append(r);
+        printResult(r);
+    }
+
+    QMetaObject::invokeMethod(simulator, [simulator]() {
+        simulator->stop();
+    }, Qt::BlockingQueuedConnection);
+    simThread.quit();
+    simThread.wait();
+    return true;
+}
+
+MdbBenchmarkResult MdbBenchmark::runRate(int rateHz)
+{
+    MdbBenchmarkResult r;
+    r.rateHz = rateHz;
+    r.intervalMs = qMax(1, 1000 / qMax(1, rateHz));
+
+    mdbprocess proc;
+    proc.Forcemdbport = 1;
+    proc.Torquemdbport = 2;
+    proc.Poitionmdbport = 3;
+    // 第四个网关再挂一路拉力, 使四个端口都有负载
+    MdbPollItem extra;
+    extra.mode = MdbSensorTraction;
+    extra.reg = 450;
+    extra.count = 4;
+    const int extraId = proc.pollScheduler->addItem(extra);
+
+    connect(&proc, &mdbprocess::frameDecoded, this, [&r](const MdbFrame &frame) {
+        r.frames++;
+        for (int ch = 0; ch < MdbChannelCount; ch++) {
+            if (frame.isValid(ch)) {
+                r.values[ch]++;
+            }
+        }
+    });
+
+    proc.TCPConnect(port, address);
+    const bool connected = waitUntil([&proc]() {
+        for (int i = 0; i < 4; i++) {
+            if (!proc.pollTransports[i]->isConnected()) {
+                return false;
+            }
+        }
+        return true;
+    }, 3000);
+    if (!connected) {
+        std::cout << "连接模拟器超时" << std::endl;
+        proc.TCPDisconnect();
+        return r;
+    }
+
+    QElapsedTimer elapsed;
+    elapsed.start();
+    proc.setReadtractionTimer(true, r.intervalMs);
+    proc.setReadtorqueTimer(true, r.intervalMs);
+    proc.setReadpositionTimer(true, r.intervalMs);
+    proc.pollScheduler->setItemEnabled(extraId, true, 3, r.intervalMs);
+    runEvents(int(durationSec * 1000));
+    proc.setReadtractionTimer(false, r.intervalMs);
+    proc.setReadtorqueTimer(false, r.intervalMs);
+    proc.setReadpositionTimer(false, r.intervalMs);
+    proc.pollScheduler->setItemEnabled(extraId, false, 3, r.intervalMs);
+    r.seconds = elapsed.elapsed() / 1000.0;
+
+    // 等待在途请求返回
+    waitUntil([&proc]() {
+        for (int i = 0; i < 4; i++) {
+            if (proc.pollTransports[i]->outstanding() > 0) {
+                return false;
+            }
+        }
+        return true;
+    }, 2000);
+
+    r.issuedRequests = proc.pollScheduler->issuedRequests();
+    r.droppedPolls = proc.pollScheduler->droppedPolls();
+    for (int i = 0; i < 4; i++) {
+        const MdbTransportStats s = proc.pollTransports[i]->stats();
+        r.transport.sent += s.sent;
+        r.transport.completed += s.completed;
+        r.transport.retries += s.retries;
+        r.transport.timeouts += s.timeouts;
+        r.transport.exceptions += s.exceptions;
+        r.transport.stale += s.stale;
+        for (int dev : proc.pollTransports[i]->devices()) {
+            r.rtt.merge(proc.pollTransports[i]->rttHistogram(dev));
+        }
+    }
+
+    proc.TCPDisconnect();
+    runEvents(100);
+    return r;
+}
+
+void MdbBenchmark::printResult(const MdbBenchmarkResult &r)
+{
+    const double s = qMax(r.seconds, 1e-3);
+    std::cout << qPrintable(QString("\n[%1 Hz] 周期 %2ms, 运行 %3s, 帧 %4 (%5/s)")
+                            .arg(r.rateHz).arg(r.intervalMs).arg(s, 0, 'f', 2)
+                            .arg(r.frames).arg(r.frames / s, 0, 'f', 1)) << std::endl;
+    std::cout << qPrintable(QString("  采样率: 上拉力 %1/s  下拉力 %2/s  扭矩 %3/s  位置 %4/s")
+                            .arg(r.values[MdbTractionTop] / s, 0, 'f', 1)
+                            .arg(r.values[MdbTractionDown] / s, 0, 'f', 1)
+                            .arg(r.values[MdbTorque] / s, 0, 'f', 1)
+                            .arg(r.values[MdbPosition] / s, 0, 'f', 1)) << std::endl;
+    std::cout << qPrintable(QString("  往返时间: p50<=%1ms p90<=%2ms p99<=%3ms max=%4ms avg=%5ms")
+                            .arg(r.rtt.percentileUs(0.5) / 1000.0, 0, 'f', 2)
+                            .arg(r.rtt.percentileUs(0.9) / 1000.0, 0, 'f', 2)
+                            .arg(r.rtt.percentileUs(0.99) / 1000.0, 0, 'f', 2)
+                            .arg(r.rtt.maxUs / 1000.0, 0, 'f', 2)
+                            .arg(r.rtt.total ? r.rtt.sumUs / 1000.0 / r.rtt.total : 0.0, 0, 'f', 2)) << std::endl;
+    std::cout << qPrintable(QString("  请求 %1, 丢弃轮询 %2, 重发 %3, 超时 %4, 异常 %5, 迟到 %6")
+                            .arg(r.issuedRequests).arg(r.droppedPolls).arg(r.transport.retries)
+                            .arg(r.transport.timeouts).arg(r.transport.exceptions)
+                            .arg(r.transport.stale)) << std::endl;
+}
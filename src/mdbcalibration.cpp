@@ -0,0 +1,83 @@
+#include "inc/mdbcalibration.h"
+
+MdbCalibrator::MdbCalibrator()
+{
+    channels[MdbTractionTop].scale = 0.00981;
+    channels[MdbTractionDown].scale = 0.00981;
+    channels[MdbTorque].scale = 0.01;
+    channels[MdbPosition].scale = 150.0 / 4096.0;
+    channels[MdbPosition].unwrap16 = true;
+}
+
+double MdbCalibrator::toEngineering(const MdbChannelCalibration &cal, qint32 raw) const
+{
+    double x = raw;
+    if (cal.unwrap16 && raw < 0) {
+        x = 2 * 32767 + raw;
+    }
+
+    const int n = cal.table.size();
+    if (n == 0) {
+        return x * cal.scale + cal.offset;
+    }
+    if (n == 1) {
+        return cal.table[0].value;
+    }
+    // 分段线性插值, 两端按首末两段外推
+    int i = 1;
+    while (i < n - 1 && x > cal.table[i].raw) {
+        i++;
+    }
+    const MdbCalibrationPoint &a = cal.table[i - 1];
+    const MdbCalibrationPoint &b = cal.table[i];
+    if (b.raw == a.raw) {
+        return b.value;
+    }
+    return a.value + (x - a.raw) * (b.value - a.value) / (b.raw - a.raw);
+}
+
+void MdbCalibrator::process(const MdbFrame &in, MdbCalibratedFrame &out)
+{
+    for (int ch = 0; ch < MdbChannelCount; ch++) {
+        if (!in.isValid(ch)) {
+            continue;
+        }
+        const MdbChannelCalibration &cal = channels[ch];
+        const double absolute = toEngineering(cal, in.raw[ch]);
+        const double alpha = qBound(0.0, cal.filterAlpha, 1.0);
+        if (!hasValue[ch] || alpha >= 1.0) {
+            filterState[ch] = absolute;
+        } else {
+            filterState[ch] += alpha * (absolute - filterState[ch]);
+        }
+        hasValue[ch] = true;
+        lastAbsolute[ch] = absolute;
+
+        out.absolute[ch] = absolute;
+        out.value[ch] = filterState[ch] - cal.zero;
+        out.timeUs[ch] = in.timeUs[ch];
+    }
+    out.validMask = in.validMask & ((1u << MdbChannelCount) - 1);
+}
+
+void MdbCalibrator::zeroChannel(int ch)
+{
+    if (ch < 0 || ch >= MdbChannelCount || !hasValue[ch]) {
+        return;
+    }
+    channels[ch].zero = lastAbsolute[ch];
+}
+
+void MdbCalibrator::zeroAll()
+{
+    for (int ch = 0; ch < MdbChannelCount; ch++) {
+        zeroChannel(ch);
+    }
+}
+
+void MdbCalibrator::resetFilters()
+{
+    for (int ch = 0; ch < MdbChannelCount; ch++) {
+        hasValue[ch] = false;
+    }
+}
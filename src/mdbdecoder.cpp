@@ -0,0 +1,79 @@
+#include "inc/mdbdecoder.h"
+
+// 各传感器的寄存器表
+static constexpr MdbRegisterField tractionMap[] = {
+    {450, MdbWordFormat::Int32, MdbTractionTop},
+    {452, MdbWordFormat::Int32, MdbTractionDown},
+};
+static constexpr MdbRegisterField torqueMap[] = {
+    {0x00, MdbWordFormat::Long, MdbTorque},         // 扭矩; 0x02 转速, 0x04 功率 暂不读取
+};
+static constexpr MdbRegisterField positionMap[] = {
+    {0x00, MdbWordFormat::Long, MdbPosition},
+};
+
+struct MdbSensorMap {
+    const MdbRegisterField *fields;
+    int count;
+};
+
+// 按 MdbSensorType 索引
+static constexpr MdbSensorMap sensorMaps[MdbSensorTypeCount] = {
+    {nullptr, 0},
+    {tractionMap, int(sizeof(tractionMap) / sizeof(tractionMap[0]))},
+    {torqueMap, int(sizeof(torqueMap) / sizeof(torqueMap[0]))},
+    {positionMap, int(sizeof(positionMap) / sizeof(positionMap[0]))},
+};
+
+static inline int formatWords(MdbWordFormat format)
+{
+    return format == MdbWordFormat::Short ? 1 : 2;
+}
+
+static inline qint32 decodeWords(MdbWordFormat format, const quint16 *p)
+{
+    switch (format) {
+    case MdbWordFormat::Int32:
+        return static_cast<qint32>((quint32(p[0]) << 16) | quint32(p[1]));
+    case MdbWordFormat::Long:
+        // 低字按有符号数扩展后再拼接, 保持与原实现相同的结果
+        return static_cast<qint32>((quint32(p[0]) << 16) | quint32(qint32(qint16(p[1]))));
+    case MdbWordFormat::Short:
+        return qint16(p[0]);
+    }
+    return 0;
+}
+
+int MdbDecoder::decode(int sensorType, int startReg, const quint16 *regs, int count,
+                       qint64 timeUs, MdbFrame &frame)
+{
+    if (sensorType <= 0 || sensorType >= MdbSensorTypeCount || !regs) {
+        return 0;
+    }
+    const MdbSensorMap &map = sensorMaps[sensorType];
+    int decoded = 0;
+    for (int i = 0; i < map.count; i++) {
+        const MdbRegisterField &field = map.fields[i];
+        const int offset = field.reg - startReg;
+        if (offset < 0 || offset + formatWords(field.format) > count) {
+            continue;
+        }
+        frame.raw[field.channel] = decodeWords(field.format, regs + offset);
+        frame.timeUs[field.channel] = timeUs;
+        frame.validMask |= 1u << field.channel;
+        decoded++;
+    }
+    return decoded;
+}
+
+int MdbDecoder::channelRegister(int channel)
+{
+    for (int t = 1; t < MdbSensorTypeCount; t++) {
+        for (int i = 0; i < sensorMaps[t].count; i++) {
+            if (sensorMaps[t].fields[i].channel == channel) {
+                return sensorMaps[t].fields[i].reg;
+            }
+        }
+    }
+    return -1;
+}
@@ -0,0 +1,179 @@
+#include "inc/mdbpollscheduler.h"
+#include "inc/sensorclock.h"
+
+#include <QThread>
+#include <QDebug>
+#include <algorithm>
+
+// 最大公约数
+static int gcdInt(int a, int b)
+{
+    while (b != 0) {
+        const int t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+MdbPollScheduler::MdbPollScheduler(MdbTcpTransport **transports, int portCount, QObject *parent) : QObject(parent),
+    transports(transports),
+    portCount(qMin(portCount, MDB_POLL_MAX_PORTS))
+{
+    timer = new QTimer(this);
+    timer->setTimerType(Qt::PreciseTimer);
+    connect(timer, &QTimer::timeout, this, &MdbPollScheduler::onTick);
+}
+
+int MdbPollScheduler::addItem(const MdbPollItem &item)
+{
+    items.append(item);
+    return items.size() - 1;
+}
+
+void MdbPollScheduler::setItemEnabled(int id, bool enabled, int port, int intervalMs)
+{
+    // 定时器只能在所属线程中启停
+    if (QThread::currentThread() != thread()) {
+        QMetaObject::invokeMethod(this, [=]() {
+            setItemEnabled(id, enabled, port, intervalMs);
+        }, Qt::QueuedConnection);
+        return;
+    }
+    if (id < 0 || id >= items.size()) {
+        return;
+    }
+    items[id].enabled = enabled;
+    items[id].port = port;
+    items[id].intervalMs = qMax(1, intervalMs);
+    reschedule();
+}
+
+void MdbPollScheduler::reschedule()
+{
+    int tick = 0;
+    for (const MdbPollItem &item : items) {
+        if (item.enabled) {
+            tick = (tick == 0) ? item.intervalMs : gcdInt(tick, item.intervalMs);
+        }
+    }
+
+    if (tick == 0) {
+        timer->stop();
+        tickMs = 0;
+        return;
+    }
+    if (tick != tickMs || !timer->isActive()) {
+        // 节拍变化时重新对齐, 所有区间从同一节拍开始
+        tickMs = tick;
+        tickIndex = 0;
+        timer->start(tickMs);
+        qDebug() << "Modbus poll tick:" << tickMs << "ms";
+    }
+}
+
+void MdbPollScheduler::onTick()
+{
+    // 收集本节拍到期的区间
+    due.resize(0);
+    for (int i = 0; i < items.size(); i++) {
+        const MdbPollItem &item = items[i];
+        if (item.enabled && tickIndex % qMax(1, item.intervalMs / tickMs) == 0) {
+            due.append(i);
+        }
+    }
+    tickIndex++;
+    if (due.isEmpty()) {
+        return;
+    }
+
+    // 上一周期仍有请求未返回时先结束它, 迟到的回复计入新周期的输出
+    if (cycleOpen) {
+        finishCycle();
+    }
+    cycle++;
+    cycleOutstanding = 0;
+    cycleOpen = true;
+
+    // 按端口/设备/寄存器排序后合并相邻区间
+    std::sort(due.begin(), due.end(), [this](int a, int b) {
+        const MdbPollItem &x = items[a];
+        const MdbPollItem &y = items[b];
+        if (x.port != y.port) return x.port < y.port;
+        if (x.deviceId != y.deviceId) return x.deviceId < y.deviceId;
+        return x.reg < y.reg;
+    });
+
+    QVector<int> members;
+    int i = 0;
+    while (i < due.size()) {
+        const MdbPollItem &first = items[due[i]];
+        const int startReg = first.reg;
+        int endReg = first.reg + first.count;
+        members.resize(0);
+        members.append(due[i]);
+        int j = i + 1;
+        for (; j < due.size(); j++) {
+            const MdbPollItem &next = items[due[j]];
+            const int nextEnd = qMax(endReg, next.reg + next.count);
+            if (next.port != first.port || next.deviceId != first.deviceId
+                || next.reg > endReg + maxMergeGap || nextEnd - startReg > maxRegisters) {
+                break;
+            }
+            endReg = nextEnd;
+            members.append(due[j]);
+        }
+        sendGroup(first.port, first.deviceId, startReg, endReg - startReg, members);
+        i = j;
+    }
+
+    if (cycleOutstanding == 0) {
+        finishCycle();
+    }
+}
+
+void MdbPollScheduler::finishCycle()
+{
+    cycleOpen = false;
+    if (cycleHandler) {
+        cycleHandler();
+    }
+}
+
+void MdbPollScheduler::sendGroup(int port, int deviceId, int startReg, int count,
+                                 const QVector<int> &members)
+{
+    if (port < 0 || port >= portCount || !transports[port] || !transports[port]->isConnected()) {
+        return;
+    }
+    if (inFlight[port] >= maxInFlight) {
+        // 之前的请求还未返回, 跳过本次轮询而不是继续堆积
+        dropped += members.size();
+        return;
+    }
+
+    const quint64 replyCycle = cycle;
+    const bool accepted = transports[port]->readHoldingRegisters(deviceId, startReg, count,
+            [=](bool ok, const QVector<quint16> &regs, qint64 timeUs) {
+        inFlight[port]--;
+        if (ok) {
+            const QModbusDataUnit unit(QModbusDataUnit::HoldingRegisters, startReg, regs);
+            for (int id : members) {
+                const MdbPollItem &item = items[id];
+                if (handler && item.reg - startReg + item.count <= regs.size()) {
+                    handler(item, unit, item.reg - startReg, timeUs);
+                }
+            }
+        }
+        if (replyCycle == cycle && cycleOpen && --cycleOutstanding == 0) {
+            finishCycle();
+        }
+    });
+    if (!accepted) {
+        dropped += members.size();
+        return;
+    }
+    issued++;
+    inFlight[port]++;
+    cycleOutstanding++;
+}
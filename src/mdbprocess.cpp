@@ -1,41 +1,46 @@
 #include "inc/mdbprocess.h"
+#include "inc/sensorclock.h"
+#include "inc/sensoraligner.h"
+#include "inc/Global.h"
+#include "inc/livesensors.h"
 
-#define SINGLE_TIMER 0
+SeqLock<MdbCalibratedFrame> g_liveSensors;
 
 mdbprocess::mdbprocess(QObject *parent) : QObject(parent)
 {
     qDebug() << "mdbThread:" << QThread::currentThreadId();
+    qRegisterMetaType<MdbFrame>("MdbFrame");
+    qRegisterMetaType<MdbCalibratedFrame>("MdbCalibratedFrame");
 
     for (int i = 0; i < 4; i++){
     modbusDevices[i] = new QModbusTcpClient(this);
+    pollTransports[i] = new MdbTcpTransport(this);
     }
 
-#if SINGLE_TIMER
-    tractTimer = new QTimer();
-    connect(tractTimer, &QTimer::timeout, this, [=]()
-            { Readtraction(Forcemdbport); });
-    connect(tractTimer, &QTimer::timeout, this, [=]()
-            { Readtorque(Torquemdbport); });
-    connect(tractTimer, &QTimer::timeout, this, [=]()
-            { Readposition(Poitionmdbport); });
-#else
-    tractTimer = new QTimer();
-    connect(tractTimer, &QTimer::timeout, this, [=](){
-        Readtraction(Forcemdbport);
+    // 所有传感器共用一个轮询时钟, 同一设备上相邻的寄存器合并读取, 经流水线连接发出
+    pollScheduler = new MdbPollScheduler(pollTransports, 4, this);
+    MdbPollItem item;
+    item.mode = MdbSensorTraction;      // 拉力: 450/452 合并为一次读取 450-453
+    item.reg = 450;
+    pollTractionTop = pollScheduler->addItem(item);
+    item.reg = 452;
+    pollTractionDown = pollScheduler->addItem(item);
+    item.mode = MdbSensorTorque;        // 扭矩
+    item.reg = 0x00;
+    pollTorque = pollScheduler->addItem(item);
+    item.mode = MdbSensorPosition;      // 位置
+    item.reg = 0x00;
+    pollPosition = pollScheduler->addItem(item);
+    pollScheduler->setHandler([this](const MdbPollItem &item, const QModbusDataUnit &unit, int offset, qint64 timeUs) {
+        DecodeValues(item.mode, item.reg, unit, offset, item.count, timeUs, pendingFrame);
     });
-
-    torqueTimer = new QTimer();
-    connect(torqueTimer, &QTimer::timeout, this, [=](){
-        Readtorque(Torquemdbport);
-    });
-
-    positionTimer = new QTimer();
-    connect(positionTimer, &QTimer::timeout, this, [=](){
-        Readposition(Poitionmdbport);
+    // 每个轮询周期只发射一次, 包含本周期所有传感器的值
+    pollScheduler->setCycleHandler([this]() {
+        if (pendingFrame.validMask != 0) {
+            ProcessFrame(pendingFrame);
+            pendingFrame.clear();
+        }
     });
-#endif
-
-
 }
 
 mdbprocess::~mdbprocess()
@@ -43,34 +48,78 @@ mdbprocess::~mdbprocess()
 
 }
 
-/**
- * @brief 将2个短字节的拼成一个长字节，并且转化标准补码成10进制
- * @param lowerShort
- * @param upperShort
- * @return
- */
-int64_t concatenateShortsToLong(int16_t lowerShort, int16_t upperShort) {
-    // Concatenate the two short integers into a long integer
-    int64_t result = ((static_cast<int64_t>(upperShort) << 16) & 0xFFFF0000) | (lowerShort & 0x0000FFFF);
-    // Check if the result is negative
-    if (result & 0x80000000) {
-        // If so, perform two's complement to get the negative value
-        result = -((~result + 1) & 0xFFFFFFFF);
+void mdbprocess::ProcessFrame(const MdbFrame &frame)
+{
+    emit frameDecoded(frame);
+
+    MdbCalibratedFrame cal;
+    calibrator.process(frame, cal);
+    for (int ch = 0; ch < MdbChannelCount; ch++) {
+        if (cal.isValid(ch)) {
+            latestFrame.value[ch] = cal.value[ch];
+            latestFrame.absolute[ch] = cal.absolute[ch];
+            latestFrame.timeUs[ch] = cal.timeUs[ch];
+        }
+    }
+    latestFrame.validMask |= cal.validMask;
+
+    // 控制路径: 不经过界面线程, 控制线程通过 g_liveSensors 无锁读取
+    g_liveSensors.store(latestFrame);
+    if (g_sensorAligner) {
+        static const int alignChannel[MdbChannelCount] = {SensorForceTop, SensorForceDown, SensorTorque, SensorPosition};
+        for (int ch = 0; ch < MdbChannelCount; ch++) {
+            if (cal.isValid(ch)) {
+                g_sensorAligner->push(alignChannel[ch], cal.timeUs[ch], cal.value[ch]);
+            }
+        }
+    }
+    emit calibratedFrame(cal);
+
+    // 记录: 直接交给写库线程
+    if (recorder && AllRecordStart) {
+        const int round = recordRound.loadRelaxed();
+        for (int ch = 0; ch < MdbChannelCount; ch++) {
+            if (!cal.isValid(ch)) {
+                continue;
+            }
+            MdbSample sample;
+            sample.roundId = round;
+            sample.value = cal.value[ch];
+            sample.timeUs = cal.timeUs[ch];
+            switch (ch) {
+            case MdbTractionTop:
+                sample.kind = MdbSampleKind::Force;
+                sample.chId = 1;
+                break;
+            case MdbTractionDown:
+                sample.kind = MdbSampleKind::Force;
+                sample.chId = 2;
+                break;
+            case MdbTorque:
+                sample.kind = MdbSampleKind::Torque;
+                break;
+            case MdbPosition:
+                sample.kind = MdbSampleKind::Position;
+                break;
+            }
+            recorder->submit(sample);
+        }
+    }
+
+    // 界面: 限速发送各通道最近的值
+    if (!displayClock.isValid() || displayClock.elapsed() >= displayIntervalMs) {
+        displayClock.start();
+        emit displayFrame(latestFrame);
     }
-    return result;
 }
-/**
- * @brief 把两个短字节拼成一个长字节
- * @param short1
- * @param short2
- * @return
- */
-long ShortsToLong(int16_t short1, int16_t short2) {
-    long long_byte = (short2 << 16) | short1;
-    return long_byte;
+
+void mdbprocess::ZeroSensors()
+{
+    calibrator.zeroAll();
+    qDebug() << "set zero";
 }
 
-void mdbprocess::ReceiveData(int mode, int reg, int num)
+void mdbprocess::ReceiveData(int mode, int reg, int num, qint64 sendUs)
 {
     QModbusReply* reply = qobject_cast<QModbusReply*>(sender());
     if (!reply) {
@@ -79,59 +128,14 @@ void mdbprocess::ReceiveData(int mode, int reg, int num)
     }
 
     if (reply->error() == QModbusDevice::NoError) {
+       // 取请求往返的中点作为采样时刻
+       const qint64 timeUs = sendUs + (sensorClockUs() - sendUs) / 2;
        QModbusDataUnit unit = reply->result();
-       if(mode == 1)            //需要拼接且需要从补码转化（拉力传感器）
-       {
-            for (uint i = 0; i < unit.valueCount(); i += 2)
-            {
-                int16_t lower = QString::number(unit.value(i)).toUInt();
-                int16_t upper = QString::number(unit.value(i+1)).toUInt();
-                long combine = concatenateShortsToLong(upper, lower);
-                //qDebug() << "Value[t" << reg+i << "]: " << combine;
-                emit tractionLCDshow(combine, reg);
-            }
+       MdbFrame frame;
+       DecodeValues(mode, reg, unit, 0, unit.valueCount(), timeUs, frame);
+       if (frame.validMask != 0) {
+           ProcessFrame(frame);
        }
-       else if(mode == 2)       //需要拼接，但不转化（LONG)（扭矩传感器）
-       {
-           if(num % 2 == 0)
-           {
-               for (uint i = 0; i < unit.valueCount(); i += 2)
-               {
-                   short int short1 = QString::number(unit.value(i)).toUInt();
-                   short int short2 = QString::number(unit.value(i+1)).toUInt();
-                   long combine = ShortsToLong(short2, short1);
-                   //qDebug() << "short" << short1 << short2;
-                   //qDebug() << "Value[l" << reg+i << "]: " << combine;
-                   emit torqueLCDshow(combine, reg);
-               }
-           }
-
-       }
-       else if(mode == 3)       //需要拼接，但不转化（位置传感器）
-       {
-           if(num % 2 == 0)
-           {
-               for (uint i = 0; i < unit.valueCount(); i += 2)
-               {
-                   short int short1 = QString::number(unit.value(i)).toUInt();
-                   short int short2 = QString::number(unit.value(i+1)).toUInt();
-                   long combine = ShortsToLong(short2, short1);
-                   //qDebug() << "Value[l" << reg+i << "]: " << combine;
-                   emit positionLCDshow(combine, reg);
-               }
-           }
-       }
-       if (mode == 4) {
-           QVector<quint16> receivedData;
-           for (uint i = 0; i < unit.valueCount(); i++) {
-               quint16 value = static_cast<quint16>(unit.value(i));
-               receivedData.append(value);
-           }
-
-           // 发射信号，传递整个数据向量和起始寄存器地址
-           emit dataReceived(receivedData, reg);
-
-        }
     } else {
        qDebug() << "Read error: " << reply->errorString();
     }
@@ -139,6 +143,26 @@ void mdbprocess::ReceiveData(int mode, int reg, int num)
     reply->deleteLater();
 }
 
+void mdbprocess::DecodeValues(int mode, int reg, const QModbusDataUnit &unit, int offset, int num, qint64 timeUs, MdbFrame &frame)
+{
+    const int end = offset + num;
+    if (offset < 0 || end > static_cast<int>(unit.valueCount())) {
+        return;
+    }
+    // values() 与回复共享数据, 不复制
+    const QVector<quint16> regs = unit.values();
+    if (mode >= MdbSensorTraction && mode < MdbSensorTypeCount)
+    {
+        MdbDecoder::decode(mode, reg, regs.constData() + offset, num, timeUs, frame);
+    }
+    if (mode == 4) {
+        QVector<quint16> receivedData = regs.mid(offset, num);
+
+        // 发射信号，传递整个数据向量和起始寄存器地址
+        emit dataReceived(receivedData, reg);
+    }
+}
+
 
 void mdbprocess::ReadValue(int mdbport, int mdbID, int reg, int num, int mode)
 {
@@ -148,12 +172,13 @@ void mdbprocess::ReadValue(int mdbport, int mdbID, int reg, int num, int mode)
         // 类型/地址/个数
         QModbusDataUnit readUnit(QModbusDataUnit::HoldingRegisters, reg, num);
         // 这里的1代表设备ID
+        const qint64 sendUs = sensorClockUs();
         if (auto *reply = modbusDevices[mdbport]->sendReadRequest(readUnit, mdbID))
         {
            if (!reply->isFinished())
            {
                 connect(reply, &QModbusReply::finished, this, [=](){
-                    ReceiveData(mode, reg, num);
+                    ReceiveData(mode, reg, num, sendUs);
                 });
                 return;
            }
@@ -182,6 +207,9 @@ void mdbprocess::TCPConnect(int port, QString addr)
             modbusDevices[i]->connectDevice();
             connectStatus = true;
         }
+        // 轮询连接 (写入和单次读取仍走 modbusDevices)
+        pollTransports[i]->connectToHost(QString("%1.%2.%3.%4").arg(ipParts[0]).arg(ipParts[1])
+                                         .arg(ipParts[2]).arg(ipParts[3].toInt() + i), port);
     }
 }
 
@@ -193,10 +221,30 @@ void mdbprocess::TCPDisconnect()
             modbusDevices[i]->disconnectDevice();
             qDebug() << "[B] Disconnected device" << i + 1;
         }
+        pollTransports[i]->disconnectFromHost();
     }
+    qDebug().noquote() << RttReport();
     connectStatus = false;
 }
 
+QString mdbprocess::RttReport() const
+{
+    QString report = "Modbus RTT:";
+    for (int i = 0; i < 4; i++) {
+        const MdbTransportStats s = pollTransports[i]->stats();
+        if (s.sent == 0) {
+            continue;
+        }
+        report += QString("\n  port%1: sent=%2 ok=%3 retry=%4 timeout=%5 exception=%6 stale=%7")
+                .arg(i + 1).arg(s.sent).arg(s.completed).arg(s.retries)
+                .arg(s.timeouts).arg(s.exceptions).arg(s.stale);
+        for (int dev : pollTransports[i]->devices()) {
+            report += QString("\n    dev%1 %2").arg(dev).arg(pollTransports[i]->rttHistogram(dev).toString());
+        }
+    }
+    return report;
+}
+
 
 void mdbprocess::Readtraction(int mdbport)
 {
@@ -219,38 +267,18 @@ void mdbprocess::Readposition(int mdbport)
 
 void mdbprocess::setReadtractionTimer(bool start, int interval)
 {
-    if(start == true)
-    {
-        tractTimer->start(interval);
-    }
-    else
-    {
-        tractTimer->stop();
-    }
+    pollScheduler->setItemEnabled(pollTractionTop, start, Forcemdbport-1, interval);
+    pollScheduler->setItemEnabled(pollTractionDown, start, Forcemdbport-1, interval);
 }
 
 void mdbprocess::setReadtorqueTimer(bool start, int interval)
 {
-    if(start == true)
-    {
-        torqueTimer->start(interval);
-    }
-    else
-    {
-        torqueTimer->stop();
-    }
+    pollScheduler->setItemEnabled(pollTorque, start, Torquemdbport-1, interval);
 }
 
 void mdbprocess::setReadpositionTimer(bool start, int interval)
 {
-    if(start == true)
-    {
-        positionTimer->start(interval);
-    }
-    else
-    {
-        positionTimer->stop();
-    }
+    pollScheduler->setItemEnabled(pollPosition, start, Poitionmdbport-1, interval);
 }
 
 //写入寄存器
@@ -0,0 +1,325 @@
+#include "inc/mdbrecorder.h"
+
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QElapsedTimer>
+#include <QtEndian>
+#include <QDebug>
+#include <cstring>
+
+#define MDB_RECORDER_CONNECTION "mdbtcp_writer"
+
+MdbRecorder::MdbRecorder(QObject *parent) : QObject(parent),
+    shouldStop(0)
+{
+}
+
+MdbRecorder::~MdbRecorder()
+{
+    requestStop();
+}
+
+bool MdbRecorder::submit(const MdbSample &sample)
+{
+    QMutexLocker locker(&queueMutex);
+    if (queue.size() >= queueCapacity) {
+        dropped++;
+        return false;
+    }
+    queue.append(sample);
+    if (queue.size() >= commitRows) {
+        queueNotEmpty.wakeOne();
+    }
+    return true;
+}
+
+bool MdbRecorder::submitFrame(const SensorFrame &frame, int roundId)
+{
+    QMutexLocker locker(&queueMutex);
+    if (frameQueue.size() >= queueCapacity) {
+        dropped++;
+        return false;
+    }
+    frameQueue.append({roundId, frame});
+    return true;
+}
+
+bool MdbRecorder::submitFeatures(const QVector<MdbFeatureRow> &rows)
+{
+    QMutexLocker locker(&queueMutex);
+    if (featureQueue.size() + rows.size() > queueCapacity) {
+        dropped += rows.size();
+        return false;
+    }
+    featureQueue += rows;
+    return true;
+}
+
+void MdbRecorder::requestStop()
+{
+    QMutexLocker locker(&queueMutex);
+    shouldStop.storeRelaxed(1);
+    queueNotEmpty.wakeAll();
+}
+
+qint64 MdbRecorder::writtenRows() const
+{
+    QMutexLocker locker(&queueMutex);
+    return written;
+}
+
+qint64 MdbRecorder::droppedRows() const
+{
+    QMutexLocker locker(&queueMutex);
+    return dropped;
+}
+
+// 丢弃各列最早的行, 只保留最近 keep 行, 返回丢弃行数
+static int dropOldestRows(const QList<QVariantList *> &columns, int keep)
+{
+    const int n = columns.first()->size() - qMax(0, keep);
+    if (n <= 0) {
+        return 0;
+    }
+    for (QVariantList *column : columns) {
+        column->erase(column->begin(), column->begin() + n);
+    }
+    return n;
+}
+
+// 旧数据库中的采样表没有时间列时补上
+static void ensureTimeColumn(QSqlDatabase &db, const QString &table)
+{
+    QSqlQuery query(db);
+    if (!query.exec(QString("PRAGMA table_info(%1)").arg(table))) {
+        return;
+    }
+    bool found = false;
+    while (query.next()) {
+        if (query.value(1).toString() == "TimeUs") {
+            found = true;
+        }
+    }
+    if (!found && !query.exec(QString("ALTER TABLE %1 ADD COLUMN TimeUs INTEGER").arg(table))) {
+        qDebug() << "Error adding TimeUs column to" << table << ":" << query.lastError().text();
+    }
+}
+
+// 执行一张表的批量插入
+static bool execInsertBatch(QSqlQuery &query, const QString &sql, const QList<QVariantList> &columns)
+{
+    if (columns.isEmpty() || columns.first().isEmpty()) {
+        return true;
+    }
+    query.prepare(sql);
+    for (const QVariantList &column : columns) {
+        query.addBindValue(column);
+    }
+    if (!query.execBatch()) {
+        qDebug() << "Error inserting Modbus data:" << query.lastError().text();
+        return false;
+    }
+    return true;
+}
+
+bool MdbRecorder::commitPending(QSqlDatabase &db)
+{
+    const int rows = forceRounds.size() + torqueRounds.size() + positionRounds.size() + frameRounds.size()
+            + featRounds.size();
+    if (rows == 0) {
+        return true;
+    }
+
+    db.transaction();
+    QSqlQuery query(db);
+    const bool ok =
+            execInsertBatch(query, "INSERT INTO Forcedata (RoundID, ChID, ForceData, TimeUs) VALUES (?, ?, ?, ?)",
+                            {forceRounds, forceChannels, forceValues, forceTimes})
+            && execInsertBatch(query, "INSERT INTO Torquedata (RoundID, TorData, TimeUs) VALUES (?, ?, ?)",
+                               {torqueRounds, torqueValues, torqueTimes})
+            && execInsertBatch(query, "INSERT INTO Positiondata (RoundID, PosData, TimeUs) VALUES (?, ?, ?)",
+                               {positionRounds, positionValues, positionTimes})
+            && execInsertBatch(query, "INSERT INTO SensorFrames (RoundID, TimeUs, ValidMask, Vals) VALUES (?, ?, ?, ?)",
+                               {frameRounds, frameTimes, frameMasks, frameValues})
+            && execInsertBatch(query, "INSERT INTO VibFeatures (RoundID, ChID, TimeUs, RMS, Peak, Crest, Kurtosis, PeakFreq, BandRMS) "
+                                      "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?)",
+                               {featRounds, featChannels, featTimes, featRms, featPeaks, featCrests,
+                                featKurtosis, featPeakFreqs, featBandRms});
+    if (!ok) {
+        db.rollback();
+        return false;
+    }
+    if (!db.commit()) {
+        qDebug() << "Error committing Modbus data:" << db.lastError().text();
+        return false;
+    }
+
+    forceRounds.clear();
+    forceChannels.clear();
+    forceValues.clear();
+    forceTimes.clear();
+    torqueRounds.clear();
+    torqueValues.clear();
+    torqueTimes.clear();
+    positionRounds.clear();
+    positionValues.clear();
+    positionTimes.clear();
+    frameRounds.clear();
+    frameTimes.clear();
+    frameMasks.clear();
+    frameValues.clear();
+    featRounds.clear();
+    featChannels.clear();
+    featTimes.clear();
+    featRms.clear();
+    featPeaks.clear();
+    featCrests.clear();
+    featKurtosis.clear();
+    featPeakFreqs.clear();
+    featBandRms.clear();
+
+    QMutexLocker locker(&queueMutex);
+    written += rows;
+    return true;
+}
+
+void MdbRecorder::trimPending()
+{
+    const int rows = dropOldestRows({&forceRounds, &forceChannels, &forceValues, &forceTimes}, maxPendingRows)
+            + dropOldestRows({&torqueRounds, &torqueValues, &torqueTimes}, maxPendingRows)
+            + dropOldestRows({&positionRounds, &positionValues, &positionTimes}, maxPendingRows)
+            + dropOldestRows({&frameRounds, &frameTimes, &frameMasks, &frameValues}, maxPendingRows)
+            + dropOldestRows({&featRounds, &featChannels, &featTimes, &featRms, &featPeaks, &featCrests,
+                              &featKurtosis, &featPeakFreqs, &featBandRms}, maxPendingRows);
+    if (rows == 0) {
+        return;
+    }
+    qDebug() << "Modbus writer backlog over limit, dropped" << rows << "oldest rows";
+    QMutexLocker locker(&queueMutex);
+    dropped += rows;
+}
+
+void MdbRecorder::doWork()
+{
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", MDB_RECORDER_CONNECTION);
+        db.setDatabaseName(dbFileName);
+        if (!db.open()) {
+            qDebug() << "Error: Modbus writer failed to connect database." << db.lastError();
+        } else {
+            QSqlQuery pragmaQuery(db);
+            pragmaQuery.exec("PRAGMA journal_mode = WAL");
+            pragmaQuery.exec("PRAGMA synchronous = NORMAL");
+            pragmaQuery.exec("PRAGMA busy_timeout = 2000");
+            if (!pragmaQuery.exec("CREATE TABLE IF NOT EXISTS SensorFrames ("
+                                  "ID INTEGER PRIMARY KEY AUTOINCREMENT, RoundID INTEGER, "
+                                  "TimeUs INTEGER, ValidMask INTEGER, Vals BLOB)")) {
+                qDebug() << "Error creating SensorFrames table:" << pragmaQuery.lastError().text();
+            }
+            // 振动特征与各采样表同库, 按 (RoundID, TimeUs) 与 Modbus 数据对齐
+            if (!pragmaQuery.exec("CREATE TABLE IF NOT EXISTS VibFeatures ("
+                                  "RoundID INTEGER, ChID INTEGER, TimeUs INTEGER, RMS REAL, Peak REAL, "
+                                  "Crest REAL, Kurtosis REAL, PeakFreq REAL, BandRMS TEXT)")) {
+                qDebug() << "Error creating VibFeatures table:" << pragmaQuery.lastError().text();
+            }
+            pragmaQuery.exec("CREATE INDEX IF NOT EXISTS idx_VibFeatures_Round ON VibFeatures (RoundID, TimeUs)");
+            ensureTimeColumn(db, "Forcedata");
+            ensureTimeColumn(db, "Torquedata");
+            ensureTimeColumn(db, "Positiondata");
+        }
+
+        QElapsedTimer sinceCommit;
+        sinceCommit.start();
+        QVector<MdbSample> batch;
+        QVector<FrameRow> frameBatch;
+        QVector<MdbFeatureRow> featureBatch;
+
+        for (;;) {
+            {
+                QMutexLocker locker(&queueMutex);
+                if (queue.size() < commitRows && shouldStop.loadRelaxed() == 0) {
+                    const qint64 remain = commitIntervalMs - sinceCommit.elapsed();
+                    queueNotEmpty.wait(&queueMutex, static_cast<unsigned long>(qMax<qint64>(1, remain)));
+                }
+                // 一次取走全部采样, 写库期间不持有锁
+                batch.swap(queue);
+                frameBatch.swap(frameQueue);
+                featureBatch.swap(featureQueue);
+            }
+
+            for (const MdbSample &s : batch) {
+                switch (s.kind) {
+                case MdbSampleKind::Force:
+                    forceRounds.append(s.roundId);
+                    forceChannels.append(s.chId);
+                    forceValues.append(s.value);
+                    forceTimes.append(s.timeUs);
+                    break;
+                case MdbSampleKind::Torque:
+                    torqueRounds.append(s.roundId);
+                    torqueValues.append(s.value);
+                    torqueTimes.append(s.timeUs);
+                    break;
+                case MdbSampleKind::Position:
+                    positionRounds.append(s.roundId);
+                    positionValues.append(s.value);
+                    positionTimes.append(s.timeUs);
+                    break;
+                }
+            }
+            batch.clear();
+
+            for (const FrameRow &row : frameBatch) {
+                QByteArray vals(int(sizeof(double)) * SensorChannelCount, Qt::Uninitialized);
+                for (int ch = 0; ch < SensorChannelCount; ch++) {
+                    quint64 bits;
+                    std::memcpy(&bits, &row.frame.values[ch], sizeof(bits));
+                    qToLittleEndian<quint64>(bits, vals.data() + ch * sizeof(bits));
+                }
+                frameRounds.append(row.roundId);
+                frameTimes.append(row.frame.timeUs);
+                frameMasks.append(qint64(row.frame.validMask));
+                frameValues.append(vals);
+            }
+            frameBatch.clear();
+
+            for (const MdbFeatureRow &row : featureBatch) {
+                featRounds.append(row.roundId);
+                featChannels.append(row.chId);
+                featTimes.append(row.timeUs);
+                featRms.append(row.rms);
+                featPeaks.append(row.peak);
+                featCrests.append(row.crest);
+                featKurtosis.append(row.kurtosis);
+                featPeakFreqs.append(row.peakFreq);
+                featBandRms.append(row.bandRms);
+            }
+            featureBatch.clear();
+
+            const int pending = forceRounds.size() + torqueRounds.size() + positionRounds.size() + frameRounds.size()
+                    + featRounds.size();
+            if (pending >= commitRows || sinceCommit.elapsed() >= commitIntervalMs) {
+                // 数据库未打开或提交失败时数据保留重试, 积压超过上限则丢弃最早的部分
+                if (!db.isOpen() || !commitPending(db)) {
+                    trimPending();
+                }
+                sinceCommit.restart();
+            }
+
+            if (shouldStop.loadRelaxed() != 0) {
+                QMutexLocker locker(&queueMutex);
+                if (queue.isEmpty() && frameQueue.isEmpty() && featureQueue.isEmpty()) {
+                    break;
+                }
+            }
+        }
+
+        // 退出前提交剩余数据
+        if (db.isOpen()) {
+            commitPending(db);
+        }
+        db.close();
+    }
+    QSqlDatabase::removeDatabase(MDB_RECORDER_CONNECTION);
+    qDebug() << "Modbus writer thread exited.";
+}
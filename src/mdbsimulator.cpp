@@ -0,0 +1,211 @@
+#include "inc/mdbsimulator.h"
+#include "inc/mdbtcptransport.h"
+
+#include <QHostAddress>
+#include <QTimer>
+#include <QtEndian>
+#include <QDebug>
+#include <cmath>
+#include <cstring>
+
+MdbSimulator::MdbSimulator(QObject *parent) : QObject(parent),
+    rng(12345)
+{
+}
+
+MdbSimulator::~MdbSimulator()
+{
+    stop();
+}
+
+bool MdbSimulator::start(const QString &baseAddress, int port)
+{
+    stop();
+    const QStringList parts = baseAddress.split(".");
+    if (parts.size() != 4) {
+        qDebug() << "Modbus simulator: invalid address" << baseAddress;
+        return false;
+    }
+    for (int i = 0; i < MDB_SIM_GATEWAYS; i++) {
+        // 与 mdbprocess::TCPConnect 相同, 第i个网关地址为末段+i
+        const QString addr = QString("%1.%2.%3.%4").arg(parts[0]).arg(parts[1]).arg(parts[2])
+                .arg(parts[3].toInt() + i);
+        servers[i] = new QTcpServer(this);
+        if (!servers[i]->listen(QHostAddress(addr), static_cast<quint16>(port))) {
+            qDebug() << "Modbus simulator: listen failed on" << addr << port << servers[i]->errorString();
+            stop();
+            return false;
+        }
+        connect(servers[i], &QTcpServer::newConnection, this, &MdbSimulator::onNewConnection);
+    }
+    clock.start();
+    served = 0;
+    qDebug() << "Modbus simulator listening on" << baseAddress << "+0..3 port" << port;
+    return true;
+}
+
+void MdbSimulator::stop()
+{
+    for (auto it = connections.begin(); it != connections.end(); ++it) {
+        it.key()->abort();
+        it.key()->deleteLater();
+    }
+    connections.clear();
+    for (int i = 0; i < MDB_SIM_GATEWAYS; i++) {
+        if (servers[i]) {
+            servers[i]->close();
+            servers[i]->deleteLater();
+            servers[i] = nullptr;
+        }
+    }
+}
+
+void MdbSimulator::onNewConnection()
+{
+    QTcpServer *server = qobject_cast<QTcpServer *>(sender());
+    int gateway = 0;
+    for (int i = 0; i < MDB_SIM_GATEWAYS; i++) {
+        if (servers[i] == server) {
+            gateway = i;
+        }
+    }
+    while (QTcpSocket *socket = server->nextPendingConnection()) {
+        socket->setSocketOption(QAbstractSocket::LowDelayOption, 1);
+        Connection conn;
+        conn.gateway = gateway;
+        connections.insert(socket, conn);
+        connect(socket, &QTcpSocket::readyRead, this, &MdbSimulator::onReadyRead);
+        connect(socket, &QTcpSocket::disconnected, this, [this, socket]() {
+            connections.remove(socket);
+            socket->deleteLater();
+        });
+    }
+}
+
+quint16 MdbSimulator::registerValue(int gateway, int reg, double tSec)
+{
+    std::uniform_real_distribution<double> noise(-1.0, 1.0);
+    const double pi = 3.14159265358979;
+    qint32 value = 0;
+    const bool lowWord = (reg % 2) == 1;
+
+    if (reg == 450 || reg == 451) {
+        // 上拉力: 约 29kN, 随回转缓慢波动 (x0.00981)
+        value = qint32(3000 + 800 * std::sin(2 * pi * 0.2 * tSec) + 20 * noise(rng));
+    } else if (reg == 452 || reg == 453) {
+        // 下拉力: 钻压方向为负
+        value = qint32(-1500 + 400 * std::sin(2 * pi * 0.2 * tSec + 1.0) + 20 * noise(rng));
+    } else if (reg == 0 || reg == 1) {
+        if (gatewaySensor[gateway] == MdbSensorTorque) {
+            // 扭矩: 约 120Nm, 含 1.5Hz 切削波动 (x0.01)
+            value = qint32(12000 + 3000 * std::sin(2 * pi * 1.5 * tSec) + 150 * noise(rng));
+        } else if (gatewaySensor[gateway] == MdbSensorPosition) {
+            // 位置: 2mm/s 给进 100mm 后回退, 0-150mm 对应 0-4096
+            const double mm = 20.0 + std::fmod(tSec * 2.0, 100.0);
+            value = qint32(mm / 150.0 * 4096.0);
+        }
+    }
+    // 两个寄存器高字在前
+    return lowWord ? quint16(quint32(value) & 0xFFFF) : quint16((quint32(value) >> 16) & 0xFFFF);
+}
+
+QByteArray MdbSimulator::buildResponse(int gateway, quint16 transactionId, quint8 unitId,
+                                       const char *pdu, int pduSize)
+{
+    const uchar *p = reinterpret_cast<const uchar *>(pdu);
+    quint8 exception = 0;
+    int startReg = 0;
+    int count = 0;
+    if (pduSize < 5 || p[0] != 0x03) {
+        exception = 0x01;                           // 不支持的功能码
+    } else {
+        startReg = qFromBigEndian<quint16>(p + 1);
+        count = qFromBigEndian<quint16>(p + 3);
+        for (int r = startReg; r < startReg + count; r++) {
+            if (!(r <= 1 || (r >= 450 && r <= 453))) {
+                exception = 0x02;                   // 非法寄存器地址
+                break;
+            }
+        }
+        if (count < 1 || count > 125) {
+            exception = 0x03;
+        }
+    }
+
+    const int pduOut = exception ? 2 : 2 + 2 * count;
+    QByteArray frame(7 + pduOut, Qt::Uninitialized);
+    uchar *o = reinterpret_cast<uchar *>(frame.data());
+    qToBigEndian<quint16>(transactionId, o);
+    qToBigEndian<quint16>(0, o + 2);
+    qToBigEndian<quint16>(static_cast<quint16>(1 + pduOut), o + 4);
+    o[6] = unitId;
+    if (exception) {
+        o[7] = 0x83;
+        o[8] = exception;
+        return frame;
+    }
+    o[7] = 0x03;
+    o[8] = static_cast<uchar>(2 * count);
+    const double tSec = clock.nsecsElapsed() / 1e9;
+    for (int i = 0; i < count; i++) {
+        qToBigEndian<quint16>(registerValue(gateway, startReg + i, tSec), o + 9 + 2 * i);
+    }
+    return frame;
+}
+
+void MdbSimulator::onReadyRead()
+{
+    QTcpSocket *socket = qobject_cast<QTcpSocket *>(sender());
+    auto it = connections.find(socket);
+    if (it == connections.end()) {
+        return;
+    }
+    Connection &conn = it.value();
+    conn.rxBuffer.append(socket->readAll());
+
+    std::uniform_real_distribution<double> jitter(-jitterMs, jitterMs);
+    int consumed = 0;
+    for (;;) {
+        quint16 tid;
+        quint8 unitId;
+        quint8 function;
+        const char *pdu;
+        int pduSize;
+        const int n = MdbTcpTransport::parseFrame(conn.rxBuffer.constData() + consumed,
+                                                  conn.rxBuffer.size() - consumed,
+                                                  &tid, &unitId, &function, &pdu, &pduSize);
+        if (n <= 0) {
+            if (n < 0) {
+                consumed = conn.rxBuffer.size();
+            }
+            break;
+        }
+        consumed += n;
+
+        // 功能码在 parseFrame 中单独返回, 这里拼回 PDU 首字节
+        QByteArray request(1 + pduSize, Qt::Uninitialized);
+        request[0] = static_cast<char>(function);
+        std::memcpy(request.data() + 1, pdu, static_cast<size_t>(pduSize));
+        const QByteArray response = buildResponse(conn.gateway, tid, unitId, request.constData(), request.size());
+        served++;
+
+        const qint64 nowUs = clock.nsecsElapsed() / 1000;
+        const qint64 delayUs = qMax<qint64>(0, qint64((latencyMs + jitter(rng)) * 1000));
+        qint64 replyUs = nowUs + delayUs;
+        if (serialService) {
+            replyUs = qMax(nowUs, conn.busyUntilUs) + delayUs;
+            conn.busyUntilUs = replyUs;
+        }
+        const int waitMs = int((replyUs - nowUs + 500) / 1000);
+        if (waitMs <= 0) {
+            socket->write(response);
+        } else {
+            QTimer::singleShot(waitMs, Qt::PreciseTimer, socket, [socket, response]() {
+                socket->write(response);
+            });
+        }
+    }
+    if (consumed > 0) {
+        conn.rxBuffer.remove(0, consumed);
+    }
+}
@@ -1,7 +1,8 @@
 #include "inc/mdbtcp.h"
 #include "ui_mdbtcp.h"
 
-float downForce = 0;
+// Modbus 数据库文件
+const QString mdbDBFile = "/home/hui/workdir/VK701_Demo/db/mdbsqlite.db";
 
 MdbTCP::MdbTCP(QWidget *parent) :
     QWidget(parent),
@@ -16,7 +17,7 @@ MdbTCP::MdbTCP(QWidget *parent) :
     ui->lcd_position->setMode(QLCDNumber::Dec); // 小数点模式
 
     // 连接数据库
-    InitDB("/home/hui/workdir/VK701_Demo/db/mdbsqlite.db");
+    InitDB(mdbDBFile);
     //currentRoundID = 0;
     // 设置表头自适应
     QHeaderView *header = ui->tb_Force->horizontalHeader();
@@ -36,6 +37,16 @@ MdbTCP::MdbTCP(QWidget *parent) :
         ui->tb_cmdWindow->clear();
     });
 
+    // 采样写库线程: 独立连接, 预编译语句批量提交, 界面线程不再逐条写库
+    recorderThread = new QThread();
+    recorder = new MdbRecorder();
+    recorder->dbFileName = mdbDBFile;
+    recorder->moveToThread(recorderThread);
+    connect(recorderThread, &QThread::started, recorder, &MdbRecorder::doWork);
+    connect(recorderThread, &QThread::finished, recorder, &QObject::deleteLater);
+    connect(recorderThread, &QThread::finished, recorderThread, &QObject::deleteLater);
+    recorderThread->start();
+
     mdbThread = new QThread();
     mdbworker = new mdbprocess();
     mdbworker->moveToThread(mdbThread);
@@ -46,12 +57,18 @@ MdbTCP::MdbTCP(QWidget *parent) :
     connect(mdbThread, SIGNAL(finished()), mdbThread, SLOT(deleteLater()));
 
     //QObject <=> mdbTCP
-    // 拉力传感器数值显示到LCD上
-    connect(mdbworker, &mdbprocess::tractionLCDshow, this, &MdbTCP::ShowLCDtraction);
-    // 扭矩传感器数值显示到LCD上
-    connect(mdbworker, &mdbprocess::torqueLCDshow, this, &MdbTCP::ShowLCDtorque);
-    // 拉力传感器数值显示到LCD上
-    connect(mdbworker, &mdbprocess::positionLCDshow, this, &MdbTCP::ShowLCDposition);
+    // 换算、去零点和记录在采集线程完成, 界面只接收限速后的工程值
+    mdbworker->setRecorder(recorder);
+    mdbworker->setRecordRound(currentRoundID);
+    connect(mdbworker, &mdbprocess::displayFrame, this, &MdbTCP::ShowFrame);
+    // 记录期间对齐帧与原始采样一起写库
+    if (g_sensorAligner) {
+        connect(g_sensorAligner, &SensorAligner::frameReady, this, [=](const SensorFrame &frame) {
+            if (AllRecordStart == true) {
+                recorder->submitFrame(frame, currentRoundID);
+            }
+        });
+    }
 
 
     // 连接modbus网关
@@ -110,6 +127,7 @@ MdbTCP::MdbTCP(QWidget *parent) :
             if(ui->cb_traON->isChecked() || ui->cb_torON->isChecked() || ui->cb_posON->isChecked()){
                 startTime = QDateTime::currentDateTime();
                 currentRoundID++;
+                mdbworker->setRecordRound(currentRoundID);
             }
         }
         else
@@ -161,136 +179,35 @@ MdbTCP::~MdbTCP()
 {
     mdbThread->quit();
     mdbThread->wait();
+    // 停止写库线程, 剩余数据在退出前提交
+    recorder->requestStop();
+    recorderThread->quit();
+    recorderThread->wait();
     delete ui;
 }
 
 void MdbTCP::SetZero()
 {
-    traction1zero = ui->lcd_top->value();
-    traction2zero = ui->lcd_down->value();
-    torqueZero    = ui->lcd_torque->value();
-    positionZero  = ui->lcd_position->value();
+    // 零点在采集线程中按当前工程值设置
+    QMetaObject::invokeMethod(mdbworker, "ZeroSensors", Qt::QueuedConnection);
     startTime = QDateTime::currentDateTime();
-    qDebug()<< "set zero" ;
 }
 
 
 /**
-* @brief 拉力显示到LCD上
-* @param data
-* @param reg
-*/
-void MdbTCP::ShowLCDtraction(long data, int reg)
-{
-    QString values;
-    double data1 = data * 0.00981;
-    if(reg == 450)
-    {
-        ui->lcd_top->display(data1-traction1zero);
-        values = QString("(%1, %2, %3)").arg(currentRoundID).arg(1).arg(data1-traction1zero);
-    }else if(reg == 452)
-    {
-        ui->lcd_down->display(data1-traction2zero);
-        values = QString("(%1, %2, %3)").arg(currentRoundID).arg(2).arg(data1-traction2zero);
-        downForce = data1;
-        //qDebug()<<"DOWN"<<downForce;
-    }
-    else
-    {
-        return;
-    }
-    if(AllRecordStart != true)
-    {
-        return;
-    }
-    QSqlQuery query(dbModbus);
-    QString insertQuery = "INSERT INTO Forcedata (RoundID, ChID, ForceData) VALUES ";
-    // 拼接完整的 SQL 插入语句
-    insertQuery += values;
-    // 执行 SQL 插入操作
-    if (!query.exec(insertQuery))
-    {
-        qDebug() << "Error inserting [F]data into database:" << query.lastError().text();
-        return;
-    }
-}
-
-/**
- * @brief 扭矩显示到LCD上
- * @param data
- * @param reg
- */
-void MdbTCP::ShowLCDtorque(long data, int reg)
-{
-
-    QString values;
-    float data1 = data * 0.01;
-    if(reg == 0x00)         //扭矩值
-    {
-        ui->lcd_torque->display(data1-torqueZero);
-        values = QString("(%1, %2)").arg(currentRoundID).arg(data1-torqueZero);
-    }
-    else
-    {
-        return;
-    }
-    if(AllRecordStart != true)
-    {
-        return;
-    }
-    QSqlQuery query(dbModbus);
-    QString insertQuery = "INSERT INTO Torquedata (RoundID, TorData) VALUES ";
-    // 拼接完整的 SQL 插入语句
-    insertQuery += values;
-    // 执行 SQL 插入操作
-    if (!query.exec(insertQuery))
-    {
-        qDebug() << "Error inserting [T]data into database:" << query.lastError().text();
-        return;
-    }
-}
-
-/**
- * @brief 位置显示到LCD上
- * @param data
- * @param reg
+ * @brief 显示工程值 (采集线程已完成换算、去零点和记录, 这里只负责界面, 限速刷新)
+ * @param frame
  */
-void MdbTCP::ShowLCDposition(long data, int reg)
+void MdbTCP::ShowFrame(const MdbCalibratedFrame &frame)
 {
-    QString values;
-    float data1;
-    if(data < 0)
-    {
-        data1 = 2*32767 + data; //修正负数
-    }
-    else
-    {
-        data1 = data;
-    }
-    data1 = data1 * 150/4096;
-    if(reg == 0x00)         //位置值
-    {
-        ui->lcd_position->display(data1-positionZero);
-        values = QString("(%1, %2)").arg(currentRoundID).arg(data1-positionZero);
-    }
-    else
-    {
-        return;
-    }
-    if(AllRecordStart != true)
-    {
-        return;
-    }
-    QSqlQuery query(dbModbus);
-    QString insertQuery = "INSERT INTO Positiondata (RoundID, PosData) VALUES ";
-    // 拼接完整的 SQL 插入语句
-    insertQuery += values;
-    // 执行 SQL 插入操作
-    if (!query.exec(insertQuery))
-    {
-        qDebug() << "Error inserting [P]data into database:" << query.lastError().text();
-        return;
-    }
+    if (frame.isValid(MdbTractionTop))
+        ui->lcd_top->display(frame.value[MdbTractionTop]);
+    if (frame.isValid(MdbTractionDown))
+        ui->lcd_down->display(frame.value[MdbTractionDown]);
+    if (frame.isValid(MdbTorque))
+        ui->lcd_torque->display(frame.value[MdbTorque]);
+    if (frame.isValid(MdbPosition))
+        ui->lcd_position->display(frame.value[MdbPosition]);
 }
 
 /**
@@ -321,6 +238,12 @@ void MdbTCP::InitDB(const QString &fileName)
     }
     qDebug() << "Connect to mdbtcp database.";
 
+    // WAL 模式: 写库线程提交时不阻塞界面线程的查询
+    QSqlQuery pragmaQuery(dbModbus);
+    pragmaQuery.exec("PRAGMA journal_mode = WAL");
+    pragmaQuery.exec("PRAGMA synchronous = NORMAL");
+    pragmaQuery.exec("PRAGMA busy_timeout = 2000");
+
     // 读取数据库最后一行中的RoundID，并赋值给currentRoundID，保持连贯性
     QSqlQuery query("SELECT MAX(RoundID) FROM TimeRecord", dbModbus);
     if (query.exec() && query.first())
@@ -337,6 +260,33 @@ void MdbTCP::InitDB(const QString &fileName)
 
 
 
+void MdbTCP::recordVibFeatures(const VibFeatureFrame &frame)
+{
+    if (AllRecordStart != true) {
+        return;
+    }
+    QVector<MdbFeatureRow> rows;
+    rows.reserve(frame.channels.size());
+    for (int ch = 0; ch < frame.channels.size(); ch++) {
+        const VibChannelFeatures &f = frame.channels[ch];
+        QStringList bands;
+        for (double v : f.bandRms) {
+            bands << QString::number(v, 'g', 6);
+        }
+        MdbFeatureRow row;
+        row.roundId = currentRoundID;
+        row.chId = ch + 1;
+        row.timeUs = frame.timeUs;
+        row.rms = f.rms;
+        row.peak = f.peak;
+        row.crest = f.crestFactor;
+        row.kurtosis = f.kurtosis;
+        row.peakFreq = f.peakFrequency;
+        row.bandRms = bands.join(',');
+        rows.append(row);
+    }
+    recorder->submitFeatures(rows);
+}
 
 void MdbTCP::on_btn_nuke_clicked()
 {
@@ -354,6 +304,12 @@ void MdbTCP::on_btn_nuke_clicked()
     query.prepare("DELETE FROM Positiondata");
     query.exec();
 
+    query.prepare("DELETE FROM SensorFrames");
+    query.exec();
+
+    query.prepare("DELETE FROM VibFeatures");
+    query.exec();
+
     query.prepare("DELETE FROM sqlite_sequence WHERE name='Forcedata'");
     query.exec();
 
@@ -366,6 +322,9 @@ void MdbTCP::on_btn_nuke_clicked()
     query.prepare("DELETE FROM sqlite_sequence WHERE name='Positiondata'");
     query.exec();
 
+    query.prepare("DELETE FROM sqlite_sequence WHERE name='SensorFrames'");
+    query.exec();
+
     // 提交删除操作，然后执行 VACUUM
     dbModbus.commit();
 
@@ -411,7 +370,7 @@ void MdbTCP::on_btn_showDB_clicked()
         int count = record.count();
         qDebug() << "record.count:" << count;
         ui->tb_Force->setColumnCount(count);
-        ui->tb_Force->setHorizontalHeaderLabels({"RoundID" , "ChID" , "ForceData"}); // 设置表头
+        ui->tb_Force->setHorizontalHeaderLabels({"RoundID" , "ChID" , "ForceData" , "TimeUs"}); // 设置表头
         // 输出查询结果
         while (query.next())
         {
@@ -450,7 +409,7 @@ void MdbTCP::on_btn_showDB_clicked()
         int count = record.count();
         qDebug() << "record.count:" << count;
         ui->tb_Torque->setColumnCount(count);
-        ui->tb_Torque->setHorizontalHeaderLabels({"RoundID" , "TorData"}); // 设置表头
+        ui->tb_Torque->setHorizontalHeaderLabels({"RoundID" , "TorData" , "TimeUs"}); // 设置表头
         // 输出查询结果
         while (query.next())
         {
@@ -489,7 +448,7 @@ void MdbTCP::on_btn_showDB_clicked()
         int count = record.count();
         qDebug() << "record.count:" << count;
         ui->tb_Position->setColumnCount(count);
-        ui->tb_Position->setHorizontalHeaderLabels({"RoundID" , "PosData"}); // 设置表头
+        ui->tb_Position->setHorizontalHeaderLabels({"RoundID" , "PosData" , "TimeUs"}); // 设置表头
         // 输出查询结果
         while (query.next())
         {
@@ -532,7 +491,9 @@ void MdbTCP::on_btn_deleteData_clicked()
     // 构造删除数据的 SQL 语句
     QString deleteQuery = QString( "DELETE FROM Forcedata WHERE RoundID = %1; "
                                    "DELETE FROM Torquedata WHERE RoundID = %1; "
-                                   "DELETE FROM Positiondata WHERE RoundID = %1").arg(round);
+                                   "DELETE FROM Positiondata WHERE RoundID = %1; "
+                                   "DELETE FROM SensorFrames WHERE RoundID = %1; "
+                                   "DELETE FROM VibFeatures WHERE RoundID = %1").arg(round);
     // 执行 SQL 删除操作
     if (query.exec(deleteQuery))
     {
@@ -0,0 +1,344 @@
+#include "inc/mdbtcptransport.h"
+#include "inc/sensorclock.h"
+
+#include <QtEndian>
+#include <QDebug>
+
+#define MDB_MBAP_SIZE       7       // 事务号2 + 协议号2 + 长度2 + 设备地址1
+#define MDB_MAX_ADU_SIZE    260
+
+//////////////////////////////////RTT 直方图/////////////////////////////////////
+
+void MdbRttHistogram::add(qint64 rttUs)
+{
+    int i = 0;
+    while (i < MDB_RTT_BUCKETS - 1 && rttUs > bucketUpperUs(i)) {
+        i++;
+    }
+    counts[i]++;
+    minUs = (total == 0) ? rttUs : qMin(minUs, rttUs);
+    maxUs = qMax(maxUs, rttUs);
+    sumUs += rttUs;
+    total++;
+}
+
+void MdbRttHistogram::merge(const MdbRttHistogram &other)
+{
+    if (other.total == 0) {
+        return;
+    }
+    for (int i = 0; i < MDB_RTT_BUCKETS; i++) {
+        counts[i] += other.counts[i];
+    }
+    minUs = (total == 0) ? other.minUs : qMin(minUs, other.minUs);
+    maxUs = qMax(maxUs, other.maxUs);
+    sumUs += other.sumUs;
+    total += other.total;
+}
+
+qint64 MdbRttHistogram::bucketUpperUs(int i)
+{
+    if (i >= MDB_RTT_BUCKETS - 1) {
+        return -1;
+    }
+    return qint64(250) << i;
+}
+
+qint64 MdbRttHistogram::percentileUs(double p) const
+{
+    if (total == 0) {
+        return 0;
+    }
+    const quint64 rank = qMax<quint64>(1, quint64(p * total + 0.5));
+    quint64 seen = 0;
+    for (int i = 0; i < MDB_RTT_BUCKETS; i++) {
+        seen += counts[i];
+        if (seen >= rank) {
+            const qint64 upper = bucketUpperUs(i);
+            return (upper < 0) ? maxUs : qMin(upper, maxUs);
+        }
+    }
+    return maxUs;
+}
+
+QString MdbRttHistogram::toString() const
+{
+    if (total == 0) {
+        return "n=0";
+    }
+    QString text = QString("n=%1 min=%2ms avg=%3ms p50<=%4ms p99<=%5ms max=%6ms |")
+            .arg(total)
+            .arg(minUs / 1000.0, 0, 'f', 2)
+            .arg(sumUs / 1000.0 / total, 0, 'f', 2)
+            .arg(percentileUs(0.5) / 1000.0, 0, 'f', 2)
+            .arg(percentileUs(0.99) / 1000.0, 0, 'f', 2)
+            .arg(maxUs / 1000.0, 0, 'f', 2);
+    for (int i = 0; i < MDB_RTT_BUCKETS; i++) {
+        if (counts[i] == 0) {
+            continue;
+        }
+        const qint64 upper = bucketUpperUs(i);
+        text += (upper < 0) ? QString(" >%1ms:%2").arg(bucketUpperUs(i - 1) / 1000.0).arg(counts[i])
+                            : QString(" <=%1ms:%2").arg(upper / 1000.0).arg(counts[i]);
+    }
+    return text;
+}
+
+//////////////////////////////////组帧/解析/////////////////////////////////////
+
+QByteArray MdbTcpTransport::buildReadRequest(quint16 transactionId, quint8 unitId, quint16 startReg, quint16 count)
+{
+    QByteArray frame(MDB_MBAP_SIZE + 5, Qt::Uninitialized);
+    uchar *p = reinterpret_cast<uchar *>(frame.data());
+    qToBigEndian<quint16>(transactionId, p);
+    qToBigEndian<quint16>(0, p + 2);                // 协议号
+    qToBigEndian<quint16>(6, p + 4);                // 设备地址 + PDU 长度
+    p[6] = unitId;
+    p[7] = 0x03;                                    // 读保持寄存器
+    qToBigEndian<quint16>(startReg, p + 8);
+    qToBigEndian<quint16>(count, p + 10);
+    return frame;
+}
+
+int MdbTcpTransport::parseFrame(const char *data, int size, quint16 *transactionId, quint8 *unitId,
+                                quint8 *function, const char **pdu, int *pduSize)
+{
+    if (size < MDB_MBAP_SIZE + 1) {
+        return 0;
+    }
+    const uchar *p = reinterpret_cast<const uchar *>(data);
+    const quint16 protocol = qFromBigEndian<quint16>(p + 2);
+    const int length = qFromBigEndian<quint16>(p + 4);
+    if (protocol != 0 || length < 2 || MDB_MBAP_SIZE - 1 + length > MDB_MAX_ADU_SIZE) {
+        return -1;
+    }
+    const int frameSize = MDB_MBAP_SIZE - 1 + length;
+    if (size < frameSize) {
+        return 0;
+    }
+    *transactionId = qFromBigEndian<quint16>(p);
+    *unitId = p[6];
+    *function = p[7];
+    *pdu = data + MDB_MBAP_SIZE + 1;
+    *pduSize = frameSize - MDB_MBAP_SIZE - 1;
+    return frameSize;
+}
+
+//////////////////////////////////传输/////////////////////////////////////
+
+MdbTcpTransport::MdbTcpTransport(QObject *parent) : QObject(parent)
+{
+    socket = new QTcpSocket(this);
+    socket->setSocketOption(QAbstractSocket::LowDelayOption, 1);
+    connect(socket, &QTcpSocket::readyRead, this, &MdbTcpTransport::onReadyRead);
+    connect(socket, &QTcpSocket::connected, this, [this]() {
+        emit connectionChanged(true);
+    });
+    connect(socket, &QTcpSocket::disconnected, this, &MdbTcpTransport::onDisconnected);
+
+    timeoutTimer = new QTimer(this);
+    timeoutTimer->setTimerType(Qt::PreciseTimer);
+    connect(timeoutTimer, &QTimer::timeout, this, &MdbTcpTransport::onTimeoutCheck);
+}
+
+MdbTcpTransport::~MdbTcpTransport()
+{
+    // 析构时不再回调
+    pending.clear();
+    waiting.clear();
+}
+
+void MdbTcpTransport::connectToHost(const QString &address, int port)
+{
+    if (socket->state() != QAbstractSocket::UnconnectedState) {
+        return;
+    }
+    rxBuffer.clear();
+    socket->connectToHost(address, static_cast<quint16>(port));
+}
+
+void MdbTcpTransport::disconnectFromHost()
+{
+    socket->disconnectFromHost();
+}
+
+bool MdbTcpTransport::isConnected() const
+{
+    return socket->state() == QAbstractSocket::ConnectedState;
+}
+
+bool MdbTcpTransport::readHoldingRegisters(int unitId, int startReg, int count, const ReadCallback &callback)
+{
+    if (!isConnected() || count <= 0 || count > 125) {
+        return false;
+    }
+    Request request;
+    request.unitId = static_cast<quint8>(unitId);
+    request.startReg = static_cast<quint16>(startReg);
+    request.count = static_cast<quint16>(count);
+    request.callback = callback;
+
+    if (pending.size() < maxOutstanding) {
+        send(request);
+        return true;
+    }
+    if (waiting.size() >= maxQueued) {
+        return false;
+    }
+    waiting.append(request);
+    return true;
+}
+
+void MdbTcpTransport::send(Request &request)
+{
+    // 跳过仍在使用的事务号 (回绕后)
+    while (nextTransactionId == 0 || pending.contains(nextTransactionId)) {
+        nextTransactionId++;
+    }
+    const quint16 tid = nextTransactionId++;
+
+    request.attempts++;
+    request.sendUs = sensorClockUs();
+    pending.insert(tid, request);
+    socket->write(buildReadRequest(tid, request.unitId, request.startReg, request.count));
+    counters.sent++;
+
+    if (!timeoutTimer->isActive()) {
+        timeoutTimer->start(qBound(1, timeoutMs / 10, 20));
+    }
+}
+
+void MdbTcpTransport::sendWaiting()
+{
+    int sent = 0;
+    while (sent < waiting.size() && pending.size() < maxOutstanding) {
+        send(waiting[sent]);
+        sent++;
+    }
+    if (sent > 0) {
+        waiting.remove(0, sent);
+    }
+}
+
+void MdbTcpTransport::finish(Request &request, bool ok, const QVector<quint16> &regs, qint64 timeUs)
+{
+    if (request.callback) {
+        request.callback(ok, regs, timeUs);
+    }
+}
+
+void MdbTcpTransport::onReadyRead()
+{
+    rxBuffer.append(socket->readAll());
+
+    int consumed = 0;
+    QVector<quint16> regs;
+    for (;;) {
+        quint16 tid;
+        quint8 unitId;
+        quint8 function;
+        const char *pdu;
+        int pduSize;
+        const int n = parseFrame(rxBuffer.constData() + consumed, rxBuffer.size() - consumed,
+                                 &tid, &unitId, &function, &pdu, &pduSize);
+        if (n == 0) {
+            break;
+        }
+        if (n < 0) {
+            // 帧头错乱, 无法再定位后续帧, 丢弃缓存
+            qDebug() << "Modbus TCP: malformed frame, dropping" << rxBuffer.size() - consumed << "bytes";
+            consumed = rxBuffer.size();
+            break;
+        }
+        consumed += n;
+
+        auto it = pending.find(tid);
+        if (it == pending.end()) {
+            counters.stale++;
+            continue;
+        }
+        Request request = it.value();
+        pending.erase(it);
+
+        const qint64 recvUs = sensorClockUs();
+        histograms[request.unitId].add(recvUs - request.sendUs);
+        const qint64 timeUs = request.sendUs + (recvUs - request.sendUs) / 2;
+
+        const uchar *p = reinterpret_cast<const uchar *>(pdu);
+        if (function == 0x03 && pduSize >= 1 && p[0] == request.count * 2 && pduSize >= 1 + p[0]) {
+            regs.resize(request.count);
+            for (int i = 0; i < request.count; i++) {
+                regs[i] = qFromBigEndian<quint16>(p + 1 + 2 * i);
+            }
+            counters.completed++;
+            finish(request, true, regs, timeUs);
+        } else {
+            if (function & 0x80) {
+                qDebug() << "Modbus TCP exception: device" << request.unitId << "reg" << request.startReg
+                         << "code" << (pduSize > 0 ? p[0] : 0);
+            }
+            counters.exceptions++;
+            finish(request, false, QVector<quint16>(), timeUs);
+        }
+    }
+    if (consumed > 0) {
+        rxBuffer.remove(0, consumed);
+    }
+
+    sendWaiting();
+    if (pending.isEmpty()) {
+        timeoutTimer->stop();
+    }
+}
+
+void MdbTcpTransport::onTimeoutCheck()
+{
+    const qint64 now = sensorClockUs();
+    const qint64 limitUs = qint64(timeoutMs) * 1000;
+
+    QVector<quint16> expired;
+    for (auto it = pending.constBegin(); it != pending.constEnd(); ++it) {
+        if (now - it.value().sendUs >= limitUs) {
+            expired.append(it.key());
+        }
+    }
+    for (quint16 tid : expired) {
+        Request request = pending.take(tid);
+        if (request.attempts <= maxRetries && isConnected()) {
+            // 以新的事务号重发, 旧事务号的迟到回复会被丢弃
+            counters.retries++;
+            send(request);
+        } else {
+            counters.timeouts++;
+            finish(request, false, QVector<quint16>(), now);
+        }
+    }
+
+    sendWaiting();
+    if (pending.isEmpty()) {
+        timeoutTimer->stop();
+    }
+}
+
+void MdbTcpTransport::failAll()
+{
+    const qint64 now = sensorClockUs();
+    QHash<quint16, Request> lost;
+    lost.swap(pending);
+    QVector<Request> queued;
+    queued.swap(waiting);
+    for (Request &request : lost) {
+        finish(request, false, QVector<quint16>(), now);
+    }
+    for (Request &request : queued) {
+        finish(request, false, QVector<quint16>(), now);
+    }
+}
+
+void MdbTcpTransport::onDisconnected()
+{
+    timeoutTimer->stop();
+    rxBuffer.clear();
+    failAll();
+    emit connectionChanged(false);
+}
@@ -9,6 +9,8 @@
 #include <cstring>
 #include <QElapsedTimer>
 #include <QMutexLocker>
+#include <QVarLengthArray>
+#include "inc/sensorclock.h"
 
 MotionController::MotionController(QObject *parent)
     : QObject(parent)
@@ -16,11 +18,35 @@ MotionController::MotionController(QObject *parent)
     , m_connected(false)
     , m_debugMode(false)
 {
+    qRegisterMetaType<AxisState>("AxisState");
+    qRegisterMetaType<AxisStateArray>("AxisStateArray");
+    
     // 初始化电机名称
     initializeMotorNames();
     
     // 连接定时器信号
     connect(&m_updateTimer, &QTimer::timeout, this, &MotionController::onUpdateTimerTimeout);
+
+    // 订阅统一的电机状态轮询: 直接在轮询线程中判定运动完成, 状态回调转到本对象线程
+    if (g_motionState) {
+        connect(g_motionState, &MotionStateService::stateUpdated,
+                this, &MotionController::onMotionState, Qt::DirectConnection);
+        // 读取失败的周期同样检查超时, 通信中断时等待不会一直挂起
+        connect(g_motionState, &MotionStateService::pollFailed,
+                this, &MotionController::onMotionPollFailed, Qt::DirectConnection);
+    }
+}
+
+/**
+ * @brief 生成已完成的 future
+ */
+static QFuture<bool> finishedFuture(bool result)
+{
+    QFutureInterface<bool> promise;
+    promise.reportStarted();
+    promise.reportResult(result);
+    promise.reportFinished();
+    return promise.future();
 }
 
 MotionController::~MotionController()
@@ -91,6 +117,16 @@ void MotionController::release()
     // 停止定时器
     m_updateTimer.stop();
     
+    // 结束所有等待中的运动
+    {
+        QMutexLocker pendingLocker(&m_pendingMutex);
+        for (auto it = m_pendingMotions.begin(); it != m_pendingMotions.end(); ++it) {
+            it->promise.reportResult(false);
+            it->promise.reportFinished();
+        }
+        m_pendingMotions.clear();
+    }
+    
     // 如果是调试模式，则只需重置标志
     if (m_debugMode) {
         m_connected = false;
@@ -136,21 +172,22 @@ bool MotionController::isDebugMode() const
  * @param motorID 电机ID
  * @return 模拟参数
  */
-QMap<QString, float> MotionController::generateDebugMotorParameters(int motorID)
+AxisState MotionController::generateDebugMotorParameters(int motorID)
 {
-    QMap<QString, float> params;
+    AxisState state;
     
     // 根据电机ID生成不同的模拟数据
-    params["type"] = 1.0;  // 伺服电机
-    params["enabled"] = 1.0;  // 已启用
-    params["dpos"] = 0.0 + (motorID * 10.0);  // 目标位置
-    params["mpos"] = 0.0 + (motorID * 10.0);  // 实际位置
-    params["speed"] = 0.0;  // 目标速度
-    params["mspeed"] = 0.0;  // 实际速度
-    params["units"] = 1.0;  // 单位换算
-    params["accel"] = 10.0;  // 加速度
-    params["decel"] = 10.0;  // 减速度
-    params["dac"] = 0.0;  // DAC值
+    state.atype = 1;  // 伺服电机
+    state.enabled = 1;  // 已启用
+    state.idle = -1;  // 已停止
+    state.dpos = 0.0f + (motorID * 10.0f);  // 目标位置
+    state.mpos = 0.0f + (motorID * 10.0f);  // 实际位置
+    state.speed = 0.0f;  // 目标速度
+    state.mspeed = 0.0f;  // 实际速度
+    state.units = 1.0f;  // 单位换算
+    state.accel = 10.0f;  // 加速度
+    state.decel = 10.0f;  // 减速度
+    state.dac = 0.0f;  // DAC值
     
     // 添加一些随机变化
     static int counter = 0;
@@ -158,20 +195,36 @@ QMap<QString, float> MotionController::generateDebugMotorParameters(int motorID)
     
     // 每次调用略微改变位置，模拟轻微运动
     if (counter % 10 == 0) {
-        params["mpos"] += (rand() % 10) / 10.0;
-        params["mspeed"] = (rand() % 100) / 10.0;
+        state.mpos += (rand() % 10) / 10.0f;
+        state.mspeed = (rand() % 100) / 10.0f;
     }
     
-    return params;
+    return state;
 }
 
 /**
  * @brief 获取电机参数
  * @param motorID 电机ID
- * @param params 输出参数
+ * @param state 输出的电机状态
+ * @return 是否成功
+ */
+bool MotionController::getMotorParameters(int motorID, AxisState &state)
+{
+    AxisStateArray states;
+    if (!getMotorParameters(QList<int>() << motorID, states)) {
+        return false;
+    }
+    state = states.axis[motorID];
+    return true;
+}
+
+/**
+ * @brief 批量获取多个电机的参数, 所有 (参数, 轴) 合并为一条查询命令
+ * @param motorIDs 电机ID列表
+ * @param states 输出的电机状态, 读到的电机在 validMask 中置位
  * @return 是否成功
  */
-bool MotionController::getMotorParameters(int motorID, QMap<QString, float> &params)
+bool MotionController::getMotorParameters(const QList<int> &motorIDs, AxisStateArray &states)
 {
     QMutexLocker locker(&m_mutex);
     
@@ -181,42 +234,49 @@ bool MotionController::getMotorParameters(int motorID, QMap<QString, float> &par
         return false;
     }
     
+    for (int motorID : motorIDs) {
+        if (motorID < 0 || motorID >= MOTION_STATE_AXES) {
+            emit errorOccurred(QString("无效的电机ID: %1").arg(motorID));
+            return false;
+        }
+    }
+    
     // 如果是调试模式，返回模拟数据
     if (m_debugMode) {
-        params = generateDebugMotorParameters(motorID);
+        for (int motorID : motorIDs) {
+            states.axis[motorID] = generateDebugMotorParameters(motorID);
+            states.validMask |= 1u << motorID;
+        }
+        states.timeUs = sensorClockUs();
         return true;
     }
     
-    int iEN, iAType;
-    float fMPos, fDPos, fMVel, fDVel, fDAC, fUnit, fAcc, fDec;
-    
-    int ret = 0;
-    ret += ZAux_Direct_GetAtype(m_handle, motorID, &iAType);
-    ret += ZAux_Direct_GetAxisEnable(m_handle, motorID, &iEN);
-    ret += ZAux_Direct_GetDpos(m_handle, motorID, &fDPos);
-    ret += ZAux_Direct_GetMpos(m_handle, motorID, &fMPos);
-    ret += ZAux_Direct_GetSpeed(m_handle, motorID, &fDVel);
-    ret += ZAux_Direct_GetMspeed(m_handle, motorID, &fMVel);
-    ret += ZAux_Direct_GetUnits(m_handle, motorID, &fUnit);
-    ret += ZAux_Direct_GetAccel(m_handle, motorID, &fAcc);
-    ret += ZAux_Direct_GetDecel(m_handle, motorID, &fDec);
-    ret += ZAux_Direct_GetDAC(m_handle, motorID, &fDAC);
+    const int count = motorIDs.size() * AxisFieldCount;
+    QVarLengthArray<const char *, 256> names(count);
+    QVarLengthArray<int, 256> axes(count);
+    QVarLengthArray<float, 256> values(count);
+    for (int m = 0; m < motorIDs.size(); m++) {
+        for (int f = 0; f < AxisFieldCount; f++) {
+            names[m * AxisFieldCount + f] = axisStateParamName(f);
+            axes[m * AxisFieldCount + f] = motorIDs[m];
+        }
+    }
     
+    const qint64 t0 = sensorClockUs();
+    int ret = ZAux_Direct_GetParamBatch(m_handle, names.constData(), axes.constData(), count, values.data());
     if (ret != 0) {
-        logError(QString("获取电机 %1 参数").arg(motorID), ret);
+        logError(QString("批量获取电机参数 (%1 个电机)").arg(motorIDs.size()), ret);
         return false;
     }
     
-    params["EN"] = iEN;
-    params["MPos"] = fMPos;
-    params["Pos"] = fDPos;
-    params["MVel"] = fMVel;
-    params["Vel"] = fDVel;
-    params["DAC"] = fDAC;
-    params["Atype"] = iAType;
-    params["Unit"] = fUnit;
-    params["Acc"] = fAcc;
-    params["Dec"] = fDec;
+    for (int m = 0; m < motorIDs.size(); m++) {
+        AxisState &axis = states.axis[motorIDs[m]];
+        for (int f = 0; f < AxisFieldCount; f++) {
+            axisStateStore(axis, f, values[m * AxisFieldCount + f]);
+        }
+        states.validMask |= 1u << motorIDs[m];
+    }
+    states.timeUs = (t0 + sensorClockUs()) / 2;
     
     return true;
 }
@@ -325,135 +385,276 @@ bool MotionController::setMotorParameter(int motorID, const QString &paramName,
 }
 
 /**
- * @brief 移动电机到绝对位置
+ * @brief 移动电机到绝对位置并等待完成
  * @param motorID 电机ID
  * @param position 目标位置
  * @return 是否成功
  */
 bool MotionController::moveMotorAbsolute(int motorID, float position)
 {
-    QMutexLocker locker(&m_mutex);
-    
-    // 检查是否已连接
-    if (!m_connected) {
-        emit errorOccurred("未连接到控制器");
-        return false;
-    }
-    
-    // 调试模式下模拟操作
-    if (m_debugMode) {
-        QString motorName = getMotorName(motorID);
-        QString cmdStr = QString("MOVEABS(%1,%2)").arg(motorID).arg(position);
-        emit commandResponse(QString("调试模式: 电机%1(%2)移动到绝对位置%3").arg(motorID).arg(motorName).arg(position));
+    QFuture<bool> done = moveMotorAbsoluteAsync(motorID, position);
+    done.waitForFinished();
+    return done.result();
+}
+
+/**
+ * @brief 异步移动电机到绝对位置, 只在发送命令时持锁
+ * @param motorID 电机ID
+ * @param position 目标位置
+ * @param timeout 超时时间（毫秒）
+ * @return 运动完成令牌
+ */
+QFuture<bool> MotionController::moveMotorAbsoluteAsync(int motorID, float position, int timeout)
+{
+    {
+        QMutexLocker locker(&m_mutex);
         
-        // 生成并发送一个电机状态更新
-        QMap<QString, float> params = generateDebugMotorParameters(motorID);
-        params["dpos"] = position;  // 设置目标位置
-        params["mpos"] = position;  // 在调试模式下，假设立即达到目标位置
+        // 检查是否已连接
+        if (!m_connected) {
+            emit errorOccurred("未连接到控制器");
+            return finishedFuture(false);
+        }
         
-        // 更新成功，调用回调函数
-        if (m_callbacks.contains(motorID)) {
-            m_callbacks[motorID](motorID, params);
+        // 调试模式下模拟操作
+        if (m_debugMode) {
+            QString motorName = getMotorName(motorID);
+            emit commandResponse(QString("调试模式: 电机%1(%2)移动到绝对位置%3").arg(motorID).arg(motorName).arg(position));
+            
+            // 生成并发送一个电机状态更新
+            AxisState state = generateDebugMotorParameters(motorID);
+            state.dpos = position;  // 设置目标位置
+            state.mpos = position;  // 在调试模式下，假设立即达到目标位置
+            
+            // 更新成功，调用回调函数
+            if (m_callbacks.contains(motorID)) {
+                m_callbacks[motorID](motorID, state);
+            }
+            
+            emit motorStatusChanged(motorID, state);
+            return finishedFuture(true);
         }
         
-        emit motorStatusChanged(motorID, params);
-        return true;
-    }
-    
-    // 实际控制代码
-    QString cmdStr = QString("MOVEABS(%1,%2)").arg(motorID).arg(position);
-    
-    // 执行命令
-    bool success = executeCommand(cmdStr);
-    if (!success) {
-        emit errorOccurred(QString("移动电机%1到绝对位置%2失败").arg(motorID).arg(position));
-        return false;
-    }
-    
-    emit commandResponse(QString("电机%1(%2)开始移动到绝对位置%3").arg(motorID).arg(getMotorName(motorID)).arg(position));
-    
-    // 等待运动完成
-    if (!waitForMotionComplete(motorID)) {
-        emit errorOccurred(QString("电机%1(%2)移动到位置%3超时").arg(motorID).arg(getMotorName(motorID)).arg(position));
-        return false;
-    }
-    
-    // 检查是否到达目标位置
-    if (!isAtPosition(motorID, position)) {
-        emit errorOccurred(QString("电机%1(%2)未能精确到达目标位置%3").arg(motorID).arg(getMotorName(motorID)).arg(position));
-        return false;
+        // 实际控制代码
+        QString cmdStr = QString("MOVEABS(%1,%2)").arg(motorID).arg(position);
+        
+        // 执行命令
+        bool success = executeCommand(cmdStr);
+        if (!success) {
+            emit errorOccurred(QString("移动电机%1到绝对位置%2失败").arg(motorID).arg(position));
+            return finishedFuture(false);
+        }
+        
+        emit commandResponse(QString("电机%1(%2)开始移动到绝对位置%3").arg(motorID).arg(getMotorName(motorID)).arg(position));
     }
     
-    emit commandResponse(QString("电机%1(%2)已到达目标位置%3").arg(motorID).arg(getMotorName(motorID)).arg(position));
-    return true;
+    return motionCompletion(motorID, position, timeout);
 }
 
 /**
- * @brief 移动电机相对距离
+ * @brief 移动电机相对距离并等待完成
  * @param motorID 电机ID
  * @param distance 相对距离
  * @return 是否成功
  */
 bool MotionController::moveMotorRelative(int motorID, float distance)
 {
-    QMutexLocker locker(&m_mutex);
-    
-    // 检查是否已连接
-    if (!m_connected) {
-        emit errorOccurred("未连接到控制器");
-        return false;
-    }
-    
-    // 获取当前位置
-    float currentPosition = getCurrentPosition(motorID);
-    float targetPosition = currentPosition + distance;
-    
-    // 调试模式下模拟操作
-    if (m_debugMode) {
-        QString motorName = getMotorName(motorID);
-        QString cmdStr = QString("MOVE(%1,%2)").arg(motorID).arg(distance);
-        emit commandResponse(QString("调试模式: 电机%1(%2)相对移动%3").arg(motorID).arg(motorName).arg(distance));
+    QFuture<bool> done = moveMotorRelativeAsync(motorID, distance);
+    done.waitForFinished();
+    return done.result();
+}
+
+/**
+ * @brief 异步移动电机相对距离, 只在发送命令时持锁
+ * @param motorID 电机ID
+ * @param distance 相对距离
+ * @param timeout 超时时间（毫秒）
+ * @return 运动完成令牌
+ */
+QFuture<bool> MotionController::moveMotorRelativeAsync(int motorID, float distance, int timeout)
+{
+    float targetPosition = 0.0f;
+    {
+        QMutexLocker locker(&m_mutex);
         
-        // 生成并发送一个电机状态更新
-        QMap<QString, float> params = generateDebugMotorParameters(motorID);
-        params["dpos"] = targetPosition;  // 设置目标位置
-        params["mpos"] = targetPosition;  // 在调试模式下，假设立即达到目标位置
+        // 检查是否已连接
+        if (!m_connected) {
+            emit errorOccurred("未连接到控制器");
+            return finishedFuture(false);
+        }
         
-        // 更新成功，调用回调函数
-        if (m_callbacks.contains(motorID)) {
-            m_callbacks[motorID](motorID, params);
+        // 获取当前位置
+        float currentPosition = getCurrentPosition(motorID);
+        targetPosition = currentPosition + distance;
+        
+        // 调试模式下模拟操作
+        if (m_debugMode) {
+            QString motorName = getMotorName(motorID);
+            emit commandResponse(QString("调试模式: 电机%1(%2)相对移动%3").arg(motorID).arg(motorName).arg(distance));
+            
+            // 生成并发送一个电机状态更新
+            AxisState state = generateDebugMotorParameters(motorID);
+            state.dpos = targetPosition;  // 设置目标位置
+            state.mpos = targetPosition;  // 在调试模式下，假设立即达到目标位置
+            
+            // 更新成功，调用回调函数
+            if (m_callbacks.contains(motorID)) {
+                m_callbacks[motorID](motorID, state);
+            }
+            
+            emit motorStatusChanged(motorID, state);
+            return finishedFuture(true);
         }
         
-        emit motorStatusChanged(motorID, params);
-        return true;
+        // 实际控制代码
+        QString cmdStr = QString("MOVE(%1,%2)").arg(motorID).arg(distance);
+        
+        // 执行命令
+        bool success = executeCommand(cmdStr);
+        if (!success) {
+            emit errorOccurred(QString("移动电机%1相对距离%2失败").arg(motorID).arg(distance));
+            return finishedFuture(false);
+        }
+        
+        emit commandResponse(QString("电机%1(%2)开始相对移动%3").arg(motorID).arg(getMotorName(motorID)).arg(distance));
     }
     
-    // 实际控制代码
-    QString cmdStr = QString("MOVE(%1,%2)").arg(motorID).arg(distance);
-    
-    // 执行命令
-    bool success = executeCommand(cmdStr);
-    if (!success) {
-        emit errorOccurred(QString("移动电机%1相对距离%2失败").arg(motorID).arg(distance));
-        return false;
+    return motionCompletion(motorID, targetPosition, timeout);
+}
+
+/**
+ * @brief 生成运动完成令牌
+ *
+ * 统一轮询运行时登记到等待表, 由 onMotionState 根据快照判定, 不产生额外的控制器通信;
+ * 否则在线程池中查询, 每次查询只短暂持锁。
+ * @param motorID 电机ID
+ * @param targetPosition 目标位置
+ * @param timeout 超时时间（毫秒）
+ * @return 到位为 true, 超时或停在错误位置为 false
+ */
+QFuture<bool> MotionController::motionCompletion(int motorID, float targetPosition, int timeout)
+{
+    if (m_debugMode) {
+        return finishedFuture(true);
     }
     
-    emit commandResponse(QString("电机%1(%2)开始相对移动%3").arg(motorID).arg(getMotorName(motorID)).arg(distance));
+    if (!g_motionState || !g_motionState->isRunning()) {
+        return QtConcurrent::run([this, motorID, targetPosition, timeout]() {
+            if (!waitForMotionComplete(motorID, timeout)) {
+                emit errorOccurred(QString("电机%1(%2)移动到位置%3超时").arg(motorID).arg(getMotorName(motorID)).arg(targetPosition));
+                return false;
+            }
+            if (!isAtPosition(motorID, targetPosition)) {
+                emit errorOccurred(QString("电机%1(%2)未能精确到达目标位置%3").arg(motorID).arg(getMotorName(motorID)).arg(targetPosition));
+                return false;
+            }
+            emit commandResponse(QString("电机%1(%2)已到达目标位置%3").arg(motorID).arg(getMotorName(motorID)).arg(targetPosition));
+            return true;
+        });
+    }
+    
+    PendingMotion pending;
+    pending.target = targetPosition;
+    pending.issuedVersion = g_motionState->version();
+    pending.deadlineUs = sensorClockUs() + qint64(timeout) * 1000;
+    pending.promise.reportStarted();
+    QFuture<bool> future = pending.promise.future();
+    
+    QMutexLocker locker(&m_pendingMutex);
+    auto it = m_pendingMotions.find(motorID);
+    if (it != m_pendingMotions.end()) {
+        // 同一轴的新运动取代之前的等待
+        it->promise.reportResult(false);
+        it->promise.reportFinished();
+        m_pendingMotions.erase(it);
+    }
+    m_pendingMotions.insert(motorID, pending);
+    return future;
+}
+
+/**
+ * @brief 统一轮询的新快照: 判定等待中的运动是否完成, 并转发状态回调
+ * @param state 各轴状态
+ */
+void MotionController::onMotionState(const AxisStateArray &state)
+{
+    {
+        QMutexLocker locker(&m_pendingMutex);
+        for (auto it = m_pendingMotions.begin(); it != m_pendingMotions.end(); ) {
+            const int motorID = it.key();
+            PendingMotion &pending = it.value();
+            bool finished = false;
+            bool ok = false;
+            // 命令发出时可能已有一次读取在途, 至少等到其后的下一个周期
+            if (state.version >= pending.issuedVersion + 2 && state.isValid(motorID)
+                && state.axis[motorID].isIdle()) {
+                finished = true;
+                ok = std::abs(state.axis[motorID].mpos - pending.target) <= POSITION_TOLERANCE;
+                if (ok) {
+                    emit commandResponse(QString("电机%1(%2)已到达目标位置%3").arg(motorID).arg(getMotorName(motorID)).arg(pending.target));
+                } else {
+                    emit errorOccurred(QString("电机%1(%2)未能精确到达目标位置%3").arg(motorID).arg(getMotorName(motorID)).arg(pending.target));
+                }
+            } else if (state.timeUs > pending.deadlineUs) {
+                finished = true;
+                emit errorOccurred(QString("电机%1(%2)移动到位置%3超时").arg(motorID).arg(getMotorName(motorID)).arg(pending.target));
+            }
+            
+            if (finished) {
+                pending.promise.reportResult(ok);
+                pending.promise.reportFinished();
+                it = m_pendingMotions.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
     
-    // 等待运动完成
-    if (!waitForMotionComplete(motorID)) {
-        emit errorOccurred(QString("电机%1(%2)相对移动%3超时").arg(motorID).arg(getMotorName(motorID)).arg(distance));
-        return false;
+    QMetaObject::invokeMethod(this, [this, state]() {
+        dispatchMotorStatus(state);
+    }, Qt::QueuedConnection);
+}
+
+/**
+ * @brief 统一轮询读取失败: 只按截止时刻结束超时的等待
+ * @param timeUs 本周期时刻 (sensorClockUs)
+ */
+void MotionController::onMotionPollFailed(qint64 timeUs)
+{
+    QMutexLocker locker(&m_pendingMutex);
+    for (auto it = m_pendingMotions.begin(); it != m_pendingMotions.end(); ) {
+        if (timeUs <= it->deadlineUs) {
+            ++it;
+            continue;
+        }
+        const int motorID = it.key();
+        emit errorOccurred(QString("电机%1(%2)移动到位置%3超时 (状态读取失败)").arg(motorID).arg(getMotorName(motorID)).arg(it->target));
+        it->promise.reportResult(false);
+        it->promise.reportFinished();
+        it = m_pendingMotions.erase(it);
     }
+}
+
+/**
+ * @brief 把快照中的轴状态分发给注册的回调
+ * @param state 各轴状态
+ */
+void MotionController::dispatchMotorStatus(const AxisStateArray &state)
+{
+    QMutexLocker locker(&m_mutex);
     
-    // 检查是否到达目标位置
-    if (!isAtPosition(motorID, targetPosition)) {
-        emit errorOccurred(QString("电机%1(%2)未能精确到达目标位置%3").arg(motorID).arg(getMotorName(motorID)).arg(targetPosition));
-        return false;
+    if (!m_connected || m_debugMode) {
+        return;
     }
     
-    emit commandResponse(QString("电机%1(%2)已完成相对移动%3").arg(motorID).arg(getMotorName(motorID)).arg(distance));
-    return true;
+    emit motorStatesChanged(state);
+    for (auto it = m_callbacks.begin(); it != m_callbacks.end(); ++it) {
+        const int motorID = it.key();
+        if (!state.isValid(motorID)) {
+            continue;
+        }
+        emit motorStatusChanged(motorID, state.axis[motorID]);
+        it.value()(motorID, state.axis[motorID]);
+    }
 }
 
 /**
@@ -480,16 +681,16 @@ bool MotionController::stopMotor(int motorID, int stopMode)
                             .arg(stopMode == 0 ? "减速停止" : "紧急停止"));
         
         // 生成并发送一个电机状态更新
-        QMap<QString, float> params = generateDebugMotorParameters(motorID);
-        params["speed"] = 0.0;  // 设置目标速度为0
-        params["mspeed"] = 0.0; // 在调试模式下，假设立即停止
+        AxisState state = generateDebugMotorParameters(motorID);
+        state.speed = 0.0f;  // 设置目标速度为0
+        state.mspeed = 0.0f; // 在调试模式下，假设立即停止
         
         // 更新成功，调用回调函数
         if (m_callbacks.contains(motorID)) {
-            m_callbacks[motorID](motorID, params);
+            m_callbacks[motorID](motorID, state);
         }
         
-        emit motorStatusChanged(motorID, params);
+        emit motorStatusChanged(motorID, state);
         return true;
     }
     
@@ -622,6 +823,213 @@ bool MotionController::setZeroPosition(int motorID)
     return true;
 }
 
+/* ===================================== 多轴命令批 ===================================== */
+
+// 单次发送的命令串长度上限, 超过时分段发送
+static const int kBatchScriptLimit = 1000;
+
+static QString batchNumber(float value)
+{
+    return QString::number(value, 'f', 6);
+}
+
+MotionCommandBatch &MotionCommandBatch::setAtype(int axis, int atype)
+{
+    return add(QString("ATYPE(%1)=%2").arg(axis).arg(atype));
+}
+
+MotionCommandBatch &MotionCommandBatch::setDac(int axis, float value)
+{
+    return add(QString("DAC(%1)=%2").arg(axis).arg(batchNumber(value)));
+}
+
+MotionCommandBatch &MotionCommandBatch::setAxisEnable(int axis, bool enable)
+{
+    return add(QString("AXIS_ENABLE(%1)=%2").arg(axis).arg(enable ? 1 : 0));
+}
+
+MotionCommandBatch &MotionCommandBatch::setSpeed(int axis, float speed)
+{
+    return add(QString("SPEED(%1)=%2").arg(axis).arg(batchNumber(speed)));
+}
+
+MotionCommandBatch &MotionCommandBatch::setAccel(int axis, float accel)
+{
+    return add(QString("ACCEL(%1)=%2").arg(axis).arg(batchNumber(accel)));
+}
+
+MotionCommandBatch &MotionCommandBatch::setDecel(int axis, float decel)
+{
+    return add(QString("DECEL(%1)=%2").arg(axis).arg(batchNumber(decel)));
+}
+
+MotionCommandBatch &MotionCommandBatch::moveAbs(int axis, float position)
+{
+    return add(QString("MOVEABS(%1) AXIS(%2)").arg(batchNumber(position)).arg(axis));
+}
+
+MotionCommandBatch &MotionCommandBatch::move(int axis, float distance)
+{
+    return add(QString("MOVE(%1) AXIS(%2)").arg(batchNumber(distance)).arg(axis));
+}
+
+MotionCommandBatch &MotionCommandBatch::cancel(int axis, int mode)
+{
+    return add(QString("CANCEL(%1) AXIS(%2)").arg(mode).arg(axis));
+}
+
+MotionCommandBatch &MotionCommandBatch::rapidStop(int mode)
+{
+    return add(QString("RAPIDSTOP(%1)").arg(mode));
+}
+
+MotionCommandBatch &MotionCommandBatch::add(const QString &statement)
+{
+    m_commands.append(statement);
+    return *this;
+}
+
+/**
+ * @brief 用控制器句柄执行命令批
+ *
+ * 各条命令按行组成一个命令串, 每条之后打印其序号; 控制器遇到错误即停止执行,
+ * 应答中出现的序号即为执行成功的命令。命令串过长时分段发送, 某段失败后不再发送后续命令。
+ * @param handle 控制器句柄
+ * @param batch 命令批
+ * @return 执行结果
+ */
+MotionBatchResult MotionController::executeBatch(ZMC_HANDLE handle, const MotionCommandBatch &batch)
+{
+    MotionBatchResult result;
+    const QStringList &commands = batch.commands();
+    result.ok = QVector<bool>(commands.size(), false);
+    
+    if (handle == NULL) {
+        result.errorCode = ERR_AUX_PARAERR;
+        return result;
+    }
+    
+    char response[2048];
+    int next = 0;
+    while (next < commands.size()) {
+        // 组成一段命令串
+        QByteArray script;
+        int end = next;
+        while (end < commands.size()) {
+            const QByteArray line = commands[end].toLatin1() + "\n?" + QByteArray::number(end) + "\n";
+            if (!script.isEmpty() && script.size() + line.size() > kBatchScriptLimit) {
+                break;
+            }
+            script += line;
+            end++;
+        }
+        script.chop(1);
+        
+        response[0] = '\0';
+        const int ret = ZAux_Execute(handle, script.constData(), response, sizeof(response));
+        result.roundTrips++;
+        
+        // 应答中的序号对应执行成功的命令
+        const QList<QByteArray> tokens = QByteArray(response).simplified().split(' ');
+        for (const QByteArray &token : tokens) {
+            bool isNumber = false;
+            const int index = token.toInt(&isNumber);
+            if (isNumber && index >= next && index < end) {
+                result.ok[index] = true;
+            }
+        }
+        while (result.completed < commands.size() && result.ok[result.completed]) {
+            result.completed++;
+        }
+        
+        if (ret != ERR_OK) {
+            result.errorCode = ret;
+            break;
+        }
+        if (result.completed < end) {
+            result.errorCode = ERR_ACKERROR;
+            break;
+        }
+        next = end;
+    }
+    
+    return result;
+}
+
+/**
+ * @brief 用控制器句柄逐条执行命令批
+ *
+ * 每条命令单独发送, 某条失败后仍继续发送后续命令。用于停止等安全相关序列,
+ * 以及合并发送失败后的补发。
+ * @param handle 控制器句柄
+ * @param batch 命令批
+ * @return 执行结果, errorCode 为第一条失败命令的错误码
+ */
+MotionBatchResult MotionController::executeEach(ZMC_HANDLE handle, const MotionCommandBatch &batch)
+{
+    MotionBatchResult result;
+    const QStringList &commands = batch.commands();
+    result.ok = QVector<bool>(commands.size(), false);
+    
+    if (handle == NULL) {
+        result.errorCode = ERR_AUX_PARAERR;
+        return result;
+    }
+    
+    char response[256];
+    for (int i = 0; i < commands.size(); i++) {
+        response[0] = '\0';
+        const int ret = ZAux_Execute(handle, commands[i].toLatin1().constData(), response, sizeof(response));
+        result.roundTrips++;
+        result.ok[i] = (ret == ERR_OK);
+        if (ret != ERR_OK && result.errorCode == 0) {
+            result.errorCode = ret;
+        }
+    }
+    while (result.completed < commands.size() && result.ok[result.completed]) {
+        result.completed++;
+    }
+    
+    return result;
+}
+
+/**
+ * @brief 执行命令批
+ * @param batch 命令批
+ * @return 执行结果, 失败时记录第一条未执行成功的命令
+ */
+MotionBatchResult MotionController::executeBatch(const MotionCommandBatch &batch)
+{
+    QMutexLocker locker(&m_mutex);
+    
+    if (!m_connected) {
+        emit errorOccurred("未连接到控制器");
+        MotionBatchResult result;
+        result.errorCode = ERR_AUX_PARAERR;
+        result.ok = QVector<bool>(batch.size(), false);
+        return result;
+    }
+    
+    // 调试模式下模拟执行
+    if (m_debugMode) {
+        for (const QString &command : batch.commands()) {
+            logCommand(command);
+        }
+        MotionBatchResult result;
+        result.completed = batch.size();
+        result.ok = QVector<bool>(batch.size(), true);
+        return result;
+    }
+    
+    MotionBatchResult result = executeBatch(m_handle, batch);
+    if (!result.success()) {
+        logError(QString("执行命令批 (第%1/%2条: %3)")
+                 .arg(result.completed + 1).arg(batch.size())
+                 .arg(batch.commands().value(result.completed)), result.errorCode);
+    }
+    return result;
+}
+
 /**
  * @brief 暂停所有电机
  * @return 是否成功
@@ -747,13 +1155,13 @@ void MotionController::updateMotorStatus(int motorID)
         return;
     }
     
-    QMap<QString, float> params;
-    if (getMotorParameters(motorID, params)) {
+    AxisState state;
+    if (getMotorParameters(motorID, state)) {
         // 发出信号通知状态变化
-        emit motorStatusChanged(motorID, params);
+        emit motorStatusChanged(motorID, state);
         
         // 调用注册的回调函数
-        m_callbacks[motorID](motorID, params);
+        m_callbacks[motorID](motorID, state);
     }
 }
 
@@ -766,10 +1174,20 @@ void MotionController::updateAllMotorStatus()
         return;
     }
     
-    // 更新所有注册了回调的电机状态
+    // 更新所有注册了回调的电机状态, 一次读取全部电机
+    QMutexLocker locker(&m_mutex);
     QList<int> motorIDs = m_callbacks.keys();
+    if (motorIDs.isEmpty()) {
+        return;
+    }
+    AxisStateArray states;
+    if (!getMotorParameters(motorIDs, states)) {
+        return;
+    }
+    emit motorStatesChanged(states);
     foreach (int motorID, motorIDs) {
-        updateMotorStatus(motorID);
+        emit motorStatusChanged(motorID, states.axis[motorID]);
+        m_callbacks[motorID](motorID, states.axis[motorID]);
     }
 }
 
@@ -781,20 +1199,27 @@ void MotionController::onUpdateTimerTimeout()
     // 调试模式下，为每个电机生成模拟数据
     if (m_debugMode) {
         // 模拟更新所有电机状态
-        for (int motorID = 0; motorID <= 9; motorID++) {
-            QMap<QString, float> params = generateDebugMotorParameters(motorID);
+        AxisStateArray states;
+        states.timeUs = sensorClockUs();
+        for (int motorID = 0; motorID < MOTION_STATE_AXES; motorID++) {
+            states.axis[motorID] = generateDebugMotorParameters(motorID);
+            states.validMask |= 1u << motorID;
             
             // 更新成功，调用回调函数
             if (m_callbacks.contains(motorID)) {
-                m_callbacks[motorID](motorID, params);
+                m_callbacks[motorID](motorID, states.axis[motorID]);
             }
             
-            emit motorStatusChanged(motorID, params);
+            emit motorStatusChanged(motorID, states.axis[motorID]);
         }
+        emit motorStatesChanged(states);
         return;
     }
     
-    // 真实模式下，获取实际电机状态
+    // 真实模式下，统一轮询运行时由其快照分发状态，否则直接读取
+    if (g_motionState && g_motionState->isRunning()) {
+        return;
+    }
     updateAllMotorStatus();
 }
 
@@ -930,31 +1355,49 @@ QString MotionController::getMotorName(int motorID) const
 
 /**
  * @brief 等待电机运动完成
+ *
+ * 统一轮询运行时只查看快照, 否则每次查询控制器时短暂持锁, 等待期间不阻塞其他电机的命令。
  * @param motorID 电机ID
  * @param timeout 超时时间（毫秒）
  * @return 是否成功完成运动
  */
 bool MotionController::waitForMotionComplete(int motorID, int timeout)
 {
-    QMutexLocker locker(&m_mutex);
-    
-    if (!m_connected) {
-        emit errorOccurred(tr("控制器未连接"));
-        return false;
-    }
-    
-    // 调试模式下直接返回成功
-    if (m_debugMode) {
-        emit commandResponse(tr("调试模式: 电机 %1 (%2) 运动完成").arg(motorID).arg(getMotorName(motorID)));
-        return true;
+    {
+        QMutexLocker locker(&m_mutex);
+        
+        if (!m_connected) {
+            emit errorOccurred(tr("控制器未连接"));
+            return false;
+        }
+        
+        // 调试模式下直接返回成功
+        if (m_debugMode) {
+            emit commandResponse(tr("调试模式: 电机 %1 (%2) 运动完成").arg(motorID).arg(getMotorName(motorID)));
+            return true;
+        }
     }
     
     // 记录开始时间
     QElapsedTimer timer;
     timer.start();
+    const bool useSnapshot = g_motionState && g_motionState->isRunning();
+    const quint64 startVersion = useSnapshot ? g_motionState->version() : 0;
     
     // 循环检查运动是否完成
-    while (!checkEndMove(motorID)) {
+    for (;;) {
+        bool done = false;
+        if (useSnapshot) {
+            const AxisStateArray state = g_motionState->snapshot();
+            done = state.version >= startVersion + 2 && state.isValid(motorID) && state.axis[motorID].isIdle();
+        } else {
+            QMutexLocker locker(&m_mutex);
+            done = checkEndMove(motorID);
+        }
+        if (done) {
+            break;
+        }
+        
         // 检查是否超时
         if (timer.elapsed() > timeout) {
             emit errorOccurred(tr("等待电机 %1 (%2) 运动完成超时").arg(motorID).arg(getMotorName(motorID)));
@@ -1028,8 +1471,7 @@ float MotionController::getCurrentPosition(int motorID) const
     
     // 调试模式下返回模拟数据
     if (m_debugMode) {
-        QMap<QString, float> params = const_cast<MotionController*>(this)->generateDebugMotorParameters(motorID);
-        return params["mpos"];
+        return const_cast<MotionController*>(this)->generateDebugMotorParameters(motorID).mpos;
     }
     
     float position = 0.0f;
@@ -1055,8 +1497,7 @@ float MotionController::getTargetPosition(int motorID) const
     
     // 调试模式下返回模拟数据
     if (m_debugMode) {
-        QMap<QString, float> params = const_cast<MotionController*>(this)->generateDebugMotorParameters(motorID);
-        return params["dpos"];
+        return const_cast<MotionController*>(this)->generateDebugMotorParameters(motorID).dpos;
     }
     
     float position = 0.0f;
@@ -1074,11 +1515,12 @@ float MotionController::getTargetPosition(int motorID) const
  */
 bool MotionController::checkEndMove(int motorID) const
 {
-    float endMove = 0.0f;
-    if (ZAux_Direct_GetEndMove(m_handle, motorID, &endMove) != 0) {
+    // IDLE: -1 表示已停止, 0 表示运动中
+    int idle = 0;
+    if (ZAux_Direct_GetIfIdle(m_handle, motorID, &idle) != 0) {
         return false;
     }
-    return endMove != 0.0f;
+    return idle != 0;
 }
 
 /**
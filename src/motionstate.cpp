@@ -0,0 +1,130 @@
+#include "inc/motionstate.h"
+#include "inc/sensorclock.h"
+#include "inc/Global.h"
+
+#include <QDebug>
+
+MotionStateService *g_motionState = nullptr;
+
+static const char *const kFieldNames[AxisFieldCount] = {
+    "AXIS_ENABLE", "IDLE", "AXISSTATUS", "DPOS", "MPOS", "MSPEED", "DAC", "DRIVE_TORQUE",
+    "ATYPE", "UNITS", "SPEED", "ACCEL", "DECEL"
+};
+
+const char *axisStateParamName(int field)
+{
+    return (field >= 0 && field < AxisFieldCount) ? kFieldNames[field] : "";
+}
+
+void axisStateStore(AxisState &s, int field, float v)
+{
+    switch (field) {
+    case AxisFieldEnable:       s.enabled = qint32(v); break;
+    case AxisFieldIdle:         s.idle = qint32(v); break;
+    case AxisFieldAxisStatus:   s.axisStatus = qint32(v); break;
+    case AxisFieldDpos:         s.dpos = v; break;
+    case AxisFieldMpos:         s.mpos = v; break;
+    case AxisFieldMspeed:       s.mspeed = v; break;
+    case AxisFieldDac:          s.dac = v; break;
+    case AxisFieldDriveTorque:  s.driveTorque = v; break;
+    case AxisFieldAtype:        s.atype = qint32(v); break;
+    case AxisFieldUnits:        s.units = v; break;
+    case AxisFieldSpeed:        s.speed = v; break;
+    case AxisFieldAccel:        s.accel = v; break;
+    case AxisFieldDecel:        s.decel = v; break;
+    }
+}
+
+MotionStateService::MotionStateService(QObject *parent) : QObject(parent), m_running(false), m_version(0)
+{
+    qRegisterMetaType<AxisState>("AxisState");
+    qRegisterMetaType<AxisStateArray>("AxisStateArray");
+}
+
+MotionStateService::~MotionStateService()
+{
+}
+
+void MotionStateService::start()
+{
+    if (isRunning()) {
+        return;
+    }
+    if (!m_timer) {
+        m_timer = new QTimer(this);
+        m_timer->setTimerType(Qt::PreciseTimer);
+        connect(m_timer, &QTimer::timeout, this, &MotionStateService::poll);
+    }
+    m_cycle = 0;
+    m_timer->start(pollIntervalMs);
+    m_running.store(true, std::memory_order_release);
+}
+
+void MotionStateService::stop()
+{
+    if (!isRunning()) {
+        return;
+    }
+    m_timer->stop();
+    m_running.store(false, std::memory_order_release);
+}
+
+void MotionStateService::invalidate()
+{
+    // 下一次成功读取时附带读取静态参数
+    if (m_work.validMask != 0) {
+        m_work.validMask = 0;
+        m_state.store(m_work);
+    }
+    emit pollFailed(sensorClockUs());
+}
+
+void MotionStateService::poll()
+{
+    if (!g_handle) {
+        m_cycle = 0;
+        invalidate();
+        return;
+    }
+
+    // 首个周期及每 slowDivider 个周期附带读取静态参数
+    const bool slow = (m_cycle % qMax(1, slowDivider)) == 0 || m_work.validMask == 0;
+    const int fieldCount = slow ? int(AxisFieldCount) : int(AxisFieldFastCount);
+    const int count = fieldCount * MOTION_STATE_AXES;
+    m_names.resize(count);
+    m_axes.resize(count);
+    m_fields.resize(count);
+    m_values.resize(count);
+    int n = 0;
+    for (int axis = 0; axis < MOTION_STATE_AXES; axis++) {
+        for (int field = 0; field < fieldCount; field++) {
+            m_names[n] = kFieldNames[field];
+            m_axes[n] = axis;
+            m_fields[n] = field;
+            n++;
+        }
+    }
+
+    const qint64 t0 = sensorClockUs();
+    const int ret = ZAux_Direct_GetParamBatch(g_handle, m_names.constData(), m_axes.constData(), count, m_values.data());
+    if (ret != ERR_OK) {
+        if (m_cycle % 50 == 0) {
+            qDebug() << "MotionStateService: read failed, ret =" << ret;
+        }
+        m_cycle++;
+        invalidate();
+        return;
+    }
+    m_cycle++;
+
+    for (int i = 0; i < count; i++) {
+        axisStateStore(m_work.axis[m_axes[i]], m_fields[i], m_values[i]);
+    }
+    m_work.timeUs = (t0 + sensorClockUs()) / 2;
+    m_work.validMask = (1u << MOTION_STATE_AXES) - 1;
+    m_work.version = m_version.load(std::memory_order_relaxed) + 1;
+    m_state.store(m_work);
+    m_version.store(m_work.version, std::memory_order_release);
+
+    emit stateUpdated(m_work);
+}
@@ -30,6 +30,15 @@ motorpage::motorpage(QWidget *parent)
     // 连接信号到槽函数，用于处理从线程中读取到的参数数据
     connect(workthread, &ReadParamThread::paramsRead, this, &motorpage::onParamsRead);
 
+    // 控制器端 TABLE 缓冲的 1kHz 电机采样, 与统一轮询在同一线程中读取, 对控制器的访问不并发
+    if (g_motionState) {
+        g_axisTelemetry = new AxisTelemetry();
+        g_axisTelemetry->moveToThread(g_motionState->thread());
+        connect(g_motionState->thread(), &QThread::finished, g_axisTelemetry, &QObject::deleteLater);
+    } else {
+        g_axisTelemetry = new AxisTelemetry(this);
+    }
+
     for (int i = 0; i < 10; ++i) {
         qcustomplot[i] = this->findChild<QCustomPlot*>(QString("qcustomplot%1").arg(i+1));
         //这里可以对每个 QCustomPlot 对象进行其他初始化操作
@@ -64,6 +73,7 @@ motorpage::motorpage(QWidget *parent)
             ReadAlldataTimer->start();
 
             workthread->runStart = true;
+            QMetaObject::invokeMethod(g_axisTelemetry, "start", Qt::QueuedConnection);
 
             startTime = QDateTime::currentDateTime();
             currentRoundID++;
@@ -74,6 +84,7 @@ motorpage::motorpage(QWidget *parent)
         {
             ui->btn_testReadAll->setText("TestReadAll");
             workthread->runStart = false;
+            QMetaObject::invokeMethod(g_axisTelemetry, "stop", Qt::QueuedConnection);
             ReadAlldataTimer->stop();
             //workthread->exit();
 
@@ -149,6 +160,17 @@ motorpage::motorpage(QWidget *parent)
 
 motorpage::~motorpage()
 {
+    // 轮询线程退出时对象已随线程释放 (析构函数清空 g_axisTelemetry);
+    // 所在线程已停止时不能再阻塞调用
+    if (g_axisTelemetry) {
+        QThread *telemetryThread = g_axisTelemetry->thread();
+        if (telemetryThread == QThread::currentThread()) {
+            g_axisTelemetry->stop();
+        } else if (telemetryThread && telemetryThread->isRunning()) {
+            QMetaObject::invokeMethod(g_axisTelemetry, "stop", Qt::BlockingQueuedConnection);
+        }
+    }
+    g_axisTelemetry = nullptr;
     delete ui;
 }
 
@@ -0,0 +1,106 @@
+#include "inc/plotdecimator.h"
+
+#include <cmath>
+#include <limits>
+
+void MinMaxAccumulator::add(float v)
+{
+    if (count == 0) {
+        min = max = v;
+        minIdx = maxIdx = 0;
+    } else if (v < min) {
+        min = v;
+        minIdx = count;
+    } else if (v > max) {
+        max = v;
+        maxIdx = count;
+    }
+    count++;
+}
+
+MinMaxBucket MinMaxAccumulator::bucket() const
+{
+    MinMaxBucket b;
+    if (minIdx <= maxIdx) {
+        b.first = min;
+        b.second = max;
+    } else {
+        b.first = max;
+        b.second = min;
+    }
+    return b;
+}
+
+MinMaxDecimator::MinMaxDecimator()
+{
+}
+
+void MinMaxDecimator::begin(double t0, double t1, int pixels, double scale,
+                            QVector<double> *keys, QVector<double> *values)
+{
+    m_t0 = t0;
+    m_pixelSec = (t1 - t0) / qMax(1, pixels);
+    m_scale = scale;
+    m_keys = keys;
+    m_values = values;
+    m_keys->resize(0);
+    m_values->resize(0);
+    m_keys->reserve(2 * pixels + 2);
+    m_values->reserve(2 * pixels + 2);
+    m_acc.clear();
+    m_pixel = -1;
+    m_lo = std::numeric_limits<double>::max();
+    m_hi = std::numeric_limits<double>::lowest();
+    m_hasValue = false;
+}
+
+void MinMaxDecimator::add(double t, float first, float second)
+{
+    if (std::isnan(first) || std::isnan(second)) {
+        return;
+    }
+    const qint64 pixel = static_cast<qint64>(std::floor((t - m_t0) / m_pixelSec));
+    if (pixel != m_pixel) {
+        flush();
+        m_pixel = pixel;
+    }
+    m_acc.add(first);
+    if (second != first) {
+        m_acc.add(second);
+    }
+}
+
+void MinMaxDecimator::addBreak(double t)
+{
+    flush();
+    if (!m_values->isEmpty() && !std::isnan(m_values->last())) {
+        m_keys->append(t);
+        m_values->append(std::numeric_limits<double>::quiet_NaN());
+    }
+}
+
+int MinMaxDecimator::finish()
+{
+    flush();
+    return m_keys->size();
+}
+
+void MinMaxDecimator::flush()
+{
+    if (m_acc.count == 0) {
+        return;
+    }
+    const double x = m_t0 + m_pixel * m_pixelSec;
+    const MinMaxBucket b = m_acc.bucket();
+    m_keys->append(x);
+    m_values->append(b.first * m_scale);
+    if (m_acc.count > 1) {
+        // 每像素两个点, 保留像素内的峰值
+        m_keys->append(x + m_pixelSec / 2);
+        m_values->append(b.second * m_scale);
+    }
+    m_lo = qMin(m_lo, m_acc.min * m_scale);
+    m_hi = qMax(m_hi, m_acc.max * m_scale);
+    m_hasValue = true;
+    m_acc.clear();
+}
@@ -0,0 +1,147 @@
+#include "inc/realfft.h"
+
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define FFT_USE_SSE2 1
+#endif
+
+RealFFT::RealFFT(int size)
+{
+    if (size > 0) {
+        setSize(size);
+    }
+}
+
+bool RealFFT::setSize(int size)
+{
+    if (size < 8 || (size & (size - 1)) != 0) {
+        return false;
+    }
+    if (size == m_size) {
+        return true;
+    }
+
+    m_size = size;
+    m_half = size / 2;
+    const double pi = 3.14159265358979323846;
+
+    // 位反转下标
+    int bits = 0;
+    while ((1 << bits) < m_half) {
+        bits++;
+    }
+    m_bitrev.resize(m_half);
+    for (int i = 0; i < m_half; i++) {
+        int r = 0;
+        for (int b = 0; b < bits; b++) {
+            r |= ((i >> b) & 1) << (bits - 1 - b);
+        }
+        m_bitrev[i] = r;
+    }
+
+    // 第 len 级使用 exp(-2πij/len), j < len/2; 各级连续存放, 共 m_half-1 个
+    m_twRe.clear();
+    m_twIm.clear();
+    m_twRe.reserve(m_half);
+    m_twIm.reserve(m_half);
+    for (int len = 2; len <= m_half; len <<= 1) {
+        for (int j = 0; j < len / 2; j++) {
+            const double a = -2.0 * pi * j / len;
+            m_twRe.push_back(static_cast<float>(std::cos(a)));
+            m_twIm.push_back(static_cast<float>(std::sin(a)));
+        }
+    }
+
+    m_splitCos.resize(m_half + 1);
+    m_splitSin.resize(m_half + 1);
+    for (int k = 0; k <= m_half; k++) {
+        const double a = 2.0 * pi * k / m_size;
+        m_splitCos[k] = static_cast<float>(std::cos(a));
+        m_splitSin[k] = static_cast<float>(std::sin(a));
+    }
+
+    m_re.assign(m_half, 0.0f);
+    m_im.assign(m_half, 0.0f);
+    return true;
+}
+
+void RealFFT::complexTransform()
+{
+    float *re = m_re.data();
+    float *im = m_im.data();
+    const float *twRe = m_twRe.data();
+    const float *twIm = m_twIm.data();
+
+    for (int len = 2; len <= m_half; len <<= 1) {
+        const int half = len / 2;
+        for (int start = 0; start < m_half; start += len) {
+            float *ar = re + start;
+            float *ai = im + start;
+            float *br = ar + half;
+            float *bi = ai + half;
+            int j = 0;
+#ifdef FFT_USE_SSE2
+            for (; j + 3 < half; j += 4) {
+                const __m128 wr = _mm_loadu_ps(twRe + j);
+                const __m128 wi = _mm_loadu_ps(twIm + j);
+                const __m128 xr = _mm_loadu_ps(br + j);
+                const __m128 xi = _mm_loadu_ps(bi + j);
+                const __m128 tr = _mm_sub_ps(_mm_mul_ps(xr, wr), _mm_mul_ps(xi, wi));
+                const __m128 ti = _mm_add_ps(_mm_mul_ps(xr, wi), _mm_mul_ps(xi, wr));
+                const __m128 ur = _mm_loadu_ps(ar + j);
+                const __m128 ui = _mm_loadu_ps(ai + j);
+                _mm_storeu_ps(br + j, _mm_sub_ps(ur, tr));
+                _mm_storeu_ps(bi + j, _mm_sub_ps(ui, ti));
+                _mm_storeu_ps(ar + j, _mm_add_ps(ur, tr));
+                _mm_storeu_ps(ai + j, _mm_add_ps(ui, ti));
+            }
+#endif
+            for (; j < half; j++) {
+                const float tr = br[j] * twRe[j] - bi[j] * twIm[j];
+                const float ti = br[j] * twIm[j] + bi[j] * twRe[j];
+                br[j] = ar[j] - tr;
+                bi[j] = ai[j] - ti;
+                ar[j] += tr;
+                ai[j] += ti;
+            }
+        }
+        twRe += half;
+        twIm += half;
+    }
+}
+
+void RealFFT::powerSpectrum(const float *in, float *power)
+{
+    if (m_size == 0) {
+        return;
+    }
+
+    // 偶数点作实部, 奇数点作虚部, 按位反转顺序装入
+    for (int i = 0; i < m_half; i++) {
+        const int r = m_bitrev[i];
+        m_re[r] = in[2 * i];
+        m_im[r] = in[2 * i + 1];
+    }
+    complexTransform();
+
+    // 拆分: X_k = (Z_k + conj(Z_{M-k}))/2 - i*e^{-2πik/N} * (Z_k - conj(Z_{M-k}))/2
+    for (int k = 0; k <= m_half; k++) {
+        const int a = (k == m_half) ? 0 : k;
+        const int b = (k == 0) ? 0 : m_half - k;
+        const float zr = m_re[a];
+        const float zi = m_im[a];
+        const float cr = m_re[b];
+        const float ci = -m_im[b];
+        const float er = 0.5f * (zr + cr);
+        const float ei = 0.5f * (zi + ci);
+        const float dr = 0.5f * (zi - ci);          // (Z_k - conj(Z_{M-k})) / 2i 的实部
+        const float di = -0.5f * (zr - cr);         // 虚部
+        const float c = m_splitCos[k];
+        const float s = m_splitSin[k];
+        const float xr = er + dr * c + di * s;
+        const float xi = ei + di * c - dr * s;
+        power[k] = xr * xr + xi * xi;
+    }
+}
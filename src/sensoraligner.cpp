@@ -0,0 +1,121 @@
+#include "inc/sensoraligner.h"
+
+#include <QMutexLocker>
+#include <QDebug>
+
+SensorAligner *g_sensorAligner = nullptr;
+
+SensorAligner::SensorAligner(QObject *parent) : QObject(parent)
+{
+    qRegisterMetaType<SensorFrame>("SensorFrame");
+}
+
+void SensorAligner::push(int channel, qint64 timeUs, double value)
+{
+    if (channel < 0 || channel >= SensorChannelCount) {
+        return;
+    }
+    QMutexLocker locker(&mutex);
+    History &h = histories[channel];
+    h.samples[h.head] = {timeUs, value};
+    h.head = (h.head + 1) % SENSOR_HISTORY_SIZE;
+    if (h.count < SENSOR_HISTORY_SIZE) {
+        h.count++;
+    }
+}
+
+void SensorAligner::push(int firstChannel, const float *values, int count, qint64 timeUs)
+{
+    if (firstChannel < 0 || count <= 0 || firstChannel + count > SensorChannelCount) {
+        return;
+    }
+    QMutexLocker locker(&mutex);
+    for (int i = 0; i < count; i++) {
+        History &h = histories[firstChannel + i];
+        h.samples[h.head] = {timeUs, values[i]};
+        h.head = (h.head + 1) % SENSOR_HISTORY_SIZE;
+        if (h.count < SENSOR_HISTORY_SIZE) {
+            h.count++;
+        }
+    }
+}
+
+void SensorAligner::start()
+{
+    // 定时器在对齐线程中创建, 帧生成不受界面线程阻塞的影响
+    if (!timer) {
+        timer = new QTimer(this);
+        timer->setTimerType(Qt::PreciseTimer);
+        connect(timer, &QTimer::timeout, this, &SensorAligner::onTick);
+    }
+    nextFrameUs = 0;
+    timer->start(framePeriodMs);
+    qDebug() << "Sensor aligner started, period" << framePeriodMs << "ms, latency" << latencyMs << "ms";
+}
+
+void SensorAligner::stop()
+{
+    if (timer) {
+        timer->stop();
+    }
+}
+
+SensorFrame SensorAligner::latestFrame() const
+{
+    QMutexLocker locker(&mutex);
+    return latest;
+}
+
+bool SensorAligner::valueAt(const History &history, qint64 timeUs, double *value) const
+{
+    // 从最新的采样往回找, 第一个不晚于帧时刻的采样为 before, 其后一个为 after
+    const Sample *after = nullptr;
+    for (int k = 1; k <= history.count; k++) {
+        const Sample &s = history.samples[(history.head - k + SENSOR_HISTORY_SIZE) % SENSOR_HISTORY_SIZE];
+        if (s.timeUs > timeUs) {
+            after = &s;
+            continue;
+        }
+        if (after && after->timeUs > s.timeUs && after->timeUs - s.timeUs <= qint64(staleMs) * 1000) {
+            // 两侧都有采样且间隔未超过过期时间, 线性插值; 跨越更长断点时按只有更早的采样处理
+            const double w = double(timeUs - s.timeUs) / double(after->timeUs - s.timeUs);
+            *value = s.value + (after->value - s.value) * w;
+            return true;
+        }
+        // 只有更早的采样, 未过期时保持最近值
+        if (timeUs - s.timeUs <= qint64(staleMs) * 1000) {
+            *value = s.value;
+            return true;
+        }
+        return false;
+    }
+    // 所有采样都晚于帧时刻 (刚开始采集), 没有可用的值
+    return false;
+}
+
+void SensorAligner::onTick()
+{
+    const qint64 periodUs = qint64(qMax(1, framePeriodMs)) * 1000;
+    const qint64 targetUs = sensorClockUs() - qint64(latencyMs) * 1000;
+
+    // 帧时刻落在周期的整数倍上; 首次运行或长时间阻塞后直接跳到当前时刻
+    if (nextFrameUs == 0 || targetUs - nextFrameUs > 10 * periodUs) {
+        nextFrameUs = (targetUs / periodUs) * periodUs;
+    }
+
+    while (nextFrameUs <= targetUs) {
+        SensorFrame frame;
+        frame.timeUs = nextFrameUs;
+        {
+            QMutexLocker locker(&mutex);
+            for (int ch = 0; ch < SensorChannelCount; ch++) {
+                if (valueAt(histories[ch], nextFrameUs, &frame.values[ch])) {
+                    frame.validMask |= quint64(1) << ch;
+                }
+            }
+            latest = frame;
+        }
+        emit frameReady(frame);
+        nextFrameUs += periodUs;
+    }
+}
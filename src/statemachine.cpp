@@ -10,6 +10,11 @@ StateMachine* State::getMachine() const {
 // StateMachine 类实现
 StateMachine::StateMachine(QObject *parent)
     : QObject(parent)
+    , m_hasTransitions(false)
+    , m_tableValid(true)
+    , m_currentState(INVALID_STATE)
+    , m_current(nullptr)
+    , m_initialState(INVALID_STATE)
     , m_isRunning(false)
     , m_isPaused(false)
 {
@@ -22,26 +27,99 @@ StateMachine::~StateMachine() {
     logDebug("状态机销毁");
 }
 
-void StateMachine::addState(const QString& stateName, std::shared_ptr<State> state) {
-    if (m_states.contains(stateName)) {
-        logWarning(QString("状态 '%1' 已存在，将被覆盖").arg(stateName));
+bool StateMachine::addState(StateId id, const QString& stateName, std::shared_ptr<State> state) {
+    if (id < 0 || id >= MAX_STATES) {
+        logError(QString("添加状态失败：状态编号 %1 超出范围 (0 ~ %2)").arg(id).arg(MAX_STATES - 1));
+        return false;
+    }
+    if (m_states.size() <= id) {
+        m_states.resize(id + 1);
+    }
+    if (m_states[id].state) {
+        logWarning(QString("状态 %1 '%2' 已存在，将被 '%3' 覆盖").arg(id).arg(m_states[id].name).arg(stateName));
+    }
+    m_states[id].name = stateName;
+    m_states[id].state = state;
+    logDebug(QString("添加状态: %1 (%2)").arg(stateName).arg(id));
+    return true;
+}
+
+bool StateMachine::addTransition(StateId from, StateId to, TransitionGuard guard) {
+    if (from < 0 || from >= MAX_STATES || to < 0 || to >= MAX_STATES) {
+        logError(QString("添加转换失败：状态编号超出范围 (%1 -> %2)").arg(from).arg(to));
+        return false;
+    }
+    if (m_states.size() <= qMax(from, to)) {
+        m_states.resize(qMax(from, to) + 1);
+    }
+    StateEntry& entry = m_states[from];
+    entry.transitions |= quint64(1) << to;
+    if (guard) {
+        if (entry.guards.isEmpty()) {
+            entry.guards.resize(MAX_STATES);
+        }
+        entry.guards[to] = guard;
+    }
+    m_hasTransitions = true;
+    return true;
+}
+
+/**
+ * @brief 检查状态表: 编号连续且都已添加, 转换两端都存在, 初始状态已设置,
+ *        所有状态都可从初始状态到达。在构造完成后调用一次。
+ * @return 表是否有效
+ */
+bool StateMachine::validateStateTable() {
+    bool valid = true;
+    for (int id = 0; id < m_states.size(); id++) {
+        if (!m_states[id].state) {
+            logError(QString("状态表无效：状态编号 %1 未添加状态").arg(id));
+            valid = false;
+        }
+    }
+    if (!hasState(m_initialState)) {
+        logError("状态表无效：未设置初始状态");
+        valid = false;
+    }
+    m_tableValid = valid;
+    if (!valid || !m_hasTransitions) {
+        return valid;
     }
-    m_states[stateName] = state;
-    logDebug(QString("添加状态: %1").arg(stateName));
+
+    // 从初始状态出发的可达集合
+    quint64 reached = quint64(1) << m_initialState;
+    quint64 frontier = reached;
+    while (frontier) {
+        quint64 next = 0;
+        for (int id = 0; id < m_states.size(); id++) {
+            if (frontier & (quint64(1) << id)) {
+                next |= m_states[id].transitions;
+            }
+        }
+        frontier = next & ~reached;
+        reached |= next;
+    }
+    for (int id = 0; id < m_states.size(); id++) {
+        if (!(reached & (quint64(1) << id))) {
+            logWarning(QString("状态 '%1' 无法从初始状态 '%2' 到达").arg(m_states[id].name).arg(m_states[m_initialState].name));
+        }
+    }
+    return valid;
 }
 
-void StateMachine::setInitialState(const QString& stateName) {
-    if (!m_states.contains(stateName)) {
-        logError(QString("设置初始状态失败：状态 '%1' 不存在").arg(stateName));
+void StateMachine::setInitialState(StateId id) {
+    if (!hasState(id)) {
+        logError(QString("设置初始状态失败：状态 %1 不存在").arg(id));
         return;
     }
-    m_initialStateName = stateName;
-    logInfo(QString("设置初始状态: %1").arg(stateName));
+    m_initialState = id;
+    logInfo(QString("设置初始状态: %1").arg(m_states[id].name));
 }
 
-bool StateMachine::changeState(const QString& stateName) {
-    if (!m_states.contains(stateName)) {
-        logError(QString("状态切换失败：目标状态 '%1' 不存在").arg(stateName));
+bool StateMachine::changeState(StateId id) {
+    QMutexLocker locker(&m_mutex);
+    if (!hasState(id)) {
+        logError(QString("状态切换失败：目标状态 %1 不存在").arg(id));
         return false;
     }
 
@@ -55,112 +133,184 @@ bool StateMachine::changeState(const QString& stateName) {
         return false;
     }
 
-    QString oldState = m_currentStateName;
-    
+    const StateId oldState = m_currentState.load(std::memory_order_relaxed);
+    const QString& newName = m_states[id].name;
+    const QString oldName = stateName(oldState);
+
+    // 转换表与守卫条件 (从无状态进入初始状态时不检查)
+    if (oldState != INVALID_STATE && !canTransition(oldState, id)) {
+        logWarning(QString("状态切换被转换表拒绝: %1 -> %2").arg(oldName).arg(newName));
+        return false;
+    }
+
     // 调用状态切换前的钩子
-    if (!beforeStateChange(oldState, stateName)) {
-        logWarning(QString("状态切换被阻止: %1 -> %2").arg(oldState).arg(stateName));
+    if (!beforeStateChange(oldState, id)) {
+        logWarning(QString("状态切换被阻止: %1 -> %2").arg(oldName).arg(newName));
         return false;
     }
 
     // 退出当前状态
-    if (!oldState.isEmpty() && m_states.contains(oldState)) {
-        m_states[oldState]->exit();
+    if (m_current) {
+        m_current->exit();
     }
 
     // 更新当前状态
-    m_currentStateName = stateName;
-    
+    m_current = m_states[id].state.get();
+    m_currentState.store(id, std::memory_order_release);
+
     // 进入新状态
-    if (m_states.contains(m_currentStateName)) {
-        m_states[m_currentStateName]->enter();
-    }
+    m_current->enter();
 
     // 调用状态切换后的钩子
-    afterStateChange(oldState, stateName);
+    afterStateChange(oldState, id);
 
     // 发送状态改变信号
-    emit stateChanged(oldState, stateName);
-    logInfo(QString("状态切换完成: %1 -> %2").arg(oldState).arg(stateName));
-    
+    emit stateIdChanged(oldState, id);
+    emit stateChanged(oldName, newName);
+    logInfo(QString("状态切换完成: %1 -> %2").arg(oldName).arg(newName));
+
     return true;
 }
 
+bool StateMachine::changeState(const QString& stateName) {
+    const StateId id = stateId(stateName);
+    if (id == INVALID_STATE) {
+        logError(QString("状态切换失败：目标状态 '%1' 不存在").arg(stateName));
+        return false;
+    }
+    return changeState(id);
+}
+
+StateMachine::StateId StateMachine::getCurrentStateId() const {
+    return m_currentState.load(std::memory_order_acquire);
+}
+
 QString StateMachine::getCurrentStateName() const {
-    return m_currentStateName;
+    return stateName(getCurrentStateId());
 }
 
 std::shared_ptr<State> StateMachine::getCurrentState() const {
-    return m_states.value(m_currentStateName);
+    const StateId id = getCurrentStateId();
+    return hasState(id) ? m_states[id].state : std::shared_ptr<State>();
+}
+
+void StateMachine::update() {
+    // 其他线程正在切换或启停时跳过本周期
+    if (!m_mutex.tryLock()) {
+        return;
+    }
+    if (m_isRunning && !m_isPaused && m_current) {
+        m_current->update();
+    }
+    m_mutex.unlock();
+}
+
+StateMachine::StateId StateMachine::stateId(const QString& stateName) const {
+    for (int id = 0; id < m_states.size(); id++) {
+        if (m_states[id].state && m_states[id].name == stateName) {
+            return id;
+        }
+    }
+    return INVALID_STATE;
+}
+
+QString StateMachine::stateName(StateId id) const {
+    return hasState(id) ? m_states[id].name : QString();
+}
+
+bool StateMachine::hasState(StateId id) const {
+    return id >= 0 && id < m_states.size() && m_states[id].state;
+}
+
+bool StateMachine::canTransition(StateId from, StateId to) const {
+    if (!hasState(from) || !hasState(to)) {
+        return false;
+    }
+    if (!m_hasTransitions) {
+        return true;
+    }
+    const StateEntry& entry = m_states[from];
+    if (!(entry.transitions & (quint64(1) << to))) {
+        return false;
+    }
+    return entry.guards.isEmpty() || !entry.guards[to] || entry.guards[to]();
 }
 
 bool StateMachine::start() {
+    QMutexLocker locker(&m_mutex);
     if (m_isRunning) {
         logWarning("状态机已在运行中");
         return false;
     }
 
-    if (m_initialStateName.isEmpty()) {
+    if (!hasState(m_initialState)) {
         logError("未设置初始状态，无法启动状态机");
         return false;
     }
 
+    if (!m_tableValid) {
+        logError("状态表无效，无法启动状态机");
+        return false;
+    }
+
     m_isRunning = true;
     m_isPaused = false;
-    
+
     // 进入初始状态
-    if (!changeState(m_initialStateName)) {
+    if (!changeState(m_initialState)) {
         m_isRunning = false;
         logError("无法进入初始状态");
         return false;
     }
 
-    // 确保当前状态被正确设置
-    if (m_currentStateName.isEmpty()) {
-        m_currentStateName = m_initialStateName;
-        if (m_states.contains(m_currentStateName)) {
-            m_states[m_currentStateName]->enter();
-        }
-    }
-
     emit machineStarted();
-    logInfo(QString("状态机启动，当前状态: %1").arg(m_currentStateName));
+    logInfo(QString("状态机启动，当前状态: %1").arg(getCurrentStateName()));
     return true;
 }
 
 void StateMachine::stop() {
+    QMutexLocker locker(&m_mutex);
     if (!m_isRunning) {
         return;
     }
 
     // 退出当前状态
-    if (!m_currentStateName.isEmpty() && m_states.contains(m_currentStateName)) {
-        m_states[m_currentStateName]->exit();
+    if (m_current) {
+        m_current->exit();
     }
 
     m_isRunning = false;
     m_isPaused = false;
-    m_currentStateName.clear();
+    m_current = nullptr;
+    m_currentState.store(INVALID_STATE, std::memory_order_release);
 
     emit machineStopped();
     logInfo("状态机停止");
 }
 
 void StateMachine::pause() {
+    QMutexLocker locker(&m_mutex);
     if (!m_isRunning || m_isPaused) {
         return;
     }
 
     m_isPaused = true;
+    if (m_current) {
+        m_current->pause();
+    }
     emit machinePaused();
     logInfo("状态机暂停");
 }
 
 void StateMachine::resume() {
+    QMutexLocker locker(&m_mutex);
     if (!m_isRunning || !m_isPaused) {
         return;
     }
 
+    if (m_current) {
+        m_current->resume();
+    }
     m_isPaused = false;
     emit machineResumed();
     logInfo("状态机恢复");
@@ -168,17 +318,17 @@ void StateMachine::resume() {
 
 void StateMachine::reset() {
     stop();
-    
+
     // 确保有初始状态
-    if (!m_initialStateName.isEmpty()) {
+    if (hasState(m_initialState)) {
         // 重新启动状态机
         if (start()) {
-            logInfo(QString("状态机重置成功，当前状态: %1").arg(m_currentStateName));
+            logInfo(QString("状态机重置成功，当前状态: %1").arg(getCurrentStateName()));
         } else {
             logError("状态机重置失败");
         }
     }
-    
+
     emit machineReset();
 }
 
@@ -190,13 +340,13 @@ bool StateMachine::isPaused() const {
     return m_isPaused;
 }
 
-bool StateMachine::beforeStateChange(const QString& oldState, const QString& newState) {
+bool StateMachine::beforeStateChange(StateId oldState, StateId newState) {
     Q_UNUSED(oldState);
     Q_UNUSED(newState);
     return true;
 }
 
-void StateMachine::afterStateChange(const QString& oldState, const QString& newState) {
+void StateMachine::afterStateChange(StateId oldState, StateId newState) {
     Q_UNUSED(oldState);
     Q_UNUSED(newState);
 }
@@ -220,4 +370,4 @@ void StateMachine::logInfo(const QString& message) {
 void StateMachine::logDebug(const QString& message) {
     qDebug() << "[DEBUG]" << message;
     emit debug(message);
-} 
\ No newline at end of file
+}
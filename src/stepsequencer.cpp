@@ -0,0 +1,199 @@
+#include "inc/stepsequencer.h"
+#include "inc/sensorclock.h"
+
+#include <QDebug>
+
+/* ===================================== Step ===================================== */
+
+StepSequencer::Step &StepSequencer::Step::parallel()
+{
+    m_deps = m_index > 0 ? m_owner->m_steps[m_index - 1].m_deps : 0;
+    return *this;
+}
+
+StepSequencer::Step &StepSequencer::Step::after(std::initializer_list<int> steps)
+{
+    m_deps = 0;
+    for (int s : steps) {
+        if (s < 0 || s >= m_index) {
+            qDebug() << QString("[%1] 步骤 '%2' 的前置步骤 %3 无效").arg(m_owner->m_name).arg(m_name).arg(s);
+            continue;
+        }
+        m_deps |= quint64(1) << s;
+    }
+    return *this;
+}
+
+/* ===================================== StepSequencer ===================================== */
+
+StepSequencer::StepSequencer(const QString &name)
+    : m_name(name), m_pauseStartUs(0), m_pausedTotalUs(0), m_rearm(false)
+{
+    // 预留容量, addStep() 返回的引用不因扩容失效
+    m_steps.reserve(MAX_STEPS);
+}
+
+StepSequencer::Step &StepSequencer::addStep(const QString &name)
+{
+    if (m_steps.size() >= MAX_STEPS) {
+        qDebug() << QString("[%1] 步骤数超过上限 %2, 忽略 '%3'").arg(m_name).arg(MAX_STEPS).arg(name);
+        return m_steps.last();
+    }
+    Step step;
+    step.m_name = name;
+    step.m_owner = this;
+    step.m_index = m_steps.size();
+    step.m_deps = step.m_index > 0 ? quint64(1) << (step.m_index - 1) : 0;
+    m_steps.append(step);
+    return m_steps.last();
+}
+
+void StepSequencer::clear()
+{
+    m_steps.clear();
+    reset();
+}
+
+void StepSequencer::reset()
+{
+    for (Step &step : m_steps) {
+        step.m_status = Step::Pending;
+        step.m_startUs = 0;
+    }
+    m_doneMask = 0;
+    m_busy = 0;
+    m_failedStep = -1;
+    m_result = Running;
+    m_pauseStartUs.store(0, std::memory_order_relaxed);
+    m_pausedTotalUs.store(0, std::memory_order_relaxed);
+    m_rearm.store(false, std::memory_order_release);
+}
+
+qint64 StepSequencer::activeClockUs() const
+{
+    return sensorClockUs() - m_pausedTotalUs.load(std::memory_order_acquire);
+}
+
+/**
+ * @brief 开始或重试一步: 首次进入时占用机构并上报, 动作被拒绝时停在 Starting 下周期重试
+ * @return 动作是否已被接受
+ */
+bool StepSequencer::startStep(Step &step, qint64 nowUs)
+{
+    if (step.m_status == Step::Pending) {
+        step.m_status = Step::Starting;
+        step.m_startUs = nowUs;
+        m_busy |= step.m_resources;
+        if (step.m_announce && m_callback) {
+            m_callback(step.m_name);
+        }
+    }
+    if (step.m_action && !step.m_action()) {
+        return false;
+    }
+    step.m_status = Step::Running;
+    return true;
+}
+
+StepSequencer::Result StepSequencer::tick()
+{
+    if (m_steps.isEmpty()) {
+        return Finished;
+    }
+    if (m_pauseStartUs.load(std::memory_order_acquire) != 0) {
+        return m_result;
+    }
+
+    const qint64 now = activeClockUs();
+    if (m_rearm.exchange(false, std::memory_order_acq_rel)) {
+        // 恢复后未完成的步骤重新计时, 超时失败的步骤继续等待
+        for (Step &step : m_steps) {
+            if (step.m_status == Step::Starting || step.m_status == Step::Running) {
+                step.m_startUs = now;
+            }
+        }
+        if (m_result == Failed) {
+            qDebug() << QString("[%1] 恢复, 继续等待步骤 '%2'").arg(m_name).arg(m_steps[m_failedStep].m_name);
+            m_failedStep = -1;
+            m_result = Running;
+        }
+    }
+    if (m_result != Running) {
+        return m_result;
+    }
+
+    // 步骤完成后在同一周期内启动后续步骤, 直到没有新的进展
+    bool progressed = true;
+    while (progressed) {
+        progressed = false;
+
+        for (Step &step : m_steps) {
+            if (step.m_status == Step::Pending || step.m_status == Step::Done) {
+                continue;
+            }
+            if (step.m_status == Step::Starting && !startStep(step, now)) {
+                // 动作仍未被接受
+            } else if (!step.m_done || step.m_done()) {
+                step.m_status = Step::Done;
+                m_doneMask |= quint64(1) << step.m_index;
+                m_busy &= ~step.m_resources;
+                progressed = true;
+                continue;
+            }
+            if (step.m_timeoutUs > 0 && now - step.m_startUs > step.m_timeoutUs) {
+                m_failedStep = step.m_index;
+                m_result = Failed;
+                qDebug() << QString("[%1] 步骤 '%2' 超时 (%3 ms)").arg(m_name).arg(step.m_name).arg(step.m_timeoutUs / 1000);
+                return m_result;
+            }
+        }
+
+        for (Step &step : m_steps) {
+            if (step.m_status != Step::Pending) {
+                continue;
+            }
+            if ((step.m_deps & ~m_doneMask) != 0 || (step.m_resources & m_busy) != 0) {
+                continue;
+            }
+            startStep(step, now);
+            progressed = true;
+        }
+    }
+
+    if (m_doneMask == (m_steps.size() == MAX_STEPS ? ~quint64(0) : (quint64(1) << m_steps.size()) - 1)) {
+        m_result = Finished;
+    }
+    return m_result;
+}
+
+void StepSequencer::pause()
+{
+    qint64 expected = 0;
+    m_pauseStartUs.compare_exchange_strong(expected, sensorClockUs(), std::memory_order_acq_rel);
+}
+
+void StepSequencer::resume()
+{
+    const qint64 start = m_pauseStartUs.load(std::memory_order_acquire);
+    if (start != 0) {
+        m_pausedTotalUs.fetch_add(sensorClockUs() - start, std::memory_order_acq_rel);
+    }
+    m_rearm.store(true, std::memory_order_release);
+    m_pauseStartUs.store(0, std::memory_order_release);
+}
+
+QString StepSequencer::failedStep() const
+{
+    return m_failedStep >= 0 ? m_steps[m_failedStep].m_name : QString();
+}
+
+QStringList StepSequencer::runningSteps() const
+{
+    QStringList names;
+    for (const Step &step : m_steps) {
+        if (step.m_status == Step::Starting || step.m_status == Step::Running) {
+            names << step.m_name;
+        }
+    }
+    return names;
+}
@@ -0,0 +1,271 @@
+#include "inc/vibrationanalyzer.h"
+#include "inc/sensoraligner.h"
+
+#include <QThread>
+#include <QDebug>
+#include <cmath>
+#include <cstring>
+
+VibrationAnalyzer::VibrationAnalyzer(QObject *parent) : QObject(parent),
+    roundChanged(0),
+    shouldStop(0)
+{
+    qRegisterMetaType<VibFeatureFrame>("VibFeatureFrame");
+}
+
+VibrationAnalyzer::~VibrationAnalyzer()
+{
+    requestStop();
+}
+
+void VibrationAnalyzer::setRingBuffer(const std::shared_ptr<DAQRingBuffer> &ringBuffer)
+{
+    ring = ringBuffer;
+    consumerId = ring ? ring->addConsumer("analysis") : -1;
+}
+
+void VibrationAnalyzer::beginRound(int newRoundId, int newSampleRate)
+{
+    QMutexLocker locker(&roundMutex);
+    pendingRoundId = newRoundId;
+    pendingSampleRate = newSampleRate;
+    roundChanged.storeRelease(1);
+}
+
+void VibrationAnalyzer::requestStop()
+{
+    shouldStop.storeRelaxed(1);
+}
+
+void VibrationAnalyzer::setupRound()
+{
+    {
+        QMutexLocker locker(&roundMutex);
+        roundId = pendingRoundId;
+        sampleRate = pendingSampleRate;
+    }
+    intervalSamples = qMax(1, static_cast<int>(static_cast<qint64>(sampleRate) * featureIntervalMs / 1000));
+
+    // 段长取不超过 fftSize 的2的整数次幂, 并保证一个周期内至少有一段
+    segmentSize = 256;
+    while (segmentSize * 2 <= fftSize && segmentSize * 2 <= intervalSamples) {
+        segmentSize *= 2;
+    }
+    fft.setSize(segmentSize);
+
+    // 周期Hann窗
+    const double pi = 3.14159265358979323846;
+    window.resize(segmentSize);
+    windowPower = 0.0;
+    for (int i = 0; i < segmentSize; i++) {
+        window[i] = static_cast<float>(0.5 - 0.5 * std::cos(2.0 * pi * i / segmentSize));
+        windowPower += static_cast<double>(window[i]) * window[i];
+    }
+    windowed.resize(segmentSize);
+    power.resize(fft.bins());
+
+    const int channels = ring ? ring->channels() : 0;
+    channelStates.assign(channels, ChannelState());
+    for (ChannelState &state : channelStates) {
+        state.frame.resize(segmentSize);
+        state.psdSum.assign(fft.bins(), 0.0);
+    }
+    intervalCount = 0;
+    nextSamplePos = -1;
+    roundStartPos = -1;
+
+    qDebug() << "振动分析: 轮次" << roundId << "采样频率" << sampleRate << "段长" << segmentSize;
+}
+
+void VibrationAnalyzer::processSegment(ChannelState &state)
+{
+    // 去除段内直流后加窗, 避免直流泄漏到低频
+    double mean = 0.0;
+    for (int i = 0; i < segmentSize; i++) {
+        mean += state.frame[i];
+    }
+    const float dc = static_cast<float>(mean / segmentSize);
+    for (int i = 0; i < segmentSize; i++) {
+        windowed[i] = (state.frame[i] - dc) * window[i];
+    }
+
+    fft.powerSpectrum(windowed.data(), power.data());
+    const int bins = fft.bins();
+    for (int k = 0; k < bins; k++) {
+        state.psdSum[k] += power[k];
+    }
+    state.segments++;
+
+    // 50%重叠: 后半段移到开头
+    const int hop = segmentSize / 2;
+    std::memmove(state.frame.data(), state.frame.data() + hop, sizeof(float) * (segmentSize - hop));
+    state.fill = segmentSize - hop;
+}
+
+void VibrationAnalyzer::pushBlockRms(const DAQSampleBlock &block)
+{
+    if (!g_sensorAligner || block.points() <= 0) {
+        return;
+    }
+    float rms[4] = {0};
+    const int channels = qMin(4, block.channels());
+    for (int ch = 0; ch < channels; ch++) {
+        const double *x = block.channel(ch);
+        double sum = 0;
+        for (int i = 0; i < block.points(); i++) {
+            sum += x[i] * x[i];
+        }
+        rms[ch] = static_cast<float>(std::sqrt(sum / block.points()));
+    }
+    const qint64 midUs = block.timeUs() + qint64(block.points()) * 500000 / sampleRate;
+    g_sensorAligner->push(SensorVib1Rms, rms, channels, midUs);
+}
+
+void VibrationAnalyzer::processBlock(const DAQSampleBlock &block)
+{
+    const int channels = qMin(block.channels(), static_cast<int>(channelStates.size()));
+    const int points = block.points();
+
+    // 出现断点时丢弃未满的段, 不把两段不连续的数据拼在一起做FFT
+    if (nextSamplePos >= 0 && block.samplePos() != nextSamplePos) {
+        for (ChannelState &state : channelStates) {
+            state.fill = 0;
+        }
+    }
+    nextSamplePos = block.samplePos() + points;
+    if (roundStartPos < 0) {
+        roundStartPos = block.samplePos();
+    }
+
+    for (int ch = 0; ch < channels; ch++) {
+        ChannelState &state = channelStates[ch];
+        const double *data = block.channel(ch);
+        if (state.count == 0 && points > 0) {
+            state.minValue = state.maxValue = data[0];
+        }
+        for (int i = 0; i < points; i++) {
+            const double v = data[i];
+            const double v2 = v * v;
+            state.sum += v;
+            state.sum2 += v2;
+            state.sum3 += v2 * v;
+            state.sum4 += v2 * v2;
+            state.minValue = qMin(state.minValue, v);
+            state.maxValue = qMax(state.maxValue, v);
+
+            state.frame[state.fill++] = static_cast<float>(v);
+            if (state.fill == segmentSize) {
+                processSegment(state);
+            }
+        }
+        state.count += points;
+    }
+
+    intervalCount += points;
+    if (intervalCount >= intervalSamples) {
+        // 周期结束时刻取本块最后一个点之后, 与 Modbus 采样同一时钟
+        const qint64 endUs = block.timeUs() + (sampleRate > 0 ? qint64(points) * 1000000 / sampleRate : 0);
+        emitFeatures(nextSamplePos - 1, endUs);
+    }
+}
+
+void VibrationAnalyzer::emitFeatures(qint64 samplePos, qint64 timeUs)
+{
+    VibFeatureFrame frame;
+    frame.roundId = roundId;
+    frame.sampleRate = sampleRate;
+    frame.samplePos = samplePos;
+    frame.timeSec = (sampleRate > 0) ? static_cast<double>(samplePos + 1 - roundStartPos) / sampleRate : 0.0;
+    frame.timeUs = timeUs;
+    frame.frequencyResolution = static_cast<double>(sampleRate) / segmentSize;
+    frame.averages = channelStates.empty() ? 0 : channelStates[0].segments;
+    frame.bandEdges = bandEdges;
+    frame.channels.resize(static_cast<int>(channelStates.size()));
+
+    // 单边功率谱归一化: 各频点之和等于信号的均方值
+    const int bins = fft.bins();
+    const double binScale = 1.0 / (static_cast<double>(segmentSize) * windowPower);
+
+    for (int ch = 0; ch < static_cast<int>(channelStates.size()); ch++) {
+        ChannelState &state = channelStates[ch];
+        VibChannelFeatures &out = frame.channels[ch];
+
+        if (state.count > 0) {
+            const double n = static_cast<double>(state.count);
+            const double mean = state.sum / n;
+            const double e2 = state.sum2 / n;
+            const double e3 = state.sum3 / n;
+            const double e4 = state.sum4 / n;
+            const double m2 = qMax(0.0, e2 - mean * mean);
+            const double m4 = e4 - 4 * mean * e3 + 6 * mean * mean * e2 - 3 * mean * mean * mean * mean;
+            out.rms = std::sqrt(m2);
+            out.peak = qMax(state.maxValue - mean, mean - state.minValue);
+            out.crestFactor = (out.rms > 0) ? out.peak / out.rms : 0.0;
+            out.kurtosis = (m2 > 0) ? m4 / (m2 * m2) : 0.0;
+        }
+
+        if (state.segments > 0) {
+            out.spectrum.resize(bins);
+            int peakBin = 1;
+            for (int k = 0; k < bins; k++) {
+                const double oneSided = (k == 0 || k == bins - 1) ? 1.0 : 2.0;
+                out.spectrum[k] = static_cast<float>(state.psdSum[k] / state.segments * binScale * oneSided);
+                if (k >= 1 && out.spectrum[k] > out.spectrum[peakBin]) {
+                    peakBin = k;
+                }
+            }
+            out.peakFrequency = peakBin * frame.frequencyResolution;
+
+            // 频带 [bandEdges[b], bandEdges[b+1]), 不含直流
+            out.bandRms.fill(0.0, qMax(0, bandEdges.size() - 1));
+            for (int b = 0; b + 1 < bandEdges.size(); b++) {
+                const int k0 = qMax(1, static_cast<int>(std::ceil(bandEdges[b] / frame.frequencyResolution)));
+                const int k1 = qMin(bins, static_cast<int>(std::ceil(bandEdges[b + 1] / frame.frequencyResolution)));
+                double sum = 0.0;
+                for (int k = k0; k < k1; k++) {
+                    sum += out.spectrum[k];
+                }
+                out.bandRms[b] = std::sqrt(sum);
+            }
+        }
+
+        // 清零本周期的累加量, 未满的段保留到下一周期
+        state.sum = state.sum2 = state.sum3 = state.sum4 = 0.0;
+        state.count = 0;
+        state.segments = 0;
+        std::fill(state.psdSum.begin(), state.psdSum.end(), 0.0);
+    }
+    intervalCount = 0;
+
+    emit featuresReady(frame);
+}
+
+void VibrationAnalyzer::doWork()
+{
+    if (!ring || consumerId < 0) {
+        qDebug() << "振动分析: 未设置环形缓冲区";
+        return;
+    }
+
+    DAQBlockPtr block;
+    while (shouldStop.loadRelaxed() == 0) {
+        if (roundChanged.testAndSetAcquire(1, 0)) {
+            setupRound();
+        }
+
+        bool received = false;
+        while (shouldStop.loadRelaxed() == 0 && ring->read(consumerId, block)) {
+            received = true;
+            if (sampleRate > 0) {
+                pushBlockRms(*block);
+                processBlock(*block);
+            }
+        }
+        block.reset(); // 及时释放句柄, 让生产者可以复用该块
+
+        if (!received) {
+            QThread::msleep(10);
+        }
+    }
+    qDebug() << "振动分析线程已退出";
+}
@@ -0,0 +1,254 @@
+#include "inc/vibrationhistory.h"
+
+#include <QDir>
+#include <QDebug>
+#include <cmath>
+#include <limits>
+
+VibrationHistory::VibrationHistory()
+{
+}
+
+VibrationHistory::~VibrationHistory()
+{
+}
+
+void VibrationHistory::reset(int channels, int sampleRate)
+{
+    m_channels.clear();     // 临时文件随之删除
+    m_channels.resize(qMax(0, channels));
+    for (Channel &channel : m_channels) {
+        channel.levels.resize(qMax(1, levelCount));
+    }
+    m_segments.clear();
+    m_sampleRate = sampleRate;
+    m_totalSamples = 0;
+    m_startUs = 0;
+    m_nextSamplePos = 0;
+    m_spilledBytes = 0;
+    m_spillFailed = false;
+}
+
+double VibrationHistory::duration() const
+{
+    if (m_segments.isEmpty() || m_sampleRate <= 0) {
+        return 0.0;
+    }
+    const Segment &last = m_segments.last();
+    return last.timeSec + static_cast<double>(m_totalSamples - last.start) / m_sampleRate;
+}
+
+qint64 VibrationHistory::bucketSamples(int level) const
+{
+    qint64 samples = baseBucket;
+    for (int i = 0; i < level; i++) {
+        samples *= levelFactor;
+    }
+    return samples;
+}
+
+template <typename T>
+void VibrationHistory::appendItem(Store<T> &store, const T &item)
+{
+    store.tail.append(item);
+    store.count++;
+    if (store.tail.size() >= 2 * memoryBuckets && !m_spillFailed) {
+        spill(store);
+    }
+}
+
+template <typename T>
+void VibrationHistory::spill(Store<T> &store)
+{
+    if (!store.file) {
+        const QString dir = spillDir.isEmpty() ? QDir::tempPath() : spillDir;
+        QDir().mkpath(dir);
+        store.file.reset(new QTemporaryFile(QDir(dir).filePath("vibhist_XXXXXX.tmp")));
+        if (!store.file->open()) {
+            qDebug() << "创建历史数据临时文件失败:" << store.file->errorString();
+            store.file.reset();
+            m_spillFailed = true;
+            return;
+        }
+    }
+
+    const qint64 bytes = static_cast<qint64>(memoryBuckets) * sizeof(T);
+    store.file->seek(store.spilled * static_cast<qint64>(sizeof(T)));
+    if (store.file->write(reinterpret_cast<const char *>(store.tail.constData()), bytes) != bytes) {
+        qDebug() << "写历史数据临时文件失败:" << store.file->errorString();
+        m_spillFailed = true;
+        return;
+    }
+    store.tail.remove(0, memoryBuckets);
+    store.spilled += memoryBuckets;
+    m_spilledBytes += bytes;
+}
+
+template <typename T>
+void VibrationHistory::read(Store<T> &store, qint64 first, int n, T *dst, const T &fill)
+{
+    int done = 0;
+
+    // 已写出的部分从文件读回
+    if (first < store.spilled) {
+        const int fromFile = static_cast<int>(qMin<qint64>(n, store.spilled - first));
+        const qint64 bytes = static_cast<qint64>(fromFile) * sizeof(T);
+        bool ok = store.file && store.file->seek(first * static_cast<qint64>(sizeof(T)));
+        ok = ok && store.file->read(reinterpret_cast<char *>(dst), bytes) == bytes;
+        if (!ok) {
+            // 读取失败的部分显示为断开
+            for (int i = 0; i < fromFile; i++) {
+                dst[i] = fill;
+            }
+        }
+        done = fromFile;
+    }
+
+    for (; done < n; done++) {
+        dst[done] = store.tail[static_cast<int>(first + done - store.spilled)];
+    }
+}
+
+void VibrationHistory::append(const DAQSampleBlock &block)
+{
+    const int points = block.points();
+    if (m_channels.empty() || points <= 0 || m_sampleRate <= 0) {
+        return;
+    }
+
+    // 按块的采样时刻放置; 丢块或暂停后恢复时开始新的一段
+    if (m_segments.isEmpty()) {
+        m_startUs = block.timeUs();
+        m_segments.append({m_totalSamples, 0.0});
+    } else {
+        const double blockSec = (block.timeUs() - m_startUs) / 1e6;
+        const double expectedSec = duration();
+        if (block.samplePos() != m_nextSamplePos || std::abs(blockSec - expectedSec) > gapThresholdSec) {
+            // 时刻回退时接在上一段之后, 保持横轴单调
+            m_segments.append({m_totalSamples, qMax(blockSec, expectedSec)});
+        }
+    }
+    m_nextSamplePos = block.samplePos() + points;
+
+    const int channels = qMin(block.channels(), static_cast<int>(m_channels.size()));
+    for (int ch = 0; ch < channels; ch++) {
+        Channel &channel = m_channels[ch];
+        MinMaxAccumulator &acc = channel.levels[0].pending;
+        const double *data = block.channel(ch);
+        for (int i = 0; i < points; i++) {
+            const float v = static_cast<float>(data[i]);
+            appendItem(channel.raw, v);
+            acc.add(v);
+            if (acc.count == baseBucket) {
+                const Bucket b = acc.bucket();
+                acc.count = 0;
+                push(channel, 0, b);
+            }
+        }
+    }
+    m_totalSamples += points;
+}
+
+void VibrationHistory::push(Channel &channel, int level, const Bucket &bucket)
+{
+    appendItem<Bucket>(channel.levels[level], bucket);
+
+    // 每个桶的两个极值按顺序并入上一层
+    if (level + 1 < static_cast<int>(channel.levels.size())) {
+        MinMaxAccumulator &acc = channel.levels[level + 1].pending;
+        acc.add(bucket.first);
+        acc.add(bucket.second);
+        if (acc.count == 2 * levelFactor) {
+            const Bucket b = acc.bucket();
+            acc.count = 0;
+            push(channel, level + 1, b);
+        }
+    }
+}
+
+int VibrationHistory::render(int ch, double t0, double t1, int pixels,
+                             QVector<double> &keys, QVector<double> &values, double scale,
+                             double *minValue, double *maxValue)
+{
+    keys.resize(0);
+    values.resize(0);
+    if (minValue) {
+        *minValue = 0.0;
+    }
+    if (maxValue) {
+        *maxValue = 0.0;
+    }
+    if (ch < 0 || ch >= static_cast<int>(m_channels.size()) || m_sampleRate <= 0 || pixels <= 0 || t1 <= t0) {
+        return 0;
+    }
+
+    // 每像素对应的样本数, 选用桶不超过一个像素的最粗层; 第0层的桶已宽于一个像素时读原始样本
+    const double samplesPerPixel = (t1 - t0) * m_sampleRate / pixels;
+    Channel &channel = m_channels[ch];
+    int levelIndex = -1;
+    if (samplesPerPixel >= baseBucket) {
+        levelIndex = 0;
+        while (levelIndex + 1 < static_cast<int>(channel.levels.size()) && bucketSamples(levelIndex + 1) <= samplesPerPixel) {
+            levelIndex++;
+        }
+    }
+    const qint64 itemSamples = (levelIndex < 0) ? 1 : bucketSamples(levelIndex);
+    qint64 available = channel.raw.count;
+    if (levelIndex >= 0) {
+        const Level &level = channel.levels[levelIndex];
+        available = level.count + (level.pending.count > 0 ? 1 : 0);   // 含尚未完成的最后一个桶
+    }
+
+    const float nan = std::numeric_limits<float>::quiet_NaN();
+    const Bucket nanBucket = {nan, nan};
+    m_decimator.begin(t0, t1, pixels, scale, &keys, &values);
+    for (int s = 0; s < m_segments.size(); s++) {
+        const Segment &seg = m_segments[s];
+        const qint64 segEnd = (s + 1 < m_segments.size()) ? m_segments[s + 1].start : m_totalSamples;
+        const double segEndSec = seg.timeSec + static_cast<double>(segEnd - seg.start) / m_sampleRate;
+        if (segEnd <= seg.start || segEndSec < t0 || seg.timeSec > t1) {
+            continue;
+        }
+        m_decimator.addBreak(seg.timeSec);
+
+        // 本段内 [t0, t1] 对应的样本范围, 只取起点落在本段内的条目
+        const qint64 i0 = seg.start + qMax<qint64>(0, static_cast<qint64>(std::floor((t0 - seg.timeSec) * m_sampleRate)));
+        const qint64 i1 = qMin(segEnd, seg.start + static_cast<qint64>(std::ceil((t1 - seg.timeSec) * m_sampleRate)) + 1);
+        const qint64 first = qMax((seg.start + itemSamples - 1) / itemSamples, i0 / itemSamples);
+        const qint64 last = qMin(available, (qMin(segEnd, i1) + itemSamples - 1) / itemSamples);
+        if (last <= first) {
+            continue;
+        }
+        const int n = static_cast<int>(last - first);
+
+        if (levelIndex < 0) {
+            m_rawBuffer.resize(n);
+            read(channel.raw, first, n, m_rawBuffer.data(), nan);
+            for (int i = 0; i < n; i++) {
+                const double t = seg.timeSec + static_cast<double>(first + i - seg.start) / m_sampleRate;
+                m_decimator.add(t, m_rawBuffer[i], m_rawBuffer[i]);
+            }
+        } else {
+            Level &level = channel.levels[levelIndex];
+            const int complete = static_cast<int>(qBound<qint64>(0, level.count - first, n));
+            m_readBuffer.resize(n);
+            read<Bucket>(level, first, complete, m_readBuffer.data(), nanBucket);
+            for (int i = complete; i < n; i++) {
+                m_readBuffer[i] = level.pending.bucket();   // 尚未完成的最后一个桶
+            }
+            for (int i = 0; i < n; i++) {
+                const double t = seg.timeSec + static_cast<double>((first + i) * itemSamples - seg.start) / m_sampleRate;
+                m_decimator.add(t, m_readBuffer[i].first, m_readBuffer[i].second);
+            }
+        }
+    }
+    m_decimator.finish();
+
+    if (minValue) {
+        *minValue = m_decimator.minValue();
+    }
+    if (maxValue) {
+        *maxValue = m_decimator.maxValue();
+    }
+    return keys.size();
+}
@@ -0,0 +1,274 @@
+#include "inc/vibrationrecorder.h"
+
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QElapsedTimer>
+#include <QDebug>
+#include <limits>
+
+#define RECORDER_CONNECTION "vk701_recorder"
+#define RECORDER_POLL_MS    5       // 无控制项时读取环形缓冲区的周期
+
+VibrationRecorder::VibrationRecorder(QObject *parent) : QObject(parent),
+    recording(0),
+    shouldStop(0)
+{
+    qRegisterMetaType<RecorderStats>("RecorderStats");
+}
+
+VibrationRecorder::~VibrationRecorder()
+{
+    requestStop();
+}
+
+void VibrationRecorder::setRingBuffer(const std::shared_ptr<DAQRingBuffer> &ringBuffer)
+{
+    ring = ringBuffer;
+    consumerId = ring ? ring->addConsumer("record") : -1;
+}
+
+void VibrationRecorder::beginRound(int roundId, int sampleRate, RecordMode mode)
+{
+    QMutexLocker locker(&queueMutex);
+    Item item;
+    item.type = Item::BeginRound;
+    item.seq = ring ? ring->writtenBlocks() : 0;
+    item.roundId = roundId;
+    item.sampleRate = sampleRate;
+    item.mode = mode;
+    queue.enqueue(item);
+    recording.storeRelaxed(1);
+    queueNotEmpty.wakeOne();
+}
+
+void VibrationRecorder::endRound()
+{
+    QMutexLocker locker(&queueMutex);
+    recording.storeRelaxed(0);
+    Item item;
+    item.type = Item::EndRound;
+    item.seq = ring ? ring->writtenBlocks() : 0;
+    queue.enqueue(item);
+    queueNotEmpty.wakeOne();
+}
+
+bool VibrationRecorder::isRecording() const
+{
+    return recording.loadRelaxed() != 0;
+}
+
+RecorderStats VibrationRecorder::getStats() const
+{
+    QMutexLocker locker(&queueMutex);
+    RecorderStats result = stats;
+    result.queueDepth = ring ? static_cast<int>(ring->available(consumerId)) : 0;
+    result.queueCapacity = ring ? ring->slotCount() - 1 : 0;
+    return result;
+}
+
+void VibrationRecorder::requestStop()
+{
+    QMutexLocker locker(&queueMutex);
+    shouldStop.storeRelaxed(1);
+    queueNotEmpty.wakeAll();
+}
+
+void VibrationRecorder::drainRing(quint64 endSeq)
+{
+    if (!ring || consumerId < 0) {
+        return;
+    }
+    for (;;) {
+        if (!heldBlock && !ring->read(consumerId, heldBlock)) {
+            break;
+        }
+        if (heldBlock->seq() >= endSeq) {
+            break;
+        }
+        recordBlock(*heldBlock);
+        heldBlock.reset();  // 及时释放句柄, 让生产者可以复用该块
+    }
+
+    const quint64 overruns = ring->overruns(consumerId);
+    const int backlog = static_cast<int>(ring->available(consumerId));
+    QMutexLocker locker(&queueMutex);
+    stats.overrunBlocks = static_cast<qint64>(overruns);
+    stats.maxQueueDepth = qMax(stats.maxQueueDepth, backlog);
+}
+
+void VibrationRecorder::recordBlock(const DAQSampleBlock &block)
+{
+    // 读取落后被覆盖: 起始点跳变部分即为未记录的数据
+    const quint64 overruns = ring->overruns(consumerId);
+    const bool overrun = overruns != lastOverruns;
+    lastOverruns = overruns;
+    const qint64 lost = (overrun && nextSamplePos >= 0) ? qMax<qint64>(0, block.samplePos() - nextSamplePos) : 0;
+    nextSamplePos = block.samplePos() + block.points();
+
+    bool segmentError = false;
+    if (inRound) {
+        if (roundMode == RecordMode::RawSegments) {
+            // 段文件写入只是内存复制, 由操作系统异步回写
+            segmentError = !segmentWriter.append(block);
+        } else {
+            store.append(block);
+        }
+    }
+
+    QMutexLocker locker(&queueMutex);
+    if (inRound) {
+        stats.readBlocks++;
+    } else {
+        stats.ignoredBlocks++;
+    }
+    if (segmentError) {
+        stats.segmentErrors++;
+    }
+    if (overrun && inRound) {
+        stats.recordGaps++;
+        stats.lostSamples += lost;
+    }
+}
+
+void VibrationRecorder::commitPending(QSqlDatabase &db)
+{
+    if (store.pendingChunks() == 0) {
+        return;
+    }
+
+    if (!db.isOpen()) {
+        // 数据库未打开: 不尝试提交, 只限制积压
+        trimPending();
+        return;
+    }
+
+    const int chunks = store.pendingChunks();
+    const qint64 bytes = store.pendingBytes();
+    QElapsedTimer timer;
+    timer.start();
+    const bool ok = store.commit(db);
+    const int elapsedMs = static_cast<int>(timer.elapsed());
+
+    {
+        QMutexLocker locker(&queueMutex);
+        stats.commits++;
+        stats.lastCommitMs = elapsedMs;
+        stats.maxCommitMs = qMax(stats.maxCommitMs, elapsedMs);
+        if (ok) {
+            stats.writtenChunks += chunks;
+            stats.writtenBytes += bytes;
+        } else {
+            // 失败时数据保留在store中, 下次继续重试
+            stats.failedCommits++;
+        }
+    }
+    if (!ok) {
+        trimPending();
+    }
+}
+
+void VibrationRecorder::trimPending()
+{
+    const int chunks = store.dropOldestChunks(maxPendingChunks);
+    if (chunks == 0) {
+        return;
+    }
+    qDebug() << "振动数据待提交积压超过上限, 丢弃最早的" << chunks << "块";
+    QMutexLocker locker(&queueMutex);
+    stats.droppedChunks += chunks;
+}
+
+void VibrationRecorder::doWork()
+{
+    // 记录线程使用独立连接, 与界面线程的查询互不阻塞 (数据库为WAL模式)
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", RECORDER_CONNECTION);
+        db.setDatabaseName(dbFileName);
+        if (!db.open()) {
+            qDebug() << "记录线程连接数据库失败:" << db.lastError().text();
+        } else {
+            QSqlQuery pragmaQuery(db);
+            pragmaQuery.exec("PRAGMA journal_mode = WAL");
+            pragmaQuery.exec("PRAGMA synchronous = NORMAL");
+            pragmaQuery.exec("PRAGMA busy_timeout = 2000");
+            VibrationStore::createTables(db);
+        }
+        store.setFormat(sampleFormat);
+        segmentWriter.directory = segmentDir;
+        segmentWriter.segmentSize = segmentSize;
+
+        QElapsedTimer sinceCommit;
+        sinceCommit.start();
+        QQueue<Item> batch;
+
+        for (;;) {
+            {
+                QMutexLocker locker(&queueMutex);
+                if (queue.isEmpty() && shouldStop.loadRelaxed() == 0) {
+                    queueNotEmpty.wait(&queueMutex, RECORDER_POLL_MS);
+                }
+                // 一次取走全部控制项, 处理期间不持有锁
+                batch.swap(queue);
+            }
+
+            bool roundEnded = false;
+            while (!batch.isEmpty()) {
+                Item item = batch.dequeue();
+                switch (item.type) {
+                case Item::BeginRound:
+                    drainRing(item.seq);    // 开始前写入的块不属于本轮
+                    store.finishRound();
+                    roundMode = item.mode;
+                    if (roundMode == RecordMode::RawSegments) {
+                        segmentWriter.setRound(item.roundId, item.sampleRate);
+                    } else {
+                        store.setChunkPoints(qMax(1000, item.sampleRate / 10)); // 每块约100ms, 至少1000点
+                        store.beginRound(item.roundId, item.sampleRate);
+                    }
+                    inRound = true;
+                    break;
+                case Item::EndRound:
+                    drainRing(item.seq);    // 结束前写入的块仍属于本轮
+                    store.finishRound();
+                    segmentWriter.close();  // 一轮结束即关闭段文件, 便于离线分析
+                    inRound = false;
+                    roundEnded = true;
+                    break;
+                }
+            }
+            drainRing(std::numeric_limits<quint64>::max());
+
+            {
+                QMutexLocker locker(&queueMutex);
+                stats.segmentBytes = segmentWriter.totalBytes();
+                stats.segmentCount = segmentWriter.segmentCount();
+            }
+
+            // 成组提交: 达到数量/字节阈值, 超过最长间隔, 或一轮结束
+            if (store.pendingChunks() >= commitChunks
+                || store.pendingBytes() >= commitBytes
+                || sinceCommit.elapsed() >= commitIntervalMs
+                || roundEnded) {
+                commitPending(db);
+                sinceCommit.restart();
+                emit statsUpdated(getStats());
+            }
+
+            if (shouldStop.loadRelaxed() != 0) {
+                QMutexLocker locker(&queueMutex);
+                if (queue.isEmpty()) {
+                    break;
+                }
+            }
+        }
+
+        // 退出前提交剩余数据
+        heldBlock.reset();
+        store.finishRound();
+        commitPending(db);
+        segmentWriter.close();
+        db.close();
+    }
+    QSqlDatabase::removeDatabase(RECORDER_CONNECTION);
+    qDebug() << "振动数据记录线程已退出";
+}
@@ -0,0 +1,282 @@
+#include "inc/vibrationsegment.h"
+
+#include <QDir>
+#include <QDateTime>
+#include <QDebug>
+#include <cstring>
+
+#include "inc/sensorclock.h"
+
+VibrationSegmentWriter::VibrationSegmentWriter()
+{
+}
+
+VibrationSegmentWriter::~VibrationSegmentWriter()
+{
+    close();
+}
+
+void VibrationSegmentWriter::setRound(int roundId, int sampleRate)
+{
+    // 采样频率变化时另起新段, 保证段头中的采样频率对段内所有块有效
+    if (isOpen() && static_cast<int>(header()->sampleRate) != sampleRate) {
+        close();
+    }
+    m_roundId = roundId;
+    m_sampleRate = sampleRate;
+    // 每轮换算一次单调时钟到墙上时间的偏移, 本轮各块的时间戳之间不受系统时间调整影响
+    m_wallOffsetUs = QDateTime::currentMSecsSinceEpoch() * 1000 - sensorClockUs();
+}
+
+bool VibrationSegmentWriter::openSegment(int channels)
+{
+    QDir dir(directory);
+    if (!dir.exists() && !dir.mkpath(".")) {
+        qDebug() << "创建段文件目录失败:" << directory;
+        return false;
+    }
+
+    // 索引区之后按页对齐数据区
+    const qint64 indexBytes = static_cast<qint64>(indexCapacity) * sizeof(VibSegmentIndexEntry);
+    const qint64 dataOffset = ((VIB_SEGMENT_HEADER_SIZE + indexBytes + 4095) / 4096) * 4096;
+    if (segmentSize <= dataOffset) {
+        qDebug() << "段文件大小过小:" << segmentSize;
+        return false;
+    }
+
+    const QString name = QString("%1_%2_%3%4")
+            .arg(prefix)
+            .arg(QDateTime::currentDateTime().toString("yyyyMMdd_HHmmss_zzz"))
+            .arg(m_segmentCount, 4, 10, QChar('0'))
+            .arg(VIB_SEGMENT_SUFFIX);
+    m_file.setFileName(dir.filePath(name));
+    if (!m_file.open(QIODevice::ReadWrite)) {
+        qDebug() << "打开段文件失败:" << m_file.fileName() << m_file.errorString();
+        return false;
+    }
+    if (!m_file.resize(segmentSize)) {
+        qDebug() << "预分配段文件失败:" << m_file.errorString();
+        m_file.close();
+        return false;
+    }
+    m_map = m_file.map(0, segmentSize);
+    if (!m_map) {
+        qDebug() << "映射段文件失败:" << m_file.errorString();
+        m_file.close();
+        return false;
+    }
+
+    VibSegmentHeader *h = header();
+    std::memset(h, 0, sizeof(VibSegmentHeader));
+    std::memcpy(h->magic, VIB_SEGMENT_MAGIC, sizeof(h->magic));
+    h->version = VIB_SEGMENT_VERSION;
+    h->channels = static_cast<quint32>(channels);
+    h->sampleRate = static_cast<quint32>(m_sampleRate);
+    h->indexCapacity = static_cast<quint32>(indexCapacity);
+    h->segmentSize = static_cast<quint64>(segmentSize);
+    h->dataOffset = static_cast<quint64>(dataOffset);
+    h->dataUsed = 0;
+    h->blockCount = 0;
+    h->closed = 0;
+    h->createdMs = QDateTime::currentMSecsSinceEpoch();
+
+    m_segmentCount++;
+    qDebug() << "新建振动段文件:" << m_file.fileName();
+    return true;
+}
+
+bool VibrationSegmentWriter::append(const DAQSampleBlock &block)
+{
+    const int channels = block.channels();
+    const int points = block.points();
+    if (points <= 0) {
+        return true;
+    }
+    const quint64 bytes = static_cast<quint64>(channels) * points * sizeof(float);
+
+    // 通道数变化、数据区或索引写满时滚动到新段
+    if (isOpen()) {
+        const VibSegmentHeader *h = header();
+        if (static_cast<int>(h->channels) != channels
+            || h->blockCount >= h->indexCapacity
+            || h->dataOffset + h->dataUsed + bytes > h->segmentSize) {
+            close();
+        }
+    }
+    if (!isOpen() && !openSegment(channels)) {
+        return false;
+    }
+
+    VibSegmentHeader *h = header();
+    if (h->dataOffset + bytes > h->segmentSize) {
+        qDebug() << "数据块大于段文件数据区, 无法写入";
+        return false;
+    }
+
+    // 数据: 各通道连续存放 float32
+    const quint64 offset = h->dataOffset + h->dataUsed;
+    float *dst = reinterpret_cast<float *>(m_map + offset);
+    for (int ch = 0; ch < channels; ch++) {
+        const double *src = block.channel(ch);
+        for (int i = 0; i < points; i++) {
+            dst[i] = static_cast<float>(src[i]);
+        }
+        dst += points;
+    }
+
+    // 索引
+    VibSegmentIndexEntry *index = reinterpret_cast<VibSegmentIndexEntry *>(m_map + VIB_SEGMENT_HEADER_SIZE);
+    VibSegmentIndexEntry &e = index[h->blockCount];
+    e.dataOffset = offset;
+    e.samplePos = block.samplePos();
+    e.timestampUs = block.timeUs() + m_wallOffsetUs;   // 块第一个点的采样时刻
+    e.roundId = m_roundId;
+    e.points = points;
+
+    // 最后更新计数, 读取正在写入的段时只会看到完整的块
+    h->dataUsed += bytes;
+    h->blockCount++;
+    m_totalBytes += static_cast<qint64>(bytes);
+    return true;
+}
+
+void VibrationSegmentWriter::close()
+{
+    if (!isOpen()) {
+        return;
+    }
+
+    VibSegmentHeader *h = header();
+    h->closed = 1;
+    const qint64 usedSize = static_cast<qint64>(h->dataOffset + h->dataUsed);
+    m_file.unmap(m_map);
+    m_map = nullptr;
+
+    // 截断未使用的预分配空间
+    m_file.resize(usedSize);
+    m_file.close();
+}
+
+VibrationSegmentReader::VibrationSegmentReader()
+{
+}
+
+VibrationSegmentReader::~VibrationSegmentReader()
+{
+    close();
+}
+
+bool VibrationSegmentReader::open(const QString &fileName)
+{
+    close();
+
+    m_file.setFileName(fileName);
+    if (!m_file.open(QIODevice::ReadOnly)) {
+        qDebug() << "打开段文件失败:" << fileName << m_file.errorString();
+        return false;
+    }
+    m_size = m_file.size();
+    if (m_size < VIB_SEGMENT_HEADER_SIZE) {
+        qDebug() << "段文件过小:" << fileName;
+        m_file.close();
+        return false;
+    }
+    m_map = m_file.map(0, m_size);
+    if (!m_map) {
+        qDebug() << "映射段文件失败:" << m_file.errorString();
+        m_file.close();
+        return false;
+    }
+
+    const VibSegmentHeader &h = header();
+    if (std::memcmp(h.magic, VIB_SEGMENT_MAGIC, sizeof(h.magic)) != 0 || h.version != VIB_SEGMENT_VERSION
+        || h.dataOffset > static_cast<quint64>(m_size)
+        || VIB_SEGMENT_HEADER_SIZE + static_cast<quint64>(h.indexCapacity) * sizeof(VibSegmentIndexEntry) > h.dataOffset) {
+        qDebug() << "段文件格式错误:" << fileName;
+        close();
+        return false;
+    }
+    return true;
+}
+
+void VibrationSegmentReader::close()
+{
+    if (m_map) {
+        m_file.unmap(m_map);
+        m_map = nullptr;
+    }
+    if (m_file.isOpen()) {
+        m_file.close();
+    }
+    m_size = 0;
+}
+
+int VibrationSegmentReader::blockCount() const
+{
+    if (!m_map) {
+        return 0;
+    }
+    const VibSegmentHeader &h = header();
+    return static_cast<int>(qMin(h.blockCount, h.indexCapacity));
+}
+
+const VibSegmentIndexEntry &VibrationSegmentReader::entry(int block) const
+{
+    const VibSegmentIndexEntry *index = reinterpret_cast<const VibSegmentIndexEntry *>(m_map + VIB_SEGMENT_HEADER_SIZE);
+    return index[block];
+}
+
+VibChannelSpan VibrationSegmentReader::channel(int block, int ch) const
+{
+    VibChannelSpan span;
+    if (block < 0 || block >= blockCount() || ch < 0 || ch >= static_cast<int>(header().channels)) {
+        return span;
+    }
+    const VibSegmentIndexEntry &e = entry(block);
+    const quint64 offset = e.dataOffset + static_cast<quint64>(ch) * e.points * sizeof(float);
+    if (offset + static_cast<quint64>(e.points) * sizeof(float) > static_cast<quint64>(m_size)) {
+        return span;
+    }
+    span.data = reinterpret_cast<const float *>(m_map + offset);
+    span.count = e.points;
+    return span;
+}
+
+int VibrationSegmentReader::findBlock(int roundId, qint64 samplePos) const
+{
+    // 同一轮次内块的采样点序号单调递增, 先定位轮次范围再二分查找
+    const int count = blockCount();
+    int lo = 0;
+    while (lo < count && entry(lo).roundId != roundId) {
+        lo++;
+    }
+    int hi = lo;
+    while (hi < count && entry(hi).roundId == roundId) {
+        hi++;
+    }
+
+    while (lo < hi) {
+        const int mid = (lo + hi) / 2;
+        const VibSegmentIndexEntry &e = entry(mid);
+        if (samplePos < e.samplePos) {
+            hi = mid;
+        } else if (samplePos >= e.samplePos + e.points) {
+            lo = mid + 1;
+        } else {
+            return mid;
+        }
+    }
+    return -1;
+}
+
+QStringList VibrationSegmentReader::listSegments(const QString &directory, const QString &prefix)
+{
+    QDir dir(directory);
+    QStringList result;
+    const QStringList names = dir.entryList(QStringList() << (prefix + "_*" + VIB_SEGMENT_SUFFIX),
+                                            QDir::Files, QDir::Name);
+    for (const QString &name : names) {
+        result.append(dir.filePath(name));
+    }
+    return result;
+}
@@ -0,0 +1,271 @@
+#include "inc/vibrationstore.h"
+
+#include <QtEndian>
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QDebug>
+#include <cmath>
+#include <cstring>
+
+#define INT24_MAX_VALUE 8388607
+
+QByteArray encodeVibrationBlock(const double *samples, int points, VibSampleFormat format, int sampleRate)
+{
+    const int bytesPerSample = (format == VibSampleFormat::Int24) ? 3 : 4;
+    QByteArray blob(VIB_BLOCK_HEADER_SIZE + points * bytesPerSample, Qt::Uninitialized);
+    uchar *p = reinterpret_cast<uchar *>(blob.data());
+
+    // Int24 以块内峰值归一化, 保证满量程利用
+    float scale = 1.0f;
+    if (format == VibSampleFormat::Int24) {
+        double peak = 0.0;
+        for (int i = 0; i < points; i++) {
+            peak = qMax(peak, std::fabs(samples[i]));
+        }
+        if (peak > 0.0) {
+            scale = static_cast<float>(peak / INT24_MAX_VALUE);
+        }
+    }
+
+    // 块头
+    qToLittleEndian<quint16>(VIB_BLOCK_MAGIC, p);
+    p[2] = VIB_BLOCK_VERSION;
+    p[3] = static_cast<quint8>(format);
+    qToLittleEndian<quint32>(static_cast<quint32>(points), p + 4);
+    quint32 scaleBits;
+    std::memcpy(&scaleBits, &scale, sizeof(scaleBits));
+    qToLittleEndian<quint32>(scaleBits, p + 8);
+    qToLittleEndian<quint32>(static_cast<quint32>(sampleRate), p + 12);
+    p += VIB_BLOCK_HEADER_SIZE;
+
+    // 样本
+    if (format == VibSampleFormat::Int24) {
+        const double inv = 1.0 / scale;
+        for (int i = 0; i < points; i++) {
+            long v = std::lround(samples[i] * inv);
+            v = qBound(-INT24_MAX_VALUE, static_cast<int>(v), INT24_MAX_VALUE);
+            const quint32 u = static_cast<quint32>(v);
+            p[0] = static_cast<uchar>(u & 0xFF);
+            p[1] = static_cast<uchar>((u >> 8) & 0xFF);
+            p[2] = static_cast<uchar>((u >> 16) & 0xFF);
+            p += 3;
+        }
+    } else {
+        for (int i = 0; i < points; i++) {
+            const float f = static_cast<float>(samples[i]);
+            quint32 bits;
+            std::memcpy(&bits, &f, sizeof(bits));
+            qToLittleEndian<quint32>(bits, p);
+            p += 4;
+        }
+    }
+    return blob;
+}
+
+bool decodeVibrationBlock(const QByteArray &blob, QVector<double> &samples, VibBlockHeader *header)
+{
+    if (blob.size() < VIB_BLOCK_HEADER_SIZE) {
+        return false;
+    }
+    const uchar *p = reinterpret_cast<const uchar *>(blob.constData());
+
+    VibBlockHeader h;
+    h.magic = qFromLittleEndian<quint16>(p);
+    h.version = p[2];
+    h.format = p[3];
+    h.points = qFromLittleEndian<quint32>(p + 4);
+    const quint32 scaleBits = qFromLittleEndian<quint32>(p + 8);
+    std::memcpy(&h.scale, &scaleBits, sizeof(h.scale));
+    h.sampleRate = qFromLittleEndian<quint32>(p + 12);
+    if (h.magic != VIB_BLOCK_MAGIC || h.version != VIB_BLOCK_VERSION) {
+        return false;
+    }
+
+    const int bytesPerSample = (h.format == static_cast<quint8>(VibSampleFormat::Int24)) ? 3 : 4;
+    if (blob.size() < VIB_BLOCK_HEADER_SIZE + static_cast<qint64>(h.points) * bytesPerSample) {
+        return false;
+    }
+    p += VIB_BLOCK_HEADER_SIZE;
+
+    samples.resize(static_cast<int>(h.points));
+    if (bytesPerSample == 3) {
+        for (quint32 i = 0; i < h.points; i++) {
+            qint32 v = p[0] | (p[1] << 8) | (p[2] << 16);
+            if (v & 0x800000) {
+                v -= 0x1000000;     // 符号扩展
+            }
+            samples[i] = v * static_cast<double>(h.scale);
+            p += 3;
+        }
+    } else {
+        for (quint32 i = 0; i < h.points; i++) {
+            const quint32 bits = qFromLittleEndian<quint32>(p);
+            float f;
+            std::memcpy(&f, &bits, sizeof(f));
+            samples[i] = f;
+            p += 4;
+        }
+    }
+
+    if (header) {
+        *header = h;
+    }
+    return true;
+}
+
+VibrationStore::VibrationStore(VibSampleFormat format, int chunkPoints)
+    : m_format(format)
+    , m_chunkPoints(qMax(1, chunkPoints))
+{
+}
+
+bool VibrationStore::createTables(QSqlDatabase &db)
+{
+    QSqlQuery query(db);
+    if (!query.exec("CREATE TABLE IF NOT EXISTS IEPEBlocks ("
+                    "RoundID INTEGER,"
+                    "ChID INTEGER,"
+                    "StartSample INTEGER,"
+                    "StartTime REAL,"
+                    "Points INTEGER,"
+                    "Data BLOB,"
+                    "PRIMARY KEY (RoundID, ChID, StartSample))")) {
+        qDebug() << "创建IEPEBlocks表出错:" << query.lastError().text();
+        return false;
+    }
+    return true;
+}
+
+void VibrationStore::beginRound(int roundId, int sampleRate)
+{
+    finishRound();
+    m_roundId = roundId;
+    m_sampleRate = sampleRate;
+    m_roundStartSample = -1;
+    m_channelBuf.clear();
+    m_channelStart.clear();
+}
+
+void VibrationStore::append(const DAQSampleBlock &block)
+{
+    const int channels = block.channels();
+    if (m_roundStartSample < 0) {
+        m_roundStartSample = block.samplePos();
+    }
+    if (m_channelBuf.size() != channels) {
+        finishRound();
+        m_channelBuf.resize(channels);
+        m_channelStart.fill(block.samplePos(), channels);
+        for (int ch = 0; ch < channels; ch++) {
+            m_channelBuf[ch].reserve(m_chunkPoints);
+        }
+    }
+
+    for (int ch = 0; ch < channels; ch++) {
+        QVector<double> &buf = m_channelBuf[ch];
+
+        // 起始点不连续(新一轮采集)时先提交已有数据
+        if (m_channelStart[ch] + buf.size() != block.samplePos()) {
+            flushChannel(ch);
+            m_channelStart[ch] = block.samplePos();
+        }
+
+        const double *src = block.channel(ch);
+        int offset = 0;
+        while (offset < block.points()) {
+            const int n = qMin(block.points() - offset, m_chunkPoints - buf.size());
+            const int oldSize = buf.size();
+            buf.resize(oldSize + n);
+            std::memcpy(buf.data() + oldSize, src + offset, sizeof(double) * n);
+            offset += n;
+            if (buf.size() >= m_chunkPoints) {
+                flushChannel(ch);
+            }
+        }
+    }
+}
+
+void VibrationStore::finishRound()
+{
+    for (int ch = 0; ch < m_channelBuf.size(); ch++) {
+        flushChannel(ch);
+    }
+}
+
+void VibrationStore::flushChannel(int ch)
+{
+    QVector<double> &buf = m_channelBuf[ch];
+    if (buf.isEmpty()) {
+        return;
+    }
+
+    const qint64 start = m_channelStart[ch];
+    QByteArray blob = encodeVibrationBlock(buf.constData(), buf.size(), m_format, m_sampleRate);
+    m_pendingBytes += blob.size();
+
+    m_roundIds.append(m_roundId);
+    m_chIds.append(ch + 1);                 // 通道编号从1开始
+    m_startSamples.append(start);
+    m_startTimes.append(m_sampleRate > 0 ? (start - qMax<qint64>(0, m_roundStartSample)) * 1000.0 / m_sampleRate : 0.0);   // 相对本轮开始的毫秒数
+    m_points.append(buf.size());
+    m_blobs.append(blob);
+
+    m_channelStart[ch] = start + buf.size();
+    buf.resize(0);
+}
+
+bool VibrationStore::commit(QSqlDatabase &db)
+{
+    if (m_roundIds.isEmpty()) {
+        return true;
+    }
+
+    db.transaction();
+    QSqlQuery query(db);
+    if (!m_roundIds.isEmpty()) {
+        query.prepare("INSERT OR REPLACE INTO IEPEBlocks (RoundID, ChID, StartSample, StartTime, Points, Data) "
+                      "VALUES (?, ?, ?, ?, ?, ?)");
+        query.addBindValue(m_roundIds);
+        query.addBindValue(m_chIds);
+        query.addBindValue(m_startSamples);
+        query.addBindValue(m_startTimes);
+        query.addBindValue(m_points);
+        query.addBindValue(m_blobs);
+        if (!query.execBatch()) {
+            qDebug() << "写入IEPEBlocks失败:" << query.lastError().text();
+            db.rollback();
+            return false;
+        }
+    }
+    if (!db.commit()) {
+        qDebug() << "提交振动数据失败:" << db.lastError().text();
+        return false;
+    }
+
+    m_roundIds.clear();
+    m_chIds.clear();
+    m_startSamples.clear();
+    m_startTimes.clear();
+    m_points.clear();
+    m_blobs.clear();
+    m_pendingBytes = 0;
+    return true;
+}
+
+int VibrationStore::dropOldestChunks(int keep)
+{
+    const int n = m_roundIds.size() - qMax(0, keep);
+    if (n <= 0) {
+        return 0;
+    }
+    for (int i = 0; i < n; i++) {
+        m_pendingBytes -= m_blobs.at(i).toByteArray().size();
+    }
+    m_roundIds.erase(m_roundIds.begin(), m_roundIds.begin() + n);
+    m_chIds.erase(m_chIds.begin(), m_chIds.begin() + n);
+    m_startSamples.erase(m_startSamples.begin(), m_startSamples.begin() + n);
+    m_startTimes.erase(m_startTimes.begin(), m_startTimes.begin() + n);
+    m_points.erase(m_points.begin(), m_points.begin() + n);
+    m_blobs.erase(m_blobs.begin(), m_blobs.begin() + n);
+    return n;
+}
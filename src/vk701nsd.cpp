@@ -1,17 +1,21 @@
 #include "inc/vk701nsd.h"
 #include "./inc/VK70xNMC_DAQ2.h"
+#include "inc/sensorclock.h"
 
 #include <QDebug>
 #include <memory>
+#include <cstring>
+
+// 断点检测的计时窗口: 每个窗口结束时以实际点数重新对齐起点, 主机时钟与采集卡时钟的漂移不会累积
+#define STREAM_ANCHOR_MS 1000
 
 vk701nsd::vk701nsd(QObject *parent) : QObject(parent), 
+    ring(std::make_shared<DAQRingBuffer>(DAQ_RING_SLOT_COUNT, DAQ_RING_MAX_BLOCK_POINTS, DAQ_CHANNEL_COUNT)),
     bufferSize(4 * samplingFrequency), // 初始缓冲区大小基于采样频率
     shouldStop(0),
     currentState(DAQState::Disconnected)
 {
-    // 初始化数据缓冲区
-    dataBuffer = new QVector<double>();
-    dataBuffer->reserve(bufferSize); // 预分配内存，减少重新分配
+    qRegisterMetaType<DAQStreamStats>("DAQStreamStats");
 }
 
 vk701nsd::~vk701nsd()
@@ -21,21 +25,12 @@ vk701nsd::~vk701nsd()
     
     // 确保停止采样
     VK70xNMC_StopSampling(cardId);
-    
-    // 清理缓冲区内存
-    if (dataBuffer) {
-        delete dataBuffer;
-        dataBuffer = nullptr;
-    }
 }
 
 void vk701nsd::setBufferSize(int size)
 {
     QMutexLocker locker(&mutex); // 自动锁定和解锁
     bufferSize = size;
-    if (dataBuffer) {
-        dataBuffer->reserve(bufferSize);
-    }
 }
 
 DAQState vk701nsd::getState() const
@@ -53,6 +48,41 @@ bool vk701nsd::shouldContinue() const
     return shouldStop.loadRelaxed() == 0;
 }
 
+std::shared_ptr<DAQRingBuffer> vk701nsd::ringBuffer() const
+{
+    return ring;
+}
+
+DAQStreamStats vk701nsd::getStreamStats() const
+{
+    QMutexLocker locker(&statsMutex);
+    return stats;
+}
+
+// 流模式块大小: 未指定时取约10ms的数据量, 既保证100K采样率下的吞吐, 又不让单次读取阻塞过久
+int vk701nsd::streamBlockPoints() const
+{
+    int points = blockPoints > 0 ? blockPoints : qMax(100, samplingFrequency / 100);
+    return qMin(points, ring->maxPoints());
+}
+
+void vk701nsd::resetStreamStats()
+{
+    QMutexLocker locker(&statsMutex);
+    stats = DAQStreamStats();
+    streamClock.invalidate();
+    streamBaseSamples = 0;
+    lastStatsEmitMs = 0;
+}
+
+void vk701nsd::rearmGapDetection()
+{
+    // 暂停期间采集卡不产生数据, 恢复后以第一个数据块重新计时, 点序号继续累加
+    QMutexLocker locker(&statsMutex);
+    streamClock.invalidate();
+    lastStatsEmitMs = 0;
+}
+
 // 初始化采集卡
 bool vk701nsd::initializeDAQ()
 {
@@ -143,6 +173,7 @@ bool vk701nsd::startSampling()
         return false;
     } else {
         qDebug() << "数据采集设备连接成功!";
+        rearmGapDetection();
         currentState = DAQState::Running;
         emit stateChanged(currentState);
         initStatus = true;
@@ -164,22 +195,21 @@ void vk701nsd::processSampling()
     }
     
     // 读取数据
-    int recv = VK70xNMC_GetFourChannel(cardId, pucRecBuf.get(), samplingFrequency);
+    int recv = VK70xNMC_GetFourChannel(cardId, pucRecBuf.get(), qMin(samplingFrequency, bufferSize / 4));
+    const qint64 recvUs = sensorClockUs();
     if (recv > 0) {
-        // 创建新的数据容器并锁定互斥锁，保证数据安全
-        QMutexLocker locker(&mutex);
-        
-        // 重用数据缓冲区，避免频繁分配内存
-        dataBuffer->clear();
-        dataBuffer->reserve(4 * recv);
-        
-        // 复制数据
-        for (int i = 0; i < 4 * recv; i++) {
-            dataBuffer->append(pucRecBuf[i]);
+        // 读取返回时刻对应最后一个点, 按采样频率倒推第一个点的时刻
+        const qint64 firstUs = recvUs - qint64(recv) * 1000000 / samplingFrequency;
+        // 按环形缓冲区槽大小分块写入
+        QMutexLocker locker(&statsMutex);
+        for (int offset = 0; offset < recv; offset += ring->maxPoints()) {
+            const int points = qMin(ring->maxPoints(), recv - offset);
+            std::memcpy(ring->writeBuffer(), pucRecBuf.get() + DAQ_CHANNEL_COUNT * offset,
+                        sizeof(double) * DAQ_CHANNEL_COUNT * points);
+            ring->commit(points, stats.totalSamples, firstUs + qint64(offset) * 1000000 / samplingFrequency);
+            stats.totalSamples += points;
+            stats.blockCount++;
         }
-        
-        // 发送数据信号
-        emit resultValue(dataBuffer);
     } else if (recv < 0) {
         qDebug() << "异常退出，错误码: " << recv;
         currentState = DAQState::Error;
@@ -187,6 +217,73 @@ void vk701nsd::processSampling()
     }
 }
 
+// 连续流采集: 采样只在startSampling()中启动一次, 此处背靠背读取固定大小的数据块
+void vk701nsd::processStreaming()
+{
+    const int points = streamBlockPoints();
+
+    // 驱动直接写入环形缓冲区的当前槽, 无中间复制
+    int recv = VK70xNMC_GetFourChannel(cardId, ring->writeBuffer(), points);
+    const qint64 recvUs = sensorClockUs();
+    if (recv < 0) {
+        qDebug() << "异常退出，错误码: " << recv;
+        currentState = DAQState::Error;
+        emit stateChanged(currentState);
+        return;
+    }
+    if (recv == 0) {
+        // 驱动缓冲区暂无数据, 短暂让出CPU
+        QThread::usleep(200);
+        return;
+    }
+
+    // 断点检测: 以计时窗口起点为基准, 按采样频率推算应到达的点数,
+    // 若实际接收(含已计入的丢点)落后超过容差, 则认为驱动缓冲区溢出导致丢点;
+    // 每个窗口结束或检测到断点后重新对齐起点
+    qint64 gapPos = -1;
+    qint64 missing = 0;
+    {
+        QMutexLocker locker(&statsMutex);
+        const qint64 blockStart = stats.totalSamples;
+        ring->commit(recv, blockStart, recvUs - qint64(recv) * 1000000 / samplingFrequency);
+        stats.totalSamples += recv;
+        stats.blockCount++;
+
+        if (!streamClock.isValid()) {
+            streamClock.start();
+            streamBaseSamples = stats.totalSamples;
+        } else {
+            const qint64 elapsedMs = streamClock.elapsed();
+            const qint64 expected = streamBaseSamples + elapsedMs * samplingFrequency / 1000;
+            const qint64 accounted = stats.totalSamples + stats.droppedSamples;
+            const qint64 tolerance = qMax<qint64>(4 * points, samplingFrequency / 5);
+            if (expected - accounted > tolerance) {
+                // 保留一个块的在途余量, 其余计为丢失
+                missing = expected - accounted - points;
+                gapPos = blockStart;
+                stats.droppedSamples += missing;
+                stats.gapCount++;
+            }
+            if (gapPos >= 0 || elapsedMs >= STREAM_ANCHOR_MS) {
+                streamClock.restart();
+                streamBaseSamples = stats.totalSamples + stats.droppedSamples;
+            }
+        }
+    }
+
+    if (gapPos >= 0) {
+        qDebug() << "采集断点: 位置" << gapPos << "丢失约" << missing << "点";
+        emit gapDetected(gapPos, missing);
+    }
+
+    // 约每秒发送一次统计信息
+    const qint64 nowMs = recvUs / 1000;
+    if (nowMs - lastStatsEmitMs >= 1000) {
+        lastStatsEmitMs = nowMs;
+        emit streamStatsUpdated(getStreamStats());
+    }
+}
+
 // 处理暂停状态
 void vk701nsd::handlePausedState()
 {
@@ -207,7 +304,8 @@ void vk701nsd::doWork()
         return;
     }
     
-    // 开始采样
+    // 开始采样, 统计与点序号只在线程启动时清零, 暂停恢复后继续累加
+    resetStreamStats();
     if (!startSampling()) {
         emit resultMsg("启动采样失败");
         return;
@@ -231,6 +329,12 @@ void vk701nsd::doWork()
                     break; // 重新开始采样失败，退出循环
                 }
             }
+        } else if (streamingMode) {
+            // 连续流模式 - 背靠背读取数据块, 不休眠
+            processStreaming();
+            if (currentState == DAQState::Error) {
+                break;
+            }
         } else {
             // 处理运行状态 - 采集数据
             processSampling();
@@ -242,6 +346,12 @@ void vk701nsd::doWork()
     
     // 线程退出前的清理工作
     VK70xNMC_StopSampling(cardId);
+    if (streamingMode) {
+        DAQStreamStats finalStats = getStreamStats();
+        qDebug() << "流采集统计: 总点数" << finalStats.totalSamples
+                 << "丢失" << finalStats.droppedSamples << "断点" << finalStats.gapCount;
+        emit streamStatsUpdated(finalStats);
+    }
     currentState = DAQState::Stopping;
     emit stateChanged(currentState);
     qDebug() << "数据采集线程已退出";
@@ -5,6 +5,13 @@
 // 设置绘图颜色常量
 const QColor color[4] = {Qt::darkRed, Qt::darkGreen, Qt::darkBlue, Qt::darkYellow};
 
+// 振动数据库文件
+const QString vibDBFile = "/home/hui/workdir/VK701_Demo/db/vibsqlite.db";
+
+// 原始数据段文件目录; 采样频率不低于该值时改用段文件全速率记录, SQLite跟不上此数据率
+const QString vibRawDir = "/home/hui/workdir/VK701_Demo/db/vibraw";
+#define VIB_RAW_RECORD_MIN_RATE 20000
+
 vk701page::vk701page(QWidget *parent)
     : QWidget(parent)
     , ui(new Ui::vk701page)
@@ -12,7 +19,7 @@ vk701page::vk701page(QWidget *parent)
     ui->setupUi(this);
 
     // 初始化数据库
-    InitDB("/home/hui/workdir/VK701_Demo/db/vibsqlite.db");
+    InitDB(vibDBFile);
 
     // 设置表头自适应
     QHeaderView *header = ui->table_vibDB->horizontalHeader();
@@ -52,6 +59,18 @@ vk701page::vk701page(QWidget *parent)
         }
         qcustomplot[i]->graph(0)->setData(x, y);
         qcustomplot[i]->replot();
+
+        // 横轴为自本轮开始的秒数, 允许水平拖动和缩放回看本轮历史
+        qcustomplot[i]->setInteractions(QCP::iRangeDrag | QCP::iRangeZoom);
+        qcustomplot[i]->axisRect()->setRangeDrag(Qt::Horizontal);
+        qcustomplot[i]->axisRect()->setRangeZoom(Qt::Horizontal);
+        qcustomplot[i]->xAxis->setLabel("时间 (s)");
+        connect(qcustomplot[i]->xAxis, QOverload<const QCPRange &>::of(&QCPAxis::rangeChanged),
+                this, [this, i](const QCPRange &range) { handlePlotRangeChanged(i, range); });
+        connect(qcustomplot[i], &QCustomPlot::mouseDoubleClick, this, [this](QMouseEvent *) {
+            plotFollowLive = true;
+            needPlotUpdate = true;
+        });
     }
 
     // 创建定时器用于更新图表，避免频繁重绘
@@ -59,22 +78,16 @@ vk701page::vk701page(QWidget *parent)
     connect(plotUpdateTimer, &QTimer::timeout, this, &vk701page::updatePlots);
     plotUpdateTimer->start(plotUpdateInterval);
     
-    // 创建定时器用于批量提交数据库
-    dbCommitTimer = new QTimer(this);
-    connect(dbCommitTimer, &QTimer::timeout, [this]() {
-        if (AllRecordStart && !batchData.isEmpty()) {
-            QSqlDatabase::database("vk701").transaction();
-            QSqlQuery query(QSqlDatabase::database("vk701"));
-            query.prepare("INSERT INTO IEPEdata (RoundID, ChID, VibrationData) VALUES (?, ?, ?)");
-            query.addBindValue(batchData[0]);
-            query.addBindValue(batchData[1]);
-            query.addBindValue(batchData[2]);
-            query.execBatch();
-            QSqlDatabase::database("vk701").commit();
-            batchData.clear();
-        }
-    });
-    dbCommitTimer->start(500); // 每500ms提交一次
+    // 创建振动数据记录线程, 使用独立的数据库连接成组提交, 界面线程不参与写库
+    recorderThread = new QThread();
+    recorder = new VibrationRecorder();
+    recorder->dbFileName = vibDBFile;
+    recorder->segmentDir = vibRawDir;
+    recorder->moveToThread(recorderThread);
+    connect(recorderThread, &QThread::started, recorder, &VibrationRecorder::doWork);
+    connect(recorderThread, &QThread::finished, recorder, &QObject::deleteLater);
+    connect(recorderThread, &QThread::finished, recorderThread, &QObject::deleteLater);
+    connect(recorder, &VibrationRecorder::statsUpdated, this, &vk701page::handleRecorderStats, Qt::QueuedConnection);
 
     // 创建单独的数据读取线程
     workerThread = new QThread();
@@ -86,12 +99,29 @@ vk701page::vk701page(QWidget *parent)
     connect(workerThread, &QThread::finished, worker, &QObject::deleteLater);
     connect(workerThread, &QThread::finished, workerThread, &QObject::deleteLater);
 
-    // 连接数据处理信号和槽
-    connect(worker, &vk701nsd::resultValue, this, &vk701page::handleResultValue, Qt::QueuedConnection);
-    
+    // 注册环形缓冲区绘图消费者
+    daqRing = worker->ringBuffer();
+    plotConsumer = daqRing->addConsumer("plot");
+
+    // 创建振动在线分析线程, 作为环形缓冲区的另一个消费者
+    analyzerThread = new QThread();
+    analyzer = new VibrationAnalyzer();
+    analyzer->setRingBuffer(daqRing);
+    analyzer->moveToThread(analyzerThread);
+    connect(analyzerThread, &QThread::started, analyzer, &VibrationAnalyzer::doWork);
+    connect(analyzerThread, &QThread::finished, analyzer, &QObject::deleteLater);
+    connect(analyzerThread, &QThread::finished, analyzerThread, &QObject::deleteLater);
+    connect(analyzer, &VibrationAnalyzer::featuresReady, this, &vk701page::handleVibFeatures, Qt::QueuedConnection);
+    analyzerThread->start();
+
+    // 记录线程作为环形缓冲区的消费者独立读取, 采集线程只写环形缓冲区
+    recorder->setRingBuffer(daqRing);
+    recorderThread->start();
+
     // 新增: 连接状态变化和消息信号
     connect(worker, &vk701nsd::stateChanged, this, &vk701page::handleStateChanged);
     connect(worker, &vk701nsd::resultMsg, this, &vk701page::handleResultMsg);
+    connect(worker, &vk701nsd::streamStatsUpdated, this, &vk701page::handleStreamStats, Qt::QueuedConnection);
 
     // 在vk701page构造函数中添加这行代码
     connect(ui->btn_exit, &QPushButton::clicked, this, &vk701page::on_btn_exit_clicked);
@@ -108,22 +138,9 @@ vk701page::~vk701page()
         delete plotUpdateTimer;
     }
     
-    if (dbCommitTimer) {
-        dbCommitTimer->stop();
-        delete dbCommitTimer;
-    }
-    
-    // 提交剩余数据
-    if (!batchData.isEmpty()) {
-        QSqlDatabase::database("vk701").transaction();
-        QSqlQuery query(QSqlDatabase::database("vk701"));
-        query.prepare("INSERT INTO IEPEdata (RoundID, ChID, VibrationData) VALUES (?, ?, ?)");
-        query.addBindValue(batchData[0]);
-        query.addBindValue(batchData[1]);
-        query.addBindValue(batchData[2]);
-        query.execBatch();
-        QSqlDatabase::database("vk701").commit();
-    }
+    // 停止分析线程和记录线程, 剩余数据在退出前提交
+    safelyShutdownAnalyzer();
+    safelyShutdownRecorder();
     
     // 关闭数据库连接
     if (db.isOpen()) {
@@ -133,38 +150,41 @@ vk701page::~vk701page()
     delete ui;
 }
 
-// 处理数据采集线程返回的数据
-void vk701page::handleResultValue(QVector<double> *list)
+// 从环形缓冲区读取绘图数据, 追加到本轮的历史金字塔中
+void vk701page::drainPlotBlocks()
 {
-    // 记录开始的时间
-    if(startTimeflag != false) {
-        startTime = QDateTime::currentDateTime();
-        startTimeflag = false;
-    }
-    
-    // 获取数据大小
-    int size = list->size();
-    if (size <= 0) return;
-    
-    // 保存数据到本地缓存，用于更新图表
-    {
+    bool received = false;
+    while (daqRing->read(plotConsumer, plotBlock)) {
+        // 记录开始的时间
+        if (startTimeflag != false) {
+            startTime = QDateTime::currentDateTime();
+            startTimeflag = false;
+        }
+
+        // 各通道连续数据直接送入金字塔, 增量更新各层的最小/最大值
         QMutexLocker locker(&dataMutex); // 锁定数据互斥锁
-        currentData = *list; // 复制数据
+        history.append(*plotBlock);
+        received = true;
     }
-    
-    // 标记需要更新图表
-    needPlotUpdate = true;
-    
-    // 保存数据到数据库（如果数据记录标志为真）
-    if (AllRecordStart) {
-        // 使用QtConcurrent异步保存数据，避免阻塞UI
-        QtConcurrent::run(this, &vk701page::saveDataToDatabase, *list, 4, size/4);
+    plotBlock.reset(); // 及时释放句柄, 让生产者可以复用该块
+
+    if (received) {
+        // 标记需要更新图表
+        needPlotUpdate = true;
+    }
+
+    quint64 overruns = daqRing->overruns(plotConsumer);
+    if (overruns != lastPlotOverruns) {
+        qDebug() << "绘图消费者溢出块数:" << overruns;
+        lastPlotOverruns = overruns;
     }
 }
 
 // 处理状态变化
 void vk701page::handleStateChanged(DAQState newState)
 {
+    daqState = newState;
+
     // 根据状态更新UI
     switch (newState) {
         case DAQState::Disconnected:
@@ -196,6 +216,92 @@ void vk701page::handleStateChanged(DAQState newState)
     }
 }
 
+// 处理流采集统计
+void vk701page::handleStreamStats(DAQStreamStats stats)
+{
+    if (daqState != DAQState::Running) {
+        return;
+    }
+    QString text = QString("状态: 采集中  丢失: %1点 / 断点: %2次")
+                   .arg(stats.droppedSamples)
+                   .arg(stats.gapCount);
+    if (recordLostSamples > 0) {
+        text += QString("  记录丢失: %1点").arg(recordLostSamples);
+    }
+    ui->statusLabel->setText(text);
+}
+
+// 处理记录线程统计
+void vk701page::handleRecorderStats(RecorderStats stats)
+{
+    if (stats.overrunBlocks != lastRecorderOverruns) {
+        qDebug() << "记录线程读取落后, 累计被覆盖块数:" << stats.overrunBlocks
+                 << "未读块数峰值:" << stats.maxQueueDepth << "/" << stats.queueCapacity;
+        lastRecorderOverruns = stats.overrunBlocks;
+    }
+    // 本轮未被记录的点数在状态栏提示
+    recordLostSamples = stats.lostSamples - roundLostBase;
+    if (stats.droppedChunks != lastRecorderDropped) {
+        qDebug() << "振动数据提交积压, 累计丢弃存储块数:" << stats.droppedChunks;
+        lastRecorderDropped = stats.droppedChunks;
+    }
+    ui->statusLabel->setToolTip(QString("记录未读块: %1/%2 (峰值 %3)\n已写入: %4 块, %5 KB\n提交耗时: %6 ms (峰值 %7 ms)\n段文件: %8 个, %9 MB\n记录断点: %10 次, 丢弃存储块: %11")
+                                .arg(stats.queueDepth).arg(stats.queueCapacity).arg(stats.maxQueueDepth)
+                                .arg(stats.writtenChunks).arg(stats.writtenBytes / 1024)
+                                .arg(stats.lastCommitMs).arg(stats.maxCommitMs)
+                                .arg(stats.segmentCount).arg(stats.segmentBytes / (1024 * 1024))
+                                .arg(stats.recordGaps).arg(stats.droppedChunks));
+}
+
+// 处理振动特征: 转发给 Modbus 写库线程记录, 并在各通道图表的提示中显示
+void vk701page::handleVibFeatures(VibFeatureFrame frame)
+{
+    emit vibFeaturesReady(frame);
+
+    for (int ch = 0; ch < frame.channels.size() && ch < 4; ch++) {
+        const VibChannelFeatures &f = frame.channels[ch];
+        qcustomplot[ch]->setToolTip(QString("有效值: %1 mV\n峰值: %2 mV\n主频: %3 Hz\n峰值因子: %4\n峭度: %5")
+                                    .arg(f.rms * 1000, 0, 'f', 2)
+                                    .arg(f.peak * 1000, 0, 'f', 2)
+                                    .arg(f.peakFrequency, 0, 'f', 1)
+                                    .arg(f.crestFactor, 0, 'f', 2)
+                                    .arg(f.kurtosis, 0, 'f', 2));
+    }
+}
+
+// 安全关闭分析线程
+void vk701page::safelyShutdownAnalyzer()
+{
+    if (analyzerThread && analyzerThread->isRunning()) {
+        analyzer->requestStop();
+        analyzerThread->quit();
+        if (!analyzerThread->wait(3000)) {
+            qDebug() << "分析线程未能在3秒内退出";
+            return;
+        }
+        // 线程结束后对象由deleteLater释放
+        analyzerThread = nullptr;
+        analyzer = nullptr;
+    }
+}
+
+// 安全关闭记录线程
+void vk701page::safelyShutdownRecorder()
+{
+    if (recorderThread && recorderThread->isRunning()) {
+        recorder->endRound();
+        recorder->requestStop();
+        recorderThread->quit();
+        if (!recorderThread->wait(5000)) {
+            qDebug() << "记录线程未能在5秒内退出";
+            return;
+        }
+        // 线程结束后对象由deleteLater释放
+        recorderThread = nullptr;
+        recorder = nullptr;
+    }
+}
+
 // 处理消息
 void vk701page::handleResultMsg(QString msg)
 {
@@ -220,76 +326,50 @@ void vk701page::safelyShutdownWorker()
     }
 }
 
-// 异步保存数据到数据库
-void vk701page::saveDataToDatabase(const QVector<double> &data, int channels, int pointsPerChannel)
-{
-    // 检查数据有效性
-    if (data.isEmpty() || channels <= 0 || pointsPerChannel <= 0) {
-        return;
-    }
-    
-    QVariantList roundIds;
-    QVariantList channelIds;
-    QVariantList values;
-    
-    // 准备批量插入数据
-    for (int i = 0; i < pointsPerChannel; i++) {
-        for (int j = 0; j < channels; j++) {
-            int index = i * channels + j;
-            if (index < data.size()) {
-                roundIds.append(currentRoundID);
-                channelIds.append(j + 1);  // 通道编号从1开始
-                values.append(data[index]);
-            }
-        }
-    }
-    
-    // 使用互斥锁保护批量数据
-    {
-        QMutexLocker locker(&dataMutex);
-        batchData.clear();
-        batchData.append(roundIds);
-        batchData.append(channelIds);
-        batchData.append(values);
-    }
-}
-
 // 更新图表
 void vk701page::updatePlots()
 {
+    drainPlotBlocks();
+
     if (!needPlotUpdate) {
         return;  // 如果没有新数据，不更新图表
     }
     
-    QVector<double> dataCopy;
+    // 跟随模式显示最近 plotWindowSec 秒, 否则保持用户拖动/缩放到的范围
+    double t0, t1;
     {
         QMutexLocker locker(&dataMutex);
-        dataCopy = currentData;
+        t1 = qMax(plotWindowSec, history.duration());
     }
-    
-    int size = dataCopy.size();
-    if (size <= 0) {
-        return;
-    }
-    
-    int pointsPerChannel = size / 4;
-    
-    // 更新四个通道的图表
+    t0 = t1 - plotWindowSec;
+
+    // 更新四个通道的图表, 每通道约每像素2个点, 开销与轮次长度和采样频率无关
     for (int i = 0; i < 4; i++) {
-        QVector<double> x(pointsPerChannel), y(pointsPerChannel);
-        
-        for (int j = 0; j < pointsPerChannel; j++) {
-            x[j] = j;
-            y[j] = dataCopy[j * 4 + i] * 1000; // 转换为毫伏
+        if (!plotFollowLive) {
+            t0 = qcustomplot[i]->xAxis->range().lower;
+            t1 = qcustomplot[i]->xAxis->range().upper;
+        }
+        double minY = 0.0;
+        double maxY = 0.0;
+        {
+            QMutexLocker locker(&dataMutex);
+            history.render(i, t0, t1, qcustomplot[i]->axisRect()->width(),
+                           plotKeys, plotValues, 1000, &minY, &maxY); // 转换为毫伏
         }
         
         // 更新数据而不是清除和重建图表
-        qcustomplot[i]->graph(0)->setData(x, y);
-        qcustomplot[i]->xAxis->setRange(0, pointsPerChannel);
+        qcustomplot[i]->graph(0)->setData(plotKeys, plotValues, true);
+        if (plotFollowLive) {
+            updatingPlotRange = true;
+            qcustomplot[i]->xAxis->setRange(t0, t1);
+            updatingPlotRange = false;
+        }
+        if (plotKeys.isEmpty()) {
+            qcustomplot[i]->replot(QCustomPlot::rpQueuedReplot);
+            continue;
+        }
         
         // 判断是否需要自动调整Y轴范围
-        double minY = *std::min_element(y.begin(), y.end());
-        double maxY = *std::max_element(y.begin(), y.end());
         double margin = (maxY - minY) * 0.1; // 10%的边距
         qcustomplot[i]->yAxis->setRange(minY - margin, maxY + margin);
         
@@ -300,6 +380,27 @@ void vk701page::updatePlots()
     needPlotUpdate = false;
 }
 
+// 用户拖动/缩放某个图表的横轴: 停止跟随, 四个通道同步到同一时间范围
+void vk701page::handlePlotRangeChanged(int index, const QCPRange &range)
+{
+    if (updatingPlotRange) {
+        return;
+    }
+    plotFollowLive = false;
+
+    updatingPlotRange = true;
+    for (int i = 0; i < 4; i++) {
+        if (i != index) {
+            qcustomplot[i]->xAxis->setRange(range);
+        }
+    }
+    updatingPlotRange = false;
+
+    // 立即按新范围重新抽取, 不等待定时器
+    needPlotUpdate = true;
+    updatePlots();
+}
+
 // 开始采集按钮处理
 void vk701page::on_btn_start_2_clicked()
 {
@@ -312,6 +413,7 @@ void vk701page::on_btn_start_2_clicked()
         if (sa <= 100000 && sa >= 1000) {  // 采样频率在1-100K
             worker->samplingFrequency = sa;
             worker->setBufferSize(4 * sa); // 更新缓冲区大小
+            daqSampleRate = sa;
         }
         ui->le_samplingFrequency->setEnabled(false);
         workerThread->start();
@@ -324,7 +426,24 @@ void vk701page::on_btn_start_2_clicked()
 
     // 轮次+1
     currentRoundID++;
+    if (recorder) {
+        const RecordMode mode = (daqSampleRate >= VIB_RAW_RECORD_MIN_RATE) ? RecordMode::RawSegments
+                                                                          : RecordMode::Database;
+        recorder->beginRound(currentRoundID, daqSampleRate, mode);
+        roundLostBase += recordLostSamples;
+        recordLostSamples = 0;
+    }
+    if (analyzer) {
+        analyzer->beginRound(currentRoundID, daqSampleRate);
+    }
     
+    // 清空上一轮的历史数据, 横轴从本轮开始计时
+    {
+        QMutexLocker locker(&dataMutex);
+        history.reset(DAQ_CHANNEL_COUNT, daqSampleRate);
+    }
+    plotFollowLive = true;
+
     // 启动定时器以适当的间隔更新UI
     plotUpdateTimer->start(plotUpdateInterval);
 }
@@ -334,8 +453,11 @@ void vk701page::on_btn_stop_2_clicked()
 {
     ui->btn_start_2->setEnabled(true);
     
-    // 停止数据记录
+    // 停止数据记录, 记录线程会提交本轮剩余数据
     AllRecordStart = false;
+    if (recorder) {
+        recorder->endRound();
+    }
     
     // 停止采集卡
     worker->fDAQSampleClr = true;
@@ -397,17 +519,9 @@ void vk701page::closeEvent(QCloseEvent *event)
     // 确认关闭，先安全停止线程
     safelyShutdownWorker();
     
-    // 提交剩余数据
-    if (!batchData.isEmpty()) {
-        QSqlDatabase::database("vk701").transaction();
-        QSqlQuery query(QSqlDatabase::database("vk701"));
-        query.prepare("INSERT INTO IEPEdata (RoundID, ChID, VibrationData) VALUES (?, ?, ?)");
-        query.addBindValue(batchData[0]);
-        query.addBindValue(batchData[1]);
-        query.addBindValue(batchData[2]);
-        query.execBatch();
-        QSqlDatabase::database("vk701").commit();
-    }
+    // 停止分析线程和记录线程, 剩余数据在退出前提交
+    safelyShutdownAnalyzer();
+    safelyShutdownRecorder();
     
     // 关闭数据库连接
     if (db.isOpen()) {
@@ -488,8 +602,12 @@ void vk701page::InitDB(const QString &fileName)
     pragmaQuery.exec("PRAGMA cache_size = 10000"); // 增加缓存大小
     pragmaQuery.exec("PRAGMA temp_store = MEMORY"); // 临时存储使用内存
 
-    // 读取数据库最后一行中的RoundID，保持轮次连贯性
-    QSqlQuery query("SELECT MAX(RoundID) FROM IEPEdata", db);
+    // 振动数据按块以BLOB存储, 旧库中也需要补建该表
+    VibrationStore::createTables(db);
+
+    // 读取数据库最后一行中的RoundID，保持轮次连贯性 (兼容旧的逐样本表)
+    QSqlQuery query("SELECT MAX(RoundID) FROM (SELECT MAX(RoundID) AS RoundID FROM IEPEBlocks "
+                    "UNION ALL SELECT MAX(RoundID) FROM IEPEdata)", db);
     if (query.exec() && query.first()) {
         currentRoundID = query.value(0).toInt();
         qDebug() << "当前最大轮次ID:" << currentRoundID;
@@ -514,8 +632,9 @@ void vk701page::cleanupOldData(int keepLastNRounds)
     db.transaction();
     
     QSqlQuery deleteQuery(db);
-    // 删除IEPEdata表中的旧数据
-    if (!deleteQuery.exec(QString("DELETE FROM IEPEdata WHERE RoundID < %1").arg(deleteBeforeRound))) {
+    // 删除IEPEdata/IEPEBlocks表中的旧数据
+    if (!deleteQuery.exec(QString("DELETE FROM IEPEdata WHERE RoundID < %1").arg(deleteBeforeRound)) ||
+        !deleteQuery.exec(QString("DELETE FROM IEPEBlocks WHERE RoundID < %1").arg(deleteBeforeRound))) {
         qDebug() << "删除旧数据失败:" << deleteQuery.lastError().text();
         db.rollback();
         return;
@@ -554,58 +673,82 @@ void vk701page::on_btn_showDB_clicked()
     // 清空表格已有数据
     ui->table_vibDB->setRowCount(0);
 
-    // 使用分页查询提高性能，避免一次加载全部数据
-    const int pageSize = 1000; // 每页记录数
-    int currentPage = 0;
+    // 范围按样本行号选取 (从1开始, 与原 IEPEdata 的行号含义一致):
+    // 先按块的点数累计出覆盖该范围的数据块, 只解码这些块, 首尾块只显示范围内的样本
     int row = 0;
     
     QSqlQuery query(db);
-    // 设置查询超时
     query.setForwardOnly(true); // 只向前滚动结果集，节省内存
     
     // 设置表头
     ui->table_vibDB->setColumnCount(3);
     ui->table_vibDB->setHorizontalHeaderLabels({"轮次ID", "通道ID", "振动数据"});
     
-    // 使用分页查询
-    while (true) {
-        int offset = currentPage * pageSize;
-        QString queryStr = QString("SELECT * FROM IEPEdata WHERE rowid BETWEEN %1 AND %2 LIMIT %3 OFFSET %4")
-                           .arg(start).arg(end).arg(pageSize).arg(offset);
-                           
-        if (!query.exec(queryStr)) {
-            qDebug() << "查询失败." << query.lastError().text();
-            break;
+    qint64 firstBlock = -1, lastBlock = -1;
+    qint64 skip = 0;                            // 第一块中范围之前的样本数
+    if (!query.exec("SELECT rowid, Points FROM IEPEBlocks ORDER BY rowid")) {
+        qDebug() << "查询失败." << query.lastError().text();
+        return;
+    }
+    qint64 sampleBase = 1;                      // 当前块第一个样本的行号
+    while (query.next()) {
+        const qint64 rowid = query.value(0).toLongLong();
+        const qint64 points = query.value(1).toLongLong();
+        if (sampleBase + points > start && firstBlock < 0) {
+            firstBlock = rowid;
+            skip = qMax<qint64>(0, start - sampleBase);
         }
-        
-        // 如果没有更多记录，退出循环
-        if (!query.next()) {
+        if (firstBlock >= 0) {
+            lastBlock = rowid;
+        }
+        sampleBase += points;
+        if (sampleBase > end) {
             break;
         }
-        
-        // 处理本页数据
-        do {
-            ui->table_vibDB->insertRow(row);
-            for (int var = 0; var < 3; ++var) {
-                ui->table_vibDB->setItem(row, var, new QTableWidgetItem(query.value(var).toString()));
-            }
-            row++;
-            
-            // 当加载足够多的行时，更新UI以保持响应性
-            if (row % 100 == 0) {
+    }
+
+    if (firstBlock >= 0) {
+        query.prepare("SELECT RoundID, ChID, Data FROM IEPEBlocks WHERE rowid BETWEEN ? AND ? ORDER BY rowid");
+        query.addBindValue(firstBlock);
+        query.addBindValue(lastBlock);
+        if (!query.exec()) {
+            qDebug() << "查询失败." << query.lastError().text();
+        } else {
+            QVector<double> samples;
+            qint64 remain = qint64(end) - qMax(1, start) + 1;
+            while (remain > 0 && query.next()) {
+                const QString roundId = query.value(0).toString();
+                const QString chId = query.value(1).toString();
+                if (!decodeVibrationBlock(query.value(2).toByteArray(), samples)) {
+                    qDebug() << "数据块解码失败, 轮次" << roundId << "通道" << chId;
+                    skip = 0;
+                    continue;
+                }
+
+                const int from = static_cast<int>(qMin<qint64>(skip, samples.size()));
+                const int count = static_cast<int>(qMin<qint64>(remain, samples.size() - from));
+                skip = 0;
+                ui->table_vibDB->setRowCount(row + count);
+                for (int i = from; i < from + count; ++i) {
+                    ui->table_vibDB->setItem(row, 0, new QTableWidgetItem(roundId));
+                    ui->table_vibDB->setItem(row, 1, new QTableWidgetItem(chId));
+                    ui->table_vibDB->setItem(row, 2, new QTableWidgetItem(QString::number(samples[i])));
+                    row++;
+                }
+                remain -= count;
+
+                // 每块处理后更新UI以保持响应性
                 QApplication::processEvents();
             }
-        } while (query.next());
-        
-        currentPage++;
+        }
     }
 
-    // 查询所有记录数量并显示
-    query.prepare("SELECT COUNT(*) FROM IEPEdata");
+    // 查询所有样本数量并显示
+    query.prepare("SELECT IFNULL(SUM(Points), 0) FROM IEPEBlocks");
     if (query.exec() && query.next()) {
-        int rowCount = query.value(0).toInt();
-        qDebug() << "表中的行数:" << rowCount;
-        ui->le_totalDataNum->setText(QString::number(rowCount));
+        qint64 sampleCount = query.value(0).toLongLong();
+        qDebug() << "样本总数:" << sampleCount;
+        ui->le_totalDataNum->setText(QString::number(sampleCount));
     } else {
         qDebug() << "查询失败:" << query.lastError().text();
     }
@@ -626,7 +769,8 @@ void vk701page::on_btn_deleteData_clicked()
     QSqlQuery query(db);
     // 删除IEPEdata表中的数据
     QString deleteQuery = QString("DELETE FROM IEPEdata WHERE RoundID = %1").arg(round);
-    if (query.exec(deleteQuery)) {
+    QString deleteBlockQuery = QString("DELETE FROM IEPEBlocks WHERE RoundID = %1").arg(round);
+    if (query.exec(deleteQuery) && query.exec(deleteBlockQuery)) {
         // 同时删除TimeRecord表中相应的记录
         query.exec(QString("DELETE FROM TimeRecord WHERE Round = %1").arg(round));
         qDebug() << "数据删除成功.";
@@ -668,6 +812,13 @@ void vk701page::on_btn_nuke_clicked()
         return;
     }
     
+    // 删除IEPEBlocks表中的所有数据
+    if (!query.exec("DELETE FROM IEPEBlocks")) {
+        qDebug() << "删除IEPEBlocks表数据失败:" << query.lastError().text();
+        db.rollback();
+        return;
+    }
+    
     // 删除TimeRecord表中的所有数据
     if (!query.exec("DELETE FROM TimeRecord")) {
         qDebug() << "删除TimeRecord表数据失败:" << query.lastError().text();
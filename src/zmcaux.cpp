@@ -9577,6 +9577,153 @@ int32  ZAux_Direct_GetAllAxisInfo(ZMC_HANDLE handle,int imaxaxis,int * IdleStatu
 	return iresult;
 }
 
+//批量读取时单条命令的容量 (命令与应答缓冲均为 2048 字节)
+#define ZAUX_BATCH_MAX_ITEMS	128
+#define ZAUX_BATCH_MAX_CMD		1536
+
+/*************************************************************
+Description:    //整数转为十进制字符串, 不含结束符
+Input:          //ivalue 非负整数
+Output:         //pbuff 输出位置
+Return:         //写入的字符数
+*************************************************************/
+static int ZAux_BatchFormatUint(char *pbuff, unsigned int ivalue)
+{
+	char  atemp[12];
+	int   ilen = 0;
+	int   i;
+
+	do
+	{
+		atemp[ilen++] = (char)('0' + ivalue % 10);
+		ivalue /= 10;
+	} while(ivalue);
+
+	for(i = 0; i < ilen; i++)
+	{
+		pbuff[i] = atemp[ilen - 1 - i];
+	}
+	return ilen;
+}
+
+/*************************************************************
+Description:    //依次解析空白分隔的多个数值, 与 ZAux_TransStringtoFloat 相同按 strtod 转换,
+				但跳过换行并校验个数, 应答不足时不会留下未写入的输出
+Input:          //pstringin 应答字符串
+				inumes    解析个数
+Output:         //pfvalue 解析结果
+Return:         //错误码, 个数不足时返回 ERR_ACKERROR
+*************************************************************/
+static int32 ZAux_BatchParseFloat(const char *pstringin, int inumes, float *pfvalue)
+{
+	const char *p = pstringin;
+	char *pend;
+	int   i;
+
+	for(i = 0; i < inumes; i++)
+	{
+		while((' ' == *p) || ('\t' == *p) || ('\r' == *p) || ('\n' == *p))
+		{
+			p++;
+		}
+		if(!(isdigit((unsigned char)*p) || ('-' == *p)))
+		{
+			return ERR_ACKERROR;
+		}
+		double dvalue = strtod(p, &pend);
+		if(pend == p)
+		{
+			return ERR_ACKERROR;
+		}
+		pfvalue[i] = (float)dvalue;
+		p = pend;
+	}
+
+	return ERR_OK;
+}
+
+/*************************************************************
+Description:    //批量读取多个轴参数, 多个 (参数名, 轴号) 合并为一条命令, 一次往返
+Input:          //卡链接handle
+				sParams  参数名数组, 如 "MPOS"
+				piAxis   轴号数组
+				inum     读取个数, 超过单条命令容量时自动分成多条
+Output:         //pfValue 读取值, 与输入顺序一致
+Return:         //错误码
+*************************************************************/
+int32  ZAux_Direct_GetParamBatch(ZMC_HANDLE handle, const char * const *sParams, const int *piAxis, int inum, float *pfValue)
+{
+	int32 iresult;
+	int   isend, icur, ilen;
+	char  cmdbuff[2048];
+	char  cmdbuffAck[2048];
+
+	if(NULL == sParams || NULL == piAxis || NULL == pfValue || inum < 0)
+	{
+		return  ERR_AUX_PARAERR;
+	}
+
+	isend = 0;
+	while(isend < inum)
+	{
+		//生成命令 "?MPOS(0) MSPEED(0) ..."
+		cmdbuff[0] = '?';
+		ilen = 1;
+		icur = 0;
+		while((isend + icur < inum) && (icur < ZAUX_BATCH_MAX_ITEMS))
+		{
+			const char *pname = sParams[isend + icur];
+			int   iaxis = piAxis[isend + icur];
+			int   inamelen;
+
+			if(NULL == pname || iaxis < 0 || iaxis >= MAX_AXIS_AUX)
+			{
+				return  ERR_AUX_PARAERR;
+			}
+			inamelen = (int)strlen(pname);
+			if(ilen + inamelen + 8 > ZAUX_BATCH_MAX_CMD)
+			{
+				break;
+			}
+			memcpy(cmdbuff + ilen, pname, inamelen);
+			ilen += inamelen;
+			cmdbuff[ilen++] = '(';
+			ilen += ZAux_BatchFormatUint(cmdbuff + ilen, (unsigned int)iaxis);
+			cmdbuff[ilen++] = ')';
+			cmdbuff[ilen++] = ' ';
+			icur++;
+		}
+		if(0 == icur)
+		{
+			return  ERR_AUX_PARAERR;
+		}
+		cmdbuff[ilen - 1] = '\0';
+
+		//调用命令执行函数
+		iresult = ZAux_DirectCommand(handle, cmdbuff, cmdbuffAck, 2048);
+		if(ERR_OK != iresult)
+		{
+			return iresult;
+		}
+
+		//
+		if(0 == strlen(cmdbuffAck))
+		{
+			return ERR_NOACK;
+		}
+
+		iresult = ZAux_BatchParseFloat(cmdbuffAck, icur, pfValue + isend);
+		if(ERR_OK != iresult)
+		{
+			return iresult;
+		}
+
+		isend += icur;
+	}
+
+	return ERR_OK;
+}
+
 /*************************************************************
 Description:    //设置BASIC自定义全局数组  
 Input:          //卡链接handle  
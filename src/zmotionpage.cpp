@@ -1,5 +1,10 @@
 #include "inc/zmotionpage.h"
 #include "inc/Global.h"
+#include "inc/livesensors.h"
+#include "inc/axistelemetry.h"
+#include "inc/motionstate.h"
+#include "inc/controlexecutor.h"
+#include "inc/sensorclock.h"
 #include "ui_zmotionpage.h"
 
 // 电机映射表，EtherCAT的映射关系
@@ -509,13 +514,35 @@ void zmotionpage::advanceInfoRefreash()
     //刷新轴号，获取更新轴当前实时反馈的运动参数
     int m_atype,m_AxisStatus,m_Idle;
     float m_units,m_speed,m_accel,m_decel,m_fMpos,m_fDpos;
+    int m_bAxisEnable;
 
-    //轴状态更新,可选手动更新的参数
-    ZAux_Direct_GetAtype(g_handle, MotorMap[selectindex], &m_atype);                        // 轴类型
-    ZAux_Direct_GetUnits(g_handle, MotorMap[selectindex], &m_units);                        // 单位
-    ZAux_Direct_GetSpeed(g_handle, MotorMap[selectindex], &m_speed);                        // 速度
-    ZAux_Direct_GetAccel(g_handle, MotorMap[selectindex], &m_accel);                        // 加速度
-    ZAux_Direct_GetDecel(g_handle, MotorMap[selectindex], &m_decel);                        // 减速度
+    // 统一轮询运行时直接取快照, 不再逐项查询控制器
+    const int axis = MotorMap[selectindex];
+    const AxisStateArray state = (g_motionState && g_motionState->isRunning()) ? g_motionState->snapshot() : AxisStateArray();
+    if (state.isValid(axis)) {
+        const AxisState &a = state.axis[axis];
+        m_atype = a.atype;
+        m_units = a.units;
+        m_speed = a.speed;
+        m_accel = a.accel;
+        m_decel = a.decel;
+        m_fMpos = a.mpos;
+        m_fDpos = a.dpos;
+        m_AxisStatus = a.axisStatus;
+        m_Idle = a.idle;
+        m_bAxisEnable = a.enabled;
+    } else {
+        ZAux_Direct_GetAtype(g_handle, axis, &m_atype);                     // 轴类型
+        ZAux_Direct_GetUnits(g_handle, axis, &m_units);                     // 单位
+        ZAux_Direct_GetSpeed(g_handle, axis, &m_speed);                     // 速度
+        ZAux_Direct_GetAccel(g_handle, axis, &m_accel);                     // 加速度
+        ZAux_Direct_GetDecel(g_handle, axis, &m_decel);                     // 减速度
+        ZAux_Direct_GetMpos(g_handle, axis, &m_fMpos);                      //轴编码器反馈位置
+        ZAux_Direct_GetDpos(g_handle, axis, &m_fDpos);                      //轴指令位置
+        ZAux_Direct_GetAxisStatus(g_handle, axis, &m_AxisStatus);           //轴状态
+        ZAux_Direct_GetIfIdle(g_handle, axis, &m_Idle);                     //轴是否在运动
+        ZAux_Direct_GetAxisEnable(g_handle, axis, &m_bAxisEnable);          // 获取轴使能状态 0 表示关闭 1 表示打开
+    }
 
     ui->LE_Atype->setText(QString ("%2").arg (m_atype));
     ui->LE_PulseEquivalent->setText(QString ("%2").arg (m_units));
@@ -523,19 +550,11 @@ void zmotionpage::advanceInfoRefreash()
     ui->LE_Accel->setText(QString ("%2").arg (m_accel));
     ui->LE_Decel->setText(QString ("%2").arg (m_decel));
 
-    ZAux_Direct_GetMpos(g_handle, MotorMap[selectindex], &m_fMpos);                         //轴编码器反馈位置
-    ZAux_Direct_GetDpos(g_handle, MotorMap[selectindex], &m_fDpos);                         //轴指令位置
-    ZAux_Direct_GetAxisStatus(g_handle, MotorMap[selectindex], &m_AxisStatus);              //轴状态
-    ZAux_Direct_GetIfIdle(g_handle, MotorMap[selectindex], &m_Idle);                        //轴是否在运动
-
     ui->LE_DirectAxisPos->setText(QString ("%2").arg (m_fDpos));
     ui->LE_CurrentAxisPos->setText(QString ("%2").arg (m_fMpos));
     ui->LE_AxisStatus->setText(QString ("%2").arg(m_AxisStatus));
     ui->LE_IfIdle->setText(m_Idle == 0 ? "Going" : (m_Idle == -1 ? "Done" : ""));
 
-    int m_bAxisEnable;
-    ZAux_Direct_GetAxisEnable(g_handle, MotorMap[selectindex], &m_bAxisEnable); // 获取轴使能状态 0 表示关闭 1 表示打开
-
     ui->Btn_Enable->setText(m_bAxisEnable ? "Disable" : "Enable");
     ui->LE_EableStatus->setText(m_bAxisEnable ? "on" : "off");
 
@@ -804,6 +823,30 @@ void zmotionpage::RefreshTableRealTimeContent()
 {
     int n = fAxisNum;                                                          // 行数等于轴数
     float fMPos, fMVel;
+    // 控制器端高速采样运行时直接取其最新值, 不再逐轴发送查询命令
+    if (g_axisTelemetry && g_axisTelemetry->isRunning()) {
+        const AxisTelemetrySample sample = g_axisTelemetry->latest();
+        for (int i = 0; i < n; ++i) {
+            const int axis = MotorMap[i];
+            if (axis < 0 || axis >= SENSOR_MOTOR_AXES || !sample.hasAxis(axis)) {
+                continue;
+            }
+            ui->tb_motor->setItem(i, 1, createTableWidgetItem(QString::number(sample.position[axis])));
+            ui->tb_motor->setItem(i, 3, createTableWidgetItem(QString::number(sample.speed[axis])));
+        }
+        return;
+    }
+    if (g_motionState && g_motionState->isRunning()) {
+        const AxisStateArray state = g_motionState->snapshot();
+        for (int i = 0; i < n; ++i) {
+            if (!state.isValid(MotorMap[i])) {
+                continue;
+            }
+            ui->tb_motor->setItem(i, 1, createTableWidgetItem(QString::number(state.axis[MotorMap[i]].mpos)));
+            ui->tb_motor->setItem(i, 3, createTableWidgetItem(QString::number(state.axis[MotorMap[i]].mspeed)));
+        }
+        return;
+    }
     for (int i = 0; i < n; ++i) {
         ui->tb_motor->setItem(i, 1, createTableWidgetItem(QString(" ")));
         ZAux_Direct_GetMpos(g_handle, MotorMap[i], &fMPos);               // 获取轴反馈位置
@@ -1096,7 +1139,48 @@ const int PERCUSSION_DAC_VALUE = -1075;        // 冲击电机DAC值  -419430 -1
 const float POSITION_TOLERANCE = 1000.0;       // 位置容忍
 const float MIN_SPEED_THRESHOLD = 0.1;         // 最小速度阈值 0.1
 const int SLEEP_DURATION = 100;                // 睡眠时长 ms
+const int MONITOR_PERIOD_US = 10000;           // 钻进下降监控周期 us
 const int DONE_WAIT_DURATION = 5000;           // 完成等待时长 ms
+const int ATYPE_SETTLE_DURATION = 10;          // 切换轴类型后的等待时长 ms
+const int ATYPE_CONFIRM_TIMEOUT = 200;         // 等待轴类型回读确认的超时 ms
+const qint64 STATE_STALE_US = 100000;          // 状态快照超过该时长未更新视为过期 us
+
+/**
+ * @brief 读取单个轴的实时状态
+ *
+ * 统一轮询运行时只取 g_motionState 的快照, 快照无效或过期时返回 false, 不额外查询控制器;
+ * 轮询未运行时用一条批量查询读取该轴的高频字段与轴类型。
+ * @return 是否读到有效值
+ */
+static bool readAxisState(int axis, AxisState &state)
+{
+    if (g_motionState && g_motionState->isRunning())
+    {
+        const AxisStateArray snapshot = g_motionState->snapshot();
+        if (!snapshot.isValid(axis) || sensorClockUs() - snapshot.timeUs > STATE_STALE_US)
+            return false;
+        state = snapshot.axis[axis];
+        return true;
+    }
+
+    if (!g_handle)
+        return false;
+    const int count = AxisFieldFastCount + 1;   // 高频字段 + AxisFieldAtype
+    const char *names[count];
+    int axes[count];
+    float values[count];
+    for (int i = 0; i < count; ++i)
+    {
+        names[i] = axisStateParamName(i);
+        axes[i] = axis;
+    }
+    if (ZAux_Direct_GetParamBatch(g_handle, names, axes, count, values) != ERR_OK)
+        return false;
+    state = AxisState();
+    for (int i = 0; i < count; ++i)
+        axisStateStore(state, i, values[i]);
+    return true;
+}
 
 #define Motor2useHall 1
 
@@ -1108,6 +1192,96 @@ const int Motor2acc = 1000;
 const int Motor2acc = 10000;
 #endif
 
+/**
+ * @brief 合并发送命令批, 失败时对未执行的命令逐条补发
+ * @return 全部命令是否最终执行成功
+ */
+bool AutoModeThread::executeWithFallback(const MotionCommandBatch &batch, const char *what)
+{
+    const MotionBatchResult result = MotionController::executeBatch(g_handle, batch);
+    if (result.success())
+        return true;
+
+    qDebug() << what << "合并发送失败, 已执行" << result.completed << "/" << batch.size()
+             << "条, ret =" << result.errorCode << ", 逐条补发";
+    MotionCommandBatch rest;
+    for (int i = result.completed; i < batch.size(); i++)
+        rest.add(batch.commands()[i]);
+    const MotionBatchResult retry = MotionController::executeEach(g_handle, rest);
+    if (!retry.success())
+    {
+        qDebug() << what << "失败, 第" << result.completed + retry.completed + 1 << "条命令出错, ret =" << retry.errorCode;
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief 停止旋转与冲击输出并取消进给运动
+ *
+ * 命令逐条发送, 某条失败不影响后续命令。
+ */
+void AutoModeThread::stopDrillMotors()
+{
+    MotionCommandBatch drillStop;
+    drillStop.setDac(MotorMap[MOTOR_IDX_ROTATION], 0)
+             .setAxisEnable(MotorMap[MOTOR_IDX_PERCUSSION], false)
+             .setDac(MotorMap[MOTOR_IDX_PERCUSSION], 0)
+             .cancel(MotorMap[MOTOR_IDX_PENETRATION], 2);
+    const MotionBatchResult stopResult = MotionController::executeEach(g_handle, drillStop);
+    for (int i = 0; i < drillStop.size(); i++)
+    {
+        if (!stopResult.ok[i])
+            qDebug() << "停止命令失败:" << drillStop.commands()[i];
+    }
+}
+
+/**
+ * @brief 等待轴类型回读为期望值, 超时或停止时返回 false
+ */
+bool AutoModeThread::waitForAtype(int axis, int atype)
+{
+    QElapsedTimer timer;
+    timer.start();
+    while (!m_stopFlag.load())
+    {
+        int current = -1;
+        if (ZAux_Direct_GetAtype(g_handle, axis, &current) == 0 && current == atype)
+            return true;
+        if (timer.elapsed() >= ATYPE_CONFIRM_TIMEOUT)
+        {
+            qDebug() << "轴" << axis << "类型回读为" << current << ", 期望" << atype;
+            return false;
+        }
+        msleep(ATYPE_SETTLE_DURATION);
+    }
+    return false;
+}
+
+/**
+ * @brief 读取进给电机位置与旋转电机速度
+ *
+ * 优先取 g_motionState 的快照, 不额外占用控制器通信; 快照过期或轮询未运行时直接查询。
+ * @return 是否读到有效值
+ */
+bool AutoModeThread::readDescentState(float &position, float &speed)
+{
+    const int penetration = MotorMap[MOTOR_IDX_PENETRATION];
+    const int rotation = MotorMap[MOTOR_IDX_ROTATION];
+    if (g_motionState && g_motionState->isRunning())
+    {
+        const AxisStateArray state = g_motionState->snapshot();
+        if (state.isValid(penetration) && state.isValid(rotation) && sensorClockUs() - state.timeUs <= STATE_STALE_US)
+        {
+            position = state.axis[penetration].mpos;
+            speed = state.axis[rotation].mspeed;
+            return true;
+        }
+    }
+    return ZAux_Direct_GetMpos(g_handle, penetration, &position) == 0 &&
+           ZAux_Direct_GetMspeed(g_handle, rotation, &speed) == 0;
+}
+
 void AutoModeThread::run()
 {
     while (!m_stopFlag.load())
@@ -1211,55 +1385,77 @@ void AutoModeThread::run()
             return;
         }
 
-        // 设置旋转电机和冲击电机
+        // 切换旋转电机和冲击电机为力矩模式, 合并为一次发送
+        MotionCommandBatch drillMode;
 #ifdef Motor2useHall
-        ZAux_Direct_SetAccel(g_handle, MotorMap[MOTOR_IDX_PERCUSSION], Motor2acc);
-        ZAux_Direct_SetDecel(g_handle, MotorMap[MOTOR_IDX_PERCUSSION], Motor2acc);
+        drillMode.setAccel(MotorMap[MOTOR_IDX_PERCUSSION], Motor2acc)
+                 .setDecel(MotorMap[MOTOR_IDX_PERCUSSION], Motor2acc);
 #endif
-        ZAux_Direct_SetAtype(g_handle, MotorMap[MOTOR_IDX_ROTATION], 66);
-        msleep(10);
-        ZAux_Direct_SetAtype(g_handle, MotorMap[MOTOR_IDX_PERCUSSION], 66);
-        msleep(10);
-        ZAux_Direct_SetDAC(g_handle, MotorMap[MOTOR_IDX_PERCUSSION], PERCUSSION_DAC_VALUE);
-        msleep(10);
-        ZAux_Direct_SetAxisEnable(g_handle, MotorMap[MOTOR_IDX_PERCUSSION], 1);
-        ZAux_Direct_SetDAC(g_handle, MotorMap[MOTOR_IDX_ROTATION], ROTATION_DAC_VALUE);
+        drillMode.setAtype(MotorMap[MOTOR_IDX_ROTATION], 66)
+                 .setAtype(MotorMap[MOTOR_IDX_PERCUSSION], 66);
+        executeWithFallback(drillMode, "切换力矩模式");
+
+        // 模式切换生效后再写 DAC
+        msleep(ATYPE_SETTLE_DURATION);
+        if (!waitForAtype(MotorMap[MOTOR_IDX_ROTATION], 66) || !waitForAtype(MotorMap[MOTOR_IDX_PERCUSSION], 66))
+        {
+            qDebug() << "力矩模式切换未生效, 取消钻进";
+            emit operationCompleted();
+            return;
+        }
+
+        MotionCommandBatch drillStart;
+        drillStart.setDac(MotorMap[MOTOR_IDX_PERCUSSION], PERCUSSION_DAC_VALUE)
+                  .setAxisEnable(MotorMap[MOTOR_IDX_PERCUSSION], true)
+                  .setDac(MotorMap[MOTOR_IDX_ROTATION], ROTATION_DAC_VALUE);
+        if (!executeWithFallback(drillStart, "启动旋转和冲击"))
+        {
+            qDebug() << "启动旋转和冲击失败, 取消钻进";
+            stopDrillMotors();
+            emit operationCompleted();
+            return;
+        }
         msleep(100);
 
-        ZAux_Direct_Single_MoveAbs(g_handle, MotorMap[MOTOR_IDX_PENETRATION], 0);
+        if (ZAux_Direct_Single_MoveAbs(g_handle, MotorMap[MOTOR_IDX_PENETRATION], 0) != 0)
+        {
+            qDebug() << "进给电机下降失败, 取消钻进";
+            stopDrillMotors();
+            emit operationCompleted();
+            return;
+        }
 
-        // 监控下降过程
+        // 监控下降过程, 按绝对截止时刻定周期检查
+        ControlPacer monitorPacer(MONITOR_PERIOD_US);
         while (!m_stopFlag.load())
         {
+            monitorPacer.waitNext();
             float currentPosition, currentSpeed;
-            ZAux_Direct_GetMpos(g_handle, MotorMap[MOTOR_IDX_PENETRATION], &currentPosition);
-            msleep(10);
-            ZAux_Direct_GetMspeed(g_handle, MotorMap[MOTOR_IDX_ROTATION], &currentSpeed);
+            if (!readDescentState(currentPosition, currentSpeed))
+                continue;
             //qDebug() << "当前进给电机位置:" << currentPosition << " 速度:" << currentSpeed; // 新增日志
+            const MdbCalibratedFrame sensors = g_liveSensors.load();
+            const float downForce = sensors.isValid(MdbTractionDown) ? static_cast<float>(sensors.absolute[MdbTractionDown]) : 0.0f;
             //qDebug() << "(int)(downForce)" << (int)(downForce) << "DOWN_FORCE_THRESHOLD" << DOWN_FORCE_THRESHOLD;
             if (std::abs(currentSpeed) < MIN_SPEED_THRESHOLD || currentPosition <= 0 || (int)(downForce) >= DOWN_FORCE_THRESHOLD)
             {
                 qDebug() << "条件满足，停止冲击和旋转"; // 新增日志
                 // 停止冲击和旋转
 
-                ZAux_Direct_SetDAC(g_handle, MotorMap[MOTOR_IDX_ROTATION], 0);
-                msleep(10);
-                ZAux_Direct_SetAxisEnable(g_handle, MotorMap[MOTOR_IDX_PERCUSSION], 0);
-                ZAux_Direct_SetDAC(g_handle, MotorMap[MOTOR_IDX_PERCUSSION], 0);
-
-                //
-
-                ZAux_Direct_Single_Cancel(g_handle, MotorMap[MOTOR_IDX_PENETRATION], 2);
-
-                int ret;
-                ret = ZAux_Direct_Rapidstop(g_handle, 2);
-                if(ret == 0)
+                // 急停单独先发, 其余停止命令逐条发送, 某条失败不影响后续命令
+                const int rapidRet = ZAux_Direct_Rapidstop(g_handle, 2);
+                if (rapidRet == 0)
                     qDebug() << "[Waring] Radpid Stop!";
+                else
+                    qDebug() << "急停失败, ret =" << rapidRet;
+
+                stopDrillMotors();
                 break;
             }
-
-            msleep(SLEEP_DURATION);
         }
+        const ControlCycleStats &monitorStats = monitorPacer.stats();
+        qDebug() << "下降监控:" << monitorStats.cycles << "个周期, 抖动均值" << monitorStats.meanJitterUs
+                 << "us 最大" << monitorStats.maxJitterUs << "us, 超时" << monitorStats.overruns << "次";
 
         if (m_stopFlag.load())
         {
@@ -2270,8 +2466,10 @@ void zmotionpage::on_btn_robotarm_clamp_close_clicked()
             return;
         }
 
-        float currentPosition = 0.0f;
-        ZAux_Direct_GetMpos(g_handle, mappedMotorID, &currentPosition);
+        AxisState axisState;
+        if (!readAxisState(mappedMotorID, axisState))
+            return;                             // 本周期无有效状态, 等待下一周期
+        float currentPosition = axisState.mpos;
         
         // 输出当前状态
         QString stateMsg;
@@ -2402,25 +2600,25 @@ void zmotionpage::monitorClampSpeed()
     static float lastPosition = 0.0f;
     static int atype = 0; // 记录当前电机模式
 
+    // 获取当前速度、位置和模式
+    AxisState axisState;
+    if (!readAxisState(mappedMotorID, axisState))
+        return;                                 // 本周期无有效状态, 等待下一周期
+    float currentSpeed = axisState.mspeed;
+    float currentPosition = axisState.mpos;
+    atype = axisState.atype;
+
     if (!timerStarted)
     {
         elapsedTimer.start();
         timerStarted = true;
         stallCounter = 0;
 
-        // 获取初始位置和当前模式
-        ZAux_Direct_GetMpos(g_handle, mappedMotorID, &lastPosition);
-        ZAux_Direct_GetAtype(g_handle, mappedMotorID, &atype);
+        // 记录初始位置和当前模式
+        lastPosition = currentPosition;
         qDebug() << "[夹紧监控] 初始位置:" << lastPosition << "模式:" << atype;
     }
 
-    // 获取当前速度和位置
-    float currentSpeed = 0.0f;
-    float currentPosition = 0.0f;
-    ZAux_Direct_GetMspeed(g_handle, mappedMotorID, &currentSpeed);
-    ZAux_Direct_GetMpos(g_handle, mappedMotorID, &currentPosition);
-    ZAux_Direct_GetAtype(g_handle, mappedMotorID, &atype);
-
     // 更新UI显示（实时显示角度）
     if (ui->le_robotarm_clamp_pos)
     {
@@ -2558,13 +2756,10 @@ void zmotionpage::updateClampStatus()
     int mappedMotorID = MotorMap[MOTOR_IDX_ROBOTCLAMP]; // 机械手夹紧电机
 
     // 获取当前夹爪位置
-    char cmdbuff[2048];
-    char cmdbuffAck[2048];
-    sprintf(cmdbuff, "?MPOS(%d)", mappedMotorID);
-
-    if (ZAux_DirectCommand(g_handle, cmdbuff, cmdbuffAck, 2048) == 0)
+    AxisState axisState;
+    if (readAxisState(mappedMotorID, axisState))
     {
-        float currentPosition = atof(cmdbuffAck);
+        float currentPosition = axisState.mpos;
 
         // 将脉冲数转换为角度
         float angleDegrees = (currentPosition / 212992.0f) * 360.0f;
@@ -2605,18 +2800,12 @@ void zmotionpage::updateRotationAngle()
 
     // 获取电机位置
     int mappedMotorID = MotorMap[MOTOR_IDX_ROBOTROTATION]; // 机械手旋转电机
-    float currentPosition = 0.0f;
-    int ret = ZAux_Direct_GetMpos(g_handle, mappedMotorID, &currentPosition);
-
-    if (ret != 0)
+    AxisState axisState;
+    if (!readAxisState(mappedMotorID, axisState))
     {
-        // 获取位置失败，停止更新
-        if (m_rotationUpdateTimer && m_rotationUpdateTimer->isActive())
-        {
-            m_rotationUpdateTimer->stop();
-        }
-        return;
+        return;                                 // 本周期无有效状态, 等待下一周期
     }
+    float currentPosition = axisState.mpos;
 
     // 将脉冲位置转换为角度（可选，取决于您的需求）
     // 假设：脉冲范围 -51500~0 对应角度范围 180~0 度
@@ -2678,11 +2867,11 @@ void zmotionpage::updateExtentLength()
     int mappedMotorID = MotorMap[MOTOR_IDX_ROBOTEXTENSION]; // 机械手移动电机
 
     // 获取当前位置
-    float currentPosition = 0.0f;
-    int ret = ZAux_Direct_GetMpos(g_handle, mappedMotorID, &currentPosition);
-
-    if (ret == 0)
+    AxisState axisState;
+    if (readAxisState(mappedMotorID, axisState))
     {
+        float currentPosition = axisState.mpos;
+
         // 转换为毫米 (手臂一圈212992脉冲对应91.1035mm)
         float lengthMm = (currentPosition / 212992.0f) * 91.1035f;
 
@@ -2702,10 +2891,6 @@ void zmotionpage::updateExtentLength()
             ui->tb_cmdWindow_2->append(msg);
         }
     }
-    else
-    {
-        qDebug() << "[伸缩] 获取位置失败，错误码:" << ret;
-    }
 }
 
 /**
@@ -2733,8 +2918,11 @@ void zmotionpage::updatePenetrationDepth()
     }
 
     // 获取当前电机位置（脉冲数）
-    float currentPulse = m_motionController->getCurrentPosition(m_penetrationMotorID);
-    
+    AxisState axisState;
+    if (!readAxisState(MotorMap[m_penetrationMotorID], axisState)) {
+        return;
+    }
+    float currentPulse = axisState.mpos;
     
     // 计算当前深度（毫米）- 将脉冲转换为毫米，考虑最大高度是最高点
     double currentDepth = PENETRATION_MAX_HEIGHT - (currentPulse / PENETRATION_PULSE_PER_MM);
@@ -3234,16 +3422,10 @@ void zmotionpage::updateStorageStatus()
     // 获取映射后的电机ID
     int mappedMotorID = MotorMap[MOTOR_IDX_STORAGE];  // 存储电机
 
-    // 获取当前电机位置
-    float currentPosition = 0.0f;
-    
-    // 使用 ZAux_Direct_GetDpos 获取当前位置
-    char cmdbuff[2048];
-    char cmdbuffAck[2048];
-    sprintf(cmdbuff, "?DPOS(%d)", mappedMotorID);
-    
-    if (ZAux_DirectCommand(g_handle, cmdbuff, cmdbuffAck, 2048) == 0) {
-        currentPosition = atof(cmdbuffAck);
+    // 获取当前电机位置 (指令位置)
+    AxisState axisState;
+    if (readAxisState(mappedMotorID, axisState)) {
+        float currentPosition = axisState.dpos;
         
         // 计算当前存储位置索引
         m_storageCurrentPosition = qRound((currentPosition - m_storageOffset) / GLOBAL_STORAGE_PULSES_PER_POSITION) % GLOBAL_STORAGE_POSITIONS;
@@ -3511,13 +3693,14 @@ void zmotionpage::updateRotationStatus()
     // 使用映射后的电机ID
     int mappedMotorID = MotorMap[MOTOR_IDX_ROTATION]; // 旋转电机
 
-    // 获取当前电机状态
-    float currentSpeed = 0.0f;
-    ZAux_Direct_GetMspeed(g_handle, mappedMotorID, &currentSpeed);
-
-    // 获取DAC值
-    float currentDAC = 0.0f;
-    ZAux_Direct_GetDAC(g_handle, mappedMotorID, &currentDAC);
+    // 获取当前电机速度与DAC值
+    AxisState axisState;
+    if (!readAxisState(mappedMotorID, axisState))
+    {
+        return;
+    }
+    float currentSpeed = axisState.mspeed;
+    float currentDAC = axisState.dac;
 
     // 如果已经手动停止但状态没更新，不要在这里覆盖状态
     if (!m_isRotating && std::abs(currentSpeed) < 1.0 && std::abs(currentDAC) < 1.0)
@@ -3553,13 +3736,14 @@ void zmotionpage::updatePercussionStatus()
     // 使用映射后的电机ID
     int mappedMotorID = MotorMap[MOTOR_IDX_PERCUSSION]; // 冲击电机
 
-    // 获取当前电机状态
-    float currentSpeed = 0.0f;
-    ZAux_Direct_GetMspeed(g_handle, mappedMotorID, &currentSpeed);
-
-    // 获取DAC值
-    float currentDAC = 0.0f;
-    ZAux_Direct_GetDAC(g_handle, mappedMotorID, &currentDAC);
+    // 获取当前电机速度与DAC值
+    AxisState axisState;
+    if (!readAxisState(mappedMotorID, axisState))
+    {
+        return;
+    }
+    float currentSpeed = axisState.mspeed;
+    float currentDAC = axisState.dac;
 
     // 如果已经手动停止但状态没更新，不要在这里覆盖状态
     if (!m_isPercussing && std::abs(currentSpeed) < 1.0 && std::abs(currentDAC) < 1.0)
@@ -4013,8 +4197,10 @@ void zmotionpage::on_btn_downclamp_open_clicked()
             return;
         }
 
-        float currentPosition = 0.0f;
-        ZAux_Direct_GetMpos(g_handle, mappedMotorID, &currentPosition);
+        AxisState axisState;
+        if (!readAxisState(mappedMotorID, axisState))
+            return;                             // 本周期无有效状态, 等待下一周期
+        float currentPosition = axisState.mpos;
         
         QString posMsg = QString("[下夹紧] 当前位置: %1, DAC: %2")
                          .arg(currentPosition, 0, 'f', 2)
@@ -4197,8 +4383,10 @@ void zmotionpage::on_btn_downclamp_close_clicked()
             return;
         }
 
-        float currentPosition = 0.0f;
-        ZAux_Direct_GetMpos(g_handle, mappedMotorID, &currentPosition);
+        AxisState axisState;
+        if (!readAxisState(mappedMotorID, axisState))
+            return;                             // 本周期无有效状态, 等待下一周期
+        float currentPosition = axisState.mpos;
         
         QString posMsg = QString("[下夹紧] 当前位置: %1, DAC: %2")
                         .arg(currentPosition, 0, 'f', 2)
@@ -4328,31 +4516,28 @@ void zmotionpage::updateDownclampStatus()
     // 使用映射后的电机ID
     int mappedMotorID = MotorMap[MOTOR_IDX_DOWNCLAMP]; // 下夹紧电机
 
-    // 确保BASE仅设置为当前电机
-    char cmdbuff[2048];
-    char cmdbuffAck[2048];
-    sprintf(cmdbuff, "BASE(%d)", mappedMotorID);
-    ZAux_DirectCommand(g_handle, cmdbuff, cmdbuffAck, 2048);
-
     static float lastPosition = 0.0f;
     static float lastSpeed = 0.0f;
     static QElapsedTimer m_elapsedTimer;
     static bool timerStarted = false;
 
+    // 获取当前位置和速度 (下面的 DAC 输出均显式指定轴号, 不再每周期发送 BASE)
+    AxisState axisState;
+    if (!readAxisState(mappedMotorID, axisState))
+    {
+        return;                                 // 本周期无有效状态, 等待下一周期
+    }
+    float currentPosition = axisState.mpos;
+    float currentSpeed = axisState.mspeed;
+
     if (!timerStarted)
     {
         m_elapsedTimer.start();
         timerStarted = true;
-        ZAux_Direct_GetMpos(g_handle, mappedMotorID, &lastPosition);
-        ZAux_Direct_GetMspeed(g_handle, mappedMotorID, &lastSpeed);
+        lastPosition = currentPosition;
+        lastSpeed = currentSpeed;
     }
 
-    // 获取当前位置和速度
-    float currentPosition = 0.0f;
-    float currentSpeed = 0.0f;
-    ZAux_Direct_GetMpos(g_handle, mappedMotorID, &currentPosition);
-    ZAux_Direct_GetMspeed(g_handle, mappedMotorID, &currentSpeed);
-
     ui->le_downclamp_status->setText(QString::number(currentPosition, 'f', 2));
 
     // 检查速度变化是否很小（堵转检测）
@@ -4580,8 +4765,10 @@ void zmotionpage::on_btn_ROBOTEXTENSION_init_clicked()
     int stableCount = 0;
     
     connect(m_robotExtensionInitTimer, &QTimer::timeout, this, [this, mappedMotorID, lastPosition, stableCount]() mutable {
-        float currentPosition = 0.0f;
-        ZAux_Direct_GetMpos(g_handle, mappedMotorID, &currentPosition);
+        AxisState axisState;
+        if (!readAxisState(mappedMotorID, axisState))
+            return;                             // 本周期无有效状态, 等待下一周期
+        float currentPosition = axisState.mpos;
         
         QString posMsg = QString("[机械手移动初始化] 当前位置: %1").arg(currentPosition, 0, 'f', 2);
         qDebug() << posMsg;
@@ -4718,8 +4905,10 @@ void zmotionpage::on_btn_ROBOTCLAMP_init_clicked()
     m_robotClampInitTimer = new QTimer(this);
     
     connect(m_robotClampInitTimer, &QTimer::timeout, this, [this, mappedMotorID, status]() {
-        float currentPosition = 0.0f;
-        ZAux_Direct_GetMpos(g_handle, mappedMotorID, &currentPosition);
+        AxisState axisState;
+        if (!readAxisState(mappedMotorID, axisState))
+            return;                             // 本周期无有效状态, 等待下一周期
+        float currentPosition = axisState.mpos;
         
         QString posMsg = QString("[机械手夹爪初始化] 当前位置: %1, DAC: %2")
                          .arg(currentPosition, 0, 'f', 2)
@@ -4879,16 +5068,16 @@ void zmotionpage::on_btn_connect_fast_clicked()
         }
         
         // 获取当前位置
-        float currentPos = 0.0f;
-        int result = ZAux_Direct_GetParam(g_handle, "DPOS", MotorMap[MOTOR_IDX_PENETRATION], &currentPos);
-        if (result != 0) {
-            qDebug() << "获取进给电机位置失败，错误码:" << result;
-            ui->tb_cmdWindow_2->append(QString("获取进给电机位置失败，错误码: %1").arg(result));
+        AxisState axisState;
+        if (!readAxisState(MotorMap[MOTOR_IDX_PENETRATION], axisState)) {
+            qDebug() << "获取进给电机位置失败";
+            ui->tb_cmdWindow_2->append(QString("获取进给电机位置失败"));
             m_connectFastRunning = false;
             monitorTimer->stop();
             monitorTimer->deleteLater();
             return;
         }
+        float currentPos = axisState.dpos;
         
         // 输出当前位置信息（每设定阈值个单位）
         static float lastReportedPos = 0;
@@ -5002,8 +5191,10 @@ void zmotionpage::on_btn_DOWNCLAMP_init_clicked()
     m_downclampInitTimer = new QTimer(this);
     
     connect(m_downclampInitTimer, &QTimer::timeout, this, [this, mappedMotorID, status]() {
-        float currentPosition = 0.0f;
-        ZAux_Direct_GetMpos(g_handle, mappedMotorID, &currentPosition);
+        AxisState axisState;
+        if (!readAxisState(mappedMotorID, axisState))
+            return;                             // 本周期无有效状态, 等待下一周期
+        float currentPosition = axisState.mpos;
         
         QString posMsg = QString("[下夹紧初始化] 当前位置: %1, DAC: %2")
                          .arg(currentPosition, 0, 'f', 2)
@@ -5570,16 +5761,16 @@ void zmotionpage::on_btn_disconnect_fast_clicked()
         }
         
         // 获取当前位置
-        float currentPos = 0.0f;
-        int result = ZAux_Direct_GetParam(g_handle, "DPOS", MotorMap[MOTOR_IDX_PENETRATION], &currentPos);
-        if (result != 0) {
-            qDebug() << "获取进给电机位置失败，错误码:" << result;
-            ui->tb_cmdWindow_2->append(QString("获取进给电机位置失败，错误码: %1").arg(result));
+        AxisState axisState;
+        if (!readAxisState(MotorMap[MOTOR_IDX_PENETRATION], axisState)) {
+            qDebug() << "获取进给电机位置失败";
+            ui->tb_cmdWindow_2->append(QString("获取进给电机位置失败"));
             m_connectFastRunning = false;
             monitorTimer->stop();
             monitorTimer->deleteLater();
             return;
         }
+        float currentPos = axisState.dpos;
         
         // 输出当前位置信息（每设定阈值个单位）
         static float lastReportedPos = 0;
@@ -5623,16 +5814,17 @@ void zmotionpage::monitorPercussionUnlocking()
     }
     
     int mappedMotorID = MotorMap[MOTOR_IDX_PERCUSSION];
-    float currentPos = 0.0f;
     
     // 获取当前位置
-    int ret = ZAux_Direct_GetDpos(g_handle, mappedMotorID, &currentPos);
-    if (ret != 0) {
-        QString errorMsg = QString("[冲击电机] 错误: 获取位置失败，错误码: %1").arg(ret);
+    AxisState axisState;
+    if (!readAxisState(mappedMotorID, axisState)) {
+        QString errorMsg = QString("[冲击电机] 错误: 获取位置失败");
         qDebug() << errorMsg;
         ui->tb_cmdWindow_2->append(errorMsg);
         return;
     }
+    float currentPos = axisState.dpos;
+    int ret = 0;
     
     qDebug() << "[冲击电机] 当前位置:" << currentPos << "上次位置:" << m_lastPercussionPos;
     